@@ -13,7 +13,7 @@ void BattleEvaluator::log(const std::string& message) {
 
 void BattleEvaluator::computeTeamBattlePoints(int x, int y) {
     GameEnvConfig& gameEnvConfig = GameEnvConfig::getInstance();
-    int tileId = gameMap.getTile(x, y).getId(gameMap.width);
+    int tileId = gameMap.getTile(x, y).getId();
     int energyDiff = gameEnvConfig.unitSapCost;
     int kills = 0;
     bool attackPossible = false;
@@ -25,7 +25,7 @@ void BattleEvaluator::computeTeamBattlePoints(int x, int y) {
                 if (i == x and j == y) {
                     sapCost = gameEnvConfig.unitSapCost;
                 }
-                for (auto& shuttle : tile.shuttles) {
+                for (auto& shuttle : tile.getShuttles()) {
                     if (!shuttle->visible || shuttle->ghost) {
                         continue;
                     }
@@ -43,7 +43,7 @@ void BattleEvaluator::computeTeamBattlePoints(int x, int y) {
     }
     
     if (attackPossible) {
-        log("If we get sapped at " + std::to_string(x) + ", " + std::to_string(y) + " then energy diff will be " + std::to_string(energyDiff) + " and " + std::to_string(kills) + " kills");
+        LOG_TRACE("If we get sapped at " + std::to_string(x) + ", " + std::to_string(y) + " then energy diff will be " + std::to_string(energyDiff) + " and " + std::to_string(kills) + " kills");
         gameMap.getTeamBattlePoints()[tileId] = std::make_pair(energyDiff, kills);
     }
 }
@@ -68,7 +68,7 @@ void BattleEvaluator::computeOpponentBattlePoints(int x, int y) {
     auto& energies = opponentTracker.getOpponentMaxPossibleEnergies();
     auto& probabilities = opponentTracker.getAtleastOneShuttleProbabilities();
 
-    int tileId = gameMap.getTile(x, y).getId(gameMap.width);
+    int tileId = gameMap.getTile(x, y).getId();
     
     bool rangedSapPossible = false;
 
@@ -112,7 +112,7 @@ void BattleEvaluator::computeOpponentBattlePoints(int x, int y) {
     }
     
     if (rangedSapPossible) {
-        log("Tile evaluation - " + tileEvaluation.toString());
+        LOG_TRACE("Tile evaluation - " + tileEvaluation.toString());
         opponentBattlePoints[tileId] = tileEvaluation; 
     }
 }
@@ -124,7 +124,7 @@ void BattleEvaluator::clear() {
 
 
 void BattleEvaluator::computeCrashCollisionPossibilities() {
-    log("Computing collision possibilities");
+    LOG_DEBUG("Computing collision possibilities");
 
     GameEnvConfig& gameEnvConfig = GameEnvConfig::getInstance();
     DerivedGameState& state = gameMap.derivedGameState;
@@ -135,7 +135,7 @@ void BattleEvaluator::computeCrashCollisionPossibilities() {
 
         if (shuttle->energy < gameEnvConfig.unitMoveCost || !shuttle->visible) {
             // This shuttle doesn't have enough energy to move.
-            log("Shuttle " + std::to_string(shuttle->id) + " doesn't have enough energy to move.");
+            LOG_DEBUG("Shuttle " + std::to_string(shuttle->id) + " doesn't have enough energy to move.");
             continue;
         }
 
@@ -155,9 +155,9 @@ void BattleEvaluator::computeCrashCollisionPossibilities() {
             int cumulativeOpponentEnergy = tile.getCumulativeOpponentEnergy();
 
             if (tile.isOpponentOccupied() && cumulativeOpponentEnergy < playerEnergy) {
-                log("This tile " + std::to_string(xNext) + ", " + std::to_string(yNext) + " can be crashed by shuttle " + std::to_string(shuttle->id) + 
-             " it can kill " + std::to_string(tile.opponentShuttles.size()) + " and opponent energy is " + std::to_string(cumulativeOpponentEnergy));
-                crashCollisionPossibilities[tile.getId(gameMap.width)] = {cumulativeOpponentEnergy, tile.opponentShuttles.size(), shuttle->id}; 
+                LOG_TRACE("This tile " + std::to_string(xNext) + ", " + std::to_string(yNext) + " can be crashed by shuttle " + std::to_string(shuttle->id) + 
+             " it can kill " + std::to_string(tile.getOpponentShuttles().size()) + " and opponent energy is " + std::to_string(cumulativeOpponentEnergy));
+                crashCollisionPossibilities[tile.getId()] = {cumulativeOpponentEnergy, tile.getOpponentShuttles().size(), shuttle->id}; 
             }
         }
     }
@@ -202,8 +202,8 @@ void BattleEvaluator::announceCollision(int shuttleId) {
         }
         
         if (tile.isOpponentOccupied() && cumulativeOpponentEnergy >= energy) {
-            log("Direct collision detected for shuttle " + std::to_string(shuttleId) + " at " + std::to_string(x) + ", " + std::to_string(y));
-            shuttle->collisionRisks.emplace_back(tile.getId(gameMap.width), true);
+            LOG_TRACE("Direct collision detected for shuttle " + std::to_string(shuttleId) + " at " + std::to_string(x) + ", " + std::to_string(y));
+            shuttle->collisionRisks.emplace_back(tile.getId(), true);
             directCollisionRiskDetected = true;
         }
 
@@ -222,8 +222,8 @@ void BattleEvaluator::announceCollision(int shuttleId) {
             GameTile& nextTile = gameMap.getTile(xNext, yNext);
 
             if (nextTile.isOpponentOccupied() && nextTile.getCumulativeOpponentEnergy() - gameEnvConfig.unitMoveCost >= energy) {
-                log("Indirect collision detected for shuttle " + std::to_string(shuttleId) + " at " + std::to_string(xNext) + ", " + std::to_string(yNext));
-                shuttle->collisionRisks.emplace_back(tile.getId(gameMap.width), false);
+                LOG_TRACE("Indirect collision detected for shuttle " + std::to_string(shuttleId) + " at " + std::to_string(xNext) + ", " + std::to_string(yNext));
+                shuttle->collisionRisks.emplace_back(tile.getId(), false);
                 directCollisionRiskDetected = true;
             }
         }
@@ -231,13 +231,13 @@ void BattleEvaluator::announceCollision(int shuttleId) {
 
     if (directCollisionRiskDetected && highestCumulativeOpponentEnergy - gameEnvConfig.unitMoveCost >= shuttle->energy) {
         // Even if this shuttle stays here, it can be colloided by the opponent.  It has more energy to move and colloid
-        shuttle->collisionRisks.emplace_back(shuttleTile.getId(gameMap.width), false);
+        shuttle->collisionRisks.emplace_back(shuttleTile.getId(), false);
     }
 }
 
 
 void BattleEvaluator::announceSOSSingals() {
-    log("Inside announcing SOS signals");
+    LOG_DEBUG("Inside announcing SOS signals");
 
     GameEnvConfig& gameEnvConfig = GameEnvConfig::getInstance();
     DerivedGameState& state = gameMap.derivedGameState;
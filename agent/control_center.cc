@@ -19,27 +19,29 @@ void ControlCenter::log(const std::string& message) {
  */
 void ControlCenter::init(GameState& gameState) {
     auto start = std::chrono::high_resolution_clock::now();
-    log("Initializing the control center");
+    LOG_INFO("Initializing the control center");
     
     GameEnvConfig& gameEnvConfig = GameEnvConfig::getInstance();
     gameEnvConfig.init(gameState);
 
     if (Config::enableLogging) {
+        Logger::getInstance().setLevel(Logger::parseLevel(Config::logLevel));
         Logger::getInstance().enableLogging("application_" + std::to_string(gameEnvConfig.teamId)+ ".log");
     }
 
-    log("creating GameMap");
+    LOG_DEBUG("creating GameMap");
     gameMap = new GameMap(gameEnvConfig.mapWidth, gameEnvConfig.mapHeight);
+    pathingService = new PathingService(*gameMap, &stepDeadline);
 
     // Shuttles (player and opponent).  This is created once and reused.
     shuttles = new Shuttle*[gameEnvConfig.maxUnits];
     opponentShuttles = new Shuttle*[gameEnvConfig.maxUnits];
-    relicDiscoveryKey.insert(relicDiscoveryKey.end(),  gameState.obs.relicNodes.size(), -1);
+    relicDiscoveryKey.insert(relicDiscoveryKey.end(),  gameState.obs.relicNodes.getRows(), -1);
     gameMap->derivedGameState.relicDiscoveryStatus.resize(gameEnvConfig.matchCountPerEpisode, RelicDiscoveryStatus::INIT);
 
     for (int i = 0; i < gameEnvConfig.maxUnits; ++i) {
-        shuttles[i] = new Shuttle(i, ShuttleType::PLAYER, *gameMap);
-        opponentShuttles[i] = new Shuttle(i, ShuttleType::OPPONENT, *gameMap);
+        shuttles[i] = new Shuttle(i, ShuttleType::PLAYER, *gameMap, *pathingService);
+        opponentShuttles[i] = new Shuttle(i, ShuttleType::OPPONENT, *gameMap, *pathingService);
         gameMap->shuttles.push_back(&shuttles[i]->getShuttleData());
         gameMap->opponentShuttles.push_back(&opponentShuttles[i]->getShuttleData());
     }
@@ -47,16 +49,20 @@ void ControlCenter::init(GameState& gameState) {
     haloConstraints = new ConstraintSet();    
     driftDetector = new DriftDetector(*gameMap);
     energyEstimator = new EnergyEstimator(*gameMap);
-    opponentTracker = new OpponentTracker(*gameMap, respawnRegistry);
+    opponentTracker = new OpponentTracker(*gameMap, respawnRegistry, &stepDeadline);
     battleEvaluator = new BattleEvaluator(*gameMap, *opponentTracker);
-    planner = new Planner(shuttles, *gameMap, *opponentTracker, *battleEvaluator);
+    if (Config::planningThreads > 1) {
+        LOG_INFO("Planning with " + std::to_string(Config::planningThreads) + " threads");
+        threadPool = new ThreadPool(Config::planningThreads);
+    }
+    planner = new Planner(shuttles, *gameMap, *opponentTracker, *battleEvaluator, *pathingService, threadPool, &stepDeadline);
     shuttleEnergyTracker = new ShuttleEnergyTracker(*gameMap, *opponentTracker, respawnRegistry);
 
     visualizerClientPtr = new VisualizerClient(*gameMap, shuttles, opponentShuttles, relics, *opponentTracker);
 
     auto end = std::chrono::high_resolution_clock::now();
     auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
-    log("Initialization complete " + std::to_string(duration.count()));
+    LOG_INFO("Initialization complete " + std::to_string(duration.count()));
 }
 
 /**
@@ -78,9 +84,10 @@ void ControlCenter::update(GameState& gameState) {
 
     Logger::getInstance().setStepId(std::to_string(state.currentStep) + "/" + std::to_string(state.currentMatchStep));
     Metrics::getInstance().setStepId(std::to_string(state.currentStep));  
-    log("Updating for step " + std::to_string(state.currentStep) + "/" + std::to_string(state.currentMatchStep));
+    LOG_INFO("Updating for step " + std::to_string(state.currentStep) + "/" + std::to_string(state.currentMatchStep));
 
     state.remainingOverageTime = gameState.remainingOverageTime;
+    stepDeadline.beginStep(state.currentStep, state.remainingOverageTime);
     state.teamPointsDelta = gameState.obs.teamPoints[gameEnvConfig.teamId] - state.teamPoints;
     state.teamPoints = gameState.obs.teamPoints[gameEnvConfig.teamId];
     state.opponentTeamPointsDelta = gameState.obs.teamPoints[gameEnvConfig.opponentTeamId] - state.opponentTeamPoints;
@@ -94,7 +101,7 @@ void ControlCenter::update(GameState& gameState) {
         state.teamPointsDelta = 0;
         state.opponentTeamPointsDelta = 0;        
         state.currentMatch += 1;
-        log(" --> Match " + std::to_string(state.currentMatch) + " start <----");  
+        LOG_INFO(" --> Match " + std::to_string(state.currentMatch) + " start <----");  
         if (state.currentMatch >= 3) {
             state.relicDiscoveryStatus[state.currentMatch] = RelicDiscoveryStatus::NOT_APPLICABLE;
         } else {
@@ -124,7 +131,7 @@ void ControlCenter::update(GameState& gameState) {
     Metrics::getInstance().add("teamPointsDelta", state.teamPointsDelta);
     Metrics::getInstance().add("opponentTeamPointsDelta", state.opponentTeamPointsDelta);
     
-    log("Exploring all units");
+    LOG_DEBUG("Exploring all units");
     // Exploring all units (cost 16)
     // REQUIREMENTS: NONE
     int stuckShuttleCount = 0;
@@ -136,12 +143,14 @@ void ControlCenter::update(GameState& gameState) {
         opponentShuttles[i]->updateVisibility(gameState.obs.unitsMask[gameEnvConfig.opponentTeamId][i]);
         
         // Update unit's current position and energy
-        shuttles[i]->updateUnitsData(gameState.obs.units.position[gameEnvConfig.teamId][i],
+        const int* position = gameState.obs.units.position[gameEnvConfig.teamId][i];
+        shuttles[i]->updateUnitsData(position[0], position[1],
                                      gameState.obs.units.energy[gameEnvConfig.teamId][i],
                                      state.currentStep);
 
                                          
-        opponentShuttles[i]->updateUnitsData(gameState.obs.units.position[gameEnvConfig.opponentTeamId][i],
+        const int* opponentPosition = gameState.obs.units.position[gameEnvConfig.opponentTeamId][i];
+        opponentShuttles[i]->updateUnitsData(opponentPosition[0], opponentPosition[1],
                                           gameState.obs.units.energy[gameEnvConfig.opponentTeamId][i],
                                           state.currentStep);
                                                   
@@ -163,7 +172,7 @@ void ControlCenter::update(GameState& gameState) {
 
     Metrics::getInstance().add("stuck_shuttles", stuckShuttleCount);
 
-    log("Exploring all relics");
+    LOG_DEBUG("Exploring all relics");
     // Exploring all relics (cost 8)
     // REQUIREMENTS:
     // 1. Visited nodes should be updated. i.e. Unit movements should've already happened
@@ -175,11 +184,12 @@ void ControlCenter::update(GameState& gameState) {
             continue;
         }
         
-        int positionId = symmetry_utils::toID(gameState.obs.relicNodes[i][0], gameState.obs.relicNodes[i][1]);                
+        const int* relicPosition = gameState.obs.relicNodes[i];
+        int positionId = symmetry_utils::toID(relicPosition[0], relicPosition[1]);                
 
         if (relics.find(positionId) == relics.end()) {
             // This is a new relic
-            Relic* relic = new Relic(positionId, gameState.obs.relicNodes[i]);
+            Relic* relic = new Relic(positionId, {relicPosition[0], relicPosition[1]});
             relics[positionId] = relic;
             relic->addDiscoveryId(i);
             relicDiscoveryKey[i] = positionId;
@@ -195,7 +205,7 @@ void ControlCenter::update(GameState& gameState) {
                 details.relicDiscoveryStepRound3 = state.currentStep;
             }
 
-            log("Relic " + std::to_string(positionId) + " found at " + std::to_string(relic->position[0]) + ", " + std::to_string(relic->position[1]));
+            LOG_INFO("Relic " + std::to_string(positionId) + " found at " + std::to_string(relic->position[0]) + ", " + std::to_string(relic->position[1]));
             gameMap->addRelic(relic, state.currentStep, forcedHaloTileIds);
 
             std::vector<int> mirroredPosition = relic->getMirroredPosition(gameEnvConfig.mapWidth, gameEnvConfig.mapHeight);
@@ -206,7 +216,7 @@ void ControlCenter::update(GameState& gameState) {
                 Relic* mirroredRelic = new Relic(mirroredPositionId, mirroredPosition);
                 relics[mirroredPositionId] = mirroredRelic;
 
-                log("Mirrored Relic " + std::to_string(mirroredPositionId) + " found at " + std::to_string(mirroredRelic->position[0]) + ", " + std::to_string(mirroredRelic->position[1]));
+                LOG_INFO("Mirrored Relic " + std::to_string(mirroredPositionId) + " found at " + std::to_string(mirroredRelic->position[0]) + ", " + std::to_string(mirroredRelic->position[1]));
                 gameMap->addRelic(mirroredRelic, state.currentStep, forcedHaloTileIds);
             }
         }
@@ -216,7 +226,7 @@ void ControlCenter::update(GameState& gameState) {
             // 1. This relic is a mirror that we have already onboarded
             // 2. This relic is on the diagonal that is already created
             // 3. This relic is a re-spawn in the same tile
-            log("Relic discovery key is null for relic " + std::to_string(i));
+            LOG_DEBUG("Relic discovery key is null for relic " + std::to_string(i));
 
             bool isDiagonal = symmetry_utils::isOnDiagonal(positionId);
             bool respawned = false;
@@ -251,41 +261,39 @@ void ControlCenter::update(GameState& gameState) {
         }
     }
 
-    log("Count of relics " + std::to_string(relics.size()));
+    LOG_DEBUG("Count of relics " + std::to_string(relics.size()));
 
     haloConstraints->reconsiderNormalizedTile(forcedHaloTileIds);    
 
-    log("Exploring contents of each tile");
+    LOG_DEBUG("Exploring contents of each tile");
     // Exploring contents of each tile (cost 24x24)
     // REQUIREMENTS:
     // 1. Visited nodes should be updated. i.e. Unit movements should've already happened
-    state.allTilesExplored = true;
-    state.allTilesVisited = true;
-    state.tilesVisited = gameEnvConfig.mapHeight * gameEnvConfig.mapWidth;
-    state.tilesExplored = gameEnvConfig.mapHeight * gameEnvConfig.mapWidth;
-
     for (int i = 0; i < gameEnvConfig.mapHeight; ++i) {
+        const int* sensorMaskRow = gameState.obs.sensorMask[i];
+        const int* tileTypeRow = gameState.obs.mapFeatures.tileType[i];
+        const int* energyRow = gameState.obs.mapFeatures.energy[i];
         for (int j = 0; j < gameEnvConfig.mapWidth; ++j) {
             GameTile& currentTile = gameMap->getTile(i, j);
             GameTile& currentMirrorTile = gameMap->getMirroredTile(i, j);
 
-            currentTile.setVisible(gameState.obs.sensorMask[i][j] != 0);
+            currentTile.setVisible(sensorMaskRow[j] != 0);
 
-            auto tileType = GameTile::translateTileType(gameState.obs.mapFeatures.tileType[i][j]);
+            auto tileType = GameTile::translateTileType(tileTypeRow[j]);
 
             // Immediate will have the tile data as is, without any visibility gimmicks. Hacking this for now!
             
             currentTile.setTypeImmediate(tileType);
             
-            if (gameState.obs.sensorMask[i][j] != 0) {
+            if (sensorMaskRow[j] != 0) {
                 //Visible tile updates
 
                 currentTile.setType(tileType, state.currentStep, driftDetector->driftFinalized);                
-                currentTile.setEnergy(gameState.obs.mapFeatures.energy[i][j], state.currentStep);
+                currentTile.setEnergy(energyRow[j], state.currentStep);
                 gameMap->exploreTile(currentTile, state.currentStep);
 
                 currentMirrorTile.setType(tileType, state.currentStep, driftDetector->driftFinalized);                
-                currentMirrorTile.setEnergy(gameState.obs.mapFeatures.energy[i][j], state.currentStep);
+                currentMirrorTile.setEnergy(energyRow[j], state.currentStep);
                 gameMap->exploreTile(currentMirrorTile, state.currentStep);
             }
 
@@ -310,24 +318,20 @@ void ControlCenter::update(GameState& gameState) {
                     }
                 }
             }
-
-            if (!currentTile.isVisited()) {
-                state.allTilesVisited = false;
-                state.tilesVisited--;
-            }
-
-            if (!currentTile.isExplored()) {
-                state.allTilesExplored = false;
-                state.tilesExplored--;
-            }
         }
     }
 
+    TileStore& tileStore = gameMap->getTileStore();
+    state.tilesVisited = tileStore.visited.count();
+    state.tilesExplored = tileStore.explored.count();
+    state.allTilesVisited = tileStore.visited.all();
+    state.allTilesExplored = tileStore.explored.all();
+
     if (state.allTilesExplored) {
-        log("All tiles explored :)");
+        LOG_DEBUG("All tiles explored :)");
     }
 
-    log("Identify nebula tiles using the invisibility data");
+    LOG_DEBUG("Identify nebula tiles using the invisibility data");
 
     if (state.currentStep > 1 && driftDetector->isDriftPossible(state.currentStep) == TruthValue::FALSE && driftDetector->isDriftPossible(state.currentStep - 1) == TruthValue::FALSE) { // There is a bug in the environment, it doesn't show the nebula visibility mask properly if there was a drift the previous step! See seed 245923829
         for (int s = 0; s < gameEnvConfig.maxUnits; ++s) {
@@ -347,38 +351,29 @@ void ControlCenter::update(GameState& gameState) {
         }
     }
 
-    log("Check if all tiles are explored for relic discovery");    
+    LOG_DEBUG("Check if all tiles are explored for relic discovery");    
 
     if (state.isThereAHuntForRelic()) {
         bool relicNotFound[3] = {true, true, true};
 
         //We have crossed 50 steps, relic should be there if all nodes are explored
-        for (int i = 0; i < gameEnvConfig.mapHeight; ++i) {
-            for (int j = 0; j < gameEnvConfig.mapWidth; ++j) {
-                GameTile& currentTile = gameMap->getTile(i, j);
-                for (int k = 0; k < 3; ++k) {
-                    if (state.relicDiscoveryStatus[k] == RelicDiscoveryStatus::SEARCHING) {
-                        int cutoffTime = 101 * k + state.relicDiscoveryCutoffMatchStep[k];
-                        if (currentTile.getLastExploredTime() < cutoffTime) {
-                            //Assess for Frontier set here!
-                            gameMap->setRelicExplorationFrontier(currentTile, k, cutoffTime);
-                            relicNotFound[k] = false;
-                        }
-                    } else if (relicNotFound[k]) {
-                        //We are not searching for this relic
-                        relicNotFound[k] = false;
-                    }
-                }
+        for (int k = 0; k < 3; ++k) {
+            if (state.relicDiscoveryStatus[k] == RelicDiscoveryStatus::SEARCHING) {
+                int cutoffTime = 101 * k + state.relicDiscoveryCutoffMatchStep[k];
+                relicNotFound[k] = gameMap->updateRelicExplorationFrontier(k, cutoffTime);
+            } else {
+                //We are not searching for this relic
+                relicNotFound[k] = false;
             }
         }
 
         for (int i = 0;i < 3; i++) {
             if (relicNotFound[i]) {
-                log("Relic not found for match " + std::to_string(i+1));
+                LOG_DEBUG("Relic not found for match " + std::to_string(i+1));
                 state.relicDiscoveryStatus[i] = RelicDiscoveryStatus::NOT_FOUND;
                 // state.setRelicDiscoveryStatus(RelicDiscoveryStatus::NOT_FOUND);
                 for (int j = i+1;j < 3; j++) {
-                    log("Relic not applicable for match " + std::to_string(j+1));
+                    LOG_DEBUG("Relic not applicable for match " + std::to_string(j+1));
                     state.relicDiscoveryStatus[j] = RelicDiscoveryStatus::NOT_APPLICABLE;
                 }
                 break;
@@ -386,7 +381,7 @@ void ControlCenter::update(GameState& gameState) {
         }
     }
 
-    log("Detecting drift");
+    LOG_DEBUG("Detecting drift");
 
     bool needToUpdateEnergyNodes = false;
     for (int i = 0; i < gameEnvConfig.mapHeight; ++i) {
@@ -414,20 +409,21 @@ void ControlCenter::update(GameState& gameState) {
 
     driftDetector->step();    
 
-    log("Updating the newly identified tile types to drift tile type vector");
+    LOG_DEBUG("Updating the newly identified tile types to drift tile type vector");
 
     for (int i = 0; i < gameEnvConfig.mapHeight; ++i) {
+        const int* sensorMaskRow = gameState.obs.sensorMask[i];
         for (int j = 0; j < gameEnvConfig.mapWidth; ++j) {
             GameTile& currentTile = gameMap->getTile(i, j);
             
             //Verifying if the energy estimate is correct
             if (currentTile.isVisible() && currentTile.getEnergy() != currentTile.getLastKnownEnergy()) {
-                log("Problem: energy estimate has messed up for " + std::to_string(i) + ", " + std::to_string(j) + " - " + std::to_string(currentTile.getEnergy()) + " & " + std::to_string(currentTile.getLastKnownEnergy()));
+                LOG_WARN("Problem: energy estimate has messed up for " + std::to_string(i) + ", " + std::to_string(j) + " - " + std::to_string(currentTile.getEnergy()) + " & " + std::to_string(currentTile.getLastKnownEnergy()));
                 std::cerr<<"Problem: Energy estimate messed up"<<std::endl;
             }
 
             // Updating the drift chain to the future
-            if (gameState.obs.sensorMask[i][j]) {                
+            if (sensorMaskRow[j]) {                
                 GameTile& currentMirrorTile = gameMap->getMirroredTile(i, j);
 
                 driftDetector->exploreTile(currentTile);
@@ -436,7 +432,7 @@ void ControlCenter::update(GameState& gameState) {
         }
     }
 
-    log("Checking for constraints");
+    LOG_DEBUG("Checking for constraints");
     // Monitor change in points to observe the relic capture
     // Collect all positions that are on a halo node or possibly on a halo node with an invisible relic
     //REQUIREMENTS: 
@@ -459,19 +455,26 @@ void ControlCenter::update(GameState& gameState) {
                     // for (auto& shuttle : currentTile.getShuttles()) {
                     //     log("Shuttles - " + std::to_string(i) + ", " + std::to_string(j) + " - Shuttle " + std::to_string(shuttle->id));
                     // }
-                    log("Force setting halo tile for " + std::to_string(i) + ", " + std::to_string(j));
+                    LOG_TRACE("Force setting halo tile for " + std::to_string(i) + ", " + std::to_string(j));
                     currentTile.setHaloTile(true);  //Setting if it is not already set
-                    haloConstraints->reconsiderNormalizedTile(currentTile.getId(gameEnvConfig.mapWidth));
+                    haloConstraints->reconsiderNormalizedTile(currentTile.getId());
                 }                
-                constraintTiles.insert(currentTile.getId(gameEnvConfig.mapWidth));                
+                constraintTiles.insert(currentTile.getId());                
             }
         }
     }
 
-    // Not adding constraint if the matchstep is 0
+    // Not adding constraint if the matchstep is 0.  Observations are solved oldest first, whatever doesn't fit in the
+    // step budget waits for the next step
+    stepDeadline.startStage(STAGE_CONSTRAINT_SOLVING);
+    haloConstraints->setInferenceBudget(std::min<long long>(Config::exactInferenceBudgetUs, stepDeadline.getRemainingMs() * 1000));
     if (constraintTiles.size() >0 && state.currentMatchStep != 0) {
-        haloConstraints->addConstraint(state.teamPointsDelta, constraintTiles);
+        haloConstraints->deferConstraint(state.teamPointsDelta, constraintTiles);
+    }
+    while (haloConstraints->hasDeferredConstraints() && !stepDeadline.shouldDegrade(STAGE_CONSTRAINT_SOLVING)) {
+        haloConstraints->resolveNextDeferredConstraint();
     }
+    stepDeadline.endStage(STAGE_CONSTRAINT_SOLVING);
     // Collect information from the constraint set and clear it
 
     for (auto& regularTile : haloConstraints->identifiedRegularTiles) {
@@ -503,23 +506,25 @@ void ControlCenter::update(GameState& gameState) {
     Metrics::getInstance().add("unexploited_vantage_points", state.vantagePointsFound - state.vantagePointsOccupied);
 
     if (state.teamPointsDelta - state.vantagePointsOccupied < 0 && state.currentMatchStep != 0) {
-        log("Problem: Team points delta is less than vantage points occupied = " + std::to_string(state.teamPointsDelta) + " & " + std::to_string(state.vantagePointsOccupied));
+        LOG_WARN("Problem: Team points delta is less than vantage points occupied = " + std::to_string(state.teamPointsDelta) + " & " + std::to_string(state.vantagePointsOccupied));
         std::cerr<<"Problem: Team points delta < vantage points occupied"<<std::endl;
     }
 
-    log("Tracking opponent units");
+    LOG_DEBUG("Tracking opponent units");
+    stepDeadline.startStage(STAGE_OPPONENT_TRACKING);
     opponentTracker->step();
+    stepDeadline.endStage(STAGE_OPPONENT_TRACKING);
 
     if (state.currentMatchStep == 0) {
         opponentTracker->clear();
     }
 
-    log("Calculating previous step losses");
+    LOG_DEBUG("Calculating previous step losses");
     if (state.currentMatchStep > 1) {
         shuttleEnergyTracker->step();
     }
 
-    log ("Computing battle points");
+    LOG_DEBUG("Computing battle points");
     battleEvaluator->clear();
     battleEvaluator->announceSOSSingals();
     battleEvaluator->computeCrashCollisionPossibilities();
@@ -534,27 +539,27 @@ void ControlCenter::update(GameState& gameState) {
     auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
     Metrics::getInstance().add("update_duration", duration.count());
 
-    log("Update complete");
+    LOG_DEBUG("Update complete");
 }
 
 void ControlCenter::plan() {
-    log("planning");
+    LOG_DEBUG("planning");
     GameEnvConfig& gameEnvConfig = GameEnvConfig::getInstance();
 
     planner->plan();
-    log("Planning complete");
+    LOG_DEBUG("Planning complete");
 }
 
 ControlCenter::ControlCenter() {
     // Empty constructor
-    log("Starting the game");
+    LOG_DEBUG("Starting the game");
     shuttles = nullptr;
     opponentShuttles = nullptr;    
 }
 
 ControlCenter::~ControlCenter() {
     GameEnvConfig& gameEnvConfig = GameEnvConfig::getInstance();
-    log("destroying cc");
+    LOG_DEBUG("destroying cc");
     delete visualizerClientPtr;
     for (int i = 0; i < gameEnvConfig.maxUnits; ++i) {
         delete shuttles[i];
@@ -567,6 +572,8 @@ ControlCenter::~ControlCenter() {
     delete energyEstimator;
     delete battleEvaluator;
     delete shuttleEnergyTracker;
+    delete pathingService;
+    delete threadPool;
 }
 
 
@@ -576,7 +583,7 @@ std::vector<std::vector<int>> ControlCenter::act() {
     GameEnvConfig& gameEnvConfig = GameEnvConfig::getInstance();
     DerivedGameState& state = gameMap->derivedGameState;
 
-    log("--- Acting step " + std::to_string(state.currentStep) + "/" + std::to_string(state.currentMatchStep) + " ---");
+    LOG_DEBUG("--- Acting step " + std::to_string(state.currentStep) + "/" + std::to_string(state.currentMatchStep) + " ---");
 
     std::vector<std::vector<int>> results;
     for (int i = 0; i < gameEnvConfig.maxUnits; ++i) {
@@ -591,5 +598,6 @@ std::vector<std::vector<int>> ControlCenter::act() {
     auto end = std::chrono::high_resolution_clock::now();
     auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
     Metrics::getInstance().add("act_duration", duration.count());
+    stepDeadline.endStep();
     return results;
 }
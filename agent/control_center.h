@@ -14,6 +14,8 @@
 #include "datastructures/respawn_registry.h"
 #include "agent/opponent_tracker.h"
 #include "agent/shuttle_energy_tracker.h"
+#include "agent/pathing_service.h"
+#include "agent/step_deadline.h"
 
 #include <vector>
 #include <string>
@@ -28,8 +30,11 @@ private:
     OpponentTracker* opponentTracker = nullptr;
     BattleEvaluator* battleEvaluator = nullptr;
     ShuttleEnergyTracker* shuttleEnergyTracker = nullptr;
+    PathingService* pathingService = nullptr;
+    ThreadPool* threadPool = nullptr;
 
     RespawnRegistry respawnRegistry;
+    StepDeadline stepDeadline;
 
     // dynamic objects
     Shuttle** shuttles; 
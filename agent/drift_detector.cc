@@ -1,4 +1,5 @@
 #include "drift_detector.h"
+#include <algorithm>
 #include <cmath>
 #include "game_env_config.h"
 
@@ -9,65 +10,27 @@ void DriftDetector::log(const std::string& message) {
 }
 
 void DriftDetector::exploreTile(GameTile &gameTile) {
-    exploreTile(gameTile.x, gameTile.y, gameTile.getType(), currentDriftTileTypeVectorIndex);
-}
+    DriftForecast& driftForecast = gameMap.getDriftForecast();
+    int currentStep = gameMap.derivedGameState.currentStep;
 
-void DriftDetector::exploreTile(int x, int y, TileType tileType, int driftTileTypeIndex) {
-    // log("Entering exploreTile " + std::to_string(x) + ", " + std::to_string(y) + ", " + std::to_string(tileType) + ", " + std::to_string(driftTileTypeIndex));
-    if (tileType == TileType::UNKNOWN_TILE) {
-        //No point in exploring unknown tiles, However this is not possible!
-        return;
-    }
-    if (driftTileTypeIndex >= allDriftTileTypeVectors.size()) {
-        //Nothing to explore, return
+    if (gameTile.getType() == TileType::UNKNOWN_TILE || !driftForecast.hasForecast(currentStep)) {
+        //Nothing to explore
         return;
     }
-    if ((*allDriftTileTypeVectors[driftTileTypeIndex])[y][x] == tileType) {
-        //This tile type is already same, no action
-        return;
-    }
-
-    (*allDriftTileTypeVectors[driftTileTypeIndex])[y][x] = tileType;
-
-    int nextX = x;
-    int nextY = y;
-
-    if (finalSpeed > 0) {
-        nextX += 1;
-        nextY -= 1;
-    } else {
-        nextX -= 1;
-        nextY += 1;
-    }
-
-    auto& targetTile = gameMap.getRolledOverTile(nextX, nextY);
-    exploreTile(targetTile.x, targetTile.y, tileType, driftTileTypeIndex+1);
-}
-
-TileType DriftDetector::getEstimatedDriftTile(int x, int y, std::vector<std::vector<TileType>> *previousStepValues) {    
-    if (finalSpeed < 0) { //This x, y is the source tile, so this is inverted
-        x += 1;
-        y -= 1;
-    } else {
-        x -= 1;
-        y += 1;
-    }
 
-    auto& sourceTile = gameMap.getRolledOverTile(x, y);
-    return (*previousStepValues)[sourceTile.y][sourceTile.x];
+    // Drift only moves the tile, so this is its type wherever it drifts to
+    driftForecast.setType(gameTile.x, gameTile.y, currentStep, gameTile.getType());
 }
 
-std::vector<std::vector<TileType>>* DriftDetector::estimateDrift(std::vector<std::vector<TileType>> *previousStepValues) {
-    GameEnvConfig& config = GameEnvConfig::getInstance();
-    std::vector<std::vector<TileType>>* tileTypesArray = new std::vector<std::vector<TileType>>;
-    tileTypesArray->resize(config.mapHeight);
-    for (int y = 0; y < config.mapHeight; ++y) {
-        tileTypesArray->operator[](y).reserve(config.mapWidth);
-        for (int x = 0; x < config.mapWidth; ++x) {
-            tileTypesArray->operator[](y).emplace_back(getEstimatedDriftTile(x, y, previousStepValues));
-        }
-    }
-    return tileTypesArray;
+/**
+ * Drifts the speed makes after step from, up to and including step to
+ */
+int DriftDetector::countDriftsBetween(int speed, int from, int to) {
+    const std::vector<int>& driftCounts = speedToDriftCountMap[speed];
+    int last = static_cast<int>(driftCounts.size()) - 1;
+    from = std::clamp(from, 0, last);
+    to = std::clamp(to, 0, last);
+    return driftCounts[to] - driftCounts[from];
 }
 
 int DriftDetector::computeMoveCountBetween(int from, int to) {
@@ -85,20 +48,12 @@ int DriftDetector::computeMoveCountBetween(int from, int to) {
         multiplier = -1;
     }
 
-    int moveCount = 0;
-    for (int i = start + 1; i <= end; i++) {
-        auto& speedVector = stepToDriftSpeedMap[i];
-        if (std::find(speedVector.begin(), speedVector.end(), finalSpeed) != speedVector.end()) {
-            moveCount++;
-        }
-    }
-
-    moveCount %= gameMap.width;
-    log("Retuning moveCount " + std::to_string(moveCount * multiplier) + " between " + std::to_string(from) + " and " + std::to_string(to));
+    int moveCount = countDriftsBetween(finalSpeed, start, end) % gameMap.width;
+    LOG_DEBUG("Retuning moveCount " + std::to_string(moveCount * multiplier) + " between " + std::to_string(from) + " and " + std::to_string(to));
     return moveCount * multiplier;
 }
 
-void DriftDetector::forecastTileTypeAt(int step, GameTile& tile, std::vector<std::vector<TileType>>& tileTypesArray) {
+void DriftDetector::forecastTileTypeAt(int step, GameTile& tile, DriftForecast& driftForecast) {
 
     while(!tile.getPreviousTypes().empty()) {
         // log("The item count for the tile " + tile.toString() + " is " + std::to_string(tile.getPreviousTypes().size()));
@@ -125,45 +80,35 @@ void DriftDetector::forecastTileTypeAt(int step, GameTile& tile, std::vector<std
         int y = tile.y - moveCount * multiplier;
 
         auto& targetTile = gameMap.getRolledOverTile(x, y);
-        TileType targetTileType = tileTypesArray[targetTile.y][targetTile.x];    
+        TileType targetTileType = driftForecast.getType(targetTile.x, targetTile.y, step);
 
         if (targetTileType == TileType::UNKNOWN_TILE) {
-            log("setting tile " + targetTile.toString() + " to type " + std::to_string(tileType) + " from " + tile.toString() + " moveCount=" + std::to_string(moveCount) + ", last seen =" + std::to_string(typeUpdateStep));
-            tileTypesArray[targetTile.y][targetTile.x] = tileType;
+            LOG_TRACE("setting tile " + targetTile.toString() + " to type " + std::to_string(tileType) + " from " + tile.toString() + " moveCount=" + std::to_string(moveCount) + ", last seen =" + std::to_string(typeUpdateStep));
+            driftForecast.setType(targetTile.x, targetTile.y, step, tileType);
         } else if (targetTileType != tileType) {
-            log("Problem: Wrongly identified tile type " + std::to_string(targetTileType) + " != " + std::to_string(tileType) + " for tile=" + tile.toString());
-            log("Speed = " + std::to_string(finalSpeed) + ", moveCount = " + std::to_string(moveCount) + ", targetTile=" + targetTile.toString());
+            LOG_WARN("Problem: Wrongly identified tile type " + std::to_string(targetTileType) + " != " + std::to_string(tileType) + " for tile=" + tile.toString());
+            LOG_DEBUG("Speed = " + std::to_string(finalSpeed) + ", moveCount = " + std::to_string(moveCount) + ", targetTile=" + targetTile.toString());
             std::cerr<<"Problem: Wrongly identified tile type"<<std::endl;
         }
     }
 }
 
-std::vector<std::vector<TileType>>* DriftDetector::prepareCurrentTileTypes() {
+void DriftDetector::prepareCurrentTileTypes(DriftForecast& driftForecast) {
     GameEnvConfig& config = GameEnvConfig::getInstance();
-    std::vector<std::vector<TileType>>* tileTypesArray = new std::vector<std::vector<TileType>>;
-    tileTypesArray->resize(config.mapHeight);
-    for (int y = 0; y < config.mapHeight; ++y) {
-        tileTypesArray->operator[](y).reserve(config.mapWidth);
-        for (int x = 0; x < config.mapWidth; ++x) {
-            tileTypesArray->operator[](y).emplace_back(TileType::UNKNOWN_TILE);            
-        }
-    }
 
     for (int y = 0; y < config.mapHeight; ++y) {
         for (int x = 0; x < config.mapWidth; ++x) {
             // Assign whatever this tile has seen in the past to the current step.  Current step will be extrapolated to future later
-            forecastTileTypeAt(gameMap.derivedGameState.currentStep - 1, gameMap.getTile(x, y), *tileTypesArray);
+            forecastTileTypeAt(gameMap.derivedGameState.currentStep - 1, gameMap.getTile(x, y), driftForecast);
         }
     }
-    
-    return tileTypesArray;
 }
 
 
 void DriftDetector::estimateTileTypesforFinalizedDrift() {
 
     if (finalSpeed == 0) {
-        log("Problem: Speed not finalized to estimate drift");
+        LOG_WARN("Problem: Speed not finalized to estimate drift");
         std::cerr<<"Problem: Speed not finalized to estimate drift"<<std::endl;
         return;
     }    
@@ -171,50 +116,34 @@ void DriftDetector::estimateTileTypesforFinalizedDrift() {
     GameEnvConfig& config = GameEnvConfig::getInstance();
     DerivedGameState& state = gameMap.derivedGameState;
 
-    auto& driftAwareTileType = gameMap.getDriftAwareTileType();
+    DriftForecast& driftForecast = gameMap.getDriftForecast();
+    int stepCount = config.matchCountPerEpisode * (config.maxStepsInMatch + 1);
 
-    if (driftAwareTileType.size() == config.matchCountPerEpisode * (config.maxStepsInMatch + 1)) {
-        log("Already prepared the drift aware tile arrays");
+    if (driftForecast.getStepCount() == stepCount) {
+        LOG_DEBUG("Already prepared the drift forecast");
         return;
     }
 
-    int lastKnownKey = driftAwareTileType.size() - 1;
+    int lastKnownKey = trackedSteps - 1;
 
     if (lastKnownKey != state.currentStep - 1) {
         // We are checking if the last known key is of the last step!
-        log("Problem: Previous step's tileTypes are unknown, lastKnownKey=" + std::to_string(lastKnownKey));
+        LOG_WARN("Problem: Previous step's tileTypes are unknown, lastKnownKey=" + std::to_string(lastKnownKey));
         std::cerr<<"Problem: Previous step's tileTypes are unknown"<<std::endl;
         return;
     }
 
-    std::vector<std::vector<TileType>>* currentTileTypes = prepareCurrentTileTypes();
+    driftForecast.reset(gameMap.width, gameMap.height, finalSpeed > 0 ? 1 : -1, stepCount);
 
-    //Backfill the current step with the known values
-    for (int i = 0; i < state.currentStep;i++) {
-        //Note: We are not estimating the previous drifts.  Expecting the drift detector to detect the drift in first attempt, else this is flawed!
-        driftAwareTileType[i] = currentTileTypes;
+    //The past steps keep the previous step's tile types at offset 0.
+    //Note: We are not estimating the previous drifts.  Expecting the drift detector to detect the drift in first attempt, else this is flawed!
+    int offset = 0;
+    for (int i = state.currentStep; i < stepCount; i++) {
+        offset = (offset + countDriftsBetween(finalSpeed, i - 1, i)) % gameMap.width;
+        driftForecast.setOffset(i, offset);
     }
-    
-    //Forecast the future
-    for (int i = state.currentStep; i <  config.matchCountPerEpisode * (config.maxStepsInMatch + 1); i++) {
-        auto& possibleSpeedsThisStep = stepToDriftSpeedMap[i];
-
-        if (std::find(possibleSpeedsThisStep.begin(), possibleSpeedsThisStep.end(), finalSpeed) != possibleSpeedsThisStep.end()) {
-            currentTileTypes = estimateDrift(currentTileTypes);
-            allDriftTileTypeVectors.emplace_back(currentTileTypes);
-        }
 
-        if (allDriftTileTypeVectors.size() == 0) {
-            //If the above condition is not satisfied, allDriftTileTypeVectors should not be empty
-            allDriftTileTypeVectors.emplace_back(currentTileTypes);
-        }
-
-        driftAwareTileType.emplace_back(currentTileTypes);
-
-        // std::ostringstream oss;
-        // oss << currentTileTypes;
-        // log("Pointer added " + oss.str() + " allDriftTileTypeVectors=" + std::to_string(allDriftTileTypeVectors.size() - 1) + ", driftAwareTileType=" + std::to_string(driftAwareTileType.size() -1));
-    }
+    prepareCurrentTileTypes(driftForecast);
 }
 
 int DriftDetector::compareDrift(GameTile& sourceTile, int x, int y) {
@@ -236,18 +165,13 @@ void DriftDetector::reportNebulaDrift(GameTile& gameTile) {
     int lastSeenStart = gameTile.getPreviousTypeUpdateStep();
     int lastSeenEnd = gameTile.getTypeUpdateStep();
 
-    log("Drift reported by " + gameTile.toString() + " last seen " + std::to_string(gameTile.getPreviousType()) + " at " + std::to_string(lastSeenStart) + " but now " + std::to_string(gameTile.getType()));
+    LOG_DEBUG("Drift reported by " + gameTile.toString() + " last seen " + std::to_string(gameTile.getPreviousType()) + " at " + std::to_string(lastSeenStart) + " but now " + std::to_string(gameTile.getType()));
 
     std::map<int, int> speedCounter; // (speed, moveCount)
-    for (int i = lastSeenStart + 1; i <= lastSeenEnd; i++) {
-        // log("Checking for step " + std::to_string(i));
-        auto it = stepToDriftSpeedMap.find(i);
-        if (it != stepToDriftSpeedMap.end()) {
-            for (int speed : it->second) {
-                if (driftSpeedToStatusMap[speed] != NebulaDriftStatus::NO_DRIFT) {
-                    speedCounter[speed] += 1;
-                }
-            }
+    for (int speed : POSSIBLE_NEBULA_DRIFT_SPEEDS) {
+        int moveCount = countDriftsBetween(speed, lastSeenStart, lastSeenEnd);
+        if (moveCount > 0 && driftSpeedToStatusMap[speed] != NebulaDriftStatus::NO_DRIFT) {
+            speedCounter[speed] = moveCount;
         }
     }
 
@@ -279,7 +203,7 @@ void DriftDetector::reportNebulaDrift(GameTile& gameTile) {
         if (driftSpeedToStatusMap[pair.first] != NebulaDriftStatus::NO_DRIFT) {
             //NO_DRIFT is a conclusive evidence, do not override that!
             if (driftStatus == 1) {
-                log("Possible drift found - " + std::to_string(pair.first) + ", that has moved steps - " + std::to_string(pair.second));
+                LOG_TRACE("Possible drift found - " + std::to_string(pair.first) + ", that has moved steps - " + std::to_string(pair.second));
                 driftSpeedToStatusMap[pair.first] = NebulaDriftStatus::FOUND_DRIFT;
             } else if (driftStatus == -1) {
                 driftSpeedToStatusMap[pair.first] = NebulaDriftStatus::UNCONCLUSIVE_DRIFT;
@@ -296,10 +220,10 @@ void DriftDetector::reportNebulaDrift(GameTile& gameTile) {
         }
     }
 
-    log("Drift outstanding possibilities " + std::to_string(outstandingPossibilities) + ",size of map - " + std::to_string(driftSpeedToStatusMap.size()));
+    LOG_DEBUG("Drift outstanding possibilities " + std::to_string(outstandingPossibilities) + ",size of map - " + std::to_string(driftSpeedToStatusMap.size()));
 
     if (outstandingPossibilities == 1) {
-        log("Drift finalized = " + std::to_string(finalSpeed));
+        LOG_INFO("Drift finalized = " + std::to_string(finalSpeed));
         driftFinalized = true;
         estimateTileTypesforFinalizedDrift();
 
@@ -311,62 +235,30 @@ void DriftDetector::reportNebulaDrift(GameTile& gameTile) {
     }
 
     if (outstandingPossibilities == 0) {
-        log("Problem: Drift Detector bugged!");
+        LOG_WARN("Problem: Drift Detector bugged!");
         std::cerr<<"Drift Detector bugged!"<<std::endl;
         driftFinalized = false;
     }
 }
 
 void DriftDetector::step() {
-    auto& driftAwareTileType = gameMap.getDriftAwareTileType();
-    GameEnvConfig& config = GameEnvConfig::getInstance();
     auto& state = gameMap.derivedGameState;
 
     if (!driftFinalized) {
-        // Just set null value value to this step as the drift is not finalized!        
-        // int lastKnownKey = driftAwareTileType.size() - 1;
-        // std::vector<std::vector<TileType>>* currentTileTypes = driftAwareTileType[lastKnownKey];
-        driftAwareTileType.push_back(nullptr);
+        // No forecast for this step as the drift is not finalized!
+        trackedSteps++;
     }
 
-    if (driftAwareTileType.size() <= state.currentStep) {
-        log("Problem: There is no tileType available for current step, size of vector = " + std::to_string(driftAwareTileType.size()));
+    int knownSteps = gameMap.getDriftForecast().getStepCount() > 0 ? gameMap.getDriftForecast().getStepCount() : trackedSteps;
+    if (knownSteps <= state.currentStep) {
+        LOG_WARN("Problem: There is no tileType available for current step, known steps = " + std::to_string(knownSteps));
         std::cerr<<"Problem: There is no tileType available for current step"<<std::endl;
     }
-
-    if (driftAwareTileType[state.currentStep] != nullptr && allDriftTileTypeVectors.size() > 0 &&
-             driftAwareTileType[state.currentStep] != allDriftTileTypeVectors[currentDriftTileTypeVectorIndex]) {
-        if (allDriftTileTypeVectors.size() <= currentDriftTileTypeVectorIndex + 1) {
-            log("Problem: Unable to switch next drift tile vector = " + std::to_string(allDriftTileTypeVectors.size()) + ", " + std::to_string(currentDriftTileTypeVectorIndex));
-            std::cerr<<"Problem: Unable to switch next drift tile vector"<<std::endl;
-        }        
-
-        currentDriftTileTypeVectorIndex++;
-
-        if (driftAwareTileType[state.currentStep] != allDriftTileTypeVectors[currentDriftTileTypeVectorIndex]) {
-            log("Problem: Next drift tile doesn't match = " + std::to_string(allDriftTileTypeVectors.size()) + ", " + std::to_string(currentDriftTileTypeVectorIndex));
-
-            std::ostringstream oss;
-            oss << driftAwareTileType[state.currentStep];
-
-            std::ostringstream oss1;
-            oss1 << allDriftTileTypeVectors[currentDriftTileTypeVectorIndex];
-
-            log(oss.str() + " != " + oss1.str());
-
-            std::cerr<<"Problem: Next drift tile doesn't match"<<std::endl;
-        }
-    }
 }
 
 TruthValue DriftDetector::isDriftPossible(int stepId) {
     if (driftFinalized) {
-        if (stepToDriftSpeedMap.find(stepId) == stepToDriftSpeedMap.end()) {
-            return TruthValue::FALSE;
-        }
-
-        auto& possibleSpeedsThisStep = stepToDriftSpeedMap[stepId];
-        if (std::find(possibleSpeedsThisStep.begin(), possibleSpeedsThisStep.end(), finalSpeed) != possibleSpeedsThisStep.end()) {
+        if (countDriftsBetween(finalSpeed, stepId - 1, stepId) > 0) {
             return TruthValue::TRUE;
         } else {
             return TruthValue::FALSE;
@@ -383,24 +275,18 @@ DriftDetector::DriftDetector(GameMap &gameMap) : gameMap(gameMap) {
         driftSpeedToStatusMap[speed] = NebulaDriftStatus::UNKNOWN_DRIFT;
     }
 
-    for (int i = 0; i <= config.matchCountPerEpisode * (config.maxStepsInMatch + 1); i++ ) {        
-        for (int speed: POSSIBLE_NEBULA_DRIFT_SPEEDS) {            
-            if (std::fmod((i - 1) * std::fabs(speed/1000.0f), 1.0f) > std::fmod(i * std::fabs(speed/1000.0f), 1.0f)) {
-                stepToDriftSpeedMap[i+1].push_back(speed); //We track everything from the start of the match, so +1.  It will be 8, 11, 15, 21, 28, 3, etc
-            }
+    int totalSteps = config.matchCountPerEpisode * (config.maxStepsInMatch + 1);
+    for (int speed: POSSIBLE_NEBULA_DRIFT_SPEEDS) {
+        std::vector<int>& driftCounts = speedToDriftCountMap[speed];
+        driftCounts.assign(totalSteps + 2, 0);
+        for (int i = 0; i <= totalSteps; i++ ) {
+            //We track everything from the start of the match, so the drift lands on i+1.  It will be 8, 11, 15, 21, 28, 3, etc
+            bool drifts = std::fmod((i - 1) * std::fabs(speed/1000.0f), 1.0f) > std::fmod(i * std::fabs(speed/1000.0f), 1.0f);
+            driftCounts[i + 1] = driftCounts[i] + drifts;
         }
     }
-
-    currentDriftTileTypeVectorIndex = 0;
 }
 
 DriftDetector::~DriftDetector() {
-    auto& driftAwareTileType = gameMap.getDriftAwareTileType();
-    
-    for (auto value : allDriftTileTypeVectors) {
-        delete value;
-    }
-
-    allDriftTileTypeVectors.clear();
-    driftAwareTileType.clear();    
+    gameMap.getDriftForecast().clear();
 }
@@ -19,22 +19,17 @@ class DriftDetector {
     private:
         static void log(const std::string& message);
         int compareDrift(GameTile &sourceTile, int x, int y);
-        std::map<int, std::vector<int>> stepToDriftSpeedMap; // In this step what are all the drift speeds possible?
+        std::map<int, std::vector<int>> speedToDriftCountMap; // Drifts a speed makes from the match start up to each step
         std::map<int, NebulaDriftStatus> driftSpeedToStatusMap; // What is the current status for the drift speed?
-        std::vector< std::vector<std::vector<TileType>>* > allDriftTileTypeVectors;
-        int currentDriftTileTypeVectorIndex = 0;
+        int trackedSteps = 0; // Steps stepped through before the drift was finalized
         GameMap& gameMap;
 
-        TileType getEstimatedDriftTile(int x, int y, std::vector<std::vector<TileType>> *previousStepValues);
-
-        // void fillDriftAwareTileType(int stepId, std::vector<int>& values);
-        std::vector<std::vector<TileType>>* estimateDrift(std::vector<std::vector<TileType>>* previousStepValues);
+        int countDriftsBetween(int speed, int from, int to);
         int computeMoveCountBetween(int from, int to);
-        void forecastTileTypeAt(int step, GameTile &tile, std::vector<std::vector<TileType>> &tileTypesArray);
-        std::vector<std::vector<TileType>> *prepareCurrentTileTypes();
+        void forecastTileTypeAt(int step, GameTile &tile, DriftForecast &driftForecast);
+        void prepareCurrentTileTypes(DriftForecast &driftForecast);
         void estimateTileTypesforFinalizedDrift();
 
-        void exploreTile(int x, int y, TileType tileType, int driftTileTypeIndex);
     public:
         bool driftFinalized;
         int finalSpeed = 0;
@@ -2,7 +2,9 @@
 #include "logger.h"
 #include "symmetry_util.h"
 
+#include <algorithm>
 #include <cmath>
+#include <limits>
 
 const int MIN_ENERGY = -20;
 const int MAX_ENERGY = 20;
@@ -14,23 +16,24 @@ void EnergyEstimator::log(const std::string& message) {
 
 EnergyEstimator::EnergyEstimator(GameMap &gameMap)  : gameMap(gameMap) {
     currentEnergyNode = -1;
-    energyValuesBuffer = nullptr;
     for (int speed: POSSIBLE_ENERGY_DRIFT_SPEEDS) {
         driftSpeedToStatusMap[speed] = EnergyDriftStatus::UNKNOWN_ENERGY_DRIFT;
     }
-}
 
-EnergyEstimator::~EnergyEstimator() {
-    if (energyValuesBuffer != nullptr) {
-        delete energyValuesBuffer;
+    // A node's field only depends on the distance to it, so it is tabled once for every squared distance on the map
+    int maxSquaredDistance = (gameMap.width - 1) * (gameMap.width - 1) + (gameMap.height - 1) * (gameMap.height - 1);
+    fieldByDistance.resize(maxSquaredDistance + 1);
+    for (int squared = 0; squared <= maxSquaredDistance; ++squared) {
+        double distance = std::sqrt(squared);
+        fieldByDistance[squared] = sin(distance * energyNodeFns[0][1] + energyNodeFns[0][2]) * energyNodeFns[0][3];
     }
+    fieldSums.assign(gameMap.width * gameMap.height, std::numeric_limits<double>::quiet_NaN());
 }
 
-// Function to compute the Euclidean distance between two points (a_x, a_y) and (b_x, b_y)
-double euclideanDistance(int aX, int aY, int bX, int bY) {
+static int squaredDistance(int aX, int aY, int bX, int bY) {
     int deltaX = aX - bX;
     int deltaY = aY - bY;
-    return std::sqrt(deltaX * deltaX + deltaY * deltaY);
+    return deltaX * deltaX + deltaY * deltaY;
 }
 
 void EnergyEstimator::getPossibleDrifts(int step, std::unordered_set<int>& possibleDrifts) {
@@ -43,107 +46,105 @@ void EnergyEstimator::getPossibleDrifts(int step, std::unordered_set<int>& possi
     }
 }
 
-bool EnergyEstimator::estimate(int energyNodeTileId) {
-    // log("Estimating for energy node " + std::to_string(energyNodeTileId));
-    GameEnvConfig& gameEnvConfig = GameEnvConfig::getInstance();
-
-    int sizeOfEnergyNodeFns = sizeof(energyNodeFns) / sizeof(energyNodeFns[0]);
-
-    std::vector<std::vector<std::vector<double>>>  estimatedEnergy(
-                                                    gameEnvConfig.mapHeight, 
-                                                    std::vector<std::vector<double>>(
-                                                        gameEnvConfig.mapWidth, 
-                                                        std::vector<double>(sizeOfEnergyNodeFns, 0.0)
-                                                ));
-
-    double meanValue = 0;    
+/**
+ * The field of the node and its mirror summed over every tile, in the tile order the mean is taken in
+ */
+double EnergyEstimator::getFieldSum(int energyNodeTileId) {
+    double& fieldSum = fieldSums[energyNodeTileId];
+    if (!std::isnan(fieldSum)) {
+        return fieldSum;
+    }
 
-    for (int i = 0; i < gameEnvConfig.mapHeight; ++i) {
-        for (int j = 0; j < gameEnvConfig.mapWidth; ++j) {
-            for (int k = 0; k < sizeOfEnergyNodeFns; ++k) {
-
-                if (k == 0) {                    
-                    int x, y;
-                    symmetry_utils::toXY(energyNodeTileId, x, y);
-                    double distance = euclideanDistance(i, j, x, y);
-                    estimatedEnergy[i][j][k] =  sin(distance * energyNodeFns[0][1] + energyNodeFns[0][2]) * energyNodeFns[0][3];
-                } else if (k == 3) {
-                    int x, y, orgX, orgY;
-                    symmetry_utils::toXY(energyNodeTileId, orgX, orgY);
-                    symmetry_utils::toMirroredXY(orgX, orgY, x, y);
-                    double distance = euclideanDistance(i, j, x, y);
-                    estimatedEnergy[i][j][k] += sin(distance * energyNodeFns[0][1] + energyNodeFns[0][2]) * energyNodeFns[0][3];
-                } else {
-                    estimatedEnergy[i][j][k] = 0;
-                }
-            
-                meanValue += estimatedEnergy[i][j][k];
-            }
+    int x, y, mirrorX, mirrorY;
+    symmetry_utils::toXY(energyNodeTileId, x, y);
+    symmetry_utils::toMirroredXY(x, y, mirrorX, mirrorY);
+    fieldSum = 0;
+    for (int i = 0; i < gameMap.width; ++i) {
+        for (int j = 0; j < gameMap.height; ++j) {
+            fieldSum += fieldByDistance[squaredDistance(i, j, x, y)];
+            fieldSum += fieldByDistance[squaredDistance(i, j, mirrorX, mirrorY)];
         }
-    }    
-
-    meanValue /= gameEnvConfig.mapHeight * gameEnvConfig.mapWidth * sizeOfEnergyNodeFns;
-    // log("Mean value of estimated energy: " + std::to_string(meanValue));    
+    }
+    return fieldSum;
+}
 
-    std::vector<std::vector<double>>* energyValuesLocalBuffer = new std::vector<std::vector<double>>(
-        gameMap.height, std::vector<double>(gameMap.width, 0.0)
-    );
+/**
+ * What every node function gets added when the field averages below 0.25
+ */
+double EnergyEstimator::getShift(int energyNodeTileId) {
+    int sizeOfEnergyNodeFns = sizeof(energyNodeFns) / sizeof(energyNodeFns[0]);
+    double meanValue = getFieldSum(energyNodeTileId) / (gameMap.width * gameMap.height * sizeOfEnergyNodeFns);
+    return meanValue < 0.25 ? 0.25 - meanValue : 0;
+}
 
-    bool allGood = true;
-    double newMeanValue = 0;
-    for (int i = 0; i < gameEnvConfig.mapHeight; ++i) {
-        for (int j = 0; j < gameEnvConfig.mapWidth; ++j) {
-            GameTile& tile = gameMap.getTile(i, j);
-            double estimatedEnergyValue = 0;
-            for (int k = 0; k < sizeOfEnergyNodeFns; ++k) {                
-                if (meanValue < 0.25) {
-                    estimatedEnergy[i][j][k] += 0.25 - meanValue;
-                }
-                estimatedEnergyValue += estimatedEnergy[i][j][k];
-                newMeanValue += estimatedEnergy[i][j][k];
-            }
+/**
+ * The energy of a tile for the field values of the node and its mirror there, summed over the six node functions in
+ * their order, the four empty ones contributing only the shift
+ */
+static int toTileEnergy(double nodeField, double mirrorField, double shift) {
+    double estimatedEnergyValue = nodeField + shift;
+    estimatedEnergyValue += shift;
+    estimatedEnergyValue += shift;
+    estimatedEnergyValue += mirrorField + shift;
+    estimatedEnergyValue += shift;
+    estimatedEnergyValue += shift;
+
+    int estimatedEnergyValueRounded = std::round(estimatedEnergyValue);
+    return std::clamp(estimatedEnergyValueRounded, MIN_ENERGY, MAX_ENERGY);
+}
 
-            int estimatedEnergyValueRounded = std::round(estimatedEnergyValue);
-            estimatedEnergyValueRounded =  std::clamp(estimatedEnergyValueRounded, MIN_ENERGY, MAX_ENERGY);
-            (*energyValuesLocalBuffer)[i][j] = estimatedEnergyValueRounded;
-            // log( "(" + std::to_string(i) + "," + std::to_string(j) + ") Estimated = " + std::to_string(estimatedEnergyValueRounded) + " vs " + std::to_string(tile.getEnergy()));
-            if (tile.isVisible() && estimatedEnergyValueRounded != tile.getEnergy()) {
-                allGood = false;
-            }            
+void EnergyEstimator::collectVisibleEnergies() {
+    visibleTiles.clear();
+    visibleEnergies.clear();
+    for (int id = 0; id < gameMap.width * gameMap.height; ++id) {
+        GameTile& tile = gameMap.getTile(id);
+        if (tile.isVisible()) {
+            visibleTiles.push_back(id);
+            visibleEnergies.push_back(tile.getEnergy());
         }
     }
-    
-    newMeanValue /= gameEnvConfig.mapHeight * gameEnvConfig.mapWidth * sizeOfEnergyNodeFns;
-    // log("New Mean value of estimated energy: " + std::to_string(newMeanValue));
+}
 
-    // log("All Good? " + std::to_string(energyNodeTileId) + " = " + std::to_string(allGood));
-    if (allGood) {
-        log("Energy node matched at " + std::to_string(energyNodeTileId));
-        energyValuesBuffer = energyValuesLocalBuffer;
-    } else {
-        delete energyValuesLocalBuffer;        
+/**
+ * Whether a node at the tile, with its mirror, reproduces every visible tile energy. Stops at the first tile it
+ * does not.
+ */
+bool EnergyEstimator::estimate(int energyNodeTileId) {
+    int x, y, mirrorX, mirrorY;
+    symmetry_utils::toXY(energyNodeTileId, x, y);
+    symmetry_utils::toMirroredXY(x, y, mirrorX, mirrorY);
+    double shift = getShift(energyNodeTileId);
+
+    int visibleCount = visibleTiles.size();
+    for (int index = 0; index < visibleCount; ++index) {
+        int i, j;
+        symmetry_utils::toXY(visibleTiles[index], i, j);
+        int energy = toTileEnergy(fieldByDistance[squaredDistance(i, j, x, y)], fieldByDistance[squaredDistance(i, j, mirrorX, mirrorY)], shift);
+        if (energy != visibleEnergies[index]) {
+            return false;
+        }
     }
-    return allGood;
+
+    LOG_DEBUG("Energy node matched at " + std::to_string(energyNodeTileId));
+    return true;
 }
 
-void EnergyEstimator::updateEstimatedEnergies() {
-    if (energyValuesBuffer == nullptr) {
-        log("Problem: Energy values buffer is null.  Not updating the estimated energies");
-        std::cerr<<"Problem: Energy values buffer is null.  Not updating the estimated energies"<<std::endl;
-        return;
-    }
+void EnergyEstimator::updateEstimatedEnergies(int energyNodeTileId) {
+    int x, y, mirrorX, mirrorY;
+    symmetry_utils::toXY(energyNodeTileId, x, y);
+    symmetry_utils::toMirroredXY(x, y, mirrorX, mirrorY);
+    double shift = getShift(energyNodeTileId);
 
-    GameEnvConfig& gameEnvConfig = GameEnvConfig::getInstance();
-    for (int i = 0; i < gameEnvConfig.mapHeight; ++i) {
-        for (int j = 0; j < gameEnvConfig.mapWidth; ++j) {
+    for (int i = 0; i < gameMap.width; ++i) {
+        for (int j = 0; j < gameMap.height; ++j) {
             GameTile& tile = gameMap.getTile(i, j);
-            tile.setEstimatedEnergy((*energyValuesBuffer)[i][j]);
+            tile.setEstimatedEnergy(toTileEnergy(fieldByDistance[squaredDistance(i, j, x, y)], fieldByDistance[squaredDistance(i, j, mirrorX, mirrorY)], shift));
         }
     }
 }
 
 void EnergyEstimator::clearEstimatedEnergies() {
-    log("WARN: Clearing estimated energies.  Ideally this should not happen as it is easy to identify the energy drift");
+    LOG_WARN("WARN: Clearing estimated energies.  Ideally this should not happen as it is easy to identify the energy drift");
     GameEnvConfig& gameEnvConfig = GameEnvConfig::getInstance();
     for (int i = 0; i < gameEnvConfig.mapHeight; ++i) {
         for (int j = 0; j < gameEnvConfig.mapWidth; ++j) {
@@ -154,7 +155,7 @@ void EnergyEstimator::clearEstimatedEnergies() {
 }
 
 void EnergyEstimator::reportEnergyDrift(GameTile &tile) {    
-    log("reportEnergyDrift for tile " + tile.toString());
+    LOG_DEBUG("reportEnergyDrift for tile " + tile.toString());
 
     if (gameMap.derivedGameState.currentStep <= 20) {
         return;
@@ -174,7 +175,7 @@ void EnergyEstimator::reportEnergyDrift(GameTile &tile) {
     }
 
     if (possibleDrifts.find(1) != possibleDrifts.end() && driftSpeedToStatusMap[1] != EnergyDriftStatus::NO_ENERGY_DRIFT) {
-        log("Drift at 1 possible, but it is not already set to NO_ENERGY_DRIFT");
+        LOG_DEBUG("Drift at 1 possible, but it is not already set to NO_ENERGY_DRIFT");
         driftSpeedToStatusMap[2] = EnergyDriftStatus::NO_ENERGY_DRIFT;
         driftSpeedToStatusMap[3] = EnergyDriftStatus::NO_ENERGY_DRIFT;
         driftSpeedToStatusMap[4] = EnergyDriftStatus::NO_ENERGY_DRIFT;
@@ -182,7 +183,7 @@ void EnergyEstimator::reportEnergyDrift(GameTile &tile) {
     }
 
     if (possibleDrifts.find(2) != possibleDrifts.end() && driftSpeedToStatusMap[2] != EnergyDriftStatus::NO_ENERGY_DRIFT) {
-        log("Drift at 2 possible, but it is not already set to NO_ENERGY_DRIFT");
+        LOG_DEBUG("Drift at 2 possible, but it is not already set to NO_ENERGY_DRIFT");
         driftSpeedToStatusMap[4] = EnergyDriftStatus::NO_ENERGY_DRIFT;
     }    
 
@@ -191,7 +192,7 @@ void EnergyEstimator::reportEnergyDrift(GameTile &tile) {
         if (possibleDrifts.find(speed) == possibleDrifts.end()) {
             if (driftSpeedToStatusMap[speed] == EnergyDriftStatus::FOUND_ENERGY_DRIFT) {
                 // This is an edge case when the first smaller drifts like 0.04 or 0.02 did not drift as the energy nodes went into the same tile
-                log("Need to recover from wrongly identified drift tile for speed " + std::to_string(speed));
+                LOG_DEBUG("Need to recover from wrongly identified drift tile for speed " + std::to_string(speed));
 
                 finalEnergyDriftSpeed = -1;                
                 int currentMax = -1;
@@ -201,11 +202,11 @@ void EnergyEstimator::reportEnergyDrift(GameTile &tile) {
                     }                    
                 }
                 if (currentMax == -1) {
-                    log("Problem: No possible drifts found for tile " + tile.toString());
+                    LOG_WARN("Problem: No possible drifts found for tile " + tile.toString());
                     std::cerr<<"Problem: No possible drifts found for tile "<<tile.toString()<<std::endl;
                 } else {
                     driftSpeedToStatusMap[currentMax] = EnergyDriftStatus::UNKNOWN_ENERGY_DRIFT;
-                    log("Recovering the speed " + std::to_string(currentMax));
+                    LOG_DEBUG("Recovering the speed " + std::to_string(currentMax));
                 }
             }
             driftSpeedToStatusMap[speed] = EnergyDriftStatus::NO_ENERGY_DRIFT;
@@ -222,7 +223,7 @@ void EnergyEstimator::reportEnergyDrift(GameTile &tile) {
         for (int speed: POSSIBLE_ENERGY_DRIFT_SPEEDS) {
             if (driftSpeedToStatusMap[speed] == EnergyDriftStatus::UNKNOWN_ENERGY_DRIFT) {
                 driftSpeedToStatusMap[speed] = EnergyDriftStatus::FOUND_ENERGY_DRIFT;
-                log("Energy drift found at speed " + std::to_string(speed));
+                LOG_INFO("Energy drift found at speed " + std::to_string(speed));
                 finalEnergyDriftSpeed = speed;
 
                 auto& details = Metrics::getInstance().details;
@@ -237,11 +238,11 @@ void EnergyEstimator::reportEnergyDrift(GameTile &tile) {
 }
 
 void EnergyEstimator::updateEnergyNodes() {
-    log("Updating energy nodes");
+    LOG_DEBUG("Updating energy nodes");
 
     int x1, x2, y1, y2;
     if (currentEnergyNode == -1) {
-        log("Computing energy node for the first time");
+        LOG_DEBUG("Computing energy node for the first time");
         x1 = 0;
         x2 = 23;
         y1 = 0;
@@ -255,15 +256,19 @@ void EnergyEstimator::updateEnergyNodes() {
         y2 = y + energyNodeDriftMagnitude;
     }
 
+    collectVisibleEnergies();
+    candidateSeen.assign(gameMap.width * gameMap.height, false);
     std::unordered_set<int> possibleEnergyNodeTileIds;
 
     for (int i = x1; i <= x2; ++i) {
         for (int j = y1; j <= y2; ++j) {
             GameTile& tile = gameMap.getRolledOverTile(i, j);
-            int tileId = tile.getId(gameMap.width);
-            if (!symmetry_utils::isFirstHalfID(tileId)) {
+            // A node and its mirror make the same field, so each pair is tried once as its first half node
+            int tileId = symmetry_utils::toFirstHalfID(tile.getId());
+            if (candidateSeen[tileId]) {
                 continue;
             }
+            candidateSeen[tileId] = true;
 
             if (estimate(tileId)) {
                 possibleEnergyNodeTileIds.insert(tileId);                
@@ -273,10 +278,8 @@ void EnergyEstimator::updateEnergyNodes() {
 
     if (possibleEnergyNodeTileIds.size() == 1) {
         currentEnergyNode = *possibleEnergyNodeTileIds.begin();
-        log("Energy node found at " + std::to_string(currentEnergyNode));
-        updateEstimatedEnergies();
-        delete energyValuesBuffer;
-        energyValuesBuffer = nullptr;
+        LOG_INFO("Energy node found at " + std::to_string(currentEnergyNode));
+        updateEstimatedEnergies(currentEnergyNode);
 
         auto& details = Metrics::getInstance().details;
         if (details.energyNodeIdentifiedStep < 0) {
@@ -284,7 +287,7 @@ void EnergyEstimator::updateEnergyNodes() {
         }
 
     } else {
-        log("Energy node not found, this is rare");
+        LOG_DEBUG("Energy node not found, this is rare");
         clearEstimatedEnergies();
     }
 }
@@ -17,7 +17,11 @@ class EnergyEstimator {
 
         std::map<int, EnergyDriftStatus> driftSpeedToStatusMap;
 
-        std::vector<std::vector<double>>* energyValuesBuffer;
+        std::vector<double> fieldByDistance;   // Field of one node at each squared distance from it
+        std::vector<double> fieldSums;         // By candidate tile id, the field of the node pair summed over the map, NaN until needed
+        std::vector<int> visibleTiles;         // Tile ids whose energy the candidates must reproduce
+        std::vector<int> visibleEnergies;
+        std::vector<bool> candidateSeen;       // By tile id, within one updateEnergyNodes()
 
         double energyNodeFns[6][4] = {
             {0, 1.2, 1, 4},
@@ -34,8 +38,11 @@ class EnergyEstimator {
 
         void getPossibleDrifts(int step, std::unordered_set<int> &possibleDrifts);
 
+        double getFieldSum(int energyNodeTileId);
+        double getShift(int energyNodeTileId);
+        void collectVisibleEnergies();
         bool estimate(int energyNodeTileId);
-        void updateEstimatedEnergies();
+        void updateEstimatedEnergies(int energyNodeTileId);
 
         void clearEstimatedEnergies();
 
@@ -43,7 +50,6 @@ class EnergyEstimator {
         int energyNodeDriftMagnitude = 6; //We cant find this, so using the max always
         int finalEnergyDriftSpeed = -1;
         EnergyEstimator(GameMap& gameMap);
-        ~EnergyEstimator();
         void reportEnergyDrift(GameTile& tile);
         void updateEnergyNodes();
 
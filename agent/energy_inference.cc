@@ -0,0 +1,138 @@
+#include "energy_inference.h"
+
+#include <cmath>
+
+#include "game_env_config.h"
+
+void EnergyInference::explain(const EnergyObservation& observation, EnergyExplanation& explanation) {
+    GameEnvConfig& gameEnvConfig = GameEnvConfig::getInstance();
+    explanation = {};
+
+    nebulaCandidates.clear();
+    if (observation.inNebula) {
+        for (int index = 0; index < NebulaEnergyReductionHypotheses::CANDIDATE_COUNT; ++index) {
+            if (nebulaEnergyReduction.getMask() & (1u << index)) {
+                nebulaCandidates.push_back({index, nebulaEnergyReduction.getValue(index), 0});
+            }
+        }
+    } else {
+        nebulaCandidates.push_back({-1, 0, 0});
+    }
+
+    // Melee sap per void factor, summed the way ShuttleEnergyChangeDistribution::computeSapContributions sums it
+    voidCandidates.clear();
+    uint32_t recordableVoidFactors = 0;
+    if (observation.meleeSapEnergies.empty()) {
+        voidCandidates.push_back({-1, 0, 0});
+    } else {
+        for (int index = 0; index < MeleeVoidFactorHypotheses::CANDIDATE_COUNT; ++index) {
+            if (!(meleeVoidFactor.getMask() & (1u << index))) {
+                continue;
+            }
+            float factor = meleeVoidFactor.getValue(index);
+            double result = 0;
+            for (int energy : observation.meleeSapEnergies) {
+                if (energy > 0) {
+                    result += energy * factor;
+                }
+            }
+            int meleeSapEnergy = static_cast<int>(std::floor(result));
+            voidCandidates.push_back({index, meleeSapEnergy / observation.unitStackCount, meleeSapEnergy});
+            if (meleeSapEnergy > 0) {
+                recordableVoidFactors |= 1u << index;
+            }
+        }
+    }
+    uint32_t recordableNebulaReductions = observation.inNebula ? nebulaEnergyReduction.getMask() : 0;
+
+    // Indirect sap loss for every count and drop off factor, candidate 0 stands for no indirect sap at all
+    dropOffCandidates.clear();
+    dropOffCandidates.push_back({-1, 0, 0});
+    for (int index = 0; index < SapDropOffFactorHypotheses::CANDIDATE_COUNT; ++index) {
+        if (sapDropOffFactor.getMask() & (1u << index)) {
+            dropOffCandidates.push_back({index, 0, 0});
+        }
+    }
+    const int dropOffs = dropOffCandidates.size();
+    indirectSapLoss.assign((observation.indirectSapCandidates + 1) * dropOffs, 0);
+    for (int count = 1; count <= observation.indirectSapCandidates; ++count) {
+        for (int candidate = 1; candidate < dropOffs; ++candidate) {
+            float dropOffFactor = sapDropOffFactor.getValue(dropOffCandidates[candidate].index);
+            indirectSapLoss[count * dropOffs + candidate] = static_cast<int>(std::floor(count * gameEnvConfig.unitSapCost * dropOffFactor));
+        }
+    }
+
+    const int energyAfterMove = observation.previousEnergy - observation.moveCost;
+    const int target = observation.energy;
+
+    for (const Candidate& nebula : nebulaCandidates) {
+        const int energyGain = observation.tileEnergy - nebula.loss;
+
+        for (int direct = 0; direct <= observation.directSapCandidates; ++direct) {
+            const int afterDirectSap = energyAfterMove - direct * gameEnvConfig.unitSapCost;
+            deadDropOff.assign(dropOffs, 0);
+            bool directReachesTarget = false;
+
+            for (int indirect = 0; indirect <= observation.indirectSapCandidates; ++indirect) {
+                const bool rangedAttack = direct > 0 || indirect > 0;
+                bool indirectReachesTarget = false;
+
+                for (int candidate = indirect == 0 ? 0 : 1; candidate < (indirect == 0 ? 1 : dropOffs); ++candidate) {
+                    if (deadDropOff[candidate]) {
+                        continue;
+                    }
+                    const int afterRangedSap = afterDirectSap - indirectSapLoss[indirect * dropOffs + candidate];
+                    bool reachesTarget = false;
+
+                    for (const Candidate& meleeVoid : voidCandidates) {
+                        int energy = predictEnergy(afterRangedSap - meleeVoid.loss, energyGain, rangedAttack | (meleeVoid.sap > 0));
+                        reachesTarget |= energy >= target;
+                        if (energy != target) {
+                            continue;
+                        }
+
+                        if (explanation.solutions++ == 0) {
+                            explanation.nebulaEnergyReduction = nebula.loss;
+                            explanation.rangedDirectSapCount = direct;
+                            explanation.rangedIndirectSapCount = indirect;
+                            explanation.meleeSapEnergy = meleeVoid.sap;
+                        }
+                        if (observation.inNebula) {
+                            explanation.possibleNebulaEnergyReduction |= 1u << nebula.index;
+                        }
+                        if (meleeVoid.sap > 0) {
+                            explanation.possibleMeleeVoidFactor |= 1u << meleeVoid.index;
+                        }
+                        if (indirect > 0 && sapDropOffFactor.getValue(dropOffCandidates[candidate].index) < 1.0) {
+                            // 1.0 cannot be identified this way
+                            explanation.possibleSapDropOffFactor |= 1u << dropOffCandidates[candidate].index;
+                        }
+
+                        if (!observation.exhaustive
+                            || (explanation.solutions > 1
+                                && explanation.possibleNebulaEnergyReduction == recordableNebulaReductions
+                                && explanation.possibleMeleeVoidFactor == recordableVoidFactors)) {
+                            // No further solution can narrow anything down
+                            return;
+                        }
+                    }
+
+                    // More saps never bring the energy back up
+                    deadDropOff[candidate] = !reachesTarget;
+                    indirectReachesTarget |= reachesTarget;
+                }
+
+                if (indirect == 0) {
+                    directReachesTarget = indirectReachesTarget;
+                }
+                if (!indirectReachesTarget) {
+                    break;
+                }
+            }
+
+            if (!directReachesTarget) {
+                break;
+            }
+        }
+    }
+}
@@ -0,0 +1,125 @@
+#ifndef ENERGY_INFERENCE_H
+#define ENERGY_INFERENCE_H
+
+#include <bit>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "constants.h"
+
+/**
+ * The candidate values of one hidden game parameter that no observation has ruled out yet, as a bitmask over the
+ * candidate array
+ */
+template<typename T, int N>
+class HypothesisSet {
+    private:
+        const T* values;
+        uint32_t mask = (1u << N) - 1;
+
+    public:
+        static constexpr int CANDIDATE_COUNT = N;
+
+        explicit HypothesisSet(const T (&values)[N]): values(values) {}
+
+        uint32_t getMask() const { return mask; }
+        int size() const { return std::popcount(mask); }
+        bool isEmpty() const { return mask == 0; }
+        bool isPinned() const { return std::has_single_bit(mask); }
+        T getValue(int index) const { return values[index]; }
+        T getPinnedValue() const { return values[std::countr_zero(mask)]; }
+
+        /**
+         * Keeps only the values in the possible mask
+         */
+        void retain(uint32_t possible) { mask &= possible; }
+
+        std::string toString(const std::string& name) const {
+            std::string result = name + " values: [";
+            for (int index = 0; index < N; ++index) {
+                if (mask & (1u << index)) {
+                    result += (result.back() == '[' ? "" : ", ") + std::to_string(values[index]);
+                }
+            }
+            return result + "]";
+        }
+};
+
+using NebulaEnergyReductionHypotheses = HypothesisSet<int, std::size(POSSIBLE_NEBULA_ENERGY_REDUCTION_VALUES)>;
+using MeleeVoidFactorHypotheses = HypothesisSet<float, std::size(POSSIBLE_UNIT_ENERGY_VOID_FACTOR_VALUES)>;
+using SapDropOffFactorHypotheses = HypothesisSet<float, std::size(POSSIBLE_UNIT_SAP_DROP_OFF_FACTOR_VALUES)>;
+
+/**
+ * What is known about the energy change of one shuttle in one step
+ */
+struct EnergyObservation {
+    int previousEnergy = 0;
+    int energy = 0;
+    int moveCost = 0;
+    int tileEnergy = 0;
+    int unitStackCount = 1;
+    bool inNebula = false;
+    int directSapCandidates = 0;        // Opponents that could have sapped the shuttle's tile
+    int indirectSapCandidates = 0;      // Opponents that could have sapped a tile next to it
+    std::vector<int> meleeSapEnergies;  // Net energy of the opponents on every neighbouring tile
+    bool exhaustive = true;             // Every solution counts, otherwise the first one is enough
+};
+
+/**
+ * The combinations of sap counts and parameter values that account for an observed energy change
+ */
+struct EnergyExplanation {
+    int solutions = 0;              // Exact while 1, counting may stop past that once nothing more can be learnt
+
+    // The first solution, in the order of nebula reduction, direct saps, indirect saps, drop off and void factor
+    int nebulaEnergyReduction = 0;
+    int rangedDirectSapCount = 0;
+    int rangedIndirectSapCount = 0;
+    int meleeSapEnergy = 0;
+
+    // Candidate values some solution used, only where the observation tells the value apart
+    uint32_t possibleNebulaEnergyReduction = 0;
+    uint32_t possibleMeleeVoidFactor = 0;
+    uint32_t possibleSapDropOffFactor = 0;
+};
+
+/**
+ * Explains shuttle energy changes against the surviving hypotheses of the nebula energy reduction, the melee void
+ * factor and the ranged sap drop off factor. Only the values still possible are enumerated, the sap losses are
+ * tabled once per observation, and the sap counts stop growing once the prediction falls below the observed energy,
+ * since it never rises again with more saps.
+ */
+class EnergyInference {
+    private:
+        struct Candidate {
+            int index;      // Into the candidate array, -1 for a value that is not a hypothesis
+            int loss;
+            int sap;
+        };
+
+        std::vector<Candidate> nebulaCandidates;
+        std::vector<Candidate> voidCandidates;
+        std::vector<Candidate> dropOffCandidates;
+        std::vector<int> indirectSapLoss;   // Count * drop off candidates + drop off candidate
+        std::vector<uint8_t> deadDropOff;
+
+    public:
+        NebulaEnergyReductionHypotheses nebulaEnergyReduction{POSSIBLE_NEBULA_ENERGY_REDUCTION_VALUES};
+        MeleeVoidFactorHypotheses meleeVoidFactor{POSSIBLE_UNIT_ENERGY_VOID_FACTOR_VALUES};
+        SapDropOffFactorHypotheses sapDropOffFactor{POSSIBLE_UNIT_SAP_DROP_OFF_FACTOR_VALUES};
+
+        /**
+         * Energy after the step for an energy before gains, the same rules as ShuttleEnergyChangeDistribution::computeEnergy
+         */
+        static int predictEnergy(int energyBeforeGain, int energyGain, bool attack) {
+            int gained = energyBeforeGain + energyGain;
+            int clamped = gained < 0 ? 0 : gained > MAX_ENERGY ? static_cast<int>(MAX_ENERGY) : gained;
+            return (energyBeforeGain < 0) & (gained < 0) & attack ? energyBeforeGain : clamped;
+        }
+
+        void explain(const EnergyObservation& observation, EnergyExplanation& explanation);
+};
+
+#endif // ENERGY_INFERENCE_H
@@ -1,6 +1,7 @@
 #include "game_map.h"
 
 #include <cmath>
+#include <algorithm>
 #include <stdexcept>
 #include <tuple>
 #include <cmath>
@@ -14,15 +15,84 @@ void GameTile::log(const std::string& message) {
     Logger::getInstance().log("GameTile -> " + message);
 }
 
+void TileStore::resize(int width, int height) {
+    int tileCount = width * height;
+    typeImmediate.assign(tileCount, TileType::UNKNOWN_TILE);
+    previousTypeImmediate.assign(tileCount, TileType::UNKNOWN_TILE);
+    type.assign(tileCount, TileType::UNKNOWN_TILE);
+    previousType.assign(tileCount, TileType::UNKNOWN_TILE);
+
+    visible.resize(width, height);
+    visited.resize(width, height);
+    explored.resize(width, height);
+    unexploredFrontier.resize(width, height);
+    for (auto& frontier : relicExplorationFrontier) {
+        frontier.resize(width, height);
+    }
+    haloTile.resize(width, height);
+    vantagePoint.resize(width, height);
+    forcedRegularTile.resize(width, height);
+
+    energy.assign(tileCount, -1);
+    estimatedEnergy.assign(tileCount, -21);
+    previousEnergy.assign(tileCount, -1);
+    lastVisitedTime.assign(tileCount, -1);
+    lastExploredTime.assign(tileCount, -1);
+    lastEnergyUpdateTime.assign(tileCount, -1);
+    previousEnergyUpdateTime.assign(tileCount, -1);
+    typeUpdateStep.assign(tileCount, -1);
+    previousTypeUpdateStep.assign(tileCount, -1);
+
+    relic.assign(tileCount, nullptr);
+    previousTypes.assign(tileCount, {});
+    previousTypeUpdateSteps.assign(tileCount, {});
+    shuttles.assign(tileCount, {});
+    ghostShuttles.assign(tileCount, {});
+    opponentShuttles.assign(tileCount, {});
+    opponentGhostShuttles.assign(tileCount, {});
+}
+
+void DriftForecast::reset(int width, int height, int direction, int steps) {
+    this->width = width;
+    this->height = height;
+    this->direction = direction;
+    baseTypes.assign(4 * width * height, TileType::UNKNOWN_TILE);
+    offsets.assign(steps, 0);
+    origins.assign(steps, 0);
+}
+
+void DriftForecast::clear() {
+    baseTypes.clear();
+    offsets.clear();
+    origins.clear();
+}
+
+void DriftForecast::setOffset(int step, int offset) {
+    int shift = offset * direction;
+    offsets[step] = offset;
+    origins[step] = wrap(shift, height) * 2 * width + wrap(-shift, width);
+}
+
+void DriftForecast::setType(int x, int y, int step, TileType tileType) {
+    int origin = origins[step];
+    int baseX = (origin % (2 * width) + x) % width;
+    int baseY = (origin / (2 * width) + y) % height;
+    for (int tileY = baseY; tileY < 2 * height; tileY += height) {
+        for (int tileX = baseX; tileX < 2 * width; tileX += width) {
+            baseTypes[tileY * 2 * width + tileX] = tileType;
+        }
+    }
+}
+
 GameMap::GameMap(int width, int height) : width(width), height(height) {
     GameEnvConfig& gameEnvConfig = GameEnvConfig::getInstance();
-    map.resize(height);
+    store.resize(width, height);
+    tiles.reserve(width * height);
     for (int y = 0; y < height; ++y) {
-        map[y].reserve(width);
         for (int x = 0; x < width; ++x) {
-            map[y].emplace_back(x, y);
-            map[y][x].manhattanFromOrigin = std::abs(x - gameEnvConfig.originX) + std::abs(y - gameEnvConfig.originY);
-            map[y][x].manhattanToOpponentOrigin = std::abs(x - gameEnvConfig.opponentOriginX) + std::abs(y - gameEnvConfig.opponentOriginY);
+            GameTile& tile = tiles.emplace_back(&store, x, y, y * width + x);
+            tile.manhattanFromOrigin = std::abs(x - gameEnvConfig.originX) + std::abs(y - gameEnvConfig.originY);
+            tile.manhattanToOpponentOrigin = std::abs(x - gameEnvConfig.opponentOriginX) + std::abs(y - gameEnvConfig.opponentOriginY);
         }
     }
 }
@@ -30,19 +100,19 @@ GameMap::GameMap(int width, int height) : width(width), height(height) {
 void GameMap::addRelic(Relic *relic, int currentStep, std::vector<int>& haloTileIds) {
     int x = relic->position[0];
     int y = relic->position[1];
-    map[y][x].setRelic(relic);
+    getTile(x, y).setRelic(relic);
     for (int i = x-2;i <= x+2; ++i) {
         for (int j = y-2; j <= y+2; ++j) {            
             if (isValidTile(i, j)) {
                 auto& tile = getTile(i, j);                
-                if (map[j][i].isHaloTile()) {
+                if (tile.isHaloTile()) {
                     // If multiple relics are seen, this can happen.  This is a overlap
-                    log("Halo Overlap detected for (" + std::to_string(i) + ", " + std::to_string(j) + ")");
+                    LOG_TRACE("Halo Overlap detected for (" + std::to_string(i) + ", " + std::to_string(j) + ")");
                 }
-                map[j][i].setHaloTile(true);
-                haloTileIds.push_back(map[j][i].getId(width));
+                tile.setHaloTile(true);
+                haloTileIds.push_back(tile.getId());
                 //TODO: If this is already a halo node, and we have it in our constraint set then it is a problem!
-                log("Forcing halo tile for (" + std::to_string(i) + ", " + std::to_string(j) + ")");
+                LOG_TRACE("Forcing halo tile for (" + std::to_string(i) + ", " + std::to_string(j) + ")");
             }
         }
     }
@@ -54,7 +124,7 @@ void GameMap::getAllOpponentsInRadius(int radius, int x, int y, std::vector<Shut
             if (isValidTile(i, j)) {
                 auto& tile = getTile(i, j);
                 if (tile.isOpponentOccupied()) {
-                    for (auto& shuttle : tile.opponentShuttles) {
+                    for (auto& shuttle : tile.getOpponentShuttles()) {
                         opponents.push_back(shuttle);
                     }
                 }
@@ -63,40 +133,31 @@ void GameMap::getAllOpponentsInRadius(int radius, int x, int y, std::vector<Shut
     }
 }
 
-void GameMap::setRelicExplorationFrontier(GameTile &tile, int match, int cutoffTime) {
-    // Check if adjacent tiles are explored recently, and mark this tile as frontier
-    if (isValidTile(tile.x, tile.y - 1)) {
-        auto& nextTile = getTile(tile.x, tile.y - 1);
-        if (nextTile.getLastExploredTime() >= cutoffTime) {
-            tile.setRelicExplorationFrontier(true, match);
+/**
+ * Tiles not explored since the cutoff that border a tile explored after it become relic exploration frontiers for the
+ * match. Returns true when every tile has been explored since the cutoff.
+ */
+bool GameMap::updateRelicExplorationFrontier(int match, int cutoffTime) {
+    TileBitboard exploredSinceCutoff(width, height);
+    int tileCount = width * height;
+    for (int id = 0; id < tileCount; ++id) {
+        if (store.lastExploredTime[id] >= cutoffTime) {
+            exploredSinceCutoff.set(id);
         }
     }
 
-    if (isValidTile(tile.x, tile.y + 1)) {
-        auto& nextTile = getTile(tile.x, tile.y + 1);
-        if (nextTile.getLastExploredTime() >= cutoffTime) {
-            tile.setRelicExplorationFrontier(true, match);
-        }
+    TileBitboard staleTiles = ~exploredSinceCutoff;
+    if (staleTiles.none()) {
+        return true;
     }
 
-    if (isValidTile(tile.x - 1, tile.y)) {
-        auto& nextTile = getTile(tile.x - 1, tile.y);
-        if (nextTile.getLastExploredTime() >= cutoffTime) {
-            tile.setRelicExplorationFrontier(true, match);
-        }
-    }
-
-    if (isValidTile(tile.x + 1, tile.y)) {
-        auto& nextTile = getTile(tile.x +1, tile.y);
-        if (nextTile.getLastExploredTime() >= cutoffTime) {
-            tile.setRelicExplorationFrontier(true, match);
-        }
-    }
+    store.relicExplorationFrontier[match] |= staleTiles & exploredSinceCutoff.neighbours();
+    return false;
 }
 
 bool GameMap::hasPotentialInvisibleRelicNode(GameTile& gameTile) {
     if (!derivedGameState.isThereAHuntForRelic()) {
-        log("No potential for a relic node nearby tile " + gameTile.toString());
+        LOG_TRACE("No potential for a relic node nearby tile " + gameTile.toString());
         return false;
     }
     int x = gameTile.x;
@@ -158,15 +219,8 @@ void GameMap::exploreTile(GameTile &tile, int currenStep) {
     tile.setExplored(true, currenStep);
 }
 
-bool GameMap::isValidTile(int x, int y){
-    return x >= 0 && x < width && y >= 0 && y < height;
-}
-
-GameTile& GameMap::getTile(int x, int y){
-    if (x < 0 || x >= width || y < 0 || y >= height) {
-        throw std::out_of_range("Tile coordinates out of range - " + std::to_string(x) + ", " + std::to_string(y));
-    }
-    return map[y][x];
+void GameMap::throwOutOfRange(int x, int y) {
+    throw std::out_of_range("Tile coordinates out of range - " + std::to_string(x) + ", " + std::to_string(y));
 }
 
 GameTile& GameMap::getRolledOverTile(int x, int y) {
@@ -241,7 +295,7 @@ GameTile &GameMap::getTileFromActionId(int actionId, int x, int y) {
 }
 
 TileType GameMap::getEstimatedType(GameTile &tile, int step) const {
-    if (step >= driftAwareTileType.size() || driftAwareTileType[step] == nullptr) {
+    if (!driftForecast.hasForecast(step)) {
         // Fallback to the known value.  Likely the drift is not finalized!
         // The fallback doesn't consider previous steps more than 1.  the -1 previous lookup is needed for shuttle_energy_tracker.        
         if (step == derivedGameState.currentStep -1) {
@@ -251,7 +305,21 @@ TileType GameMap::getEstimatedType(GameTile &tile, int step) const {
         return tile.getType();
     }
 
-    return driftAwareTileType[step]->at(tile.y).at(tile.x);
+    return driftForecast.getType(tile.x, tile.y, step);
+}
+
+void GameMap::getEstimatedTypes(int step, std::vector<TileType>& types) {
+    types.resize(width * height);
+    if (driftForecast.hasForecast(step)) {
+        for (int y = 0; y < height; ++y) {
+            std::copy_n(driftForecast.getRow(y, step), width, types.begin() + y * width);
+        }
+        return;
+    }
+
+    for (int id = 0; id < width * height; ++id) {
+        types[id] = getEstimatedType(tiles[id], step);
+    }
 }
 
 std::tuple<bool, GameTile&> GameMap::isMovable(GameTile &fromTile, Direction direction) {
@@ -272,92 +340,85 @@ std::tuple<bool, GameTile&> GameMap::isMovable(GameTile &fromTile, Direction dir
     }
 }
 
-int GameTile::getId(int width){
-    return y * width + x;
-}
-
 TileType GameTile::getType() const {
-    return type;
+    return store->type[id];
 }
 
 void GameTile::setVisited(bool visited, int time) {
-    this->visited = visited;
-    this->lastVisitedTime = time;
+    store->visited.set(id, visited);
+    store->lastVisitedTime[id] = time;
 }
 
 void GameTile::addShuttle(ShuttleData* shuttle)  {
-    log("Adding shuttle at (" + std::to_string(x) + ", " + std::to_string(y) + "), id=" + std::to_string(shuttle->id));
-    this->shuttles.push_back(shuttle);
+    LOG_TRACE("Adding shuttle at (" + std::to_string(x) + ", " + std::to_string(y) + "), id=" + std::to_string(shuttle->id));
+    store->shuttles[id].push_back(shuttle);
 }
 
 void GameTile::addGhostShuttle(ShuttleData* shuttle)  {
-    log("Adding ghost shuttle at (" + std::to_string(x) + ", " + std::to_string(y) + "), id=" + std::to_string(shuttle->id));
-    this->ghostShuttles.push_back(shuttle);
+    LOG_TRACE("Adding ghost shuttle at (" + std::to_string(x) + ", " + std::to_string(y) + "), id=" + std::to_string(shuttle->id));
+    store->ghostShuttles[id].push_back(shuttle);
 }
 
 void GameTile::addOpponentShuttle(ShuttleData* shuttle) {
-    this->opponentShuttles.push_back(shuttle);
+    store->opponentShuttles[id].push_back(shuttle);
 }
 
 void GameTile::addOpponentGhostShuttle(ShuttleData* shuttle) {
-    this->opponentGhostShuttles.push_back(shuttle);
+    store->opponentGhostShuttles[id].push_back(shuttle);
 }
 
 bool GameTile::isOccupied() {
-    return shuttles.size() > 0;
+    return store->shuttles[id].size() > 0;
 }
 
 bool GameTile::isOpponentOccupied() {
-    return opponentShuttles.size() > 0;
+    return store->opponentShuttles[id].size() > 0;
 }
 
 int GameTile::getCumulativeOpponentEnergy() {
-    GameEnvConfig& gameEnvConfig = GameEnvConfig::getInstance();
     int shuttleEnergy = 0;
-    for (auto& shuttle : opponentShuttles) {       
+    for (auto& shuttle : store->opponentShuttles[id]) {       
         shuttleEnergy += shuttle->energy;
     }
     return shuttleEnergy;
 }
 
 void GameTile::clearShuttle(ShuttleData* shuttle) {
+    auto& shuttles = store->shuttles[id];
     for (auto it = shuttles.begin(); it != shuttles.end(); ++it) {
         if (*it == shuttle) {
             it = shuttles.erase(it);
-            log("clearShuttle: Shuttle removed from (" + std::to_string(x) + ", " + std::to_string(y) + "), id=" + std::to_string(shuttle->id));
+            LOG_TRACE("clearShuttle: Shuttle removed from (" + std::to_string(x) + ", " + std::to_string(y) + "), id=" + std::to_string(shuttle->id));
             break;
         }
     }
 }
 
 void GameTile::clearShuttles() {
-    this->shuttles.clear();
-    this->ghostShuttles.clear();
+    store->shuttles[id].clear();
+    store->ghostShuttles[id].clear();
 }
 
 void GameTile::clearOpponentShuttles() {
-    this->opponentShuttles.clear();
-    this->opponentGhostShuttles.clear();
+    store->opponentShuttles[id].clear();
+    store->opponentGhostShuttles[id].clear();
 }
 
 void GameTile::setExplored(bool explored, int time) {
-    this->explored = explored;
-    this->lastExploredTime = time;
+    store->explored.set(id, explored);
+    store->lastExploredTime[id] = time;
+    store->unexploredFrontier.reset(id);
 
-    if (this->unexploredFrontier) {
-        this->unexploredFrontier = false;
+    if (time >= 50) {
+        store->relicExplorationFrontier[0].reset(id);
     }
 
-    if (time >= 50 && this->relicExplorationFrontier1) {
-        relicExplorationFrontier1 = false;
+    if (time >= 151) {
+        store->relicExplorationFrontier[1].reset(id);
     }
 
-    if (time >= 151 && this->relicExplorationFrontier2) {
-        relicExplorationFrontier2 = false;
-    }
-
-    if (time >= 252 && this->relicExplorationFrontier3) {
-        relicExplorationFrontier3 = false;
+    if (time >= 252) {
+        store->relicExplorationFrontier[2].reset(id);
     }
 }
 
@@ -374,85 +435,86 @@ TileType GameTile::translateTileType(int tileTypeCode) {
 }
 
 void GameTile::setTypeImmediate(TileType tileType) {    
-    previousTypeImmediate = typeImmediate;
-    typeImmediate = tileType;
-    // log("Immediate type previous set to " + std::to_string(previousTypeImmediate) + " for tile (" + std::to_string(x) + ", " + std::to_string(y) + ")");
+    store->previousTypeImmediate[id] = store->typeImmediate[id];
+    store->typeImmediate[id] = tileType;
 }
 
 void GameTile::setType(TileType tileType, int step, bool driftIdentified) {
+    auto& previousTypes = store->previousTypes[id];
     if (!driftIdentified && tileType != TileType::UNKNOWN_TILE && (previousTypes.empty() || previousTypes.top() != tileType)) {
         previousTypes.push(tileType);
-        previousTypeUpdateSteps.push(step);
+        store->previousTypeUpdateSteps[id].push(step);
     }
 
-    previousType = type;
-    type = tileType;
+    store->previousType[id] = store->type[id];
+    store->type[id] = tileType;
 
-    previousTypeUpdateStep = typeUpdateStep;
-    typeUpdateStep = step;    
+    store->previousTypeUpdateStep[id] = store->typeUpdateStep[id];
+    store->typeUpdateStep[id] = step;    
 }
 
 TileType GameTile::getType() {
-    return type;
+    return store->type[id];
 }
 
 std::stack<TileType>& GameTile::getPreviousTypes() {
-    return previousTypes;
+    return store->previousTypes[id];
 }
 
 TileType GameTile::getPreviousTypeImmediate() {
-    return previousTypeImmediate;
+    return store->previousTypeImmediate[id];
 }
 
 std::stack<int>& GameTile::getPreviousTypeUpdateSteps() {
-    return previousTypeUpdateSteps;
+    return store->previousTypeUpdateSteps[id];
 }
 
 TileType GameTile::getPreviousType() {
-    return previousType;
+    return store->previousType[id];
 }
 
 int GameTile::getTypeUpdateStep() {
-    return typeUpdateStep;
+    return store->typeUpdateStep[id];
 }
 
 int GameTile::getPreviousTypeUpdateStep() {
-    return previousTypeUpdateStep;
+    return store->previousTypeUpdateStep[id];
 }
 
 void GameTile::setEnergy(int energyValue, int time) {
-    previousEnergy = energy;
-    energy = energyValue;
+    store->previousEnergy[id] = store->energy[id];
+    store->energy[id] = energyValue;
 
-    previousEnergyUpdateTime = lastEnergyUpdateTime;
-    lastEnergyUpdateTime = time;
+    store->previousEnergyUpdateTime[id] = store->lastEnergyUpdateTime[id];
+    store->lastEnergyUpdateTime[id] = time;
 }
 
 void GameTile::setEstimatedEnergy(int energy) {
-    estimatedEnergy = energy;
+    store->estimatedEnergy[id] = energy;
 }
 
 int GameTile::getEnergy() {
-    return energy;
+    return store->energy[id];
 }
 
 int GameTile::getPreviousEnergy() {
-    return previousEnergy;
+    return store->previousEnergy[id];
 }
 
 int GameTile::getLastEnergyUpdateTime() {
-    return lastEnergyUpdateTime;
+    return store->lastEnergyUpdateTime[id];
 }
 
 int GameTile::getPreviousEnergyUpdateTime() {
-    return previousEnergyUpdateTime;
+    return store->previousEnergyUpdateTime[id];
 }
 
 int GameTile::getLastKnownEnergy() {
+    int estimatedEnergy = store->estimatedEnergy[id];
     if (estimatedEnergy >= -20 and estimatedEnergy <= 20) {
         return estimatedEnergy;
     }
-    return energy;
+    return store->energy[id];
 }
 
 std::string GameTile::toString() {
@@ -460,21 +522,8 @@ std::string GameTile::toString() {
 }
 
 void GameTile::setRelicExplorationFrontier(bool value, int match) {
-    switch(match) {
-        case 0:
-            relicExplorationFrontier1 = value;
-            break;
-        case 1:
-            relicExplorationFrontier2 = value;
-            break;
-        case 2:
-            relicExplorationFrontier3 = value;
-            break;
-        default:
-            throw std::invalid_argument("Invalid match value: " + std::to_string(match));
+    if (match < 0 || match > 2) {
+        throw std::invalid_argument("Invalid match value: " + std::to_string(match));
     }
+    store->relicExplorationFrontier[match].set(id, value);
 }
-
-GameTile & GameMap::getMirroredTile(int x, int y) {
-    return getTile(height - y - 1, width - x - 1);
-}
\ No newline at end of file
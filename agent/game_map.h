@@ -4,6 +4,7 @@
 #include "logger.h"
 #include "agent/relic.h"
 #include "shuttle_data.h"
+#include "datastructures/tile_bitboard.h"
 
 #include <vector>
 #include <stack>
@@ -42,37 +43,56 @@ enum TileType : std::uint8_t {
     ASTEROID
 };
     
+/**
+ * Structure-of-arrays storage for every tile of the map, indexed by tile id (y * width + x). A full-map pass over a
+ * single field walks one packed array instead of striding over whole GameTile objects.
+ */
+struct TileStore {
+    std::vector<TileType> typeImmediate;
+    std::vector<TileType> previousTypeImmediate;
+    std::vector<TileType> type;
+    std::vector<TileType> previousType;
+
+    TileBitboard visible;
+    TileBitboard visited;
+    TileBitboard explored;
+    TileBitboard unexploredFrontier;
+    TileBitboard relicExplorationFrontier[3];
+    TileBitboard haloTile;
+    TileBitboard vantagePoint;
+    TileBitboard forcedRegularTile;
+
+    std::vector<int> energy;
+    std::vector<int> estimatedEnergy;
+    std::vector<int> previousEnergy;
+    std::vector<int> lastVisitedTime;
+    std::vector<int> lastExploredTime;
+    std::vector<int> lastEnergyUpdateTime;
+    std::vector<int> previousEnergyUpdateTime;
+    std::vector<int> typeUpdateStep;
+    std::vector<int> previousTypeUpdateStep;
+
+    // Cold data, only touched for individual tiles
+    std::vector<Relic*> relic;
+    std::vector<std::stack<TileType>> previousTypes;
+    std::vector<std::stack<int>> previousTypeUpdateSteps;
+    std::vector<std::vector<ShuttleData*>> shuttles;
+    std::vector<std::vector<ShuttleData*>> ghostShuttles;
+    std::vector<std::vector<ShuttleData*>> opponentShuttles;
+    std::vector<std::vector<ShuttleData*>> opponentGhostShuttles;
+
+    void resize(int width, int height);
+};
+
+/**
+ * Lightweight view of one tile in the TileStore. Only the immutable coordinates live in the object itself.
+ */
 class GameTile {    
 
     private:    
         static void log(const std::string& message);
-        TileType typeImmediate;
-        TileType previousTypeImmediate;
-        TileType type;
-        TileType previousType;
-        std::stack<TileType> previousTypes;
-        bool visible;
-        bool visited;
-        bool explored;
-        bool unexploredFrontier;
-        bool relicExplorationFrontier1;
-        bool relicExplorationFrontier2;
-        bool relicExplorationFrontier3;
-        bool haloTile;
-        bool vantagePoint;
-        bool forcedRegularTile;
-        Relic* relic;
-        int energy;
-        int estimatedEnergy;
-        int previousEnergy;
-
-        int lastVisitedTime;
-        int lastExploredTime;
-        int lastEnergyUpdateTime;
-        int previousEnergyUpdateTime;
-        int typeUpdateStep;
-        int previousTypeUpdateStep;
-        std::stack<int> previousTypeUpdateSteps;
+        TileStore* store;
+        int id;
 
     public:
         int x;
@@ -80,50 +100,44 @@ class GameTile {
         int manhattanFromOrigin;
         int manhattanToOpponentOrigin;
 
-        std::vector<ShuttleData*> shuttles;
-        std::vector<ShuttleData*> ghostShuttles;
-        std::vector<ShuttleData*> opponentShuttles;
-        std::vector<ShuttleData*> opponentGhostShuttles;
-        
-        GameTile(int x, int y) : x(x), y(y), visited(false), explored(false), haloTile(false), vantagePoint(false),
-                 unexploredFrontier(false), relicExplorationFrontier1(false), relicExplorationFrontier2(false), relicExplorationFrontier3(false),
-                forcedRegularTile(false), relic(nullptr), shuttles({}), opponentShuttles({{}}), type(TileType::UNKNOWN_TILE), previousType(TileType::UNKNOWN_TILE),
-                energy(-1), estimatedEnergy(-21), previousEnergy(-1), lastVisitedTime(-1), lastExploredTime(-1), lastEnergyUpdateTime(-1), previousEnergyUpdateTime(-1), visible(false),
-                previousTypes(), typeUpdateStep(-1), previousTypeUpdateStep(-1), previousTypeUpdateSteps(), manhattanFromOrigin(-1), manhattanToOpponentOrigin(-1),
-                 previousTypeImmediate(UNKNOWN_TILE), typeImmediate(UNKNOWN_TILE) {};
-        int getId(int width);        
-        bool isVisible() {return visible;};
-        bool isVisited() { return visited; };
-        bool isExplored() { return explored; };
-        bool isUnExploredFrontier() { return unexploredFrontier; };
-        bool isHaloTile() { return haloTile; };
-        bool isVantagePoint() { return vantagePoint; };
-        bool isForcedRegularTile() { return forcedRegularTile; };
+        GameTile(TileStore* store, int x, int y, int id) : store(store), id(id), x(x), y(y), manhattanFromOrigin(-1),
+                 manhattanToOpponentOrigin(-1) {};
+        int getId() const { return id; };
+        bool isVisible() { return store->visible[id]; };
+        bool isVisited() { return store->visited[id]; };
+        bool isExplored() { return store->explored[id]; };
+        bool isUnExploredFrontier() { return store->unexploredFrontier[id]; };
+        bool isHaloTile() { return store->haloTile[id]; };
+        bool isVantagePoint() { return store->vantagePoint[id]; };
+        bool isForcedRegularTile() { return store->forcedRegularTile[id]; };
         bool isOccupied();
         bool isOpponentOccupied();
         int getCumulativeOpponentEnergy();        
-        int getLastVisitedTime() { return lastVisitedTime; };
-        int getLastExploredTime() { return lastExploredTime; };
+        int getLastVisitedTime() { return store->lastVisitedTime[id]; };
+        int getLastExploredTime() { return store->lastExploredTime[id]; };
         TileType getType() const;
 
-        bool isRelicExplorationFrontier1() {return relicExplorationFrontier1;};
-        bool isRelicExplorationFrontier2() {return relicExplorationFrontier2;};
-        bool isRelicExplorationFrontier3() {return relicExplorationFrontier3;};
+        bool isRelicExplorationFrontier1() {return store->relicExplorationFrontier[0][id];};
+        bool isRelicExplorationFrontier2() {return store->relicExplorationFrontier[1][id];};
+        bool isRelicExplorationFrontier3() {return store->relicExplorationFrontier[2][id];};
 
-        void setVisible(bool visible) { this->visible = visible; };
+        void setVisible(bool visible) { store->visible.set(id, visible); };
         void setVisited(bool visited, int time);
         void setExplored(bool explored, int time);
-        void setUnexploredFrontier(bool unexploredFrontier) { this->unexploredFrontier = unexploredFrontier; };
-        void setHaloTile(bool haloTile) { this->haloTile = haloTile; };
-        void setVantagePoint(bool vantagePoint) { this->vantagePoint = vantagePoint; };
-        void setForcedRegularTile(bool forcedRegularTile) { this->forcedRegularTile = forcedRegularTile; };
-        void setRelic(Relic* relic) { this->relic = relic; };
+        void setUnexploredFrontier(bool unexploredFrontier) { store->unexploredFrontier.set(id, unexploredFrontier); };
+        void setHaloTile(bool haloTile) { store->haloTile.set(id, haloTile); };
+        void setVantagePoint(bool vantagePoint) { store->vantagePoint.set(id, vantagePoint); };
+        void setForcedRegularTile(bool forcedRegularTile) { store->forcedRegularTile.set(id, forcedRegularTile); };
+        void setRelic(Relic* relic) { store->relic[id] = relic; };
         void addShuttle(ShuttleData* shuttle);
         void addGhostShuttle(ShuttleData* shuttle);
         void addOpponentShuttle(ShuttleData* shuttle);
         void addOpponentGhostShuttle(ShuttleData* shuttle);
 
-        std::vector<ShuttleData*>& getShuttles() { return shuttles; };
+        std::vector<ShuttleData*>& getShuttles() { return store->shuttles[id]; };
+        std::vector<ShuttleData*>& getGhostShuttles() { return store->ghostShuttles[id]; };
+        std::vector<ShuttleData*>& getOpponentShuttles() { return store->opponentShuttles[id]; };
+        std::vector<ShuttleData*>& getOpponentGhostShuttles() { return store->opponentGhostShuttles[id]; };
         void clearShuttle(ShuttleData *shuttle);
         void clearShuttles();
         void clearOpponentShuttles();
@@ -214,23 +228,70 @@ struct DerivedGameState {
             for (int i = 0; i <= currentMatch ; i++) {
                 if (relicDiscoveryStatus[i] == RelicDiscoveryStatus::SEARCHING) {
                     relicDiscoveryStatus[i] = status;
-                    log("Relic search for match #" + std::to_string(i+1) + " is found in match #" + std::to_string(currentMatch + 1));
+                    LOG_INFO("Relic search for match #" + std::to_string(i+1) + " is found in match #" + std::to_string(currentMatch + 1));
                     success = true;
                     break;
                 }
             }
             if (!success) {
-                log("Problem: The relic discovery status doesn't match with any searching relics");
+                LOG_WARN("Problem: The relic discovery status doesn't match with any searching relics");
                 std::cerr<<"Problem: The relic discovery status cannot be set to any match"<<std::endl;
             }
         }
 };
 
+/**
+ * Tile types at every step of the episode once the nebula drift speed is known. Drift only translates the map, so a
+ * step is the base grid read at the number of drifts since the base step: one grid and one offset per step, O(1)
+ * lookups and nothing allocated per step or per drift. The base grid is tiled 2x2 so a lookup never wraps around.
+ */
+class DriftForecast {
+    private:
+        int width = 0;
+        int height = 0;
+        int direction = 0;                  // Every drift moves the tiles by (+direction, -direction)
+        std::vector<TileType> baseTypes;    // 2 * height rows of 2 * width, the types at offset 0 tiled 2x2
+        std::vector<int> offsets;           // Step -> drifts since the base step
+        std::vector<int> origins;           // Step -> index of the tiled base that is at (0, 0) then
+
+        static int wrap(int value, int size) { return ((value % size) + size) % size; }
+
+    public:
+        /**
+         * Every step at offset 0 and every tile unknown, for the steps [0, steps)
+         */
+        void reset(int width, int height, int direction, int steps);
+        void clear();
+
+        bool hasForecast(int step) const { return step >= 0 && step < getStepCount(); }
+        int getStepCount() const { return static_cast<int>(offsets.size()); }
+        int getOffset(int step) const { return offsets[step]; }
+        void setOffset(int step, int offset);
+
+        TileType getType(int x, int y, int step) const { return baseTypes[origins[step] + y * 2 * width + x]; }
+
+        /**
+         * The width types of row y at the step, contiguous
+         */
+        const TileType* getRow(int y, int step) const { return &baseTypes[origins[step] + y * 2 * width]; }
+
+        /**
+         * The type at (x, y) at the step, and with it wherever that tile drifts to at every other step
+         */
+        void setType(int x, int y, int step, TileType tileType);
+
+        size_t getMemoryUsage() const {
+            return sizeof(*this) + baseTypes.capacity() * sizeof(TileType) + (offsets.capacity() + origins.capacity()) * sizeof(int);
+        }
+};
+
 class GameMap {
     private:
         static void log(const std::string& message);
-        std::vector<std::vector<GameTile>> map;
-        std::vector< std::vector<std::vector<TileType>>* > driftAwareTileType; //<stepId, y, x>
+        [[noreturn]] static void throwOutOfRange(int x, int y);
+        TileStore store;
+        std::vector<GameTile> tiles; // Row-major views into the store, indexed by tile id
+        DriftForecast driftForecast;
         // std::map<int, std::pair<int, int>> opponentBattlePoints; //<tileId, <energyDiff, kills>> +ve energyDiff means we lose less energy than opponent
         std::map<int, std::pair<int, int>> teamBattlePoints; //<tileId, <energyDiff, kills>> +ve energyDiff means we lose less energy than opponent
     public:
@@ -243,27 +304,47 @@ class GameMap {
         std::vector<ShuttleData*> opponentShuttles;
 
         GameMap(int width, int height);
+        GameMap(const GameMap&) = delete;
+        GameMap& operator=(const GameMap&) = delete;
+
+        TileStore& getTileStore() { return store; };
+        GameTile& getTile(int id) { return tiles[id]; };
         void addRelic(Relic* relic, int currentStep, std::vector<int>& haloTileIds);
         bool hasPotentialInvisibleRelicNode(GameTile &gameTile);
         GameTile *getTileAtPosition(ShuttleData &shuttleData);
         void exploreTile(GameTile &tile, int currentStep);
-        bool isValidTile(int x, int y);
-        GameTile& getTile(int x, int y);
+        inline bool isValidTile(int x, int y) const {
+            return x >= 0 && x < width && y >= 0 && y < height;
+        }
+
+        inline GameTile& getTile(int x, int y) {
+            if (!isValidTile(x, y)) {
+                throwOutOfRange(x, y);
+            }
+            return tiles[y * width + x];
+        }
+
         GameTile& getTileFromActionId(int actionId, int x, int y);
         GameTile& getRolledOverTile(int x, int y);
-        GameTile& getMirroredTile(int x, int y);
+        inline GameTile& getMirroredTile(int x, int y) { return getTile(height - y - 1, width - x - 1); };
 
         GameTile& getTile(GameTile &fromTile, Direction direction);
 
         TileType getEstimatedType(GameTile& tile, int step) const;
 
+        /**
+         * getEstimatedType() of every tile at the step, by tile id. Straight copies of the drift forecast rows once
+         * the drift is known.
+         */
+        void getEstimatedTypes(int step, std::vector<TileType>& types);
+
         std::tuple<bool, GameTile&> isMovable(GameTile& fromTile, Direction direction);
 
         void getAllOpponentsInRadius(int radius, int x, int y, std::vector<ShuttleData*>& opponents);
-        std::vector< std::vector<std::vector<TileType>>* >& getDriftAwareTileType() {return driftAwareTileType;};
+        DriftForecast& getDriftForecast() {return driftForecast;};
         // std::map<int, std::pair<int, int>>& getOpponentBattlePoints() {return opponentBattlePoints;};
         std::map<int, std::pair<int, int>>& getTeamBattlePoints() {return teamBattlePoints;};
-        void setRelicExplorationFrontier(GameTile &tile, int match, int cutoffTime);
+        bool updateRelicExplorationFrontier(int match, int cutoffTime);
 };
 
 #endif // GAMEMAP_H
\ No newline at end of file
@@ -1,9 +1,12 @@
 #include "opponent_tracker.h"
 #include "logger.h"
-// #include "metrics.h"
+#include "metrics.h"
 #include "game_env_config.h"
 #include "symmetry_util.h"
+#include "config.h"
+#include <algorithm>
 #include <iostream>
+#include <limits>
 #include <string>
 #include <unordered_set>
 #include "constants.h"
@@ -12,81 +15,37 @@ void OpponentTracker::log(const std::string& message) {
     Logger::getInstance().log("OpponentTracker -> " + message);
 }
 
-OpponentTracker::OpponentTracker(GameMap &gameMap, RespawnRegistry& respawnRegistry): gameMap(gameMap), respawnRegistry(respawnRegistry) {
-    opponentPreviousPositionProbabilities = nullptr;
-    opponentPreviousMaxPossibleEnergies = nullptr;
-    opponentPositionProbabilities = nullptr;
-    opponentMaxPossibleEnergies = nullptr;
-    initArrays();
-}
-
-void OpponentTracker::initArrays() {
+OpponentTracker::OpponentTracker(GameMap &gameMap, RespawnRegistry& respawnRegistry, StepDeadline* stepDeadline)
+        : gameMap(gameMap), respawnRegistry(respawnRegistry), stepDeadline(stepDeadline) {
     GameEnvConfig& gameEnvConfig = GameEnvConfig::getInstance();
 
-    if (opponentPreviousPositionProbabilities != nullptr) {
-        delete opponentPreviousPositionProbabilities;
-    }
-
-    if (opponentPreviousMaxPossibleEnergies != nullptr) {
-        delete opponentPreviousMaxPossibleEnergies;
-    }
-
-    opponentPreviousPositionProbabilities = opponentPositionProbabilities;
-    opponentPreviousMaxPossibleEnergies = opponentMaxPossibleEnergies;
+    beliefs.resize(gameEnvConfig.maxUnits, gameMap.width, gameMap.height);
+    atleastOneShuttleProbabilities.resize(gameMap.width, gameMap.height, 0.0);
 
-    opponentPositionProbabilities = new std::vector<std::vector<std::vector<double>>>(
-        gameEnvConfig.maxUnits, std::vector<std::vector<double>>(gameMap.width, std::vector<double>(gameMap.height, 0.0))
-    );
-
-    opponentMaxPossibleEnergies = new std::vector<std::vector<std::vector<int>>>(
-        gameEnvConfig.maxUnits, std::vector<std::vector<int>>(gameMap.width, std::vector<int>(gameMap.height, 0))
-    );
-
-    delete atleastOneShuttleProbabilities;
-
-    atleastOneShuttleProbabilities = new std::vector<std::vector<double>>(
-        gameMap.width, std::vector<double>(gameMap.height, 0.0)
-    );
+    openMask.resize(gameMap.width, gameMap.height, 0);
+    moveOpenMask.resize(gameMap.width, gameMap.height, 0);
+    tileEnergyGain.resize(gameMap.width, gameMap.height, 0);
+    tileNebulaReduction.resize(gameMap.width, gameMap.height, 0);
 }
 
 void OpponentTracker::clear() {
     // This is supposed to be called every match start
-    GameEnvConfig& gameEnvConfig = GameEnvConfig::getInstance();
-
-    for (int i = 0; i < gameEnvConfig.maxUnits; i++) {
-        for (int x = 0; x < gameMap.width; x++) {
-            for (int y = 0; y < gameMap.height; y++) {
-                (*opponentPreviousPositionProbabilities)[i][x][y] = 0.0;
-                (*opponentPreviousMaxPossibleEnergies)[i][x][y] = 0;
-                (*opponentPositionProbabilities)[i][x][y] = 0.0;
-                (*opponentMaxPossibleEnergies)[i][x][y] = 0;
-            }
-        }
-    }
-    
-    
-    for (int x = 0; x < gameMap.width; x++) {
-        for (int y = 0; y < gameMap.height; y++) {
-            (*atleastOneShuttleProbabilities)[x][y] = 0.0;
-        }
-    }
+    beliefs.clear();
+    atleastOneShuttleProbabilities.fill(0.0);
 }
 
 void OpponentTracker::step() {
     GameEnvConfig& gameEnvConfig = GameEnvConfig::getInstance();
     DerivedGameState& state = gameMap.derivedGameState;
 
-    log("Updating opponent tracker for step " + std::to_string(state.currentStep));
+    LOG_DEBUG("Updating opponent tracker for step " + std::to_string(state.currentStep));
     auto start = std::chrono::high_resolution_clock::now();
 
-    auto& opponentPositionProbabilitiesCopy = *opponentPositionProbabilities;
-    auto& opponentMaxPossibleEnergiesCopy = *opponentMaxPossibleEnergies;
-
-    initArrays();
-
-    auto& opponentPositionProbabilitiesRef = *opponentPositionProbabilities;
-    auto& opponentMaxPossibleEnergiesRef = *opponentMaxPossibleEnergies;
+    beliefs.advance();
 
+    auto& opponentPositionProbabilitiesRef = beliefs.probabilities();
+    auto& opponentMaxPossibleEnergiesRef = beliefs.energies();
+    auto& supports = beliefs.supports();
 
     std::unordered_set<int> visibleOpponents;
     for (int s = 0; s < gameEnvConfig.maxUnits; ++s) {
@@ -95,17 +54,24 @@ void OpponentTracker::step() {
             // Opponent shuttle is visible
             opponentPositionProbabilitiesRef[s][shuttle->getX()][shuttle->getY()] = 1.0;
             opponentMaxPossibleEnergiesRef[s][shuttle->getX()][shuttle->getY()] = shuttle->energy;
+            supports[s].add(shuttle->getX(), shuttle->getY());
             visibleOpponents.insert(s);
-            log("shuttle " + std::to_string(s) + " was found visible with energy" + std::to_string(shuttle->energy));
+            LOG_TRACE("shuttle " + std::to_string(s) + " was found visible with energy" + std::to_string(shuttle->energy));
         } else if (respawnRegistry.opponentUnitRespawned == s) {
             // Opponent has just spawned
             opponentMaxPossibleEnergiesRef[s][gameEnvConfig.opponentOriginX][gameEnvConfig.opponentOriginY] = 100;
             opponentPositionProbabilitiesRef[s][gameEnvConfig.opponentOriginX][gameEnvConfig.opponentOriginY] = 1.0;
+            supports[s].add(gameEnvConfig.opponentOriginX, gameEnvConfig.opponentOriginY);
             visibleOpponents.insert(s);
-            log("shuttle " + std::to_string(s) + " was just spawned");
+            LOG_TRACE("shuttle " + std::to_string(s) + " was just spawned");
         }
     }
 
+    prepareStencil();
+
+    auto propagationStart = std::chrono::high_resolution_clock::now();
+    int supportSize = 0;
+    int denseCount = 0;
     for (int s = 0; s < gameEnvConfig.maxUnits; ++s) {
         if (!respawnRegistry.isOpponentShuttleAlive(s, state.currentStep)) {
             //This shuttle is not alive yet. No action
@@ -117,122 +83,221 @@ void OpponentTracker::step() {
             continue;
         }
 
-        double lostProbabilityForShuttle = 0.0;
-        int lostProbabilityDistributionCount = 0;
+        if (stepDeadline != nullptr && stepDeadline->shouldDegrade(STAGE_OPPONENT_TRACKING)) {
+            //Out of time, keep the last known distribution instead of propagating it
+            carryOverPositions(s);
+            continue;
+        }
 
-        std::vector<std::vector<bool>> visitedArray(gameEnvConfig.mapHeight, std::vector<bool>(gameEnvConfig.mapWidth, false));
+        propagatePositions(s);
+        supportSize += supports[s].getArea();
+        denseCount += supports[s].dense;
+    }
+    auto propagationDuration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - propagationStart);
 
-        for (int x = 0; x < gameEnvConfig.mapHeight; ++x) {
-            for (int y = 0; y < gameEnvConfig.mapWidth; ++y) {
-                GameTile& tile = gameMap.getTile(x, y);
+    computeAtleastOneShuttleProbabilities();    
 
-                if (std::abs(opponentPositionProbabilitiesCopy[s][x][y] - 0) < LOWEST_DOUBLE) {
-                    // This shuttle has not reached this tile yet even in the previous step.  No point in going further
-                    continue;
-                }
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    Metrics::getInstance().add("opponent_propagation_duration", propagationDuration.count() / 1000.0f);
+    Metrics::getInstance().add("opponent_belief_support", supportSize);
+    Metrics::getInstance().add("opponent_dense_beliefs", denseCount);
+    // Metrics::getInstance().add("opponent_tracker_step", duration.count());
+    LOG_DEBUG("Time taken for opponent_tracker_step " + std::to_string(duration.count()));
+}
 
-                if (opponentMaxPossibleEnergiesCopy[s][x][y] < 0) {
-                    // If this shuttle was present in this tile (x, y) it should've been dead by now.  
-                    lostProbabilityForShuttle += opponentPositionProbabilitiesCopy[s][x][y];
-                    continue;
-                }
-                
-                for (int pmi = 0; pmi < POSSIBLE_MOVE_SIZE; pmi++) {
-                    int xNext = POSSIBLE_MOVES[pmi][0] + x;
-                    int yNext = POSSIBLE_MOVES[pmi][1] + y;
-                    
-                    if (!gameMap.isValidTile(xNext, yNext)) {
-                        // This tile is unreachable
-                        lostProbabilityForShuttle += opponentPositionProbabilitiesCopy[s][x][y] / 5.0;
-                        continue;
-                    }
+/**
+ * Everything the propagation needs to know about the tiles, computed once per step instead of once per shuttle and move.
+ */
+void OpponentTracker::prepareStencil() {
+    DerivedGameState& state = gameMap.derivedGameState;
+    gameMap.getEstimatedTypes(state.currentStep, estimatedTypes);
 
-                    GameTile& nextTile = gameMap.getTile(xNext, yNext);
-                    if (gameMap.getEstimatedType(nextTile, state.currentStep) == TileType::ASTEROID && (xNext != x || yNext != y)) {
-                        // Opponent couldn't have moved to this tile, it is an asteroid
-                        lostProbabilityForShuttle += opponentPositionProbabilitiesCopy[s][x][y] / 5.0;
-                        continue;
-                    }
+    for (int x = 0; x < gameMap.width; ++x) {
+        for (int y = 0; y < gameMap.height; ++y) {
+            GameTile& tile = gameMap.getTile(x, y);
+            TileType estimatedType = estimatedTypes[tile.getId()];
+            bool visible = tile.isVisible();
 
-                    if (nextTile.isVisible()) {
-                        //Opponent couldn't have moved to this tile as it is visible
-                        lostProbabilityForShuttle += opponentPositionProbabilitiesCopy[s][x][y] / 5.0;
-                        continue;
-                    }
+            openMask[x][y] = !visible;
+            moveOpenMask[x][y] = !visible && estimatedType != TileType::ASTEROID;
+            tileEnergyGain[x][y] = tile.getLastKnownEnergy();
+            tileNebulaReduction[x][y] = estimatedType == TileType::NEBULA && state.nebulaTileEnergyReductionSet ? state.nebulaTileEnergyReduction : 0;
+        }
+    }
+}
 
-                    int newEnergy = opponentMaxPossibleEnergiesCopy[s][x][y] + nextTile.getLastKnownEnergy();
+/**
+ * Moves the previous distribution of a hidden shuttle one step forward, each of the 5 moves is equally likely.
+ *
+ * Written as a gather: every tile pulls from the tile each move would have come from, one move and one row at a time.
+ * The inner loop is branch free over contiguous memory so the compiler can vectorize it. Moves that end up off the
+ * map, on a visible tile, on an asteroid or that the shuttle can't afford are lost, the lost probability is spread
+ * evenly over the tiles the shuttle can still be on.
+ *
+ * Only the previous support grown by one move is touched, so a shuttle that went dark recently costs a few tiles. Once
+ * that box covers more than Config::denseBeliefShare of the map the shuttle switches to the whole map until it is
+ * seen again.
+ */
+void OpponentTracker::propagatePositions(int s) {
+    GameEnvConfig& gameEnvConfig = GameEnvConfig::getInstance();
+    const int width = gameMap.width;
+    const int height = gameMap.height;
+    const int maxEnergy = static_cast<int>(MAX_ENERGY);
+
+    const BeliefSupport& previousSupport = beliefs.previousSupports()[s];
+    BeliefSupport& support = beliefs.supports()[s];
+    if (previousSupport.isEmpty()) {
+        // Nothing to move
+        return;
+    }
 
-                    if (x != xNext || y != yNext) {
-                        newEnergy -= gameEnvConfig.unitMoveCost;
-                        
-                        if (newEnergy < 0) {
-                            // This shuttle cannot move anymore
-                            lostProbabilityForShuttle += opponentPositionProbabilitiesCopy[s][x][y] / 5.0;
-                            continue;
-                        }
-                    }                    
+    // Target region, [xFrom, xTo) x [yFrom, yTo)
+    int xFrom = std::max(previousSupport.xMin - 1, 0);
+    int xTo = std::min(previousSupport.xMax + 2, width);
+    int yFrom = std::max(previousSupport.yMin - 1, 0);
+    int yTo = std::min(previousSupport.yMax + 2, height);
+    bool dense = previousSupport.dense || (xTo - xFrom) * (yTo - yFrom) > Config::denseBeliefShare * width * height;
+    if (dense) {
+        xFrom = 0;
+        xTo = width;
+        yFrom = 0;
+        yTo = height;
+    }
 
-                    if (gameMap.getEstimatedType(nextTile, state.currentStep) == TileType::NEBULA && state.nebulaTileEnergyReductionSet) {
-                        newEnergy -= state.nebulaTileEnergyReduction;
-                    }
+    const double* previousProbabilities = beliefs.previousProbabilities().slice(s);
+    const int* previousEnergies = beliefs.previousEnergies().slice(s);
+    double* probabilities = beliefs.probabilities().slice(s);
+    int* energies = beliefs.energies().slice(s);
+
+    // A shuttle with negative energy would have been dead by now, all of its probability is lost
+    double activeProbability = 0.0;
+    for (int x = xFrom; x < xTo; ++x) {
+        const double* row = previousProbabilities + x * height;
+        for (int y = yFrom; y < yTo; ++y) {
+            activeProbability += row[y] >= LOWEST_DOUBLE ? row[y] : 0.0;
+        }
+    }
 
-                    if (newEnergy > MAX_ENERGY) {
-                        newEnergy = MAX_ENERGY;
-                    }
+    for (int x = xFrom; x < xTo; ++x) {
+        double* targetProbabilities = probabilities + x * height;
+        int* targetEnergies = energies + x * height;
+        const int* gain = tileEnergyGain[x];
+        const int* nebulaReduction = tileNebulaReduction[x];
+
+        for (int pmi = 0; pmi < POSSIBLE_MOVE_SIZE; pmi++) {
+            int dx = POSSIBLE_MOVES[pmi][0];
+            int dy = POSSIBLE_MOVES[pmi][1];
+            int xPrevious = x - dx;
+            if (xPrevious < 0 || xPrevious >= width) {
+                continue;
+            }
 
-                    if (newEnergy < 0) {                        
-                        newEnergy = 0;
-                    }
-                                                
-                    opponentMaxPossibleEnergiesRef[s][xNext][yNext] = std::max(opponentMaxPossibleEnergiesRef[s][xNext][yNext], newEnergy);
-                    opponentPositionProbabilitiesRef[s][xNext][yNext] += opponentPositionProbabilitiesCopy[s][x][y] / 5.0; // There are 5 possible moves from this tile
+            const double* sourceProbabilities = previousProbabilities + xPrevious * height;
+            const int* sourceEnergies = previousEnergies + xPrevious * height;
+            const int* mask = pmi == 0 ? openMask[x] : moveOpenMask[x];
+            const int moveCost = pmi == 0 ? 0 : gameEnvConfig.unitMoveCost;
+            const int minEnergy = pmi == 0 ? std::numeric_limits<int>::min() : 0; // Staying put needs no energy
+
+            int yStart = std::max(yFrom, dy);
+            int yEnd = std::min(yTo, height + dy);
+            for (int y = yStart; y < yEnd; ++y) {
+                double sourceProbability = sourceProbabilities[y - dy];
+                int sourceEnergy = sourceEnergies[y - dy];
+                int newEnergy = sourceEnergy + gain[y] - moveCost;
+
+                bool reaches = (sourceProbability >= LOWEST_DOUBLE) & (sourceEnergy >= 0) & (mask[y] != 0) & (newEnergy >= minEnergy);
+                int clampedEnergy = std::min(std::max(newEnergy - nebulaReduction[y], 0), maxEnergy);
+
+                // Energies start at 0 for a hidden shuttle, so a move that doesn't reach can take part as 0
+                targetProbabilities[y] += sourceProbability * reaches / 5.0; // There are 5 possible moves from a tile
+                targetEnergies[y] = std::max(targetEnergies[y], reaches ? clampedEnergy : 0);
+            }
+        }
+    }
 
-                    if (opponentPositionProbabilitiesRef[s][xNext][yNext] > LOWEST_DOUBLE && !visitedArray[xNext][yNext]) {
-                        visitedArray[xNext][yNext] = true;
-                        lostProbabilityDistributionCount++;
-                    }
-                }
+    double receivedProbability = 0.0;
+    int lostProbabilityDistributionCount = 0;
+    for (int x = xFrom; x < xTo; ++x) {
+        const double* row = probabilities + x * height;
+        for (int y = yFrom; y < yTo; ++y) {
+            receivedProbability += row[y];
+            lostProbabilityDistributionCount += row[y] > LOWEST_DOUBLE;
+        }
+    }
 
-                if (opponentPositionProbabilitiesRef[s][x][y] > LOWEST_DOUBLE && !visitedArray[x][y]) {
-                    visitedArray[x][y] = true;
-                    lostProbabilityDistributionCount++;
-                }
-            }
+    // Now fill the offset to make sum(probability) = 1
+    double offsetValue = (activeProbability - receivedProbability) / lostProbabilityDistributionCount;
+    double totalProbability = 0.0;
+    for (int x = xFrom; x < xTo; ++x) {
+        double* row = probabilities + x * height;
+        for (int y = yFrom; y < yTo; ++y) {
+            row[y] += row[y] > LOWEST_DOUBLE ? offsetValue : 0.0;
+            totalProbability += row[y];
         }
+    }
 
-        // Now fill the offset to make sum(probability) = 1        
-        double offsetValue = lostProbabilityForShuttle / lostProbabilityDistributionCount;
-        double totalProbability = 0.0;
-        for (int x = 0; x < gameEnvConfig.mapHeight; ++x) {
-            for (int y = 0; y < gameEnvConfig.mapWidth; ++y) {
-                if (opponentPositionProbabilitiesRef[s][x][y] > LOWEST_DOUBLE) {
-                    opponentPositionProbabilitiesRef[s][x][y] += offsetValue;
+    if (dense) {
+        support.setDense(width, height);
+    } else {
+        for (int x = xFrom; x < xTo; ++x) {
+            const double* row = probabilities + x * height;
+            for (int y = yFrom; y < yTo; ++y) {
+                if (row[y] > 0.0) {
+                    support.add(x, y);
                 }
-                totalProbability += opponentPositionProbabilitiesRef[s][x][y];                
             }
         }
+    }
 
-        log("shuttle " + std::to_string(s) + " has " + std::to_string(lostProbabilityDistributionCount) + " possibilities, total=" + std::to_string(totalProbability));
+    LOG_TRACE("shuttle " + std::to_string(s) + " has " + std::to_string(lostProbabilityDistributionCount) + " possibilities, total=" + std::to_string(totalProbability));
 
-        //TODO:  Ideally zero lostProbabilityDistributionCount should have been dead.  After improving the death detector, revisit this to raise some noise if the probability doesn't match
-        if ((totalProbability < 1.0 - LOWEST_DOUBLE || totalProbability > 1.0 + LOWEST_DOUBLE) && lostProbabilityDistributionCount > 0) {
-            log("Problem, the probabilty doesn't sum to 1.0");
-            std::cerr<<"Problem, the probabilty doesn't sum to 1.0"<<std::endl;
+    //TODO:  Ideally zero lostProbabilityDistributionCount should have been dead.  After improving the death detector, revisit this to raise some noise if the probability doesn't match
+    if ((totalProbability < 1.0 - LOWEST_DOUBLE || totalProbability > 1.0 + LOWEST_DOUBLE) && lostProbabilityDistributionCount > 0) {
+        LOG_WARN("Problem, the probabilty doesn't sum to 1.0");
+        std::cerr<<"Problem, the probabilty doesn't sum to 1.0"<<std::endl;
+    }
+}
+
+/**
+ * Cheap fallback of the propagation, the previous distribution is kept as is except for the tiles that are visible now.
+ * What remains is normalized back to 1.
+ */
+void OpponentTracker::carryOverPositions(int s) {
+    auto previousPositionProbabilities = beliefs.previousProbabilities()[s];
+    auto previousMaxPossibleEnergies = beliefs.previousEnergies()[s];
+    auto positionProbabilities = beliefs.probabilities()[s];
+    auto maxPossibleEnergies = beliefs.energies()[s];
+    const BeliefSupport& support = beliefs.previousSupports()[s];
+
+    double totalProbability = 0.0;
+    for (int x = support.xMin; x <= support.xMax; ++x) {
+        for (int y = support.yMin; y <= support.yMax; ++y) {
+            if (previousPositionProbabilities[x][y] > LOWEST_DOUBLE && openMask[x][y]) {
+                positionProbabilities[x][y] = previousPositionProbabilities[x][y];
+                maxPossibleEnergies[x][y] = previousMaxPossibleEnergies[x][y];
+                totalProbability += previousPositionProbabilities[x][y];
+            }
         }
     }
 
-    computeAtleastOneShuttleProbabilities();    
+    if (totalProbability < LOWEST_DOUBLE) {
+        return;
+    }
 
-    auto end = std::chrono::high_resolution_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-    // Metrics::getInstance().add("opponent_tracker_step", duration.count());
-    log("Time taken for opponent_tracker_step " + std::to_string(duration.count()));
+    beliefs.supports()[s] = support;
+    for (int x = support.xMin; x <= support.xMax; ++x) {
+        for (int y = support.yMin; y <= support.yMax; ++y) {
+            positionProbabilities[x][y] /= totalProbability;
+        }
+    }
+    LOG_TRACE("shuttle " + std::to_string(s) + " carried over from the previous step");
 }
 
 void OpponentTracker::computeAtleastOneShuttleProbabilities() {
     GameEnvConfig& gameEnvConfig = GameEnvConfig::getInstance();
-    auto& positionProbabilities = *opponentPositionProbabilities;
-    auto& atleastOneShuttleProbabilitiesRef = * atleastOneShuttleProbabilities;
+    auto& positionProbabilities = beliefs.probabilities();
+    auto& atleastOneShuttleProbabilitiesRef = atleastOneShuttleProbabilities;
 
     int opponentOpportunities = 0;
     int opponentExploiting = 0;
@@ -240,20 +305,27 @@ void OpponentTracker::computeAtleastOneShuttleProbabilities() {
 
     std::unordered_set<int> opponentOpportunitiesTiles;
 
+    // Probability of no shuttle first, each shuttle only needs to visit its own support
+    atleastOneShuttleProbabilitiesRef.fill(1.0);
+    auto& supports = beliefs.supports();
+    for (int s = 0; s < gameEnvConfig.maxUnits; ++s) {
+        for (int x = supports[s].xMin; x <= supports[s].xMax; ++x) {
+            for (int y = supports[s].yMin; y <= supports[s].yMax; ++y) {
+                atleastOneShuttleProbabilitiesRef[x][y] *= (1.0 - positionProbabilities[s][x][y]);
+            }
+        }
+    }
+
     for (int x = 0; x < gameEnvConfig.mapHeight; ++x) {
         for (int y = 0; y < gameEnvConfig.mapWidth; ++y) {
-            double pNotShuttle = 1.0;
-            for (int s = 0; s < gameEnvConfig.maxUnits; ++s) {
-                pNotShuttle *= (1.0 - positionProbabilities[s][x][y]);
-            }
-            atleastOneShuttleProbabilitiesRef[x][y] = 1.0 - pNotShuttle;
+            atleastOneShuttleProbabilitiesRef[x][y] = 1.0 - atleastOneShuttleProbabilitiesRef[x][y];
 
             // Count vantage points and halo tiles
             GameTile& tile = gameMap.getTile(x, y);
             if (tile.isHaloTile() || tile.isVantagePoint()) {
                 if (!tile.isVisible()) {
                     opponentOpportunities++;
-                    opponentOpportunitiesTiles.insert(tile.getId(gameMap.width));
+                    opponentOpportunitiesTiles.insert(tile.getId());
                 } else if (tile.isOpponentOccupied()) {
                     opponentExploiting++;
 
@@ -272,7 +344,7 @@ void OpponentTracker::computeAtleastOneShuttleProbabilities() {
         int outstandingPoints = opponentTeamPointsDelta - opponentConfirmedPoints;
 
         if (outstandingPoints < 0 && gameMap.derivedGameState.currentMatchStep > 0) {
-            log("Problem: opponent outstanding points negative " + std::to_string(opponentTeamPointsDelta) + ", " + std::to_string(opponentConfirmedPoints));
+            LOG_WARN("Problem: opponent outstanding points negative " + std::to_string(opponentTeamPointsDelta) + ", " + std::to_string(opponentConfirmedPoints));
             std::cerr<<"Problem: opponent outstanding points negative "<<std::endl;
         }
 
@@ -281,19 +353,19 @@ void OpponentTracker::computeAtleastOneShuttleProbabilities() {
         if (probabilityDistribution > 1.0) {
 
             if (!gameMap.derivedGameState.isThereAHuntForRelic()) {
-                log("Problem: probability distribution is greater than 1.0 " + std::to_string(probabilityDistribution));
+                LOG_WARN("Problem: probability distribution is greater than 1.0 " + std::to_string(probabilityDistribution));
                 std::cerr<<"Problem: probability distribution is greater than 1.0 "<<std::endl;
             } else {
                 auto& state = gameMap.derivedGameState;
                 if (state.currentMatch < 3 && state.currentMatchStep < state.relicDiscoveryCutoffMatchStep[state.currentMatch]) {
-                    log("Opponent has found the relic, we have not, " + std::to_string(state.relicDiscoveryCutoffMatchStep[state.currentMatch]));
+                    LOG_DEBUG("Opponent has found the relic, we have not, " + std::to_string(state.relicDiscoveryCutoffMatchStep[state.currentMatch]));
                     state.relicDiscoveryCutoffMatchStep[state.currentMatch] = state.currentMatchStep;
                 }
             }
         }
 
         if (probabilityDistribution < 1.0 + LOWEST_DOUBLE && probabilityDistribution > 1.0 - LOWEST_DOUBLE) {
-            log("Voila! can snipe the opponent now");
+            LOG_DEBUG("Voila! can snipe the opponent now");
         }    
 
         if (!gameMap.derivedGameState.isThereAHuntForRelic()) {
@@ -305,49 +377,36 @@ void OpponentTracker::computeAtleastOneShuttleProbabilities() {
                     //TODO: Back-propagate this probability to the positionProbabilities
                     atleastOneShuttleProbabilitiesRef[x][y] = probabilityDistribution;
                 }
-                log("Forcing atleast one shuttle probability at " + std::to_string(x) + ", " + std::to_string(y) + " to " + std::to_string(probabilityDistribution));
+                LOG_TRACE("Forcing atleast one shuttle probability at " + std::to_string(x) + ", " + std::to_string(y) + " to " + std::to_string(probabilityDistribution));
             }
         }
     }
 }
 
-OpponentTracker::~OpponentTracker() {
-    delete opponentPositionProbabilities;
-    delete opponentMaxPossibleEnergies;
-    delete atleastOneShuttleProbabilities;
-}
-
-
-std::vector<std::vector<std::vector<double>>>& OpponentTracker::getOpponentPositionProbabilities() {
-    return *opponentPositionProbabilities;
+FlatArray3D<double>& OpponentTracker::getOpponentPositionProbabilities() {
+    return beliefs.probabilities();
 }
 
-std::vector<std::vector<std::vector<int>>>& OpponentTracker::getOpponentMaxPossibleEnergies() {
-    return *opponentMaxPossibleEnergies;
+FlatArray3D<int>& OpponentTracker::getOpponentMaxPossibleEnergies() {
+    return beliefs.energies();
 }
 
-std::vector<std::vector<std::vector<double>>>& OpponentTracker::getOpponentPreviousPositionProbabilities() {
-    if (opponentPreviousPositionProbabilities == nullptr) {
-        return getOpponentPositionProbabilities();
-    }
-    return *opponentPreviousPositionProbabilities;
+FlatArray3D<double>& OpponentTracker::getOpponentPreviousPositionProbabilities() {
+    return beliefs.previousProbabilities();
 }
 
-std::vector<std::vector<std::vector<int>>>& OpponentTracker::getOpponentPreviousMaxPossibleEnergies() {
-    if (opponentPreviousMaxPossibleEnergies == nullptr) {
-        return getOpponentMaxPossibleEnergies();
-    }
-    return *opponentPreviousMaxPossibleEnergies;
+FlatArray3D<int>& OpponentTracker::getOpponentPreviousMaxPossibleEnergies() {
+    return beliefs.previousEnergies();
 }
 
-std::vector<std::vector<double>>& OpponentTracker::getAtleastOneShuttleProbabilities() {
-    return *atleastOneShuttleProbabilities;
+FlatArray2D<double>& OpponentTracker::getAtleastOneShuttleProbabilities() {
+    return atleastOneShuttleProbabilities;
 }
 
 
 bool OpponentTracker::isOpponentOccupied(int x, int y){
     GameEnvConfig& gameEnvConfig = GameEnvConfig::getInstance();
-    auto probabilities = getOpponentPositionProbabilities();
+    auto& probabilities = getOpponentPositionProbabilities();
     for (int s = 0; s<gameEnvConfig.maxUnits;s++) {
         if (probabilities[s][x][y] > 1.0 - LOWEST_DOUBLE && probabilities[s][x][y] < 1.0 + LOWEST_DOUBLE) {
             return true;
@@ -359,7 +418,7 @@ bool OpponentTracker::isOpponentOccupied(int x, int y){
 
 double OpponentTracker::expectationOfOpponentOccupancy(int x, int y) {
     GameEnvConfig& gameEnvConfig = GameEnvConfig::getInstance();
-    auto probabilities = getOpponentPositionProbabilities();
+    auto& probabilities = getOpponentPositionProbabilities();
     double expectation = 0.0;
     for (int s = 0; s<gameEnvConfig.maxUnits;s++) {
         expectation += probabilities[s][x][y];        
@@ -371,7 +430,7 @@ double OpponentTracker::expectationOfOpponentOccupancy(int x, int y) {
 
 int OpponentTracker::getAllPossibleEnergyAt(int x, int y) {
     GameEnvConfig& gameEnvConfig = GameEnvConfig::getInstance();
-    auto energies = getOpponentMaxPossibleEnergies();
+    auto& energies = getOpponentMaxPossibleEnergies();
     int expectation = 0.0;
     for (int s = 0; s<gameEnvConfig.maxUnits;s++) {
         expectation += energies[s][x][y];        
@@ -396,7 +455,7 @@ int OpponentTracker::getCountLessThanEnergyAt(int x, int y, int energy) {
 
 void OpponentTracker::reduceEnergyOfAllShuttles(GameTile& tile, int energy) {
     GameEnvConfig& gameEnvConfig = GameEnvConfig::getInstance();
-    auto& energies = *opponentMaxPossibleEnergies;
+    auto& energies = beliefs.energies();
     for (int s = 0; s<gameEnvConfig.maxUnits;s++) {        
         energies[s][tile.x][tile.y] -= energy;
     }
@@ -3,36 +3,44 @@
 
 #include "game_map.h"
 #include "datastructures/respawn_registry.h"
+#include "agent/step_deadline.h"
+#include "datastructures/belief_tensor.h"
 
 class OpponentTracker {
     private:
         GameMap& gameMap;
         RespawnRegistry& respawnRegistry;
+        StepDeadline* stepDeadline;
 
-        std::vector<std::vector<std::vector<double>>>* opponentPreviousPositionProbabilities; // (16, 24, 24)
-        std::vector<std::vector<std::vector<int>>>* opponentPreviousMaxPossibleEnergies; // (16, 24, 24)
+        BeliefTensor beliefs; // (16, 24, 24) position probabilities and max possible energies, current and previous step
+        FlatArray2D<double> atleastOneShuttleProbabilities; // (24, 24)
 
-        std::vector<std::vector<std::vector<double>>>* opponentPositionProbabilities; // (16, 24, 24)
-        std::vector<std::vector<std::vector<int>>>* opponentMaxPossibleEnergies; // (16, 24, 24)
-
-        std::vector<std::vector<double>>* atleastOneShuttleProbabilities;
+        // Per step inputs of the propagation stencil, (24, 24) indexed like the beliefs
+        FlatArray2D<int> openMask; // 1 if a hidden shuttle could be on the tile now
+        FlatArray2D<int> moveOpenMask; // 1 if a hidden shuttle could have moved on to the tile now
+        FlatArray2D<int> tileEnergyGain;
+        FlatArray2D<int> tileNebulaReduction;
+        std::vector<TileType> estimatedTypes; // By tile id, this step's drift aware tile types
 
         void log(const std::string& message);
-        void initArrays();
 
+        void prepareStencil();
+        void propagatePositions(int s);
         void computeAtleastOneShuttleProbabilities();
+        void carryOverPositions(int s);
     public:
-        OpponentTracker(GameMap& gameMap, RespawnRegistry& respawnRegistry);
+        OpponentTracker(GameMap& gameMap, RespawnRegistry& respawnRegistry, StepDeadline* stepDeadline = nullptr);
         void clear();
         void step();
 
-        std::vector<std::vector<std::vector<double>>>& getOpponentPositionProbabilities();
-        std::vector<std::vector<std::vector<int>>>& getOpponentMaxPossibleEnergies();
+        FlatArray3D<double>& getOpponentPositionProbabilities();
+        FlatArray3D<int>& getOpponentMaxPossibleEnergies();
 
-        std::vector<std::vector<std::vector<double>>>& getOpponentPreviousPositionProbabilities();
-        std::vector<std::vector<std::vector<int>>>& getOpponentPreviousMaxPossibleEnergies();
+        FlatArray3D<double>& getOpponentPreviousPositionProbabilities();
+        FlatArray3D<int>& getOpponentPreviousMaxPossibleEnergies();
 
-        std::vector<std::vector<double>>& getAtleastOneShuttleProbabilities();
+        FlatArray2D<double>& getAtleastOneShuttleProbabilities();
+        const BeliefSupport& getSupport(int s) { return beliefs.supports()[s]; }
 
         bool isOpponentOccupied(int x, int y);
         double expectationOfOpponentOccupancy(int x, int y);
@@ -40,8 +48,6 @@ class OpponentTracker {
         int getAllPossibleEnergyAt(int x, int y);
         int getCountLessThanEnergyAt(int x, int y, int energy);
         void reduceEnergyOfAllShuttles(GameTile& tile, int energy);
-
-        ~OpponentTracker();
 };
 
 #endif // OPPONENT_TRACKER_H
\ No newline at end of file
@@ -1,4 +1,6 @@
 
+#include <algorithm>
+#include <functional>
 #include <limits>
 #include "agent/pathing.h"
 #include "agent/game_map.h"
@@ -9,7 +11,11 @@ void Pathing::log(const std::string& message) {
     Logger::getInstance().log("Pathing -> " + message);
 }
 
-float Pathing::getCost(GameTile &neighbor) {
+float PathingBase::getCost(GameTile &neighbor) {
+    return getCost(neighbor, neighbor.getType());
+}
+
+float PathingBase::getCost(GameTile &neighbor, TileType type) {
     if (config.pathingHeuristics == SHORTEST_DISTANCE) {
         return 1;
     } 
@@ -25,7 +31,7 @@ float Pathing::getCost(GameTile &neighbor) {
             energyGain = 10;
         }
 
-        if (neighbor.getType() == TileType::NEBULA) {
+        if (type == TileType::NEBULA) {
             energyGain -= gameMap.derivedGameState.nebulaTileEnergyReduction;
         }
 
@@ -35,104 +41,404 @@ float Pathing::getCost(GameTile &neighbor) {
     throw std::runtime_error("Unknown heuristic to compute distance");
 }
 
-void Pathing::findAllPaths(GameTile &startTile) {
-    // Define a priority queue to store tiles with their distances    
-    std::priority_queue<TileDistancePair, std::vector<TileDistancePair>, std::greater<TileDistancePair>> pq;
+Pathing::Pathing(GameMap& gameMap, PathingConfig config): PathingBase(gameMap, config),
+        allDestinations(*this), unexploredDestinations(*this), unvisitedDestinations(*this),
+        haloDestinations(*this), vantagePointDestinations(*this) {}
 
+std::pair<int, GameTile*> PathingDestinations::Iterator::operator*() const {
+    int id = destinations->tileIds[index];
+    GameTile& tile = destinations->pathing.getGameMap().getTile(id);
+    return {destinations->pathing.getDistance(tile), &tile};
+}
 
-    // Initialize distances to infinity and paths to empty
-    for (int y = 0; y < gameMap.height; ++y) {
-        for (int x = 0; x < gameMap.width; ++x) {
-            GameTile& tile = gameMap.getTile(x, y);
-            distances[&tile] = {std::numeric_limits<int>::max(), {}};
+void PathingBase::prepareCosts() {
+    int size = gameMap.width * gameMap.height;
+    entryCost.assign(size, -1);
+    gameMap.getEstimatedTypes(gameMap.derivedGameState.currentStep, currentTypes);
+
+    for (int id = 0; id < size; ++id) {
+        GameTile& tile = gameMap.getTile(id);
+        if (currentTypes[id] == TileType::ASTEROID) {
+            continue;
         }
+
+        // Skip if the tile is occupied by an opponent shuttle
+        if (config.doNotBumpIntoOpponentShuttles && tile.isOpponentOccupied()
+            && !tile.isVantagePoint() && !tile.isHaloTile()) {
+            continue;
+        }
+
+        entryCost[id] = std::max(0, static_cast<int>(getCost(tile)));
+    }
+}
+
+void PathingBase::prepareForecastCosts(int horizon, ForecastCosts& forecast) {
+    int size = gameMap.width * gameMap.height;
+    int currentStep = gameMap.derivedGameState.currentStep;
+    const DriftForecast& driftForecast = gameMap.getDriftForecast();
+
+    prepareCosts();
+    forecast.costs.resize(std::max(horizon, 1) * size);
+    std::copy(entryCost.begin(), entryCost.end(), forecast.costs.begin());
+    forecast.layers = 1;
+
+    for (int layer = 1; layer < horizon; ++layer) {
+        int* costs = &forecast.costs[layer * size];
+        const int* previous = costs - size;
+        int step = currentStep + layer;
+
+        if (layer > 1 && driftForecast.hasForecast(step) && driftForecast.getOffset(step) == driftForecast.getOffset(step - 1)) {
+            // No drift in between, the same map as the layer before
+            std::copy(previous, previous + size, costs);
+            continue;
+        }
+
+        gameMap.getEstimatedTypes(step, forecastTypes);
+        for (int id = 0; id < size; ++id) {
+            TileType type = forecastTypes[id];
+            if (type == TileType::ASTEROID || (entryCost[id] < 0 && currentTypes[id] != TileType::ASTEROID)) {
+                // An asteroid then, or blocked now for another reason (an opponent)
+                costs[id] = -1;
+            } else {
+                costs[id] = std::max(0, static_cast<int>(getCost(gameMap.getTile(id), type)));
+            }
+        }
+
+        if (!std::equal(costs, costs + size, previous)) {
+            forecast.layers = layer + 1;
+        }
+    }
+}
+
+bool Pathing::isLeaf(GameTile& tile, int pathLength) {
+    //Do not explore further if the tile is unexplored and the config is set to stop at unexplored tiles
+    if (config.stopAtUnexploredTiles && !tile.isExplored()) {
+        return true;
+    }
+
+    //Do not explore further if the tile is visited and the config is set to stop at visited tiles
+    if (config.stopAtVisitedTiles && tile.isVisited()) {
+        return true;
     }
 
-    // Set the distance to the start tile to 0 and push it to the priority queue
-    distances[&startTile] = {0, {&startTile}};
-    pq.push({0, &startTile});
+    //Do not explore further if the tile is a halo tile and the config is set to stop at halo tiles
+    if (config.stopAtHaloTiles && tile.isHaloTile()) {
+        return true;
+    }
 
-    // Dijkstra's algorithm
-    while (!pq.empty()) {
-        auto [currentDistance, currentTile] = pq.top();
-        pq.pop();
+    //Do not explore further if the tile is a vantage point and the config is set to stop at vantage point tiles
+    if (config.stopAtVantagePointTiles && tile.isVantagePoint()) {
+        return true;
+    }
+
+    //Do not explore further if the search is bounded and the tile is already that many moves away
+    if (config.maxPathLength > 0 && pathLength >= config.maxPathLength) {
+        return true;
+    }
 
-        // Skip if the current distance is greater than the recorded distance
-        if (currentDistance > distances[currentTile].first) {
+    return false;
+}
+
+void Pathing::findAllPaths(GameTile &startTile) {
+    prepareCosts();
+    search(startTile);
+}
+
+void Pathing::findAllPaths(GameTile &startTile, const std::vector<int>& entryCost) {
+    this->entryCost = entryCost;
+    search(startTile);
+}
+
+void Pathing::findAllPaths(GameTile &startTile, const ForecastCosts& forecast) {
+    int size = gameMap.width * gameMap.height;
+    entryCost.assign(forecast.costs.begin(), forecast.costs.begin() + size);
+    if (forecast.layers <= 1) {
+        search(startTile);
+    } else {
+        searchTimeExpanded(startTile, forecast);
+    }
+}
+
+void Pathing::search(GameTile &startTile) {
+    const int width = gameMap.width;
+    const int height = gameMap.height;
+    const int size = width * height;
+
+    timeExpanded = false;
+
+    distance.assign(size, UNREACHABLE);
+    predecessor.assign(size, -1);
+    hops.assign(size, 0);
+    allDestinations.tileIds.clear();
+    unexploredDestinations.tileIds.clear();
+    unvisitedDestinations.tileIds.clear();
+    haloDestinations.tileIds.clear();
+    vantagePointDestinations.tileIds.clear();
+
+    queue.reset(*std::max_element(entryCost.begin(), entryCost.end()));
+
+    int startId = startTile.getId();
+    distance[startId] = 0;
+    queue.push(startId, 0);
+
+    // Dial's algorithm
+    int currentId;
+    int currentDistance;
+    while (queue.pop(currentId, currentDistance)) {
+        // Skip stale entries, the tile was settled through a shorter path
+        if (currentDistance != distance[currentId]) {
             continue;
         }
 
-        allDestinations.push({currentDistance, currentTile});
+        GameTile& currentTile = gameMap.getTile(currentId);
+        allDestinations.tileIds.push_back(currentId);
 
         // Record this tile if it is explored
-        if (config.captureUnexploredTileDestinations && !currentTile->isExplored()) {
-            unexploredDestinations.push({currentDistance, currentTile});
+        if (config.captureUnexploredTileDestinations && !currentTile.isExplored()) {
+            unexploredDestinations.tileIds.push_back(currentId);
         }
 
         // Record this tile if it is unvisited
-        if (config.captureUnVisitedTileDestinations && !currentTile->isVisited()) {
-            unvisitedDestinations.push({currentDistance, currentTile});
+        if (config.captureUnVisitedTileDestinations && !currentTile.isVisited()) {
+            unvisitedDestinations.tileIds.push_back(currentId);
         }
 
         // Record this tile if it is a halo tile
-        if (config.captureHaloTileDestinations && currentTile->isHaloTile()) {
-            haloDestinations.push({currentDistance, currentTile});
+        if (config.captureHaloTileDestinations && currentTile.isHaloTile()) {
+            haloDestinations.tileIds.push_back(currentId);
         }
 
-        if (config.captureVantagePointTileDestinations && currentTile->isVantagePoint()) {
-            vantagePointDestinations.push({currentDistance, currentTile});
+        if (config.captureVantagePointTileDestinations && currentTile.isVantagePoint()) {
+            vantagePointDestinations.tileIds.push_back(currentId);
         }
 
-        //Do not explore further if the tile is unexplored and the config is set to stop at unexplored tiles
-        if (config.stopAtUnexploredTiles && !currentTile->isExplored()) {
+        if (isLeaf(currentTile, hops[currentId])) {
             continue;
         }
 
-        //Do not explore further if the tile is visited and the config is set to stop at visited tiles
-        if (config.stopAtVisitedTiles && currentTile->isVisited()) {
-            continue;
+        // Explore neighbors, in the same UP, RIGHT, DOWN, LEFT order as Direction
+        const int x = currentTile.x;
+        const int y = currentTile.y;
+        const int neighbors[4] = {
+            y > 0 ? currentId - width : -1,
+            x < width - 1 ? currentId + 1 : -1,
+            y < height - 1 ? currentId + width : -1,
+            x > 0 ? currentId - 1 : -1
+        };
+
+        for (int neighborId : neighbors) {
+            if (neighborId < 0 || entryCost[neighborId] < 0) {
+                continue;
+            }
+
+            int newDistance = currentDistance + entryCost[neighborId];
+
+            // If a shorter path to the neighbor is found
+            if (newDistance < distance[neighborId]) {
+                distance[neighborId] = newDistance;
+                predecessor[neighborId] = currentId;
+                hops[neighborId] = hops[currentId] + 1;
+                queue.push(neighborId, newDistance);
+            }
         }
+    }
+}
 
-        //Do not explore further if the tile is a halo tile and the config is set to stop at halo tiles
-        if (config.stopAtHaloTiles && currentTile->isHaloTile()) {
+/**
+ * Dijkstra over (moves, tile) states. Once the moves reach the last forecast layer the states collapse into it, so
+ * there are (layers + 1) * tiles states at most. A tile's distance, hops and path are those of the first state of it
+ * that is settled.
+ */
+void Pathing::searchTimeExpanded(GameTile &startTile, const ForecastCosts& forecast) {
+    const int width = gameMap.width;
+    const int height = gameMap.height;
+    const int size = width * height;
+    const int layers = forecast.layers;
+    const int stateCount = (layers + 1) * size;
+
+    timeExpanded = true;
+    distance.assign(size, UNREACHABLE);
+    predecessor.assign(size, -1);
+    hops.assign(size, 0);
+    bestState.assign(size, -1);
+    stateDistance.assign(stateCount, UNREACHABLE);
+    statePredecessor.assign(stateCount, -1);
+    stateHops.assign(stateCount, 0);
+    allDestinations.tileIds.clear();
+    unexploredDestinations.tileIds.clear();
+    unvisitedDestinations.tileIds.clear();
+    haloDestinations.tileIds.clear();
+    vantagePointDestinations.tileIds.clear();
+
+    queue.reset(*std::max_element(forecast.costs.begin(), forecast.costs.begin() + layers * size));
+
+    int startId = startTile.getId();
+    stateDistance[startId] = 0;
+    queue.push(startId, 0);
+
+    int currentState;
+    int currentDistance;
+    while (queue.pop(currentState, currentDistance)) {
+        if (currentDistance != stateDistance[currentState]) {
             continue;
         }
 
-        //Do not explore further if the tile is a vantage point and the config is set to stop at vantage point tiles
-        if (config.stopAtVantagePointTiles && currentTile->isVantagePoint()) {
+        const int currentId = currentState % size;
+        const int layer = currentState / size;
+        GameTile& currentTile = gameMap.getTile(currentId);
+
+        if (bestState[currentId] == -1) {
+            bestState[currentId] = currentState;
+            distance[currentId] = currentDistance;
+            hops[currentId] = stateHops[currentState];
+            if (statePredecessor[currentState] >= 0) {
+                predecessor[currentId] = statePredecessor[currentState] % size;
+            }
+
+            allDestinations.tileIds.push_back(currentId);
+            if (config.captureUnexploredTileDestinations && !currentTile.isExplored()) {
+                unexploredDestinations.tileIds.push_back(currentId);
+            }
+            if (config.captureUnVisitedTileDestinations && !currentTile.isVisited()) {
+                unvisitedDestinations.tileIds.push_back(currentId);
+            }
+            if (config.captureHaloTileDestinations && currentTile.isHaloTile()) {
+                haloDestinations.tileIds.push_back(currentId);
+            }
+            if (config.captureVantagePointTileDestinations && currentTile.isVantagePoint()) {
+                vantagePointDestinations.tileIds.push_back(currentId);
+            }
+        }
+
+        if (isLeaf(currentTile, stateHops[currentState])) {
             continue;
         }
 
-        // Explore neighbors
-        for (Direction direction = Direction::UP; direction <= Direction::LEFT; ++direction) {
-            std::tuple<bool, GameTile&> result = gameMap.isMovable(*currentTile, direction);
-            bool movable = std::get<0>(result);
+        const int nextLayer = std::min(layer + 1, layers);
+        const int* costs = &forecast.costs[(nextLayer - 1) * size];
+        const int x = currentTile.x;
+        const int y = currentTile.y;
+        const int neighbors[4] = {
+            y > 0 ? currentId - width : -1,
+            x < width - 1 ? currentId + 1 : -1,
+            y < height - 1 ? currentId + width : -1,
+            x > 0 ? currentId - 1 : -1
+        };
 
-            // Skip if the tile is not movable
-            if (!movable) {
+        for (int neighborId : neighbors) {
+            if (neighborId < 0 || costs[neighborId] < 0) {
                 continue;
             }
 
-            // Skip if the tile is occupied by an opponent shuttle
-            if (config.doNotBumpIntoOpponentShuttles && std::get<1>(result).isOpponentOccupied() 
-                && !std::get<1>(result).isVantagePoint() && !std::get<1>(result).isHaloTile()) {
-                continue;
+            int nextState = nextLayer * size + neighborId;
+            int newDistance = currentDistance + costs[neighborId];
+            if (newDistance < stateDistance[nextState]) {
+                stateDistance[nextState] = newDistance;
+                statePredecessor[nextState] = currentState;
+                stateHops[nextState] = stateHops[currentState] + 1;
+                queue.push(nextState, newDistance);
             }
+        }
+    }
+}
 
-            GameTile& neighbor = std::get<1>(result);
+GameTile* Pathing::getNextTile(const GameTile& tile) const {
+    int id = tile.getId();
+    if (distance[id] == UNREACHABLE || predecessor[id] < 0) {
+        return nullptr;
+    }
 
-            int neighborCost = getCost(neighbor);
-            int newDistance = currentDistance + neighborCost;
+    if (timeExpanded) {
+        // The predecessor of a tile's state may be a different state of that tile than its best one
+        int state = bestState[id];
+        while (statePredecessor[statePredecessor[state]] >= 0) {
+            state = statePredecessor[state];
+        }
+        return &gameMap.getTile(state % (gameMap.width * gameMap.height));
+    }
 
-            // log("distance from " + currentTile->toString() + " to " + neighbor.toString() + " is " + std::to_string(neighborCost));
+    while (predecessor[predecessor[id]] >= 0) {
+        id = predecessor[id];
+    }
+    return &gameMap.getTile(id);
+}
 
-            // If a shorter path to the neighbor is found
-            if (newDistance < distances[&neighbor].first) {
-                distances[&neighbor].first = newDistance;
-                distances[&neighbor].second = distances[currentTile].second;
-                distances[&neighbor].second.push_back(&neighbor);
-                pq.push({newDistance, &neighbor});
-            }            
+std::vector<GameTile*> Pathing::getPath(const GameTile& tile) const {
+    std::vector<GameTile*> path;
+    int id = tile.getId();
+    if (distance[id] == UNREACHABLE) {
+        return path;
+    }
+
+    path.resize(hops[id] + 1);
+    if (timeExpanded) {
+        int size = gameMap.width * gameMap.height;
+        int state = bestState[id];
+        for (int index = hops[id]; index >= 0; --index) {
+            path[index] = &gameMap.getTile(state % size);
+            state = statePredecessor[state];
+        }
+        return path;
+    }
+
+    for (int index = hops[id]; index >= 0; --index) {
+        path[index] = &gameMap.getTile(id);
+        id = predecessor[id];
+    }
+    return path;
+}
+
+void DistanceField::compute(const TileBitboard& targets, const std::vector<int>& entryCost) {
+    const int width = gameMap.width;
+    const int height = gameMap.height;
+    const int size = width * height;
+
+    this->entryCost = entryCost;
+    distance.assign(size, UNREACHABLE);
+    nextTile.assign(size, -1);
+    nearestTarget.assign(size, -1);
+    hops.assign(size, 0);
+    queue.reset(*std::max_element(entryCost.begin(), entryCost.end()));
+
+    targets.forEach([&](int id) {
+        distance[id] = 0;
+        nearestTarget[id] = id;
+        queue.push(id, 0);
+    });
+
+    // Walks the moves backwards, stepping from a settled tile to a neighbour costs the entry cost of the settled tile
+    int currentId;
+    int currentDistance;
+    while (queue.pop(currentId, currentDistance)) {
+        if (currentDistance != distance[currentId] || entryCost[currentId] < 0) {
+            continue;
+        }
+
+        const int x = currentId % width;
+        const int y = currentId / width;
+        const int neighbors[4] = {
+            y > 0 ? currentId - width : -1,
+            x < width - 1 ? currentId + 1 : -1,
+            y < height - 1 ? currentId + width : -1,
+            x > 0 ? currentId - 1 : -1
+        };
+
+        int newDistance = currentDistance + entryCost[currentId];
+        for (int neighborId : neighbors) {
+            if (neighborId >= 0 && newDistance < distance[neighborId]) {
+                distance[neighborId] = newDistance;
+                nextTile[neighborId] = currentId;
+                nearestTarget[neighborId] = nearestTarget[currentId];
+                hops[neighborId] = hops[currentId] + 1;
+                queue.push(neighborId, newDistance);
+            }
         }
     }
 }
+
+GameTile* DistanceField::getNextTile(const GameTile& tile) const {
+    if (nextTile.empty() || nextTile[tile.getId()] < 0) {
+        return nullptr;
+    }
+    return &gameMap.getTile(nextTile[tile.getId()]);
+}
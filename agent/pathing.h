@@ -2,10 +2,10 @@
 #define PATHING_H
 
 #include <vector>
-#include <unordered_map>
+#include <limits>
 
 #include "agent/game_map.h"
-#include "datastructures/iterable_priority_queue.h"
+#include "datastructures/bucket_queue.h"
 
 
 enum PathingHeuristics : std::uint8_t {
@@ -24,6 +24,7 @@ struct PathingConfig {
     bool captureUnexploredTileDestinations; // Captures unexplored tiles destinations
     bool captureUnVisitedTileDestinations; // Captures unvisited tiles destinations
     bool captureVantagePointTileDestinations; // Captures vantage point tiles destinations
+    int maxPathLength; // Tiles this many moves away are not explored further, 0 for no limit
 
     void captureEverything() {
         captureHaloTileDestinations = true;
@@ -33,61 +34,208 @@ struct PathingConfig {
     }
 };
 
+/**
+ * Entry costs per move of a path under the forecast tile types. Layer t holds the cost of entering a tile with move
+ * t + 1, i.e. at step currentStep + t, the last layer holds for every later move too.
+ */
+struct ForecastCosts {
+    std::vector<int> costs; // Layer * tile count + tile id
+    int layers = 0;
+};
+
 class PathingBase {
     protected:
         GameMap& gameMap;
+        PathingConfig config;
+
+        std::vector<int> entryCost; // Cost of moving into the tile, -1 if it can't be entered
+        std::vector<int> distance;
+        std::vector<TileType> currentTypes;     // Estimated tile types this step, by tile id
+        std::vector<TileType> forecastTypes;
+        BucketQueue queue;
 
     public:
-        PathingBase(GameMap& gameMap): gameMap(gameMap) {};
+        static constexpr int UNREACHABLE = std::numeric_limits<int>::max();
 
+        PathingBase(GameMap& gameMap, PathingConfig config): gameMap(gameMap), config(config) {};
+
+        float getCost(GameTile &neighbor);
+        float getCost(GameTile &neighbor, TileType type);
+
+        /**
+         * Entry cost of every tile under this config for the current map state
+         */
+        void prepareCosts();
+
+        /**
+         * Entry costs for the next horizon moves, asteroids and nebulae where the drift forecast puts them. Trailing
+         * layers equal to the one before them are dropped, so without drift in the horizon there is a single layer
+         * equal to the entry costs. Leaves the entry costs prepared too. Energies are the last known ones, the energy
+         * field is not forecast.
+         */
+        void prepareForecastCosts(int horizon, ForecastCosts& forecast);
+        const std::vector<int>& getEntryCosts() const { return entryCost; }
+
+        GameMap& getGameMap() const { return gameMap; }
+
+        void setMaxPathLength(int maxPathLength) { config.maxPathLength = maxPathLength; }
 };
 
+class Pathing;
+
+/**
+ * Read-only list of (distance, tile) pairs in the order Dijkstra settled them, so closest tiles come first. The list
+ * only holds tile ids, distances are looked up from the owning Pathing.
+ */
+class PathingDestinations {
+    private:
+        const Pathing& pathing;
+        std::vector<int> tileIds;
+
+        friend class Pathing;
 
-// struct PathingConfig : public PathingConfigBase {
-//     int maxDistance;
-// };
+    public:
+        class Iterator {
+            private:
+                const PathingDestinations* destinations;
+                size_t index;
+
+            public:
+                Iterator(const PathingDestinations* destinations, size_t index): destinations(destinations), index(index) {};
+                std::pair<int, GameTile*> operator*() const;
+                Iterator& operator++() { ++index; return *this; }
+                bool operator!=(const Iterator& other) const { return index != other.index; }
+        };
+
+        explicit PathingDestinations(const Pathing& pathing): pathing(pathing) {};
+
+        Iterator begin() const { return Iterator(this, 0); }
+        Iterator end() const { return Iterator(this, tileIds.size()); }
+        size_t size() const { return tileIds.size(); }
+        bool empty() const { return tileIds.empty(); }
+};
 
+/**
+ * Single source Dijkstra over the tile grid. Edge costs are small non negative integers, so the frontier is a
+ * circular bucket queue (Dial's algorithm) and distance / predecessor live in flat arrays indexed by tile id. Paths
+ * are rebuilt on demand by walking the predecessors.
+ *
+ * Ties are settled in tile id order, same as the (distance, tile) heap this replaced.
+ */
 class Pathing : public PathingBase {
     private:
-        PathingConfig config;
-        
+        std::vector<int> predecessor;
+        std::vector<int> hops;
+
+        // Time expanded search, a state is (moves made, capped at the forecast layers) * tile count + tile id
+        bool timeExpanded = false;
+        std::vector<int> stateDistance;
+        std::vector<int> statePredecessor;
+        std::vector<int> stateHops;
+        std::vector<int> bestState; // Tile id -> state it was first settled in
+
+        bool isLeaf(GameTile& tile, int pathLength);
+        void search(GameTile& startTile);
+        void searchTimeExpanded(GameTile& startTile, const ForecastCosts& forecast);
+
     public:
         using TileDistancePair = std::pair<int, GameTile*>;
 
-        IterablePriorityQueue<TileDistancePair> allDestinations;
+        PathingDestinations allDestinations;
         
         /**
          *  Will be populated only if captureUnexploredTileDestinations is true, closest tiles first
          */
-        IterablePriorityQueue<TileDistancePair> unexploredDestinations;
+        PathingDestinations unexploredDestinations;
 
         /**
          *  Will be populated only if captureUnVisitedTileDestinations is true, closest tiles first
          */
-        IterablePriorityQueue<TileDistancePair> unvisitedDestinations;
+        PathingDestinations unvisitedDestinations;
 
         /**
          * Will be populated only if captureHaloTileDestinations is true, closest tiles first
          */
-        IterablePriorityQueue<TileDistancePair> haloDestinations;
+        PathingDestinations haloDestinations;
 
         /**
          * Will be populated only if captureVantagePointTileDestinations is true, closest tiles first
          */
-        IterablePriorityQueue<TileDistancePair> vantagePointDestinations;
+        PathingDestinations vantagePointDestinations;
+
+        Pathing(GameMap& gameMap, PathingConfig config);
+        Pathing(const Pathing&) = delete;
+        Pathing& operator=(const Pathing&) = delete;
+
+        static void log(const std::string& message);
+
+        void findAllPaths(GameTile &startTile);
 
         /**
-         * The main output having all the distances and paths
+         * Same as findAllPaths(startTile) but reuses entry costs already prepared for this config and map state
          */
-        std::unordered_map<GameTile*, std::pair<int, std::vector<GameTile*>>> distances;
+        void findAllPaths(GameTile &startTile, const std::vector<int>& entryCost);
 
-        Pathing(GameMap& gameMap, PathingConfig config): PathingBase(gameMap), config(config) {};
+        /**
+         * Time expanded search: a tile may be entered at the moves the forecast lets it, so a path can go around an
+         * asteroid that drifts in before the shuttle gets there. The same as the search above with a single layer.
+         */
+        void findAllPaths(GameTile &startTile, const ForecastCosts& forecast);
 
-        static void log(const std::string& message);
+        /**
+         * Distance from the start tile, UNREACHABLE if the search never got there
+         */
+        int getDistance(const GameTile& tile) const { return distance[tile.getId()]; }
+        bool isReachable(const GameTile& tile) const { return distance[tile.getId()] != UNREACHABLE; }
 
-        float getCost(GameTile &neighbor);
+        /**
+         * Number of moves on the path to the tile, 0 for the start tile
+         */
+        int getPathLength(const GameTile& tile) const { return hops[tile.getId()]; }
 
-        void findAllPaths(GameTile &startTile);
+        /**
+         * First tile to move into on the way to the tile, nullptr if it is the start tile or unreachable
+         */
+        GameTile* getNextTile(const GameTile& tile) const;
+
+        /**
+         * Full path including the start and the destination tile, empty if unreachable
+         */
+        std::vector<GameTile*> getPath(const GameTile& tile) const;
+};
+
+/**
+ * Multi-source reverse field: the least cost from every tile to the nearest of a set of target tiles, under the same
+ * entry costs a forward Pathing would use. Ignores the stopAt* / capture* options.
+ */
+class DistanceField : public PathingBase {
+    private:
+        std::vector<int> nextTile;
+        std::vector<int> nearestTarget;
+        std::vector<int> hops;
+
+    public:
+        DistanceField(GameMap& gameMap, PathingConfig config): PathingBase(gameMap, config) {};
+
+        void compute(const TileBitboard& targets, const std::vector<int>& entryCost);
+
+        int distanceToNearest(const GameTile& tile) const { return distance.empty() ? UNREACHABLE : distance[tile.getId()]; }
+        bool canReachAny(const GameTile& tile) const { return distanceToNearest(tile) != UNREACHABLE; }
+
+        /**
+         * Id of the target the distance is measured to, -1 if unreachable
+         */
+        int getNearestTarget(const GameTile& tile) const { return nearestTarget.empty() ? -1 : nearestTarget[tile.getId()]; }
+
+        /**
+         * Number of moves to the nearest target
+         */
+        int getPathLength(const GameTile& tile) const { return hops.empty() ? 0 : hops[tile.getId()]; }
+
+        /**
+         * First tile to move into on the way to the nearest target, nullptr if already on a target or unreachable
+         */
+        GameTile* getNextTile(const GameTile& tile) const;
 };
 
 #endif // PATHING_H
\ No newline at end of file
@@ -0,0 +1,162 @@
+#include "agent/pathing_service.h"
+
+#include <chrono>
+
+#include "config.h"
+#include "metrics.h"
+
+void PathingService::log(const std::string& message) {
+    Logger::getInstance().log("PathingService -> " + message);
+}
+
+PathingConfig PathingService::createLeastEnergyConfig() {
+    PathingConfig config = {};
+    config.pathingHeuristics = LEAST_ENERGY;
+    config.captureEverything();
+    config.stopAtUnexploredTiles = false;
+    config.doNotBumpIntoOpponentShuttles = true;
+    return config;
+}
+
+PathingService::PathingService(GameMap& gameMap, StepDeadline* stepDeadline)
+        : gameMap(gameMap), stepDeadline(stepDeadline), leastEnergyConfig(createLeastEnergyConfig()), costModel(gameMap, leastEnergyConfig),
+          vantagePointField(gameMap, leastEnergyConfig), haloTileField(gameMap, leastEnergyConfig),
+          frontierField(gameMap, leastEnergyConfig), rechargeField(gameMap, leastEnergyConfig), rechargeTargets(gameMap.width, gameMap.height) {
+    forwardFields.resize(gameMap.width * gameMap.height);
+}
+
+void PathingService::beginStep() {
+    // Fields are kept allocated and recomputed in place on the next request
+    computedStarts.clear();
+    costsReady = false;
+    forecastReady = false;
+    vantagePointFieldReady = false;
+    haloTileFieldReady = false;
+    frontierFieldReady = false;
+    rechargeFieldReady = false;
+    stepDurationMicros = 0;
+    cacheHits = 0;
+}
+
+void PathingService::endStep() {
+    Metrics::getInstance().add("pathing_duration", stepDurationMicros / 1000.0f);
+    Metrics::getInstance().add("pathing_fields_computed", computedStarts.size());
+    Metrics::getInstance().add("pathing_cache_hits", cacheHits.load());
+    if (forecastReady) {
+        Metrics::getInstance().add("pathing_forecast_layers", forecastCosts.layers);
+    }
+    if (stepDeadline != nullptr) {
+        stepDeadline->addStageTime(STAGE_PATHING, stepDurationMicros);
+    }
+}
+
+const std::vector<int>& PathingService::getEntryCosts() {
+    if (!costsReady) {
+        costModel.prepareCosts();
+        costsReady = true;
+    }
+    return costModel.getEntryCosts();
+}
+
+const ForecastCosts& PathingService::getForecastCosts() {
+    if (!forecastReady) {
+        // Also prepares the entry costs, they are the first layer
+        costModel.prepareForecastCosts(Config::timeExpandedHorizon, forecastCosts);
+        costsReady = true;
+        forecastReady = true;
+    }
+    return forecastCosts;
+}
+
+void PathingService::prepare(const std::vector<GameTile*>& startTiles) {
+    getEntryCosts();
+    for (GameTile* startTile : startTiles) {
+        getLeastEnergyPathing(*startTile);
+    }
+    getVantagePointField();
+    getHaloTileField();
+    getFrontierField();
+    getRechargeField();
+}
+
+Pathing* PathingService::getLeastEnergyPathing(GameTile& startTile) {
+    int startId = startTile.getId();
+    for (int computedStart : computedStarts) {
+        if (computedStart == startId) {
+            cacheHits++;
+            return forwardFields[startId].get();
+        }
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    if (!forwardFields[startId]) {
+        forwardFields[startId] = std::make_unique<Pathing>(gameMap, leastEnergyConfig);
+    }
+    bool degraded = stepDeadline != nullptr && stepDeadline->shouldDegrade(STAGE_PATHING);
+    forwardFields[startId]->setMaxPathLength(degraded ? Config::degradedPathLength : 0);
+    if (Config::timeExpandedHorizon > 1) {
+        forwardFields[startId]->findAllPaths(startTile, getForecastCosts());
+    } else {
+        forwardFields[startId]->findAllPaths(startTile, getEntryCosts());
+    }
+    computedStarts.push_back(startId);
+
+    auto end = std::chrono::high_resolution_clock::now();
+    stepDurationMicros += std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    return forwardFields[startId].get();
+}
+
+int PathingService::getDistance(GameTile& fromTile, const GameTile& toTile) {
+    return getLeastEnergyPathing(fromTile)->getDistance(toTile);
+}
+
+const DistanceField& PathingService::getField(DistanceField& field, bool& ready, const TileBitboard& targets) {
+    if (!ready) {
+        auto start = std::chrono::high_resolution_clock::now();
+        field.compute(targets, getEntryCosts());
+        ready = true;
+        auto end = std::chrono::high_resolution_clock::now();
+        stepDurationMicros += std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    }
+    return field;
+}
+
+const DistanceField& PathingService::getVantagePointField() {
+    return getField(vantagePointField, vantagePointFieldReady, gameMap.getTileStore().vantagePoint);
+}
+
+const DistanceField& PathingService::getHaloTileField() {
+    return getField(haloTileField, haloTileFieldReady, gameMap.getTileStore().haloTile);
+}
+
+const DistanceField& PathingService::getFrontierField() {
+    TileStore& store = gameMap.getTileStore();
+    if (frontierFieldReady) {
+        return frontierField;
+    }
+
+    TileBitboard targets = store.unexploredFrontier;
+    if (gameMap.derivedGameState.isThereAHuntForRelic()) {
+        for (auto& relicExplorationFrontier : store.relicExplorationFrontier) {
+            targets |= relicExplorationFrontier;
+        }
+    }
+    return getField(frontierField, frontierFieldReady, targets);
+}
+
+const DistanceField& PathingService::getRechargeField() {
+    if (rechargeFieldReady) {
+        return rechargeField;
+    }
+
+    int currentStep = gameMap.derivedGameState.currentStep;
+    rechargeTargets.clear();
+    for (int id = 0; id < gameMap.width * gameMap.height; ++id) {
+        GameTile& tile = gameMap.getTile(id);
+        if (tile.getLastKnownEnergy() > 0 && gameMap.getEstimatedType(tile, currentStep) != TileType::NEBULA) {
+            rechargeTargets.set(id);
+        }
+    }
+    return getField(rechargeField, rechargeFieldReady, rechargeTargets);
+}
@@ -0,0 +1,100 @@
+#ifndef PATHING_SERVICE_H
+#define PATHING_SERVICE_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "agent/game_map.h"
+#include "agent/pathing.h"
+#include "agent/step_deadline.h"
+
+/**
+ * Step scoped cache of the least energy pathing every shuttle plans with. Forward fields are computed once per
+ * distinct start tile (stacked shuttles share one) and the reverse fields answer "how far is the nearest vantage
+ * point / halo tile / frontier / recharge tile" for any tile in O(1).
+ *
+ * Everything is invalidated by beginStep(), the map changes between steps. Once the step deadline is exhausted new
+ * forward fields only explore Config::degradedPathLength moves out. With Config::timeExpandedHorizon set the forward
+ * fields follow the drift forecast, the reverse fields stay on the current map.
+ */
+class PathingService {
+    private:
+        GameMap& gameMap;
+        StepDeadline* stepDeadline;
+        PathingConfig leastEnergyConfig;
+
+        PathingBase costModel;
+        bool costsReady = false;
+        ForecastCosts forecastCosts;
+        bool forecastReady = false;
+
+        std::vector<std::unique_ptr<Pathing>> forwardFields; // Indexed by start tile id
+        std::vector<int> computedStarts;
+
+        DistanceField vantagePointField;
+        DistanceField haloTileField;
+        DistanceField frontierField;
+        DistanceField rechargeField;
+        TileBitboard rechargeTargets;
+        bool vantagePointFieldReady = false;
+        bool haloTileFieldReady = false;
+        bool frontierFieldReady = false;
+        bool rechargeFieldReady = false;
+
+        long long stepDurationMicros = 0;
+        std::atomic<int> cacheHits{0};
+
+        static void log(const std::string& message);
+        const DistanceField& getField(DistanceField& field, bool& ready, const TileBitboard& targets);
+        const ForecastCosts& getForecastCosts();
+
+    public:
+        static PathingConfig createLeastEnergyConfig();
+
+        PathingService(GameMap& gameMap, StepDeadline* stepDeadline = nullptr);
+
+        void beginStep();
+
+        /**
+         * Reports the pathing time spent in this step
+         */
+        void endStep();
+
+        /**
+         * Computes everything the shuttles on these tiles can ask for this step. Afterwards the getters only read, so
+         * they are safe to call from several threads. The entry costs and the reverse fields are always computed, with
+         * no start tiles only the forward fields are left out.
+         */
+        void prepare(const std::vector<GameTile*>& startTiles);
+
+        /**
+         * Cost of entering every tile this step, -1 if it can't be entered
+         */
+        const std::vector<int>& getEntryCosts();
+
+        /**
+         * Least energy paths from the tile, shared by every caller starting there in this step
+         */
+        Pathing* getLeastEnergyPathing(GameTile& startTile);
+
+        /**
+         * Least energy distance between two tiles, Pathing::UNREACHABLE if there is no path
+         */
+        int getDistance(GameTile& fromTile, const GameTile& toTile);
+
+        const DistanceField& getVantagePointField();
+        const DistanceField& getHaloTileField();
+
+        /**
+         * Unexplored frontier, plus the relic exploration frontiers while there is a hunt for relic
+         */
+        const DistanceField& getFrontierField();
+
+        /**
+         * Tiles a shuttle recharges on, positive energy and not in a nebula this step
+         */
+        const DistanceField& getRechargeField();
+};
+
+#endif // PATHING_SERVICE_H
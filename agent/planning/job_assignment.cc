@@ -0,0 +1,245 @@
+#include "job_assignment.h"
+
+#include <limits>
+
+#include "logger.h"
+
+void JobAssignment::log(const std::string& message) {
+    Logger::getInstance().log("JobAssignment -> " + message);
+}
+
+void JobAssignment::reset(int maxUnits) {
+    int tileCount = gameMap.width * gameMap.height;
+    busyShuttles.assign(maxUnits, 0);
+    for (auto& tiles : busyTiles) {
+        tiles.assign(tileCount, 0);
+    }
+    acceptedIds.clear();
+    assignedPriority = 0;
+}
+
+int JobAssignment::getTargetTileId(const Job* job) {
+    return gameMap.getTile(job->targetX, job->targetY).getId();
+}
+
+bool JobAssignment::isTargetBusy(JobApplication& jobApplication) {
+    Job* job = jobApplication.job;
+    int targetId = getTargetTileId(job);
+
+    switch (job->jobType) {
+        case JobType::RELIC_MINING_NAVIGATOR:
+            return busyTiles[JobType::RELIC_MINING_NAVIGATOR][targetId] || busyTiles[JobType::RELIC_MINER][targetId];
+        case JobType::DEFENDER:
+            if (busyTiles[JobType::DEFENDER][targetId]) {
+                return true;
+            }
+            for (auto& opponentXYPair : job->as<DefenderJob>()->getAllOpponentPositions()) {
+                if (busyTiles[JobType::DEFENDER][gameMap.getTile(opponentXYPair.first, opponentXYPair.second).getId()]) {
+                    return true;
+                }
+            }
+            return false;
+        case JobType::RECHARGE:
+            return false;
+        default:
+            return busyTiles[job->jobType][targetId];
+    }
+}
+
+void JobAssignment::accept(JobApplication& jobApplication) {
+    Job* job = jobApplication.job;
+    LOG_DEBUG("JobApplication accepted " + jobApplication.to_string());
+
+    jobApplication.setStatus(JobApplicationStatus::ACCEPTED);
+    busyShuttles[jobApplication.shuttleData->id] = 1;
+    acceptedIds.push_back(jobApplication.id);
+    assignedPriority += jobApplication.priority;
+
+    if (job->jobType == JobType::RECHARGE) {
+        return;
+    }
+    busyTiles[job->jobType][getTargetTileId(job)] = 1;
+    if (job->jobType == JobType::DEFENDER) {
+        for (auto& opponentXYPair : job->as<DefenderJob>()->getAllOpponentPositions()) {
+            busyTiles[JobType::DEFENDER][gameMap.getTile(opponentXYPair.first, opponentXYPair.second).getId()] = 1;
+        }
+    }
+}
+
+void JobAssignment::assignGreedily(JobBoard& jobBoard, const std::vector<int>& jobApplicationIds) {
+    for (int jobApplicationId : jobApplicationIds) {
+        JobApplication& jobApplication = jobBoard.getJobApplications()[jobApplicationId];
+
+        if (busyShuttles[jobApplication.shuttleData->id]) {
+            //Shuttle already assigned to a higher priority job
+            jobApplication.setStatus(JobApplicationStatus::SHUTTLE_BUSY);
+            continue;
+        }
+
+        if (isTargetBusy(jobApplication)) {
+            jobApplication.setStatus(JobApplicationStatus::TARGET_BUSY);
+            continue;
+        }
+
+        accept(jobApplication);
+    }
+}
+
+/**
+ * Column of the target the application competes for. Recharge jobs are meant for a single shuttle and get a column each.
+ */
+int JobAssignment::getResourceKey(const Job* job) {
+    int tileCount = gameMap.width * gameMap.height;
+    if (job->jobType == JobType::RECHARGE) {
+        return JOB_TYPE_COUNT * tileCount + job->id;
+    }
+    JobType resourceType = job->jobType == JobType::RELIC_MINING_NAVIGATOR ? JobType::RELIC_MINER : job->jobType;
+    return resourceType * tileCount + getTargetTileId(job);
+}
+
+void JobAssignment::assignOptimally(JobBoard& jobBoard) {
+    std::vector<JobApplication>& jobApplications = jobBoard.getJobApplications();
+
+    std::vector<int> defenderIds;
+    for (int jobApplicationId : jobBoard.getSortedJobApplicationIds()) {
+        if (jobApplications[jobApplicationId].job->jobType == JobType::DEFENDER) {
+            defenderIds.push_back(jobApplicationId);
+        }
+    }
+    assignGreedily(jobBoard, defenderIds);
+
+    // Rows are the shuttles still free, in shuttle id order
+    int shuttleCount = static_cast<int>(busyShuttles.size());
+    std::vector<int> rowByShuttleId(shuttleCount, -1);
+    rowShuttleIds.clear();
+    columnByResource.clear();
+    for (JobApplication& jobApplication : jobApplications) {
+        if (jobApplication.job->jobType == JobType::DEFENDER) {
+            continue;
+        }
+        if (busyShuttles[jobApplication.shuttleData->id]) {
+            jobApplication.setStatus(JobApplicationStatus::SHUTTLE_BUSY);
+            continue;
+        }
+        rowByShuttleId[jobApplication.shuttleData->id] = 0;
+        columnByResource.try_emplace(getResourceKey(jobApplication.job), columnByResource.size());
+    }
+    for (int shuttleId = 0; shuttleId < shuttleCount; ++shuttleId) {
+        if (rowByShuttleId[shuttleId] == 0) {
+            rowByShuttleId[shuttleId] = rowShuttleIds.size();
+            rowShuttleIds.push_back(shuttleId);
+        }
+    }
+
+    int rows = rowShuttleIds.size();
+    int targetColumns = columnByResource.size();
+    if (rows == 0) {
+        return;
+    }
+
+    // One extra column per row for staying unassigned, so every row can be matched
+    int columns = targetColumns + rows;
+    const long long unavailable = std::numeric_limits<long long>::max() / 4;
+    bestApplicationIds.assign(rows * targetColumns, -1);
+    costs.assign(rows * columns, unavailable);
+    for (int row = 0; row < rows; ++row) {
+        std::fill(costs.begin() + row * columns + targetColumns, costs.begin() + (row + 1) * columns, 0);
+    }
+
+    for (JobApplication& jobApplication : jobApplications) {
+        if (jobApplication.job->jobType == JobType::DEFENDER || busyShuttles[jobApplication.shuttleData->id]) {
+            continue;
+        }
+        int row = rowByShuttleId[jobApplication.shuttleData->id];
+        int column = columnByResource[getResourceKey(jobApplication.job)];
+        int& bestApplicationId = bestApplicationIds[row * targetColumns + column];
+        if (bestApplicationId == -1 || jobApplication.priority > jobApplications[bestApplicationId].priority) {
+            bestApplicationId = jobApplication.id;
+            costs[row * columns + column] = -jobApplication.priority;
+        }
+    }
+
+    solve(rows, columns);
+
+    for (int row = 0; row < rows; ++row) {
+        int column = columnByRow[row];
+        if (column < targetColumns && bestApplicationIds[row * targetColumns + column] != -1) {
+            accept(jobApplications[bestApplicationIds[row * targetColumns + column]]);
+        }
+    }
+
+    for (JobApplication& jobApplication : jobApplications) {
+        if (jobApplication.job->jobType == JobType::DEFENDER || jobApplication.getStatus() != JobApplicationStatus::APPLIED) {
+            continue;
+        }
+        jobApplication.setStatus(busyShuttles[jobApplication.shuttleData->id] ? JobApplicationStatus::SHUTTLE_BUSY : JobApplicationStatus::TARGET_BUSY);
+    }
+}
+
+/**
+ * Hungarian algorithm with potentials on the row major cost matrix, rows <= columns. Rows are added one at a time,
+ * each along the shortest augmenting path, O(rows^2 * columns). Fills columnByRow.
+ */
+void JobAssignment::solve(int rows, int columns) {
+    const long long infinity = std::numeric_limits<long long>::max();
+
+    // 1-based, column 0 is the virtual start of every augmenting path
+    std::vector<long long> rowPotential(rows + 1, 0);
+    std::vector<long long> columnPotential(columns + 1, 0);
+    std::vector<int> rowByColumn(columns + 1, 0);
+    std::vector<int> previousColumn(columns + 1, 0);
+    std::vector<long long> minSlack(columns + 1);
+    std::vector<uint8_t> visited(columns + 1);
+
+    for (int row = 1; row <= rows; ++row) {
+        rowByColumn[0] = row;
+        int column = 0;
+        std::fill(minSlack.begin(), minSlack.end(), infinity);
+        std::fill(visited.begin(), visited.end(), 0);
+
+        do {
+            visited[column] = 1;
+            int currentRow = rowByColumn[column];
+            long long delta = infinity;
+            int nextColumn = 0;
+            const long long* rowCosts = &costs[(currentRow - 1) * columns];
+            for (int candidate = 1; candidate <= columns; ++candidate) {
+                if (visited[candidate]) {
+                    continue;
+                }
+                long long slack = rowCosts[candidate - 1] - rowPotential[currentRow] - columnPotential[candidate];
+                if (slack < minSlack[candidate]) {
+                    minSlack[candidate] = slack;
+                    previousColumn[candidate] = column;
+                }
+                if (minSlack[candidate] < delta) {
+                    delta = minSlack[candidate];
+                    nextColumn = candidate;
+                }
+            }
+            for (int candidate = 0; candidate <= columns; ++candidate) {
+                if (visited[candidate]) {
+                    rowPotential[rowByColumn[candidate]] += delta;
+                    columnPotential[candidate] -= delta;
+                } else {
+                    minSlack[candidate] -= delta;
+                }
+            }
+            column = nextColumn;
+        } while (rowByColumn[column] != 0);
+
+        // Flip the augmenting path
+        do {
+            int previous = previousColumn[column];
+            rowByColumn[column] = rowByColumn[previous];
+            column = previous;
+        } while (column != 0);
+    }
+
+    columnByRow.assign(rows, -1);
+    for (int column = 1; column <= columns; ++column) {
+        if (rowByColumn[column] != 0) {
+            columnByRow[rowByColumn[column] - 1] = column - 1;
+        }
+    }
+}
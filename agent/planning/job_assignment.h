@@ -0,0 +1,68 @@
+#ifndef JOB_ASSIGNMENT_H
+#define JOB_ASSIGNMENT_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "agent/game_map.h"
+#include "agent/planning/jobs.h"
+
+/**
+ * Decides which applications on a board are accepted. A shuttle takes at most one job and a tile is taken by at most
+ * one shuttle per job type, a relic mining navigator also stays away from a tile that is being mined and a defender
+ * takes the opponent positions it covers too.
+ */
+class JobAssignment {
+    private:
+        GameMap& gameMap;
+        std::vector<uint8_t> busyShuttles;                          // Shuttle id -> accepted a job
+        std::array<std::vector<uint8_t>, JOB_TYPE_COUNT> busyTiles; // Job type -> tile id -> taken
+        std::vector<int> acceptedIds;
+        long long assignedPriority = 0;
+
+        // Optimal assignment scratch, kept to not reallocate every step
+        std::vector<int> rowShuttleIds;
+        std::unordered_map<int, int> columnByResource;
+        std::vector<int> bestApplicationIds;                        // Row * columns + column -> application id
+        std::vector<long long> costs;
+        std::vector<int> columnByRow;
+
+        void log(const std::string& message);
+
+        int getTargetTileId(const Job* job);
+        bool isTargetBusy(JobApplication& jobApplication);
+        void accept(JobApplication& jobApplication);
+        int getResourceKey(const Job* job);
+        void solve(int rows, int columns);
+
+    public:
+        explicit JobAssignment(GameMap& gameMap) : gameMap(gameMap) {}
+
+        /**
+         * Forgets the previous assignment
+         */
+        void reset(int maxUnits);
+
+        /**
+         * Accepts the applications in the given order as long as their shuttle and target are free
+         */
+        void assignGreedily(JobBoard& jobBoard, const std::vector<int>& jobApplicationIds);
+
+        /**
+         * Accepts the defender applications greedily in sorted order, their targets span several tiles. The others
+         * are assigned by the Hungarian algorithm to maximize the total priority: every free shuttle is a row, every
+         * target (job type and tile, relic miners and relic mining navigators sharing theirs) a column.
+         */
+        void assignOptimally(JobBoard& jobBoard);
+
+        /**
+         * Accepted application ids in the order they were accepted
+         */
+        const std::vector<int>& getAcceptedIds() const { return acceptedIds; }
+        long long getAssignedPriority() const { return assignedPriority; }
+};
+
+#endif //JOB_ASSIGNMENT_H
@@ -1,5 +1,6 @@
 #include "jobs.h"
 
+#include <algorithm>
 #include <string>
 #include <sstream>
 #include "agent/game_map.h"
@@ -41,6 +42,10 @@ Job::Job(int id, JobType jobType, int targetX, int targetY)
     }
 }
 
+void Job::log(const std::string& message) {
+    Logger::getInstance().log("Job -> " + message);
+}
+
 std::string Job::getJobTypeString(JobType jobType) {
     switch (jobType) {
         case RELIC_MINER:
@@ -85,6 +90,34 @@ HaloNodeExplorerJob::HaloNodeExplorerJob(int id, int haloNodeX, int haloNodeY)
 DefenderJob::DefenderJob(int id, int opponentPositionX, int opponentPositionY)
     : Job(id, DEFENDER, opponentPositionX, opponentPositionY) {}
 
+void DefenderJob::addOpponentPosition(int x, int y) {
+    if (opponentPositionCount == MAX_OPPONENT_POSITIONS) {
+        LOG_WARN("Problem: Too many opponent positions for " + to_string());
+        std::cerr<<"Problem: Too many opponent positions"<<std::endl;
+        return;
+    }
+    opponentPositions[opponentPositionCount++] = std::make_pair(x, y);
+}
+
+//----------------------------------------------
+
+// **JobArena implementations**
+
+void JobArena::reset(int capacity) {
+    capacityPerType = capacity;
+    std::apply([capacity](auto&... jobs) {
+        ((jobs.clear(), jobs.reserve(capacity)), ...);
+    }, storage);
+}
+
+int JobArena::size() const {
+    return std::apply([](const auto&... jobs) { return static_cast<int>((jobs.size() + ...)); }, storage);
+}
+
+void JobArena::log(const std::string& message) {
+    Logger::getInstance().log("JobArena -> " + message);
+}
+
 //----------------------------------------------
 
 // **JobApplication implementations**
@@ -106,6 +139,11 @@ JobApplication::JobApplication(const JobApplication& other)
       energyNeededToExecute(other.energyNeededToExecute), priority(other.priority),
       shuttleData(other.shuttleData), bestPlan(other.bestPlan), job(other.job) {}
 
+JobApplication::JobApplication(JobApplication&& other) noexcept
+    : id(other.id), status(other.status), stepsNeededToExecute(other.stepsNeededToExecute),
+      energyNeededToExecute(other.energyNeededToExecute), priority(other.priority),
+      shuttleData(other.shuttleData), bestPlan(std::move(other.bestPlan)), job(other.job) {}
+
 JobApplication& JobApplication::operator=(const JobApplication& other) {
     if (this != &other) {
         id = other.id;
@@ -147,22 +185,53 @@ void JobApplication::setStatus(JobApplicationStatus status) {
 // **JobBoard implementations**
 
 JobBoard::JobBoard(GameMap& gameMap)
-    : gameMap(gameMap), jobs(), jobApplications(), jobApplicationsByShuttleId(), jobApplicationsByJobId(), jobTypeToJobIdMap() {}
+    : gameMap(gameMap), index(&ownIndex) {}
+
+JobBoard::JobBoard(GameMap& gameMap, const JobBoard& parent)
+    : gameMap(gameMap), index(parent.index) {}
 
 void JobBoard::addJob(Job* job) {
-    jobs.push_back(job);
+    ownIndex.jobs.push_back(job);
+    ownIndex.jobsByType[job->jobType].push_back(job);
+}
+
+/**
+ * Counting sort of the jobs by target tile, so every tile's jobs are contiguous and keep their posting order
+ */
+void JobBoard::indexJobs() {
+    int tileCount = gameMap.width * gameMap.height;
+    ownIndex.tileOffsets.assign(tileCount + 1, 0);
+    for (Job* job : ownIndex.jobs) {
+        if (job->jobType != JobType::RECHARGE) {
+            ownIndex.tileOffsets[gameMap.getTile(job->targetX, job->targetY).getId() + 1]++;
+        }
+    }
+    for (int tileId = 0; tileId < tileCount; ++tileId) {
+        ownIndex.tileOffsets[tileId + 1] += ownIndex.tileOffsets[tileId];
+    }
+
+    ownIndex.tileJobs.resize(ownIndex.tileOffsets[tileCount]);
+    std::vector<int> next(ownIndex.tileOffsets.begin(), ownIndex.tileOffsets.end() - 1);
+    for (Job* job : ownIndex.jobs) {
+        if (job->jobType != JobType::RECHARGE) {
+            ownIndex.tileJobs[next[gameMap.getTile(job->targetX, job->targetY).getId()]++] = job;
+        }
+    }
 }
 
-std::vector<Job*>& JobBoard::getJobs() {
-    return jobs;
+std::span<Job* const> JobBoard::getJobsAt(int tileId) const {
+    if (tileId < 0 || tileId + 1 >= static_cast<int>(index->tileOffsets.size())) {
+        return {};
+    }
+    return {index->tileJobs.data() + index->tileOffsets[tileId], index->tileJobs.data() + index->tileOffsets[tileId + 1]};
 }
 
 std::unordered_set<int> JobBoard::getJobsForType(JobType jobType) {
     return jobTypeToJobIdMap[jobType];
 }
 
-std::vector<JobApplication> JobBoard::getJobApplicationsForId(int jobId) {
-    return jobApplicationsByJobId[jobId];
+const std::vector<int>& JobBoard::getJobApplicationIdsForId(int jobId) {
+    return jobApplicationIdsByJobId[jobId];
 }
 
 bool JobBoard::isApplicationRiskFree(JobApplication& jobApplication) {
@@ -174,7 +243,7 @@ bool JobBoard::isApplicationRiskFree(JobApplication& jobApplication) {
     }
 
     auto& tile = gameMap.getTileFromActionId(bestPlan[0], shuttleData->getX(), shuttleData->getY());
-    int tileId = tile.getId(gameMap.width);
+    int tileId = tile.getId();
 
     for (const auto& risk : shuttleData->collisionRisks) {
         if (risk.targetTileId == tileId) {
@@ -191,25 +260,60 @@ JobApplication& JobBoard::applyForJob(Job* job, ShuttleData* shuttleData, std::v
 
     if (!isApplicationRiskFree(jobApplication)) {
         jobApplication.setStatus(JobApplicationStatus::RISKY);
-        declinedJobApplications.push_back(jobApplication);
+        declinedJobApplications.push_back(std::move(jobApplication));
         return declinedJobApplications.back();
     }
 
     // APPLIED
-    jobApplications.push_back(jobApplication);
-    jobApplicationsByShuttleId[shuttleData->id].push_back(jobApplication);
-    jobApplicationsByJobId[job->id].push_back(jobApplication);
+    jobApplications.push_back(std::move(jobApplication));
+    jobApplicationIdsByShuttleId[shuttleData->id].push_back(id);
+    jobApplicationIdsByJobId[job->id].push_back(id);
     jobTypeToJobIdMap[job->jobType].insert(job->id);
     
     // log("Application received for job " + job->to_string() + " from shuttle " + shuttleData->to_string());
     return jobApplications.back();
 }
 
-void JobBoard::addJobDeletionExclusion(int jobId) {
-    jobDeletionExclusions.insert(jobId);
+void JobBoard::mergeApplications(JobBoard& child) {
+    // Child ids were assigned from the child's own count, shift them to where they would have been here
+    int offset = jobApplications.size();
+
+    for (auto& jobApplication : child.jobApplications) {
+        jobApplications.push_back(std::move(jobApplication));
+        jobApplications.back().id += offset;
+    }
+
+    for (auto& jobApplication : child.declinedJobApplications) {
+        declinedJobApplications.push_back(std::move(jobApplication));
+        declinedJobApplications.back().id += offset;
+    }
+
+    for (auto& [shuttleId, ids] : child.jobApplicationIdsByShuttleId) {
+        for (int id : ids) {
+            jobApplicationIdsByShuttleId[shuttleId].push_back(id + offset);
+        }
+    }
+
+    for (auto& [jobId, ids] : child.jobApplicationIdsByJobId) {
+        for (int id : ids) {
+            jobApplicationIdsByJobId[jobId].push_back(id + offset);
+        }
+    }
+
+    for (auto& [jobType, jobIds] : child.jobTypeToJobIdMap) {
+        jobTypeToJobIdMap[jobType].insert(jobIds.begin(), jobIds.end());
+    }
+    child.jobApplications.clear();
+    child.declinedJobApplications.clear();
 }
 
 void JobBoard::sortJobApplications(GameMap& gameMap) {
+    int jobApplicationCount = jobApplications.size();
+    sortedJobApplicationIds.resize(jobApplicationCount);
+    for (int id = 0; id < jobApplicationCount; ++id) {
+        sortedJobApplicationIds[id] = id;
+    }
+
     if (Config::prioritizationStrategy == 1) {
         sortJobApplicationsStrategy1(gameMap);
     } else {
@@ -242,7 +346,9 @@ void JobBoard::sortJobApplicationsStrategy1(GameMap& gameMap) {
         }
     };
     
-    std::sort(jobApplications.begin(), jobApplications.end(), compare);
+    std::sort(sortedJobApplicationIds.begin(), sortedJobApplicationIds.end(), [&](int a, int b) {
+        return compare(jobApplications[a], jobApplications[b]);
+    });
 }
 
 /**
@@ -268,7 +374,9 @@ void JobBoard::sortJobApplicationsStrategy0(GameMap& gameMap) {
         } 
     };
     
-    std::sort(jobApplications.begin(), jobApplications.end(), compare);
+    std::sort(sortedJobApplicationIds.begin(), sortedJobApplicationIds.end(), [&](int a, int b) {
+        return compare(jobApplications[a], jobApplications[b]);
+    });
 }
 
 std::vector<JobApplication>& JobBoard::getJobApplications() {
@@ -282,19 +390,3 @@ std::vector<JobApplication>& JobBoard::getDecliendJobApplications() {
 void JobBoard::log(const std::string& message) {
     Logger::getInstance().log("JobBoard -> " + message);
 }
-
-JobBoard::~JobBoard() {
-    log("Destroying job board");
-
-    for (Job* job : jobs) {
-        if (jobDeletionExclusions.find(job->id) == jobDeletionExclusions.end()) {
-            delete job;
-        }
-    }
-    jobs.clear();
-    jobApplications.clear();
-    jobApplicationsByShuttleId.clear();
-    jobApplicationsByJobId.clear();
-    jobTypeToJobIdMap.clear();
-    declinedJobApplications.clear();
-}
@@ -8,6 +8,11 @@
 #include <unordered_set>
 #include <map>
 #include <any>
+#include <array>
+#include <iostream>
+#include <span>
+#include <tuple>
+#include <type_traits>
 
 
 // Priority constants
@@ -32,6 +37,14 @@ enum JobType : std::uint8_t {
     RECHARGE
 };
 
+const int JOB_TYPE_COUNT = RECHARGE + 1;
+
+struct NavigatorJob;
+
+/**
+ * Jobs are plain data tagged with their jobType, no virtual functions. The concrete job is reached with as<T>(), which
+ * checks the tag instead of a dynamic_cast.
+ */
 struct Job {
     int id;
     JobType jobType;
@@ -42,6 +55,7 @@ struct Job {
     Job(int id, JobType jobType);
     Job(int id, JobType jobType, int targetX, int targetY);
 
+    static void log(const std::string& message);
     std::string getJobTypeString(JobType jobType);
 
     std::string to_string() {
@@ -50,17 +64,39 @@ struct Job {
         return ss.str();
     }
 
-    virtual ~Job() = default;
+    template <typename T>
+    bool is() const {
+        if constexpr (std::is_same_v<T, NavigatorJob>) {
+            return jobType == RELIC_MINING_NAVIGATOR || jobType == HALO_NODE_NAVIGATOR || jobType == TRAILBLAZER_NAVIGATOR;
+        } else {
+            return jobType == T::JOB_TYPE;
+        }
+    }
+
+    /**
+     * The concrete job, nullptr if the tag says it is another type
+     */
+    template <typename T>
+    T* as() {
+        if (!is<T>()) {
+            LOG_WARN("Problem: Job type mismatch for " + to_string());
+            std::cerr<<"Problem: Job type mismatch"<<std::endl;
+            return nullptr;
+        }
+        return static_cast<T*>(this);
+    }
 };
 
 // Derived job structures
 struct RechargeJob : Job {
+    static constexpr JobType JOB_TYPE = RECHARGE;
     RechargeJob(int id); // TODO: better to have some points identified as rechargable and let the shuttle decide which one to choose
 
     int preferredShuttle = -1;
 };
 
 struct RelicMinerJob : Job {
+    static constexpr JobType JOB_TYPE = RELIC_MINER;
     RelicMinerJob(int id, int vantagePointX, int vantagePointY);
 };
 
@@ -69,29 +105,76 @@ struct NavigatorJob : Job {
 };
 
 struct RelicMiningNavigatorJob : NavigatorJob {
+    static constexpr JobType JOB_TYPE = RELIC_MINING_NAVIGATOR;
     RelicMiningNavigatorJob(int id, int destinationX, int destinationY);
 };
 
 struct HaloNodeNavigatorJob : NavigatorJob {
+    static constexpr JobType JOB_TYPE = HALO_NODE_NAVIGATOR;
     HaloNodeNavigatorJob(int id, int destinationX, int destinationY);
 };
 
 struct TrailblazerNavigatorJob : NavigatorJob {
+    static constexpr JobType JOB_TYPE = TRAILBLAZER_NAVIGATOR;
     TrailblazerNavigatorJob(int id, int destinationX, int destinationY);
 };
 
 struct HaloNodeExplorerJob : Job {
+    static constexpr JobType JOB_TYPE = HALO_NODE_EXPLORER;
     HaloNodeExplorerJob(int id, int haloNodeX, int haloNodeY);
 };
 
 struct DefenderJob : Job {
+    static constexpr JobType JOB_TYPE = DEFENDER;
+    static constexpr int MAX_OPPONENT_POSITIONS = 9; // The target and its neighbours
+
     DefenderJob(int id, int opponentPositionX, int opponentPositionY);
-    std::vector<std::pair<int, int>> allOpponentPositions;
     int kills;
     int opponentEneryLoss;
     bool isRelicMiningOpponent = false;
     bool defendByCollision = false;
     int preferredShuttle = -1;
+
+    void addOpponentPosition(int x, int y);
+    std::span<const std::pair<int, int>> getAllOpponentPositions() const { return {opponentPositions.data(), static_cast<size_t>(opponentPositionCount)}; }
+
+private:
+    std::array<std::pair<int, int>, MAX_OPPONENT_POSITIONS> opponentPositions;
+    int opponentPositionCount = 0;
+};
+
+/**
+ * Per step storage of the jobs, one contiguous array per job type. The arrays are sized once for the map and reset
+ * every step, so after the first step creating a job allocates nothing. Jobs stay where they are until the next reset.
+ */
+class JobArena {
+private:
+    std::tuple<std::vector<RelicMinerJob>, std::vector<RelicMiningNavigatorJob>, std::vector<HaloNodeExplorerJob>,
+               std::vector<HaloNodeNavigatorJob>, std::vector<DefenderJob>, std::vector<TrailblazerNavigatorJob>,
+               std::vector<RechargeJob>> storage;
+    int capacityPerType = 0;
+
+    void log(const std::string& message);
+
+public:
+    /**
+     * Drops the jobs of the previous step, every type can then hold up to capacityPerType jobs
+     */
+    void reset(int capacityPerType);
+
+    template <typename T, typename... Args>
+    T* create(Args&&... args) {
+        std::vector<T>& jobs = std::get<std::vector<T>>(storage);
+        if (jobs.size() == jobs.capacity()) {
+            // Growing would move the jobs the board already points to
+            LOG_WARN("Problem: Job arena is full for " + std::to_string(T::JOB_TYPE));
+            std::cerr<<"Problem: Job arena is full"<<std::endl;
+            return nullptr;
+        }
+        return &jobs.emplace_back(std::forward<Args>(args)...);
+    }
+
+    int size() const;
 };
 
 //----------------------------------------------
@@ -127,27 +210,46 @@ public:
 
     // Copy and move semantics
     JobApplication(const JobApplication& other);
+    JobApplication(JobApplication&& other) noexcept;
     JobApplication& operator=(const JobApplication& other);
     JobApplication& operator=(JobApplication&& other) noexcept;
 
     void setPriority(int applicationPriority);
     void setStatus(JobApplicationStatus status);
+    JobApplicationStatus getStatus() const { return status; }
 
     std::string to_string();
 };
 
 //----------------------------------------------
 
+/**
+ * The jobs posted on a board, in the order they were posted, and the same jobs grouped by type and by target tile.
+ * Recharge jobs have no target tile.
+ */
+struct JobIndex {
+    std::vector<Job*> jobs;
+    std::array<std::vector<Job*>, JOB_TYPE_COUNT> jobsByType;
+    std::vector<int> tileOffsets; // Tile id -> first of its jobs in tileJobs, one extra entry at the end
+    std::vector<Job*> tileJobs;
+};
+
+/**
+ * Applications are stored once, in the order they were made, and their id is their index. Everything else refers to
+ * them by id, sorting only reorders the ids.
+ */
 class JobBoard {
 private:
-    std::vector<Job*> jobs;
+    GameMap& gameMap;
+    JobIndex ownIndex;
+    const JobIndex* index;
     std::vector<JobApplication> jobApplications;
     std::vector<JobApplication> declinedJobApplications;
-    std::map<int, std::vector<JobApplication>> jobApplicationsByShuttleId;
-    std::map<int, std::vector<JobApplication>> jobApplicationsByJobId;
+    std::vector<int> sortedJobApplicationIds;
+    std::map<int, std::vector<int>> jobApplicationIdsByShuttleId;
+    std::map<int, std::vector<int>> jobApplicationIdsByJobId;
     std::map<JobType, std::unordered_set<int>> jobTypeToJobIdMap;
 
-    std::unordered_set<int> jobDeletionExclusions;
     void log(const std::string& message);
 
     bool isApplicationRiskFree(JobApplication& jobApplication);
@@ -155,20 +257,45 @@ private:
     void sortJobApplicationsStrategy0(GameMap& gameMap);
     void sortJobApplicationsStrategy1(GameMap& gameMap);
 
-    GameMap& gameMap;
 public:
     JobBoard(GameMap& gameMap);
 
+    /**
+     * Board over the parent's jobs that collects its own applications, so one shuttle can survey it off the main thread.
+     */
+    JobBoard(GameMap& gameMap, const JobBoard& parent);
+
     void addJob(Job* job);
-    std::vector<Job*>& getJobs();
+
+    /**
+     * Builds the per tile index, once every job is posted
+     */
+    void indexJobs();
+
+    const std::vector<Job*>& getJobs() const { return index->jobs; }
+    std::span<Job* const> getJobs(JobType jobType) const { return index->jobsByType[jobType]; }
+
+    /**
+     * Jobs targeting the tile in the order they were posted, empty until indexJobs()
+     */
+    std::span<Job* const> getJobsAt(int tileId) const;
+
     std::unordered_set<int> getJobsForType(JobType jobType);
-    std::vector<JobApplication> getJobApplicationsForId(int jobId);
+    const std::vector<int>& getJobApplicationIdsForId(int jobId);
     JobApplication& applyForJob(Job* job, ShuttleData* shuttleData, std::vector<int>&& bestPlan);
+
+    /**
+     * Orders the application ids by the configured strategy, the applications themselves stay in place
+     */
     void sortJobApplications(GameMap& gameMap);
     std::vector<JobApplication>& getJobApplications();
+    const std::vector<int>& getSortedJobApplicationIds() const { return sortedJobApplicationIds; }
     std::vector<JobApplication>& getDecliendJobApplications();
-    void addJobDeletionExclusion(int jobId);
-    ~JobBoard();
+
+    /**
+     * Moves the applications of a child board over as if they had been made on this board, in the same order.
+     */
+    void mergeApplications(JobBoard& child);
 };
 
 #endif // JOBS_H
@@ -0,0 +1,91 @@
+#include "plan_cache.h"
+
+#include "config.h"
+#include "logger.h"
+
+void PlanCache::log(const std::string& message) {
+    Logger::getInstance().log("PlanCache -> " + message);
+}
+
+bool PlanCache::isCacheable(JobType jobType) {
+    return jobType == JobType::RELIC_MINING_NAVIGATOR || jobType == JobType::HALO_NODE_NAVIGATOR || jobType == JobType::TRAILBLAZER_NAVIGATOR;
+}
+
+Job* PlanCache::getJob(const JobBoard& jobBoard) const {
+    for (Job* job : jobBoard.getJobsAt(targetTileId)) {
+        if (job->jobType == jobType) {
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+bool PlanCache::revalidate(const JobBoard& jobBoard, int currentTileId, const std::vector<int>& entryCost, int currentStep) {
+    hit = false;
+    if (!committed) {
+        return false;
+    }
+
+    if (currentStep != step + 1 || currentStep - committedStep > Config::planCacheMaxAge) {
+        LOG_TRACE("Plan expired");
+        invalidate();
+        return false;
+    }
+
+    if (path[position + 1] != currentTileId) {
+        LOG_TRACE("Shuttle left the path");
+        invalidate();
+        return false;
+    }
+    position++;
+
+    if (position == getLastPosition()) {
+        // Arrived, whatever it does on the target is planned again
+        invalidate();
+        return false;
+    }
+
+    for (int i = position + 1; i <= getLastPosition(); ++i) {
+        if (entryCost[path[i]] != entryCosts[i]) {
+            LOG_TRACE("Tile " + std::to_string(path[i]) + " on the path changed");
+            invalidate();
+            return false;
+        }
+    }
+
+    if (getJob(jobBoard) == nullptr) {
+        LOG_TRACE("Job at " + std::to_string(targetTileId) + " is gone");
+        invalidate();
+        return false;
+    }
+
+    step = currentStep;
+    hit = true;
+    return true;
+}
+
+void PlanCache::commit(JobType jobType, int targetTileId, const std::vector<GameTile*>& path, const std::vector<int>& entryCost, int currentStep) {
+    hit = false;
+    if (path.size() < 2) {
+        invalidate();
+        return;
+    }
+
+    committed = true;
+    this->jobType = jobType;
+    this->targetTileId = targetTileId;
+    this->path.clear();
+    entryCosts.clear();
+    for (GameTile* tile : path) {
+        this->path.push_back(tile->getId());
+        entryCosts.push_back(entryCost[tile->getId()]);
+    }
+    position = 0;
+    step = currentStep;
+    committedStep = currentStep;
+}
+
+void PlanCache::invalidate() {
+    committed = false;
+    hit = false;
+}
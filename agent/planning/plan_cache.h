@@ -0,0 +1,64 @@
+#ifndef PLAN_CACHE_H
+#define PLAN_CACHE_H
+
+#include <string>
+#include <vector>
+
+#include "agent/game_map.h"
+#include "agent/planning/jobs.h"
+
+/**
+ * The navigator job a shuttle was assigned and the least energy path to it, kept across steps so the shuttle can
+ * follow the path without planning again. The plan holds while the shuttle moves along it, the job is still posted
+ * and no tile left on the path costs a different amount to enter (an asteroid drifted on it, an opponent was sighted
+ * on it or the energy field moved).
+ */
+class PlanCache {
+    private:
+        bool committed = false;
+        bool hit = false;
+        JobType jobType = JobType::RELIC_MINING_NAVIGATOR;
+        int targetTileId = -1;
+        std::vector<int> path;          // Tile ids, from where the shuttle was when it committed to the target
+        std::vector<int> entryCosts;    // Entry cost of every path tile when the path was found
+        int position = 0;               // Index of the path tile the shuttle is on
+        int step = -1;                  // Last step the plan was confirmed in
+        int committedStep = -1;
+
+        static void log(const std::string& message);
+        int getLastPosition() const { return static_cast<int>(path.size()) - 1; }
+
+    public:
+        /**
+         * Only the navigator jobs have a path worth keeping
+         */
+        static bool isCacheable(JobType jobType);
+
+        /**
+         * Follows the shuttle one tile along the path and checks the rest of it against the current entry costs.
+         * Returns whether the plan still holds, otherwise it is dropped.
+         */
+        bool revalidate(const JobBoard& jobBoard, int currentTileId, const std::vector<int>& entryCost, int currentStep);
+
+        /**
+         * The plan was confirmed in this step, i.e. the last revalidate() returned true
+         */
+        bool isHit() const { return hit; }
+
+        bool holds(JobType jobType, int targetTileId) const { return committed && this->jobType == jobType && this->targetTileId == targetTileId; }
+
+        /**
+         * The committed job on this step's board, nullptr if it is not posted anymore
+         */
+        Job* getJob(const JobBoard& jobBoard) const;
+        int getNextTileId() const { return path[position + 1]; }
+        int getRemainingPathLength() const { return getLastPosition() - position; }
+
+        /**
+         * Commits to the job along the path, which starts at the shuttle's tile
+         */
+        void commit(JobType jobType, int targetTileId, const std::vector<GameTile*>& path, const std::vector<int>& entryCost, int currentStep);
+        void invalidate();
+};
+
+#endif //PLAN_CACHE_H
@@ -1,6 +1,7 @@
 #include "planner.h"
 
-#include <unordered_set>
+#include <memory>
+#include "config.h"
 #include "game_env_config.h"
 
 void Planner::log(const std::string& message) {
@@ -16,34 +17,30 @@ void Planner::populateJobs(JobBoard& jobBoard) {
     for (int x = 0; x < gameEnvConfig.mapWidth; ++x) {
         for (int y = 0; y < gameEnvConfig.mapHeight; ++y) {
             GameTile& currentTile = gameMap.getTile(x, y);
-            int currentTileId = currentTile.getId(gameEnvConfig.mapWidth);
+            int currentTileId = currentTile.getId();
             if (currentTile.isVantagePoint()) {
-                RelicMinerJob* job = new RelicMinerJob(jobIdCounter++, x, y);
-                log("Created RelicMiner job at " + std::to_string(x) + ", " + std::to_string(y));
-                jobBoard.addJob(job);
+                createJob<RelicMinerJob>(jobBoard, jobIdCounter++, x, y);
+                LOG_TRACE("Created RelicMiner job at " + std::to_string(x) + ", " + std::to_string(y));
 
-                RelicMiningNavigatorJob* navigatorJob = new RelicMiningNavigatorJob(jobIdCounter++, x, y);
-                log("Created (Relic) Navigator job at " + std::to_string(x) + ", " + std::to_string(y));
-                jobBoard.addJob(navigatorJob);
+                createJob<RelicMiningNavigatorJob>(jobBoard, jobIdCounter++, x, y);
+                LOG_TRACE("Created (Relic) Navigator job at " + std::to_string(x) + ", " + std::to_string(y));
             }
 
             if (currentTile.isHaloTile()) {
-                HaloNodeExplorerJob* job = new HaloNodeExplorerJob(jobIdCounter++, x, y);
-                log("Created HaloNodeExplorer job at " + std::to_string(x) + ", " + std::to_string(y));
-                jobBoard.addJob(job);
+                createJob<HaloNodeExplorerJob>(jobBoard, jobIdCounter++, x, y);
+                LOG_TRACE("Created HaloNodeExplorer job at " + std::to_string(x) + ", " + std::to_string(y));
 
-                HaloNodeNavigatorJob* navigatorJob = new HaloNodeNavigatorJob(jobIdCounter++, x, y);
-                log("Created (Halo) Navigator job at " + std::to_string(x) + ", " + std::to_string(y));
-                jobBoard.addJob(navigatorJob);
+                createJob<HaloNodeNavigatorJob>(jobBoard, jobIdCounter++, x, y);
+                LOG_TRACE("Created (Halo) Navigator job at " + std::to_string(x) + ", " + std::to_string(y));
             }
 
             // Defend by Sap
             if (battleEvaluator.opponentBattlePoints.find(currentTileId) != battleEvaluator.opponentBattlePoints.end()) {
                 auto& battlePoint =battleEvaluator.opponentBattlePoints[currentTileId];
-                if (battlePoint.possibleKills > 0 || battlePoint.possibleCumulativeOpponentEnergy >= gameEnvConfig.unitSapCost || battlePoint.isRelicMiningOpponent) {
-                    DefenderJob* job = new DefenderJob(jobIdCounter++, x, y);
-                    log("Created Defender job at " + std::to_string(x) + ", " + std::to_string(y));
-                    jobBoard.addJob(job);
+                DefenderJob* job = nullptr;
+                if ((battlePoint.possibleKills > 0 || battlePoint.possibleCumulativeOpponentEnergy >= gameEnvConfig.unitSapCost || battlePoint.isRelicMiningOpponent)
+                        && (job = createJob<DefenderJob>(jobBoard, jobIdCounter++, x, y)) != nullptr) {
+                    LOG_TRACE("Created Defender job at " + std::to_string(x) + ", " + std::to_string(y));
                     job->kills = battlePoint.possibleKills;
                     job->opponentEneryLoss = battlePoint.possibleCumulativeOpponentEnergy;
                     job->isRelicMiningOpponent = battlePoint.isRelicMiningOpponent;
@@ -51,7 +48,7 @@ void Planner::populateJobs(JobBoard& jobBoard) {
                     for (int x = job->targetX - 1; x <= job->targetX + 1; ++x) {
                         for (int y = job->targetY - 1; y <= job->targetY + 1; ++y) {
                             if (gameMap.isValidTile(x, y) && opponentTracker.isOpponentOccupied(x, y)) {
-                                job->allOpponentPositions.push_back(std::make_pair(x, y));
+                                job->addOpponentPosition(x, y);
                             }
                         }
                     }
@@ -62,181 +59,172 @@ void Planner::populateJobs(JobBoard& jobBoard) {
             if (battleEvaluator.crashCollisionPossibilities.find(currentTileId) != battleEvaluator.crashCollisionPossibilities.end()) {
                 auto& crashCollision = battleEvaluator.crashCollisionPossibilities[currentTileId];
                
-                DefenderJob* job = new DefenderJob(jobIdCounter++, x, y);
-                log("Created Defender by collision job at " + std::to_string(x) + ", " + std::to_string(y));
-                jobBoard.addJob(job);
-                job->opponentEneryLoss = std::get<0>(crashCollision);
-                job->kills = std::get<1>(crashCollision);                
-                job->allOpponentPositions.push_back(std::make_pair(x, y));
-                job->defendByCollision = true;
-                job->preferredShuttle = std::get<2>(crashCollision);
+                if (DefenderJob* job = createJob<DefenderJob>(jobBoard, jobIdCounter++, x, y)) {
+                    LOG_TRACE("Created Defender by collision job at " + std::to_string(x) + ", " + std::to_string(y));
+                    job->opponentEneryLoss = std::get<0>(crashCollision);
+                    job->kills = std::get<1>(crashCollision);                
+                    job->addOpponentPosition(x, y);
+                    job->defendByCollision = true;
+                    job->preferredShuttle = std::get<2>(crashCollision);
+                }
             }
 
             if (currentTile.isUnExploredFrontier()) {
-                TrailblazerNavigatorJob* trailblazerJob = new TrailblazerNavigatorJob(jobIdCounter++, x, y);
-                log("Created Trailblazer job at " + std::to_string(x) + ", " + std::to_string(y));
-                jobBoard.addJob(trailblazerJob);
+                createJob<TrailblazerNavigatorJob>(jobBoard, jobIdCounter++, x, y);
+                LOG_TRACE("Created Trailblazer job at " + std::to_string(x) + ", " + std::to_string(y));
             }
 
             if (state.isThereAHuntForRelic() &&
                 (currentTile.isRelicExplorationFrontier1() ||currentTile.isRelicExplorationFrontier2() ||currentTile.isRelicExplorationFrontier3() )){
-                    TrailblazerNavigatorJob* trailblazerJob = new TrailblazerNavigatorJob(jobIdCounter++, x, y);
-                    log("Created Frontier exploration job at " + std::to_string(x) + ", " + std::to_string(y));
-                    jobBoard.addJob(trailblazerJob);
+                    createJob<TrailblazerNavigatorJob>(jobBoard, jobIdCounter++, x, y);
+                    LOG_TRACE("Created Frontier exploration job at " + std::to_string(x) + ", " + std::to_string(y));
             }
         }
     }
 
     //TODO:  Temporarily creating a recharge job for each shuttle
     for (int i = 0; i < gameEnvConfig.maxUnits; ++i) {
-        RechargeJob* rechargeJob = new RechargeJob(jobIdCounter++);        
-        rechargeJob->preferredShuttle = i;
+        if (RechargeJob* rechargeJob = createJob<RechargeJob>(jobBoard, jobIdCounter++)) {
+            rechargeJob->preferredShuttle = i;
+        }
 
-        log("Created Recharge job for shuttle " + std::to_string(i));
-        jobBoard.addJob(rechargeJob);        
+        LOG_TRACE("Created Recharge job for shuttle " + std::to_string(i));
     }
 
 
-    Metrics::getInstance().add("jobs_created", jobIdCounter);
+    Metrics::getInstance().add("jobs_created", jobArena.size());
 }
 
-void Planner::plan() {
-    auto start = std::chrono::high_resolution_clock::now();
+/**
+ * Once the step is out of time the remaining shuttles only apply for the jobs that need no pathing
+ */
+bool Planner::shouldSurveyWithoutPathing() {
+    return stepDeadline != nullptr && stepDeadline->shouldDegrade(STAGE_JOB_ASSIGNMENT);
+}
 
-    log("Planning now");
+/**
+ * Shuttles whose navigator plan survived the changes since the last step follow it instead of planning again
+ */
+void Planner::revalidatePlans(const JobBoard& jobBoard) {
     GameEnvConfig& gameEnvConfig = GameEnvConfig::getInstance();
-    JobBoard jobBoard(gameMap);  
-
-    populateJobs(jobBoard);
-
+    int hits = 0;
+    int replans = 0;
     for (int i = 0; i < gameEnvConfig.maxUnits; ++i) {
-        Shuttle* shuttle = shuttles[i];
-        log("Planning for shuttle " + std::to_string(shuttle->getShuttleData().id));
-
-        shuttles[i]->surveyJobBoard(jobBoard);
-        shuttles[i]->bestPlan.clear();
+        shuttles[i]->revalidatePlan(jobBoard);
+        if (shuttles[i]->isFollowingPlan()) {
+            hits++;
+        } else if (shuttles[i]->getShuttleData().visible) {
+            replans++;
+        }
     }
 
-    Metrics::getInstance().add("job_applications", jobBoard.getJobApplications().size());
-    Metrics::getInstance().add("declined_job_applications", jobBoard.getDecliendJobApplications().size());
-    
-    jobBoard.sortJobApplications(gameMap);
-
-    std::unordered_set<int> assignedShuttleIds;
-    std::unordered_set<int> assignedTilesForRelicMining;
-    std::unordered_set<int> assignedTilesForRelicMiningNavigation;
-    std::unordered_set<int> assignedTilesForHaloNodeExploration;
-    std::unordered_set<int> assignedTilesForHaloNodeNavigation;
-    std::unordered_set<int> assignedTilesForTrailblazing;
-    std::unordered_set<int> assignedTilesForDefending;
-
-    for (auto& jobApplication : jobBoard.getJobApplications()) {
-
-        GameTile& targetTile = gameMap.getTile(jobApplication.job->targetX, jobApplication.job->targetY);
-        int targetId = targetTile.getId(GameEnvConfig::getInstance().mapWidth);
-
-        if (assignedShuttleIds.find(jobApplication.shuttleData->id) != assignedShuttleIds.end()) {
-            //Shuttle already assigned to a higher priority job
-            jobApplication.setStatus(JobApplicationStatus::SHUTTLE_BUSY);
-            continue;
-        }
+    Metrics::getInstance().add("plan_cache_hits", hits);
+    Metrics::getInstance().add("plan_cache_replans", replans);
+    if (hits + replans > 0) {
+        Metrics::getInstance().add("plan_cache_hit_rate", hits / static_cast<float>(hits + replans));
+    }
+}
 
-        if (jobApplication.job->jobType == JobType::RELIC_MINER && 
-            assignedTilesForRelicMining.find(targetId) != assignedTilesForRelicMining.end()) {
-            jobApplication.setStatus(JobApplicationStatus::TARGET_BUSY);            
-            continue;
-        }
+/**
+ * Every shuttle surveys its own child board on the pool, the applications are then merged in shuttle order so the
+ * board ends up exactly as the sequential loop would leave it.
+ */
+void Planner::surveyJobBoardInParallel(JobBoard& jobBoard, bool withPathing) {
+    GameEnvConfig& gameEnvConfig = GameEnvConfig::getInstance();
 
-        if (jobApplication.job->jobType == JobType::RELIC_MINING_NAVIGATOR && 
-            (assignedTilesForRelicMiningNavigation.find(targetId) != assignedTilesForRelicMiningNavigation.end() || 
-            assignedTilesForRelicMining.find(targetId) != assignedTilesForRelicMining.end())) {
-            jobApplication.setStatus(JobApplicationStatus::TARGET_BUSY);
-            continue;
+    // Shared pathing is filled up front, the surveys only read it. The reverse fields are needed even without pathing,
+    // only the forward fields are skipped then
+    std::vector<GameTile*> startTiles;
+    for (int i = 0; withPathing && i < gameEnvConfig.maxUnits; ++i) {
+        ShuttleData& shuttleData = shuttles[i]->getShuttleData();
+        if (shuttleData.visible && !shuttles[i]->isFollowingPlan()) {
+            startTiles.push_back(&gameMap.getTile(shuttleData.getX(), shuttleData.getY()));
         }
+    }
+    pathingService.prepare(startTiles);
 
-        if (jobApplication.job->jobType == JobType::HALO_NODE_EXPLORER && 
-            assignedTilesForHaloNodeExploration.find(targetId) != assignedTilesForHaloNodeExploration.end()) {            
-            jobApplication.setStatus(JobApplicationStatus::TARGET_BUSY);
-            continue;
-        }
+    std::vector<std::unique_ptr<JobBoard>> shuttleBoards;
+    shuttleBoards.reserve(gameEnvConfig.maxUnits);
+    for (int i = 0; i < gameEnvConfig.maxUnits; ++i) {
+        shuttleBoards.push_back(std::make_unique<JobBoard>(gameMap, jobBoard));
+    }
 
-        if (jobApplication.job->jobType == JobType::HALO_NODE_NAVIGATOR && 
-            assignedTilesForHaloNodeNavigation.find(targetId) != assignedTilesForHaloNodeNavigation.end()) {            
-            jobApplication.setStatus(JobApplicationStatus::TARGET_BUSY);
-            continue;
-        }
+    threadPool->parallelFor(gameEnvConfig.maxUnits, [&](int i) {
+        LOG_DEBUG("Planning for shuttle " + std::to_string(shuttles[i]->getShuttleData().id));
+        shuttles[i]->surveyJobBoard(*shuttleBoards[i], withPathing);
+    });
 
-        if (jobApplication.job->jobType == JobType::TRAILBLAZER_NAVIGATOR && 
-            assignedTilesForTrailblazing.find(targetId) != assignedTilesForTrailblazing.end()) {            
-            jobApplication.setStatus(JobApplicationStatus::TARGET_BUSY);
-            continue;
-        }
+    for (int i = 0; i < gameEnvConfig.maxUnits; ++i) {
+        jobBoard.mergeApplications(*shuttleBoards[i]);
+        shuttles[i]->bestPlan.clear();
+    }
+}
 
-        if (jobApplication.job->jobType == JobType::DEFENDER) {
-            if (assignedTilesForDefending.find(targetId) != assignedTilesForDefending.end()) {
-                jobApplication.setStatus(JobApplicationStatus::TARGET_BUSY);
-                continue;
-            }
+void Planner::plan() {
+    auto start = std::chrono::high_resolution_clock::now();
 
-            DefenderJob* defenderJob = dynamic_cast<DefenderJob*>(jobApplication.job);
-            
-            bool targetBusy = false;
-            for (auto& opponentXYPair: defenderJob->allOpponentPositions) {
-                int tileId = gameMap.getTile(opponentXYPair.first, opponentXYPair.second).getId(GameEnvConfig::getInstance().mapWidth);
-                if (assignedTilesForDefending.find(tileId) != assignedTilesForDefending.end()) {
-                    jobApplication.setStatus(JobApplicationStatus::TARGET_BUSY);
-                    targetBusy = true;
-                    continue;
-                }
-            }
+    LOG_DEBUG("Planning now");
+    GameEnvConfig& gameEnvConfig = GameEnvConfig::getInstance();
+    JobBoard jobBoard(gameMap);  
+    // Every tile posts at most two jobs of a type, e.g. a sap and a collision defender
+    jobArena.reset(2 * gameEnvConfig.mapWidth * gameEnvConfig.mapHeight + gameEnvConfig.maxUnits);
+    pathingService.beginStep();
+    if (stepDeadline != nullptr) {
+        stepDeadline->startStage(STAGE_JOB_ASSIGNMENT);
+    }
 
-            if (targetBusy) {
-                continue;
-            }
-        }
+    populateJobs(jobBoard);
+    jobBoard.indexJobs();
 
-        // Job Assignment Confirmed :: Below this point is a success case!
-        // Copy and assign unique pointer to currentJob        //TODO: Revisit this mess!
-        // shuttles[jobApplication.shuttleData->id]->currentJob = jobApplication.job; // Do not delete this pointer.  It is owned by the shuttle now.
-        shuttles[jobApplication.shuttleData->id]->bestPlan = jobApplication.bestPlan;
-        // jobBoard.addJobDeletionExclusion(jobApplication.id);
+    if (Config::planCache) {
+        revalidatePlans(jobBoard);
+    }
 
-        log("JobApplication accepted " + jobApplication.to_string());
+    // Decided once for every shuttle, so the board doesn't depend on when the deadline hits or how the pool schedules
+    bool withPathing = !shouldSurveyWithoutPathing();
 
-        jobApplication.setStatus(JobApplicationStatus::ACCEPTED);
-        assignedShuttleIds.insert(jobApplication.shuttleData->id);
+    if (threadPool != nullptr) {
+        surveyJobBoardInParallel(jobBoard, withPathing);
+    } else {
+        for (int i = 0; i < gameEnvConfig.maxUnits; ++i) {
+            Shuttle* shuttle = shuttles[i];
+            LOG_DEBUG("Planning for shuttle " + std::to_string(shuttle->getShuttleData().id));
 
-        if (jobApplication.job->jobType == JobType::RELIC_MINER) {
-            assignedTilesForRelicMining.insert(targetId);
+            shuttles[i]->surveyJobBoard(jobBoard, withPathing);
+            shuttles[i]->bestPlan.clear();
         }
+    }
 
-        if (jobApplication.job->jobType == JobType::RELIC_MINING_NAVIGATOR) {
-            assignedTilesForRelicMiningNavigation.insert(targetId);
-        }
+    pathingService.endStep();
 
-        if (jobApplication.job->jobType == JobType::HALO_NODE_EXPLORER) {
-            assignedTilesForHaloNodeExploration.insert(targetId);
-        }
+    Metrics::getInstance().add("job_applications", jobBoard.getJobApplications().size());
+    Metrics::getInstance().add("declined_job_applications", jobBoard.getDecliendJobApplications().size());
+    
+    jobBoard.sortJobApplications(gameMap);
 
-        if (jobApplication.job->jobType == JobType::HALO_NODE_NAVIGATOR) {
-            assignedTilesForHaloNodeNavigation.insert(targetId);
-        }
+    jobAssignment.reset(gameEnvConfig.maxUnits);
+    if (Config::prioritizationStrategy == 2) {
+        jobAssignment.assignOptimally(jobBoard);
+    } else {
+        jobAssignment.assignGreedily(jobBoard, jobBoard.getSortedJobApplicationIds());
+    }
 
-        if (jobApplication.job->jobType == JobType::TRAILBLAZER_NAVIGATOR) {
-            assignedTilesForTrailblazing.insert(targetId);
+    // Job Assignment Confirmed
+    std::vector<const JobApplication*> acceptedApplications(gameEnvConfig.maxUnits, nullptr);
+    for (int jobApplicationId : jobAssignment.getAcceptedIds()) {
+        JobApplication& jobApplication = jobBoard.getJobApplications()[jobApplicationId];
+        shuttles[jobApplication.shuttleData->id]->bestPlan = jobApplication.bestPlan;
+        acceptedApplications[jobApplication.shuttleData->id] = &jobApplication;
+    }
+    if (Config::planCache) {
+        for (int i = 0; i < gameEnvConfig.maxUnits; ++i) {
+            shuttles[i]->commitPlan(acceptedApplications[i]);
         }
+    }
+    Metrics::getInstance().add("assigned_priority", jobAssignment.getAssignedPriority());
 
-        if (jobApplication.job->jobType == JobType::DEFENDER) {
-            assignedTilesForDefending.insert(targetId);
-
-            DefenderJob* defenderJob = dynamic_cast<DefenderJob*>(jobApplication.job);
-
-             for (auto& opponentXYPair: defenderJob->allOpponentPositions) {
-                int tileId = gameMap.getTile(opponentXYPair.first, opponentXYPair.second).getId(GameEnvConfig::getInstance().mapWidth);
-                assignedTilesForDefending.insert(tileId);
-             }
-        }
-        
+    if (stepDeadline != nullptr) {
+        stepDeadline->endStage(STAGE_JOB_ASSIGNMENT);
     }
 
     auto end = std::chrono::high_resolution_clock::now();
@@ -4,23 +4,51 @@
 #include "agent/battle_evaluator.h"
 #include "agent/shuttle.h"
 #include "agent/planning/jobs.h"
+#include "agent/planning/job_assignment.h"
 #include "agent/opponent_tracker.h"
+#include "agent/pathing_service.h"
+#include "agent/step_deadline.h"
+#include "datastructures/thread_pool.h"
 
 class Planner {
     private:
         void log(const std::string& message);
         void populateJobs(JobBoard& jobBoard);
+
+        /**
+         * Creates the job in the arena and posts it on the board, nullptr if the arena is full
+         */
+        template <typename T, typename... Args>
+        T* createJob(JobBoard& jobBoard, Args&&... args) {
+            T* job = jobArena.create<T>(std::forward<Args>(args)...);
+            if (job != nullptr) {
+                jobBoard.addJob(job);
+            }
+            return job;
+        }
         
         GameMap &gameMap;
         OpponentTracker& opponentTracker;
         BattleEvaluator& battleEvaluator;
+        PathingService& pathingService;
+        ThreadPool* threadPool;
+        StepDeadline* stepDeadline;
+
+        JobArena jobArena;
+        JobAssignment jobAssignment;
+
+        bool shouldSurveyWithoutPathing();
+        void surveyJobBoardInParallel(JobBoard& jobBoard, bool withPathing);
+        void revalidatePlans(const JobBoard& jobBoard);
         
     protected:
         Shuttle** shuttles;
 
     public:
-        Planner(Shuttle** shuttles, GameMap& gameMap, OpponentTracker& opponentTracker, BattleEvaluator& battleEvaluator) 
-                : shuttles(shuttles), gameMap(gameMap), opponentTracker(opponentTracker), battleEvaluator(battleEvaluator) {};
+        Planner(Shuttle** shuttles, GameMap& gameMap, OpponentTracker& opponentTracker, BattleEvaluator& battleEvaluator, PathingService& pathingService,
+                ThreadPool* threadPool = nullptr, StepDeadline* stepDeadline = nullptr) 
+                : shuttles(shuttles), gameMap(gameMap), opponentTracker(opponentTracker), battleEvaluator(battleEvaluator), pathingService(pathingService),
+                  threadPool(threadPool), stepDeadline(stepDeadline), jobAssignment(gameMap) {};
 
         void plan();
 };
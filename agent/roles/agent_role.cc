@@ -10,6 +10,10 @@ void AgentRole::setLeastEnergyPathing(Pathing *leastEnergyPathing) {
     this->leastEnergyPathing = leastEnergyPathing; // Set least path strategy
 }
 
+void AgentRole::setPathingService(PathingService *pathingService) {
+    this->pathingService = pathingService;
+}
+
 Direction AgentRole::getDirectionTo(const GameTile& destinationTile) {
     int currentX = shuttle.position[0];
     int currentY = shuttle.position[1];
@@ -38,6 +42,6 @@ std::tuple<int, int> AgentRole::getRelativePosition(const GameTile& destinationT
     return std::make_tuple(destinationX - currentX, destinationY - currentY);
 }
 
-AgentRole::AgentRole(ShuttleData &shuttle, GameMap &gameMap) : shuttle(shuttle), gameMap(gameMap), leastEnergyPathing(nullptr) {
+AgentRole::AgentRole(ShuttleData &shuttle, GameMap &gameMap) : shuttle(shuttle), gameMap(gameMap), leastEnergyPathing(nullptr), pathingService(nullptr) {
     roleClassName = "AgentRole";
 }
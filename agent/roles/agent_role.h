@@ -4,6 +4,7 @@
 #include "agent/shuttle_data.h"
 #include "agent/game_map.h"
 #include "agent/pathing.h"
+#include "agent/pathing_service.h"
 #include "agent/roles/communicator.h"
 #include "agent/planning/jobs.h"
 
@@ -16,15 +17,22 @@ class AgentRole {
         GameMap& gameMap;
         ShuttleData& shuttle;
         Pathing* leastEnergyPathing;
+        PathingService* pathingService;
 
         void log(const std::string& message);
         
     public:
         void setLeastEnergyPathing(Pathing *leastEnergyPathing);
+        void setPathingService(PathingService *pathingService);
         Direction getDirectionTo(const GameTile &destinationTile);
         std::tuple<int, int> getRelativePosition(const GameTile &destinationTile);
         AgentRole(ShuttleData& shuttle, GameMap& gameMap);
         virtual void surveyJobBoard(JobBoard& jobBoard) = 0;
+
+        /**
+         * Applies along a least energy path, skipped while the shuttle follows a cached plan
+         */
+        virtual bool plansPaths() const { return false; }
         virtual ~AgentRole() = default;
 };
 
@@ -33,6 +41,10 @@ class RechargeAgentRole : public AgentRole {
         using AgentRole::AgentRole;
         RechargeAgentRole(ShuttleData& shuttle, GameMap& gamemap);
 
+        /**
+         * Without a least energy pathing (a cached plan is followed or the step is out of time) it heads for the
+         * nearest recharge tile of the reverse field
+         */
         void surveyJobBoard(JobBoard& jobBoard) override;
 };
 
@@ -43,9 +55,18 @@ class ExplorerAgentRole : public AgentRole {
 
 class NavigatorAgentRole: public AgentRole {
     protected:
-        void surveyJob(JobBoard& jobBoard, Job *job);
+        /**
+         * Without a least energy pathing (the step is out of time) only the nearest target of the field is surveyed
+         */
+        void surveyJob(JobBoard& jobBoard, Job *job, const DistanceField& targetField);
+
+        /**
+         * Surveys the jobs of the type, only the ones on the nearest target tile without a least energy pathing
+         */
+        void surveyJobs(JobBoard& jobBoard, JobType jobType, const DistanceField& targetField);
     public:
         using AgentRole::AgentRole;
+        bool plansPaths() const override { return true; }
 };
 
 class RelicMinerAgentRole : public AgentRole {
@@ -13,38 +13,39 @@ void DefenderAgentRole::surveyJobBoard(JobBoard& jobBoard) {
         return;
     }
     
-    for (Job* job : jobBoard.getJobs()) {
-        if (job->jobType == JobType::DEFENDER) {
-            DefenderJob* defenderJob = static_cast<DefenderJob*>(job);
-            
-            GameTile& targetTile = gameMap.getTile(defenderJob->targetX, defenderJob->targetY);
-
-            if (defenderJob->defendByCollision) {
-                
-                if (defenderJob->preferredShuttle != shuttle.id) {
-                    // This job is not intended for this shuttle
-                    return;
-                }
-
-                Direction direction = getDirectionTo(targetTile);
+    for (Job* job : jobBoard.getJobs(JobType::DEFENDER)) {
+        DefenderJob* defenderJob = job->as<DefenderJob>();
+        if (defenderJob == nullptr) {
+            continue;
+        }
+        
+        GameTile& targetTile = gameMap.getTile(defenderJob->targetX, defenderJob->targetY);
 
-                std::vector<int> bestPlan = {directionToInt(direction), 0, 0};
-                log("Colloiding with tile - " + std::to_string(defenderJob->targetX) + ", " + std::to_string(defenderJob->targetY));
-                JobApplication* jobApplication = &jobBoard.applyForJob(job, &shuttle, std::move(bestPlan));
+        if (defenderJob->defendByCollision) {
+            
+            if (defenderJob->preferredShuttle != shuttle.id) {
+                // This job is not intended for this shuttle
+                return;
+            }
+
+            Direction direction = getDirectionTo(targetTile);
+
+            std::vector<int> bestPlan = {directionToInt(direction), 0, 0};
+            LOG_DEBUG("Colloiding with tile - " + std::to_string(defenderJob->targetX) + ", " + std::to_string(defenderJob->targetY));
+            JobApplication* jobApplication = &jobBoard.applyForJob(job, &shuttle, std::move(bestPlan));
+            jobApplication->setPriority(defenderJob->kills * 100 + defenderJob->opponentEneryLoss);
+
+        } else if (std::abs(defenderJob->targetX - shuttle.getX()) <= gameEnvConfig.unitSapRange && std::abs(defenderJob->targetY - shuttle.getY()) <= gameEnvConfig.unitSapRange) {                                
+
+            std::tuple<int, int> relativePosition = getRelativePosition(targetTile);
+            std::vector<int> bestPlan = {5, std::get<0>(relativePosition), std::get<1>(relativePosition)};
+            LOG_DEBUG("Attacking tile - " + std::to_string(defenderJob->targetX) + ", " + std::to_string(defenderJob->targetY));
+            JobApplication* jobApplication = &jobBoard.applyForJob(job, &shuttle, std::move(bestPlan));
+            if (defenderJob->isRelicMiningOpponent) {
+                jobApplication->setPriority( defenderJob->kills * 100 + defenderJob->opponentEneryLoss + 1000);
+            } else {
                 jobApplication->setPriority(defenderJob->kills * 100 + defenderJob->opponentEneryLoss);
-
-            } else if (std::abs(defenderJob->targetX - shuttle.getX()) <= gameEnvConfig.unitSapRange && std::abs(defenderJob->targetY - shuttle.getY()) <= gameEnvConfig.unitSapRange) {                                
-
-                std::tuple<int, int> relativePosition = getRelativePosition(targetTile);
-                std::vector<int> bestPlan = {5, std::get<0>(relativePosition), std::get<1>(relativePosition)};
-                log("Attacking tile - " + std::to_string(defenderJob->targetX) + ", " + std::to_string(defenderJob->targetY));
-                JobApplication* jobApplication = &jobBoard.applyForJob(job, &shuttle, std::move(bestPlan));
-                if (defenderJob->isRelicMiningOpponent) {
-                    jobApplication->setPriority( defenderJob->kills * 100 + defenderJob->opponentEneryLoss + 1000);
-                } else {
-                    jobApplication->setPriority(defenderJob->kills * 100 + defenderJob->opponentEneryLoss);
-                }
-            }            
-        }
+            }
+        }            
     }
 }
\ No newline at end of file
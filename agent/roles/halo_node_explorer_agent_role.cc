@@ -39,16 +39,14 @@ int HaloNodeExplorerAgentRole::removeOutOfBounds(int moveId, int x, int y) {
 
 void HaloNodeExplorerAgentRole::surveyJobBoard(JobBoard& jobBoard) {
 
-    for (Job* job : jobBoard.getJobs()) {
+    // Only a job on the tile the shuttle is on can be explored
+    for (Job* job : jobBoard.getJobsAt(gameMap.getTile(shuttle.getX(), shuttle.getY()).getId())) {
         if (job->jobType == JobType::HALO_NODE_EXPLORER) {
-            HaloNodeExplorerJob* haloNodeExplorerJob = static_cast<HaloNodeExplorerJob*>(job);
-            if (haloNodeExplorerJob->targetX == shuttle.getX() && haloNodeExplorerJob->targetY == shuttle.getY()) {
-                int moveId = dis(gen);
-                moveId = removeOutOfBounds(moveId, shuttle.getX(), shuttle.getY());
-                std::vector<int> bestPlan = {moveId, 0, 0};
-                JobApplication* jobApplication = &jobBoard.applyForJob(job, &shuttle, std::move(bestPlan));
-                jobApplication->setPriority(1); 
-            }
+            int moveId = dis(gen);
+            moveId = removeOutOfBounds(moveId, shuttle.getX(), shuttle.getY());
+            std::vector<int> bestPlan = {moveId, 0, 0};
+            JobApplication* jobApplication = &jobBoard.applyForJob(job, &shuttle, std::move(bestPlan));
+            jobApplication->setPriority(1); 
         }
     }
 
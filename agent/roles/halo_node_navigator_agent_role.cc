@@ -12,9 +12,12 @@ void HaloNodeNavigatorAgentRole::surveyJobBoard(JobBoard& jobBoard) {
         return;
     }
 
-    for (Job* job : jobBoard.getJobs()) {
-        if (job->jobType == JobType::HALO_NODE_NAVIGATOR) {
-            surveyJob(jobBoard, job);
-        }
+    GameTile& currentTile = gameMap.getTile(shuttle.getX(), shuttle.getY());
+    const DistanceField& targetField = pathingService->getHaloTileField();
+    if (!targetField.canReachAny(currentTile)) {
+        // No halo tile is reachable from here
+        return;
     }
+
+    surveyJobs(jobBoard, JobType::HALO_NODE_NAVIGATOR, targetField);
 }
\ No newline at end of file
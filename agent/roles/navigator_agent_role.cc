@@ -1,23 +1,55 @@
 #include "agent_role.h"
 
-void NavigatorAgentRole::surveyJob(JobBoard& jobBoard, Job* job) {
-    // log("Evaluating job " + job->to_string());
-    NavigatorJob* navigatorJob = static_cast<NavigatorJob*>(job);
+void NavigatorAgentRole::surveyJobs(JobBoard& jobBoard, JobType jobType, const DistanceField& targetField) {
+    if (leastEnergyPathing != nullptr) {
+        for (Job* job : jobBoard.getJobs(jobType)) {
+            surveyJob(jobBoard, job, targetField);
+        }
+        return;
+    }
+
+    // Every other job of the type would be turned down by surveyJob anyway
+    GameTile& currentTile = gameMap.getTile(shuttle.getX(), shuttle.getY());
+    for (Job* job : jobBoard.getJobsAt(targetField.getNearestTarget(currentTile))) {
+        if (job->jobType == jobType) {
+            surveyJob(jobBoard, job, targetField);
+        }
+    }
+}
 
-    for (const auto [distance, destinationTile] : leastEnergyPathing->allDestinations) { //TODO: change this to a hashMap instead of loop
+void NavigatorAgentRole::surveyJob(JobBoard& jobBoard, Job* job, const DistanceField& targetField) {
+    // log("Evaluating job " + job->to_string());
+    NavigatorJob* navigatorJob = job->as<NavigatorJob>();
 
-        if (destinationTile->x == navigatorJob->targetX && destinationTile->y == navigatorJob->targetY) {
-            // log("Found the destination tile - (" + std::to_string(destinationTile->x) + ", " + std::to_string(destinationTile->y) + ") with distance " + std::to_string(distance));
-            std::vector<GameTile*> pathToDestination = leastEnergyPathing->distances[destinationTile].second;
-            if (pathToDestination.size() < 2) {
-                // log("We are already in the closest destination tile");
-                continue;
-            }
-            Direction direction = getDirectionTo(*pathToDestination[1]);
+    if (navigatorJob == nullptr || !gameMap.isValidTile(navigatorJob->targetX, navigatorJob->targetY)) {
+        return;
+    }
 
-            std::vector<int> bestPlan = {directionToInt(direction), 0, 0};
-            JobApplication* jobApplication = &jobBoard.applyForJob(job, &shuttle, std::move(bestPlan));
-            jobApplication->setPriority(-1 * (pathToDestination.size() - 1)); //Bigger number wins, hence the * -1
+    GameTile& destinationTile = gameMap.getTile(navigatorJob->targetX, navigatorJob->targetY);
+    int pathLength;
+    GameTile* nextTile;
+    if (leastEnergyPathing != nullptr) {
+        if (!leastEnergyPathing->isReachable(destinationTile)) {
+            return;
+        }
+        pathLength = leastEnergyPathing->getPathLength(destinationTile);
+        nextTile = leastEnergyPathing->getNextTile(destinationTile);
+    } else {
+        GameTile& currentTile = gameMap.getTile(shuttle.getX(), shuttle.getY());
+        if (targetField.getNearestTarget(currentTile) != destinationTile.getId()) {
+            return;
         }
+        pathLength = targetField.getPathLength(currentTile);
+        nextTile = targetField.getNextTile(currentTile);
     }
+
+    if (pathLength < 1) {
+        // log("We are already in the closest destination tile");
+        return;
+    }
+    Direction direction = getDirectionTo(*nextTile);
+
+    std::vector<int> bestPlan = {directionToInt(direction), 0, 0};
+    JobApplication* jobApplication = &jobBoard.applyForJob(job, &shuttle, std::move(bestPlan));
+    jobApplication->setPriority(-1 * pathLength); //Bigger number wins, hence the * -1
 }
\ No newline at end of file
@@ -6,31 +6,38 @@ RechargeAgentRole::RechargeAgentRole(ShuttleData& shuttle, GameMap& gameMap) : A
 
 
 void RechargeAgentRole::surveyJobBoard(JobBoard& jobBoard) {
-    for (Job* job : jobBoard.getJobs()) {
-        if (job->jobType == JobType::RECHARGE) {
-            RechargeJob* rechargeJob = static_cast<RechargeJob*>(job);
-            if (rechargeJob->preferredShuttle != shuttle.id) {
-                // Recharge is not intended for this shuttle
-                continue;
-            }
+    if (leastEnergyPathing == nullptr && pathingService == nullptr) {
+        return;
+    }
 
-            GameTile& startTile = gameMap.getTile(shuttle.getX(), shuttle.getY());
+    for (Job* job : jobBoard.getJobs(JobType::RECHARGE)) {
+        RechargeJob* rechargeJob = job->as<RechargeJob>();
+        if (rechargeJob == nullptr || rechargeJob->preferredShuttle != shuttle.id) {
+            // Recharge is not intended for this shuttle
+            continue;
+        }
 
-            if (startTile.getLastKnownEnergy() > 0) {
-                // Already charging
-                continue;
-            }
+        GameTile& startTile = gameMap.getTile(shuttle.getX(), shuttle.getY());
+
+        if (startTile.getLastKnownEnergy() > 0) {
+            // Already charging
+            continue;
+        }
 
+        int pathLength;
+        GameTile* nextTile;
+        if (leastEnergyPathing != nullptr) {
             int shortedDistance = std::numeric_limits<int>::max();
             GameTile* shortestDestinationTile = nullptr;
 
-            for (const auto [distance, destinationTile] : leastEnergyPathing->allDestinations) { //TODO: change this to a hashMap instead of loop
+            for (const auto [distance, destinationTile] : leastEnergyPathing->allDestinations) {
 
                 if (distance < shortedDistance && destinationTile->getLastKnownEnergy() > 0 && gameMap.getEstimatedType(*destinationTile, gameMap.derivedGameState.currentStep) != TileType::NEBULA) {
 
                     // Shortest distance with positive energy
                     shortedDistance = distance;
                     shortestDestinationTile = destinationTile;
+                    break; // Destinations are in increasing distance, the first match is the closest
                 }
             }
 
@@ -39,17 +46,27 @@ void RechargeAgentRole::surveyJobBoard(JobBoard& jobBoard) {
                 continue;
             }
 
-            std::vector<GameTile*> pathToDestination = leastEnergyPathing->distances[shortestDestinationTile].second;
-            if (pathToDestination.size() < 2) {
-                // We are already on the positive tile
+            pathLength = leastEnergyPathing->getPathLength(*shortestDestinationTile);
+            nextTile = pathLength < 1 ? nullptr : leastEnergyPathing->getNextTile(*shortestDestinationTile);
+        } else {
+            // Following a cached plan or out of time, the nearest recharge tile of the reverse field
+            const DistanceField& rechargeField = pathingService->getRechargeField();
+            if (!rechargeField.canReachAny(startTile)) {
                 continue;
             }
+            pathLength = rechargeField.getPathLength(startTile);
+            nextTile = rechargeField.getNextTile(startTile);
+        }
 
-            Direction direction = getDirectionTo(*pathToDestination[1]);
-            std::vector<int> bestPlan = {directionToInt(direction), 0, 0};
-            JobApplication* jobApplication = &jobBoard.applyForJob(job, &shuttle, std::move(bestPlan));
-            jobApplication->setPriority(-1 * (pathToDestination.size() - 1)); //Bigger number wins, hence the * -1            
-            log("Shuttle " + std::to_string(shuttle.id) + " applied for recharge job with priority " + std::to_string(jobApplication->priority));
+        if (pathLength < 1) {
+            // We are already on the positive tile
+            continue;
         }
+
+        Direction direction = getDirectionTo(*nextTile);
+        std::vector<int> bestPlan = {directionToInt(direction), 0, 0};
+        JobApplication* jobApplication = &jobBoard.applyForJob(job, &shuttle, std::move(bestPlan));
+        jobApplication->setPriority(-1 * pathLength); //Bigger number wins, hence the * -1            
+        LOG_DEBUG("Shuttle " + std::to_string(shuttle.id) + " applied for recharge job with priority " + std::to_string(jobApplication->priority));
     }
 }
\ No newline at end of file
@@ -6,14 +6,12 @@ RelicMinerAgentRole::RelicMinerAgentRole(ShuttleData& shuttle, GameMap& gameMap)
 
 void RelicMinerAgentRole::surveyJobBoard(JobBoard& jobBoard) {
 
-    for (Job* job : jobBoard.getJobs()) {
+    // Only a job on the tile the shuttle is on can be mined
+    for (Job* job : jobBoard.getJobsAt(gameMap.getTile(shuttle.getX(), shuttle.getY()).getId())) {
         if (job->jobType == JobType::RELIC_MINER) {
-            RelicMinerJob* relicMinerJob = static_cast<RelicMinerJob*>(job);
-            if (relicMinerJob->targetX == shuttle.getX() && relicMinerJob->targetY == shuttle.getY()) {                
-                std::vector<int> bestPlan = {Direction::CENTER, 0, 0};
-                JobApplication* jobApplication = &jobBoard.applyForJob(job, &shuttle, std::move(bestPlan));
-                jobApplication->setPriority(1);
-            }
+            std::vector<int> bestPlan = {Direction::CENTER, 0, 0};
+            JobApplication* jobApplication = &jobBoard.applyForJob(job, &shuttle, std::move(bestPlan));
+            jobApplication->setPriority(1);
         }
     }
 }
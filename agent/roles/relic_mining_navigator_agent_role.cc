@@ -12,9 +12,12 @@ void RelicMiningNavigatorAgentRole::surveyJobBoard(JobBoard& jobBoard) {
         return;
     }
 
-    for (Job* job : jobBoard.getJobs()) {
-        if (job->jobType == JobType::RELIC_MINING_NAVIGATOR) {
-            surveyJob(jobBoard, job);
-        }
+    GameTile& currentTile = gameMap.getTile(shuttle.getX(), shuttle.getY());
+    const DistanceField& targetField = pathingService->getVantagePointField();
+    if (!targetField.canReachAny(currentTile)) {
+        // No vantage point is reachable from here
+        return;
     }
+
+    surveyJobs(jobBoard, JobType::RELIC_MINING_NAVIGATOR, targetField);
 }
\ No newline at end of file
@@ -12,9 +12,12 @@ void TrailblazerAgentRole::surveyJobBoard(JobBoard& jobBoard) {
         return;
     }
 
-    for (Job* job : jobBoard.getJobs()) {
-        if (job->jobType == JobType::TRAILBLAZER_NAVIGATOR) {
-            surveyJob(jobBoard, job);
-        }
+    GameTile& currentTile = gameMap.getTile(shuttle.getX(), shuttle.getY());
+    const DistanceField& targetField = pathingService->getFrontierField();
+    if (!targetField.canReachAny(currentTile)) {
+        // No frontier is reachable from here
+        return;
     }
+
+    surveyJobs(jobBoard, JobType::TRAILBLAZER_NAVIGATOR, targetField);
 }
\ No newline at end of file
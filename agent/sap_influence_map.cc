@@ -0,0 +1,60 @@
+#include "sap_influence_map.h"
+
+#include <algorithm>
+
+#include "constants.h"
+
+/**
+ * out[i] = OR of in[i - radius .. i + radius] along one line (van Herk / Gil-Werman). The line is padded with the
+ * radius on both ends and cut in blocks of the window size, every window then ends in the block after the one it
+ * starts in, or fills a block exactly, and is one suffix OR one prefix.
+ */
+void SapInfluenceMap::dilateLine(const uint64_t* in, uint64_t* out, int stride, int length, int radius) {
+    const int window = 2 * radius + 1;
+    const int padded = length + 2 * radius;
+    prefix.resize(padded);
+    suffix.resize(padded);
+
+    for (int j = 0; j < padded; ++j) {
+        int i = j - radius;
+        uint64_t value = i >= 0 && i < length ? in[i * stride] : 0;
+        prefix[j] = j % window == 0 ? value : prefix[j - 1] | value;
+    }
+    for (int j = padded - 1; j >= 0; --j) {
+        int i = j - radius;
+        uint64_t value = i >= 0 && i < length ? in[i * stride] : 0;
+        suffix[j] = j % window == window - 1 || j == padded - 1 ? value : suffix[j + 1] | value;
+    }
+
+    for (int i = 0; i < length; ++i) {
+        out[i * stride] = suffix[i] | prefix[i + 2 * radius];
+    }
+}
+
+void SapInfluenceMap::compute(FlatArray3D<double>& probabilities, int opponents, int radius) {
+    const int size = width * height;
+    scratch.assign(size, 0);
+    influence.resize(size);
+
+    for (int s = 0; s < std::min(opponents, MAX_OPPONENTS); ++s) {
+        const uint64_t bit = 1ULL << s;
+        auto positions = probabilities[s];
+        for (int x = 0; x < width; ++x) {
+            const double* column = positions[x];
+            for (int y = 0; y < height; ++y) {
+                if (column[y] > LOWEST_DOUBLE) {
+                    scratch[y * width + x] |= bit;
+                }
+            }
+        }
+    }
+
+    radius = std::max(radius, 0);
+    for (int y = 0; y < height; ++y) {
+        dilateLine(&scratch[y * width], &influence[y * width], 1, width, radius);
+    }
+    for (int x = 0; x < width; ++x) {
+        dilateLine(&influence[x], &scratch[x], width, height, radius);
+    }
+    influence.swap(scratch);
+}
@@ -0,0 +1,41 @@
+#ifndef SAP_INFLUENCE_MAP_H
+#define SAP_INFLUENCE_MAP_H
+
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+#include "datastructures/flat_array.h"
+
+/**
+ * For every tile the opponents that could have sapped it last step, one bit per opponent. An opponent counts when a
+ * possible previous position of it is within the radius (Chebyshev) of the tile. Built once per step and shared by
+ * every shuttle, each opponent's positions are spread with a separable sliding window OR, so building it costs the
+ * same whatever the radius.
+ */
+class SapInfluenceMap {
+    private:
+        int width;
+        int height;
+        std::vector<uint64_t> influence;    // Tile id -> opponents
+        std::vector<uint64_t> scratch;
+        std::vector<uint64_t> prefix;
+        std::vector<uint64_t> suffix;
+
+        void dilateLine(const uint64_t* in, uint64_t* out, int stride, int length, int radius);
+
+    public:
+        static constexpr int MAX_OPPONENTS = 64;
+
+        SapInfluenceMap(int width, int height): width(width), height(height) {}
+
+        /**
+         * probabilities[opponent][x][y] of the opponents' previous positions, any chance above LOWEST_DOUBLE counts
+         */
+        void compute(FlatArray3D<double>& probabilities, int opponents, int radius);
+
+        uint64_t getOpponents(int tileId) const { return influence[tileId]; }
+        int countOpponents(int tileId) const { return std::popcount(influence[tileId]); }
+};
+
+#endif // SAP_INFLUENCE_MAP_H
@@ -2,6 +2,7 @@
 #include "shuttle.h"
 #include <tuple>
 #include <utility>
+#include "game_env_config.h"
 #include "metrics.h"
 
 void Shuttle::log(const std::string& message) {
@@ -12,9 +13,10 @@ void Shuttle::log(const std::string& message) {
     Logger::getInstance().log(visibilityMark + "Shuttle-" + std::to_string(shuttleData.id) + " -> " + message);
 }
 
-void Shuttle::updateUnitsData(std::vector<int> position, int energy, int timestep) {
+void Shuttle::updateUnitsData(int x, int y, int energy, int timestep) {
     this->shuttleData.previousPosition = this->shuttleData.position;
-    this->shuttleData.position = std::move(position);
+    this->shuttleData.position[0] = x;
+    this->shuttleData.position[1] = y;
     this->shuttleData.previousEnergy = this->shuttleData.energy;
     this->shuttleData.energy = energy;
     if (energy < 0) {
@@ -44,48 +46,54 @@ void Shuttle::updateVisibility(bool isVisible) {
 
 void Shuttle::computePath() {    
     if (!shuttleData.visible) {
-        log("Retuning as shuttle is not visible");
+        LOG_DEBUG("Retuning as shuttle is not visible");
         return;
     }
 
-    log("Computing path");
+    LOG_DEBUG("Computing path");
 
-    auto start = std::chrono::high_resolution_clock::now();
-
-    if (leastEnergyPathing != nullptr) {
-        delete leastEnergyPathing;
-    }
-    
     GameTile& startTile = gameMap.getTile(shuttleData.position[0], shuttleData.position[1]);    
 
-    // Pathing expored tiles
-    PathingConfig config = {};
-    config.pathingHeuristics = LEAST_ENERGY;
-    config.captureEverything();
-    config.stopAtUnexploredTiles = false;
-    config.doNotBumpIntoOpponentShuttles = true;
-
-    leastEnergyPathing = new Pathing(gameMap, config);
-    leastEnergyPathing->findAllPaths(startTile);    
+    // Shuttles on the same tile share the same paths for this step
+    leastEnergyPathing = pathingService.getLeastEnergyPathing(startTile);
 
     for (const auto& pair : agentRoles) {
         pair.second->setLeastEnergyPathing(leastEnergyPathing);
     }
 
-    auto end = std::chrono::high_resolution_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
-    Metrics::getInstance().add("pathing_duration", duration.count());
-    log("pathing complete");
+    LOG_DEBUG("pathing complete");
 }
 
-void Shuttle::surveyJobBoard(JobBoard &jobBoard) {
+void Shuttle::surveyJobBoard(JobBoard &jobBoard, bool withPathing) {
     if (!shuttleData.visible) {
         return;
     }
 
-    log("Surveying job board");
+    LOG_DEBUG("Surveying job board");
+
+    if (planCache.isHit()) {
+        LOG_DEBUG("Following the committed plan");
+        // No pathing on a hit, the navigator roles sit this step out and recharge falls back to its reverse field
+        leastEnergyPathing = nullptr;
+        for (const auto& pair : agentRoles) {
+            pair.second->setLeastEnergyPathing(nullptr);
+            if (!pair.second->plansPaths()) {
+                pair.second->surveyJobBoard(jobBoard);
+            }
+        }
+        applyForCommittedJob(jobBoard);
+        return;
+    }
 
-    computePath();
+    if (withPathing) {
+        computePath();
+    } else {
+        LOG_DEBUG("Surveying without pathing");
+        leastEnergyPathing = nullptr;
+        for (const auto& pair : agentRoles) {
+            pair.second->setLeastEnergyPathing(nullptr);
+        }
+    }
 
     for (const auto& pair : agentRoles) {
         pair.second->surveyJobBoard(jobBoard);
@@ -93,12 +101,63 @@ void Shuttle::surveyJobBoard(JobBoard &jobBoard) {
 
 }
 
+void Shuttle::revalidatePlan(const JobBoard& jobBoard) {
+    if (!shuttleData.visible || shuttleData.energy <= GameEnvConfig::getInstance().unitMoveCost) {
+        planCache.invalidate();
+        return;
+    }
+
+    GameTile& currentTile = gameMap.getTile(shuttleData.getX(), shuttleData.getY());
+    planCache.revalidate(jobBoard, currentTile.getId(), pathingService.getEntryCosts(), gameMap.derivedGameState.currentStep);
+}
+
+/**
+ * Applies the way the navigator roles do, towards the next tile of the path and penalized by what is left of it
+ */
+void Shuttle::applyForCommittedJob(JobBoard& jobBoard) {
+    GameTile& nextTile = gameMap.getTile(planCache.getNextTileId());
+    Direction direction;
+    if (nextTile.x < shuttleData.getX()) {
+        direction = LEFT;
+    } else if (nextTile.x > shuttleData.getX()) {
+        direction = RIGHT;
+    } else if (nextTile.y < shuttleData.getY()) {
+        direction = UP;
+    } else {
+        direction = DOWN;
+    }
+
+    std::vector<int> bestPlan = {directionToInt(direction), 0, 0};
+    JobApplication& jobApplication = jobBoard.applyForJob(planCache.getJob(jobBoard), &shuttleData, std::move(bestPlan));
+    jobApplication.setPriority(-1 * planCache.getRemainingPathLength());
+}
+
+void Shuttle::commitPlan(const JobApplication* jobApplication) {
+    if (jobApplication == nullptr || !PlanCache::isCacheable(jobApplication->job->jobType)) {
+        planCache.invalidate();
+        return;
+    }
+
+    GameTile& targetTile = gameMap.getTile(jobApplication->job->targetX, jobApplication->job->targetY);
+    if (planCache.isHit() && planCache.holds(jobApplication->job->jobType, targetTile.getId())) {
+        // Still following it
+        return;
+    }
+    if (leastEnergyPathing == nullptr) {
+        // Planned from the distance fields, nothing to keep
+        planCache.invalidate();
+        return;
+    }
+    planCache.commit(jobApplication->job->jobType, targetTile.getId(), leastEnergyPathing->getPath(targetTile), pathingService.getEntryCosts(),
+                     gameMap.derivedGameState.currentStep);
+}
+
 ShuttleData &Shuttle::getShuttleData() {
     return shuttleData;
 }
 
-Shuttle::Shuttle(int id, ShuttleType type, GameMap& gameMap)
-        :shuttleData(ShuttleData(id, type)), gameMap(gameMap) {
+Shuttle::Shuttle(int id, ShuttleType type, GameMap& gameMap, PathingService& pathingService)
+        :shuttleData(ShuttleData(id, type)), gameMap(gameMap), pathingService(pathingService) {
 
     leastEnergyPathing = nullptr;
 
@@ -124,6 +183,10 @@ Shuttle::Shuttle(int id, ShuttleType type, GameMap& gameMap)
     // Sappers
     agentRoles["DefenderAgentRole"] = new DefenderAgentRole(shuttleData, gameMap);
 
+    for (const auto& pair : agentRoles) {
+        pair.second->setPathingService(&pathingService);
+    }
+
     // log("Shuttle instance created");
 }
 
@@ -135,9 +198,9 @@ bool Shuttle::isTileUnvisited(Direction direction) {
     GameTile& toTile = std::get<1>(result);
     
     if (movable) {
-        log("Tile (" + std::to_string(toTile.x) + ", " + std::to_string(toTile.y) + ") is visited? " + std::to_string(toTile.isVisited()));
+        LOG_TRACE("Tile (" + std::to_string(toTile.x) + ", " + std::to_string(toTile.y) + ") is visited? " + std::to_string(toTile.isVisited()));
     } else {
-        log("Tile is not movable - (" + std::to_string(toTile.x) + ", " + std::to_string(toTile.y) + ") in direction " + std::to_string(direction));
+        LOG_TRACE("Tile is not movable - (" + std::to_string(toTile.x) + ", " + std::to_string(toTile.y) + ") in direction " + std::to_string(direction));
     }
 
     return movable && !toTile.isVisited();    
@@ -150,7 +213,7 @@ std::vector<int> Shuttle::act() {
     }
 
     if (bestPlan.size() == 0) {
-        log("Unable to prepare a plan");
+        LOG_DEBUG("Unable to prepare a plan");
         Metrics::getInstance().add("shuttles_without_action", 1);
         // std::cerr<<"Unable to prepare a plan"<<std::endl;
         return {0, 0, 0};
@@ -8,23 +8,29 @@
 #include "shuttle_data.h"
 #include "agent/game_map.h"
 #include "agent/pathing.h"
+#include "agent/pathing_service.h"
 #include "agent/roles/agent_role.h"
 #include "agent/planning/jobs.h"
+#include "agent/planning/plan_cache.h"
 
 class Shuttle {
 
 private:
     ShuttleData shuttleData;            
     GameMap& gameMap;
+    PathingService& pathingService;
 
     std::mt19937 gen = std::mt19937(Config::seed);
     std::uniform_int_distribution<> dis;
 
     std::map<std::string, AgentRole*> agentRoles;
 
-    //Transients
+    //Transients, owned by the pathing service
     Pathing* leastEnergyPathing;  
 
+    PlanCache planCache;
+    void applyForCommittedJob(JobBoard& jobBoard);
+
 public:
     std::vector<int> bestPlan;
 
@@ -35,16 +41,31 @@ public:
     std::vector<int> act();
     
     void log(const std::string& message);
-    void updateUnitsData(std::vector<int> position, int energy, int currentStep);
+    void updateUnitsData(int x, int y, int energy, int currentStep);
     void updateVisibility(bool isVisible);
 
     void computePath();    
 
-    void surveyJobBoard(JobBoard& jobBoard);    
+    /**
+     * Without pathing the roles plan from the shared distance fields only, the cheap fallback when the step is out of time
+     */
+    void surveyJobBoard(JobBoard& jobBoard, bool withPathing = true);
+
+    /**
+     * Checks whether last step's navigator plan still holds, if so this step's survey follows it without pathing.
+     * Call before surveyJobBoard().
+     */
+    void revalidatePlan(const JobBoard& jobBoard);
+    bool isFollowingPlan() const { return planCache.isHit(); }
+
+    /**
+     * Keeps the path to the accepted job for the next steps, nullptr if no application was accepted
+     */
+    void commitPlan(const JobApplication* jobApplication);
 
     ShuttleData& getShuttleData();
 
-    Shuttle(int id, ShuttleType type, GameMap& gameMap);    
+    Shuttle(int id, ShuttleType type, GameMap& gameMap, PathingService& pathingService);    
     ~Shuttle();
 };
 
@@ -11,25 +11,12 @@ void ShuttleEnergyTracker::log(const std::string& message) {
     Logger::getInstance().log("ShuttleEnergyTracker -> " + message);
 }
 
-template<typename T>
-std::string ShuttleEnergyTracker::vectorToString(const std::vector<T>& vec, const std::string& name) {
-    std::string result = name + " values: [";
-    for (size_t i = 0; i < vec.size(); ++i) {
-        result += std::to_string(vec[i]);
-        if (i < vec.size() - 1) {
-            result += ", ";
-        }
-    }
-    result += "]";
-    return result;
-}
-
 void ShuttleEnergyTracker::preparePlayerCollisions() {
     playerCollisions.clear();
     int totalEnergyLost = 0;
     for (ShuttleData* shuttle: gameMap.shuttles) {
         if (shuttle->previouslyVisible && !shuttle->visible && shuttle->previousEnergy >= 0) {
-            log("Shuttle " + std::to_string(shuttle->id) + " was visible last turn and is not visible this turn, previous energy = " + std::to_string(shuttle->previousEnergy));
+            LOG_DEBUG("Shuttle " + std::to_string(shuttle->id) + " was visible last turn and is not visible this turn, previous energy = " + std::to_string(shuttle->previousEnergy));
             playerCollisions.insert(shuttle->id);
             totalEnergyLost += shuttle->previousEnergy;
         }
@@ -62,7 +49,7 @@ void ShuttleEnergyTracker::prepareOpponentCollisionMap() {
                 }
 
                 if (tile.isOccupied()) {
-                    playerTileIds.push_back(tile.getId(gameMap.width));
+                    playerTileIds.push_back(tile.getId());
                 }
             }
 
@@ -77,291 +64,182 @@ void ShuttleEnergyTracker::prepareOpponentCollisionMap() {
     }
 }
 
-bool ShuttleEnergyTracker::getPossibleMeleeSappingEnergyNearby(ShuttleData& shuttle, std::vector<int>& meleeSapEnergies) {
-    GameEnvConfig& gameEnvConfig = GameEnvConfig::getInstance();
-    DerivedGameState& state = gameMap.derivedGameState;
-    bool foundAccurateValues = true;
-
-    for (int i = 0; i < POSSIBLE_NEIGHBORS_SIZE; ++i) {
-        int x = shuttle.getX() + POSSIBLE_NEIGHBORS[i][0];
-        int y = shuttle.getY() + POSSIBLE_NEIGHBORS[i][1];
-
-        if (!gameMap.isValidTile(x, y)) {
-            continue;
-        }
-
-        GameTile& tile = gameMap.getTile(x, y);
-        bool opponentPossibleThisTile = opponentTracker.expectationOfOpponentOccupancy(x, y) > LOWEST_DOUBLE;
-        log("Opponent probability at " + std::to_string(x) + ", " + std::to_string(y) + " is " + std::to_string(opponentPossibleThisTile));
+const ShuttleEnergyTracker::MeleeInfluence& ShuttleEnergyTracker::getMeleeInfluence(GameTile& tile) {
+    MeleeInfluence& influence = meleeInfluence[tile.getId()];
+    if (influence.generation == influenceGeneration) {
+        return influence;
+    }
 
-        if (!tile.isVisible() && opponentPossibleThisTile) {
-            // This tile is invisible and there is a chance of opponent being there
-            foundAccurateValues = false; 
-            log("Cant predict accurately as this tile is invisible - " + std::to_string(x) + ", " + std::to_string(y) + " for shuttle - " + std::to_string(shuttle.id));
-        }
-        
-        int netEnergy = 0;
-        for (ShuttleData* shuttle: tile.opponentShuttles) {
-            if (shuttle->previouslyVisible) {
-                netEnergy += shuttle->previousEnergy;
-                if (shuttle->hasMoved()) {
-                    netEnergy -= gameEnvConfig.unitMoveCost;
-                }
-            } else {
-                log("Cant predict accurately as this opponent shuttle is invisible last turn - " + std::to_string(shuttle->id) 
-                        + " at tile - " + std::to_string(x) + ", " + std::to_string(y) + " our shuttle - " + std::to_string(shuttle->id));
-                foundAccurateValues = false;
+    GameEnvConfig& gameEnvConfig = GameEnvConfig::getInstance();
+    int x = tile.x;
+    int y = tile.y;
+    influence.generation = influenceGeneration;
+    influence.accurate = true;
+
+    bool opponentPossibleThisTile = opponentTracker.expectationOfOpponentOccupancy(x, y) > LOWEST_DOUBLE;
+    LOG_TRACE("Opponent probability at " + std::to_string(x) + ", " + std::to_string(y) + " is " + std::to_string(opponentPossibleThisTile));
+
+    if (!tile.isVisible() && opponentPossibleThisTile) {
+        // This tile is invisible and there is a chance of opponent being there
+        influence.accurate = false; 
+        LOG_TRACE("Cant predict accurately as this tile is invisible - " + std::to_string(x) + ", " + std::to_string(y));
+    }
+    
+    int netEnergy = 0;
+    for (ShuttleData* shuttle: tile.getOpponentShuttles()) {
+        if (shuttle->previouslyVisible) {
+            netEnergy += shuttle->previousEnergy;
+            if (shuttle->hasMoved()) {
+                netEnergy -= gameEnvConfig.unitMoveCost;
             }
+        } else {
+            LOG_TRACE("Cant predict accurately as this opponent shuttle is invisible last turn - " + std::to_string(shuttle->id) 
+                    + " at tile - " + std::to_string(x) + ", " + std::to_string(y));
+            influence.accurate = false;
         }
+    }
 
-        // Check the ghost shuttles as well
-        for (ShuttleData* shuttle: tile.opponentGhostShuttles) {
-            if (shuttle->previouslyVisible) {
-                netEnergy += shuttle->previousEnergy;
-                if (shuttle->hasMoved()) {
-                    netEnergy -= gameEnvConfig.unitMoveCost;  //TODO: Not sure if the negative energies are included in the netEnergy
-                }
-            } else {
-                log("Cant predict accurately as this opponent shuttle is invisible last turn - " + std::to_string(shuttle->id) 
-                        + " at tile - " + std::to_string(x) + ", " + std::to_string(y) + " our shuttle - " + std::to_string(shuttle->id));
-                foundAccurateValues = false;
+    // Check the ghost shuttles as well
+    for (ShuttleData* shuttle: tile.getOpponentGhostShuttles()) {
+        if (shuttle->previouslyVisible) {
+            netEnergy += shuttle->previousEnergy;
+            if (shuttle->hasMoved()) {
+                netEnergy -= gameEnvConfig.unitMoveCost;  //TODO: Not sure if the negative energies are included in the netEnergy
             }
+        } else {
+            LOG_TRACE("Cant predict accurately as this opponent shuttle is invisible last turn - " + std::to_string(shuttle->id) 
+                    + " at tile - " + std::to_string(x) + ", " + std::to_string(y));
+            influence.accurate = false;
         }
+    }
 
-        // Check for the confirmed dead tiles
-        if (confirmedCollisions.find(tile.getId(gameMap.width)) != confirmedCollisions.end()) {
-            for (int otherShuttleId : confirmedCollisions.at(tile.getId(gameMap.width))) {
-                auto& otherShuttle = gameMap.opponentShuttles[otherShuttleId];
-                netEnergy += otherShuttle->previousEnergy;
-                if (otherShuttle->hasMoved()) {
-                    netEnergy -= gameEnvConfig.unitMoveCost;
-                }
+    // Check for the confirmed dead tiles
+    if (confirmedCollisions.find(tile.getId()) != confirmedCollisions.end()) {
+        for (int otherShuttleId : confirmedCollisions.at(tile.getId())) {
+            auto& otherShuttle = gameMap.opponentShuttles[otherShuttleId];
+            netEnergy += otherShuttle->previousEnergy;
+            if (otherShuttle->hasMoved()) {
+                netEnergy -= gameEnvConfig.unitMoveCost;
             }
         }
+    }
 
-        // Check for the possible dead tiles
-        if (possibleCollisions.find(tile.getId(gameMap.width)) != possibleCollisions.end()) {
-            log("Cant predict accurately as there could have been unconfirmed collition and death of opponent unit at tile - " + std::to_string(x) + ", " + std::to_string(y));
-            foundAccurateValues = false;
-        }
-
-        if (netEnergy > 0) {
-            meleeSapEnergies.push_back(netEnergy);
-        }
+    // Check for the possible dead tiles
+    if (possibleCollisions.find(tile.getId()) != possibleCollisions.end()) {
+        LOG_TRACE("Cant predict accurately as there could have been unconfirmed collition and death of opponent unit at tile - " + std::to_string(x) + ", " + std::to_string(y));
+        influence.accurate = false;
     }
 
-    return foundAccurateValues;
+    influence.netEnergy = netEnergy;
+    return influence;
 }
 
-void ShuttleEnergyTracker::getPossibleDirectRangedSappingUnitsNearby(ShuttleData& shuttle,
-                                     std::unordered_set<int>& opponentShuttlesDirect,
-                                     std::unordered_set<int>& opponentShuttlesIndirect) {
-
-    GameEnvConfig& gameEnvConfig = GameEnvConfig::getInstance();
-    DerivedGameState& state = gameMap.derivedGameState;
+bool ShuttleEnergyTracker::getPossibleMeleeSappingEnergyNearby(ShuttleData& shuttle, std::vector<int>& meleeSapEnergies) {
+    bool foundAccurateValues = true;
 
-    auto& probabilities = opponentTracker.getOpponentPreviousPositionProbabilities();
+    for (int i = 0; i < POSSIBLE_NEIGHBORS_SIZE; ++i) {
+        int x = shuttle.getX() + POSSIBLE_NEIGHBORS[i][0];
+        int y = shuttle.getY() + POSSIBLE_NEIGHBORS[i][1];
 
-    log("Computing sapping possibilities for shuttle - " + std::to_string(shuttle.id));
+        if (!gameMap.isValidTile(x, y)) {
+            continue;
+        }
 
-    for (int x = shuttle.getX() - gameEnvConfig.unitSapRange - 1; x <= shuttle.getX() + gameEnvConfig.unitSapRange + 1; ++x) {
-        for (int y = shuttle.getY() - gameEnvConfig.unitSapRange - 1; y <= shuttle.getY() + gameEnvConfig.unitSapRange + 1; ++y) {
-            if (!gameMap.isValidTile(x, y)) {
-                continue;
-            }
+        const MeleeInfluence& influence = getMeleeInfluence(gameMap.getTile(x, y));
+        if (!influence.accurate) {
+            LOG_TRACE("Cant predict melee sap accurately next to shuttle - " + std::to_string(shuttle.id));
+            foundAccurateValues = false;
+        }
 
-            // GameTile& tile = gameMap.getTile(x, y);
-
-            for (int s = 0; s<gameEnvConfig.maxUnits;s++) {
-                if (probabilities[s][x][y] > LOWEST_DOUBLE) {
-                    // if (x != shuttle.getX() + gameEnvConfig.unitSapRange + 1 
-                    //     && x != shuttle.getX() - gameEnvConfig.unitSapRange - 1 
-                    //     && y != shuttle.getY() + gameEnvConfig.unitSapRange + 1 
-                    //     && y != shuttle.getY() - gameEnvConfig.unitSapRange - 1) {
-
-                                                
-                    // }
-                    // log("Adding " + std::to_string(s) + " to direct sapping set");
-                    opponentShuttlesDirect.insert(s);
-                    opponentShuttlesIndirect.insert(s);
-                    
-                }
-            }
-            
+        if (influence.netEnergy > 0) {
+            meleeSapEnergies.push_back(influence.netEnergy);
         }
     }
-    log("After resolving direct sap for shuttle - " + std::to_string(shuttle.id) + " - Direct sap size - " + std::to_string(opponentShuttlesDirect.size()) + " - Indirect sap size - " + std::to_string(opponentShuttlesIndirect.size()));
+
+    return foundAccurateValues;
 }
 
 bool ShuttleEnergyTracker::attemptResolution(ShuttleData& shuttle) {
-    log("Attempting to resolve energy for " + std::to_string(shuttle.id));
+    LOG_DEBUG("Attempting to resolve energy for " + std::to_string(shuttle.id));
 
     GameEnvConfig& gameEnvConfig = GameEnvConfig::getInstance();
     DerivedGameState& state = gameMap.derivedGameState;
 
-    ShuttleEnergyChangeDistribution distribution;
-    bool resolved = false;
+    bool accurateResults = true;
 
-    if (shuttle.hasMoved()) {
-        distribution.moveCost = gameEnvConfig.unitMoveCost;
-    } else {
-        distribution.moveCost = 0;
-    }
+    observation.previousEnergy = shuttle.previousEnergy;
+    observation.energy = shuttle.energy;
+    observation.moveCost = shuttle.hasMoved() ? gameEnvConfig.unitMoveCost : 0;
 
     GameTile& currentTile = gameMap.getTile(shuttle.getX(), shuttle.getY());
-    distribution.tileEnergy = currentTile.getLastKnownEnergy();
+    observation.tileEnergy = currentTile.getLastKnownEnergy();
 
-    for (auto& stackedShuttle: currentTile.shuttles) {
+    observation.unitStackCount = 1;
+    for (auto& stackedShuttle: currentTile.getShuttles()) {
         if (stackedShuttle->previouslyVisible && stackedShuttle->id != shuttle.id) {
-            distribution.unitStackCount++;
+            observation.unitStackCount++;
         }
     }
 
-    for (auto& stackedShuttle: currentTile.ghostShuttles) {
+    for (auto& stackedShuttle: currentTile.getGhostShuttles()) {
         if (stackedShuttle->previouslyVisible && stackedShuttle->id != shuttle.id) {
-            distribution.unitStackCount++;
+            observation.unitStackCount++;
         }
     }
 
-    std::vector<int> nebulaEnergyReductionSet;
-
-    if (gameMap.getEstimatedType(currentTile, state.currentStep - 1) == TileType::NEBULA) {
-        log("Shuttle was in nebula " + std::to_string(shuttle.id));
-        nebulaEnergyReductionSet.assign(nebulaTileEnergyReduction.begin(), nebulaTileEnergyReduction.end());
-    } else {
-        nebulaEnergyReductionSet.push_back(0);        
+    TileType previousType = gameMap.getEstimatedType(currentTile, state.currentStep - 1);
+    observation.inNebula = previousType == TileType::NEBULA;
+    if (observation.inNebula) {
+        LOG_DEBUG("Shuttle was in nebula " + std::to_string(shuttle.id));
     }
 
-    if (gameMap.getEstimatedType(currentTile, state.currentStep - 1) == TileType::UNKNOWN_TILE) {
-        log("Cant do accurate results, shuttle was in unknown tile " + std::to_string(shuttle.id));
-        distribution.accurateResults = false;
+    if (previousType == TileType::UNKNOWN_TILE) {
+        LOG_DEBUG("Cant do accurate results, shuttle was in unknown tile " + std::to_string(shuttle.id));
+        accurateResults = false;
     }
 
-    bool canPredictAccurateMeleeEnergy = getPossibleMeleeSappingEnergyNearby(shuttle, distribution.meleeSapEnergies);
+    observation.meleeSapEnergies.clear();
+    bool canPredictAccurateMeleeEnergy = getPossibleMeleeSappingEnergyNearby(shuttle, observation.meleeSapEnergies);
     if (!canPredictAccurateMeleeEnergy) {
-        distribution.accurateResults = false;
-    }
-    std::unordered_set<int> directSappingOpponents;
-    std::unordered_set<int> indirectSappingOpponents;    
-    
-    getPossibleDirectRangedSappingUnitsNearby(shuttle,
-         directSappingOpponents, indirectSappingOpponents);
-
-    int directSappingOpponentsSize = directSappingOpponents.size() + 1;
-    int indirectSappingOpponentsSize = indirectSappingOpponents.size() + 1;
-
-    std::vector<float> meleeSapEnergyVoidFactorSet = meleeSapEnergyVoidFactor;
-    std::vector<float> rangedIndirectSapEnergyDropoffFactorSet = rangedIndirectSapEnergyDropoffFactor;
-
-    if (directSappingOpponentsSize == 0) {
-        directSappingOpponentsSize = 1;
+        accurateResults = false;
     }
-
-    if (indirectSappingOpponentsSize == 0) {
-        indirectSappingOpponentsSize = 1;
-        rangedIndirectSapEnergyDropoffFactorSet.clear();
-        rangedIndirectSapEnergyDropoffFactorSet.push_back(1.0);
-    }    
-
-    if (distribution.meleeSapEnergies.size() == 0) {
-        meleeSapEnergyVoidFactorSet.clear();
-        meleeSapEnergyVoidFactorSet.push_back(1.0);
+    // Any opponent that could have been within sap range + 1 could have sapped the tile or a neighbouring one
+    observation.directSapCandidates = sapInfluenceMap.countOpponents(currentTile.getId());
+    observation.indirectSapCandidates = observation.directSapCandidates;
+    LOG_DEBUG("Sapping candidates for shuttle - " + std::to_string(shuttle.id) + " - " + std::to_string(observation.directSapCandidates));
+
+    // Without accurate results nothing is pruned, whether there is a solution at all is enough
+    observation.exhaustive = accurateResults;
+
+    LOG_DEBUG("Iteration size -> " + std::to_string(energyInference.nebulaEnergyReduction.size()) + ", " + std::to_string(observation.directSapCandidates + 1) + ", " + std::to_string(observation.indirectSapCandidates + 1));
+    LOG_DEBUG("drop off factor size -> " + std::to_string(energyInference.sapDropOffFactor.size()) + ", " + std::to_string(energyInference.meleeVoidFactor.size()));
+
+    energyInference.explain(observation, explanation);
+    bool resolved = explanation.solutions > 0;
+
+    if (resolved) {
+        //Add metrics from 1st solution.  It doesn't matter if there could be multiple possibilities!
+        energyLostInMovements += observation.moveCost;
+        energyLostInEnergyFields += observation.tileEnergy;
+        energyLostInRangedSap += explanation.rangedDirectSapCount + explanation.rangedIndirectSapCount;
+        energyLostInMeleeSap += explanation.meleeSapEnergy;
+        energyLostInNebula += explanation.nebulaEnergyReduction;
     }
 
-    log("Iteration size -> " + std::to_string(nebulaEnergyReductionSet.size()) + ", " + std::to_string(directSappingOpponentsSize) + ", " + std::to_string(indirectSappingOpponentsSize));
-    log("drop off factor size -> " + std::to_string(rangedIndirectSapEnergyDropoffFactorSet.size()) + ", " + std::to_string(meleeSapEnergyVoidFactorSet.size()));
-    int numberOfSolutions = 0;
-
-    std::unordered_set<int> possibleNebulaEnergyReduction;
-    std::unordered_set<float> possibleMeleeSapEnergyVoidFactor;
-    std::unordered_set<float> possibleRangedIndirectSapEnergyDropoffFactor;
-
-    for (int nebulaEnergyReduction: nebulaEnergyReductionSet) {
-        distribution.nebulaEnergyReduction = nebulaEnergyReduction;        
-
-        for (int sapRangedIdx = 0; sapRangedIdx < directSappingOpponentsSize; sapRangedIdx ++) {
-            distribution.rangedDirectSapCount = sapRangedIdx;            
+    if (resolved && accurateResults) {
+        if (explanation.possibleNebulaEnergyReduction != 0) {
+            auto& nebulaTileEnergyReduction = energyInference.nebulaEnergyReduction;
+            nebulaTileEnergyReduction.retain(explanation.possibleNebulaEnergyReduction);
             
-            for (int sapIndirectRangedIdx = 0; sapIndirectRangedIdx < indirectSappingOpponentsSize; sapIndirectRangedIdx ++) {
-
-                for (int dropOffFactorId = 0; dropOffFactorId < rangedIndirectSapEnergyDropoffFactorSet.size(); dropOffFactorId++) {                    
-                    float dropOffFactor = rangedIndirectSapEnergyDropoffFactorSet[dropOffFactorId];
-
-                    if (sapIndirectRangedIdx == 0) {
-                        dropOffFactor = 1.0;
-                        dropOffFactorId = rangedIndirectSapEnergyDropoffFactorSet.size(); //Ending the loop
-                    }
-                // for (float dropOffFactor: rangedIndirectSapEnergyDropoffFactorSet) {
-    
-                    distribution.rangedIndirectSapDropOffFactor = dropOffFactor;
-                    distribution.rangedIndirectSapCount = sapIndirectRangedIdx;
-                    
-                    for (float meleeSapEnergyVoidFactor: meleeSapEnergyVoidFactorSet) {                        
-                        
-                        distribution.meleeEnergyVoidFactor = meleeSapEnergyVoidFactor;
-
-                        int energyAfterMovement = distribution.computeEnergy(shuttle.previousEnergy);
-
-                        if (energyAfterMovement == shuttle.energy) {
-
-                            if (!resolved) {
-                                //Add metrics from 1st solution.  It doesn't matter if there could be multiple possibilities!
-                                energyLostInMovements += distribution.moveCost;
-                                energyLostInEnergyFields += distribution.tileEnergy;
-                                energyLostInRangedSap += distribution.rangedDirectSapCount + distribution.rangedIndirectSapCount;
-                                energyLostInMeleeSap += distribution.computedMeleeSapEnergy;
-                                energyLostInNebula += distribution.nebulaEnergyReduction;
-                            }
-                            resolved = true;
-                            log("Solution found -> " + distribution.toString());
-                            numberOfSolutions++;
-
-                            if (gameMap.getEstimatedType(currentTile, state.currentStep - 1) == TileType::NEBULA) {
-                                possibleNebulaEnergyReduction.insert(distribution.nebulaEnergyReduction);
-                            }
-                            if (distribution.computedMeleeSapEnergy > 0) {
-                                possibleMeleeSapEnergyVoidFactor.insert(distribution.meleeEnergyVoidFactor);
-                            }
-                            if (distribution.rangedIndirectSapCount > 0 && distribution.rangedIndirectSapDropOffFactor < 1.0) { // 1.0 cannot be identified this way
-                                possibleRangedIndirectSapEnergyDropoffFactor.insert(distribution.rangedIndirectSapDropOffFactor);
-                            }
-                        } else {
-                            // if (state.currentStep == 41 || state.currentStep == 61) {
-                            //     log("Shuttle resolution failed - " + std::to_string(shuttle.id));
-                            //     log("Nebula? " + std::to_string(currentTile.getPreviousTypeImmediate()) + " previousNebula? " + std::to_string(gameMap.getEstimatedType(currentTile, state.currentStep - 1)));
-                            //     log("Solution not found -> " + distribution.toString());
-                            //     log("Energy difference -> " + std::to_string(shuttle.energy) + " vs " + std::to_string(energyAfterMovement) + ", starting at " + std::to_string(shuttle.previousEnergy));
-                            // }
-                        }
-                    }
-                }
-            }
-        }
-    }
-
-    if (resolved && distribution.accurateResults ) {       
-        if (!possibleNebulaEnergyReduction.empty()) {
-            std::unordered_set<int> toBePruned;
-            
-            for (int value : nebulaTileEnergyReduction) {
-                if (possibleNebulaEnergyReduction.find(value) == possibleNebulaEnergyReduction.end()) {
-                    toBePruned.insert(value);
-                }
-            }
-            
-            nebulaTileEnergyReduction.erase(std::remove_if(nebulaTileEnergyReduction.begin(), nebulaTileEnergyReduction.end(), [&toBePruned](int x) {
-                return toBePruned.find(x) != toBePruned.end();
-            }), nebulaTileEnergyReduction.end());
-            
-            if (nebulaTileEnergyReduction.empty()) {
-                log("Problem: Identified wrong value for nebula energy reduction");
+            if (nebulaTileEnergyReduction.isEmpty()) {
+                LOG_WARN("Problem: Identified wrong value for nebula energy reduction");
                 std::cerr<<"Problem: Identified wrong value for nebula energy reduction"<<std::endl;
             }
 
-            if (nebulaTileEnergyReduction.size() == 1) {                
-                state.nebulaTileEnergyReduction = nebulaTileEnergyReduction[0];
+            if (nebulaTileEnergyReduction.isPinned()) {                
+                state.nebulaTileEnergyReduction = nebulaTileEnergyReduction.getPinnedValue();
                 state.nebulaTileEnergyReductionSet = true;
-                log("Resolved nebula energy reduction to " + std::to_string(state.nebulaTileEnergyReduction));
+                LOG_INFO("Resolved nebula energy reduction to " + std::to_string(state.nebulaTileEnergyReduction));
 
                 auto& details = Metrics::getInstance().details;
                 if (details.nebulaTileEnergyReductionIdentifiedStep < 0) {
@@ -370,33 +248,25 @@ bool ShuttleEnergyTracker::attemptResolution(ShuttleData& shuttle) {
                 }
                 
             } else {
-                log("Current nebula energy reduction values -> " + vectorToString(nebulaTileEnergyReduction, "nebulaTileEnergyReduction"));
+                LOG_DEBUG("Current nebula energy reduction values -> " + nebulaTileEnergyReduction.toString("nebulaTileEnergyReduction"));
             }
         }
         
         
-        if (!possibleMeleeSapEnergyVoidFactor.empty()) {
-            std::unordered_set<float> toBePruned;
-            for (float factor : meleeSapEnergyVoidFactor) {
-                if (possibleMeleeSapEnergyVoidFactor.find(factor) == possibleMeleeSapEnergyVoidFactor.end()) {
-                    toBePruned.insert(factor);
-                }
-            }
+        if (explanation.possibleMeleeVoidFactor != 0) {
+            auto& meleeSapEnergyVoidFactor = energyInference.meleeVoidFactor;
+            meleeSapEnergyVoidFactor.retain(explanation.possibleMeleeVoidFactor);
 
-            meleeSapEnergyVoidFactor.erase(std::remove_if(meleeSapEnergyVoidFactor.begin(), meleeSapEnergyVoidFactor.end(), [&toBePruned](float x) {
-                return toBePruned.find(x) != toBePruned.end();
-            }), meleeSapEnergyVoidFactor.end());
-
-            if (meleeSapEnergyVoidFactor.empty()) {
-                log("Problem: Identified wrong value for melee void factor");
+            if (meleeSapEnergyVoidFactor.isEmpty()) {
+                LOG_WARN("Problem: Identified wrong value for melee void factor");
                 std::cerr<<"Problem: Identified wrong value for melee void factor"<<std::endl;
             }
 
-            if (meleeSapEnergyVoidFactor.size() == 1) {
+            if (meleeSapEnergyVoidFactor.isPinned()) {
 
-                state.unitEnergyVoidFactor = meleeSapEnergyVoidFactor[0];
+                state.unitEnergyVoidFactor = meleeSapEnergyVoidFactor.getPinnedValue();
                 state.unitEnergyVoidFactorSet = true;                
-                log("Resolved unitEnergyVoidFactor to " + std::to_string(state.unitEnergyVoidFactor));
+                LOG_INFO("Resolved unitEnergyVoidFactor to " + std::to_string(state.unitEnergyVoidFactor));
 
                 auto& details = Metrics::getInstance().details;
                 if (details.unitEnergyVoidFactorIdentifiedStep < 0) {
@@ -405,32 +275,24 @@ bool ShuttleEnergyTracker::attemptResolution(ShuttleData& shuttle) {
                 }
                                 
             } else {
-                log("Current meleeSapEnergyVoidFactor values -> " + vectorToString(meleeSapEnergyVoidFactor, "meleeSapEnergyVoidFactor"));
+                LOG_DEBUG("Current meleeSapEnergyVoidFactor values -> " + meleeSapEnergyVoidFactor.toString("meleeSapEnergyVoidFactor"));
             }
         }
         
-        if (!possibleRangedIndirectSapEnergyDropoffFactor.empty() && numberOfSolutions == 1) {
-            std::unordered_set<float> toBePruned;
-            for (float factor : rangedIndirectSapEnergyDropoffFactor) {
-                if (possibleRangedIndirectSapEnergyDropoffFactor.find(factor) == possibleRangedIndirectSapEnergyDropoffFactor.end()) { 
-                    toBePruned.insert(factor);
-                }
-            }
-            rangedIndirectSapEnergyDropoffFactor.erase(std::remove_if(rangedIndirectSapEnergyDropoffFactor.begin(), rangedIndirectSapEnergyDropoffFactor.end(), [&toBePruned](float x) {
-                return toBePruned.find(x) != toBePruned.end();
-            }), rangedIndirectSapEnergyDropoffFactor.end());
+        if (explanation.possibleSapDropOffFactor != 0 && explanation.solutions == 1) {
+            auto& rangedIndirectSapEnergyDropoffFactor = energyInference.sapDropOffFactor;
+            rangedIndirectSapEnergyDropoffFactor.retain(explanation.possibleSapDropOffFactor);
             
-            
-            if (rangedIndirectSapEnergyDropoffFactor.empty()) {
-                log("Problem: Identified wrong value for rangedIndirectSapEnergyDropoffFactor");
+            if (rangedIndirectSapEnergyDropoffFactor.isEmpty()) {
+                LOG_WARN("Problem: Identified wrong value for rangedIndirectSapEnergyDropoffFactor");
                 std::cerr<<"Problem: Identified wrong value for rangedIndirectSapEnergyDropoffFactor"<<std::endl;
             }
 
-            if (rangedIndirectSapEnergyDropoffFactor.size() == 1) {
-                state.unitSapDropOffFactor = rangedIndirectSapEnergyDropoffFactor[0];
+            if (rangedIndirectSapEnergyDropoffFactor.isPinned()) {
+                state.unitSapDropOffFactor = rangedIndirectSapEnergyDropoffFactor.getPinnedValue();
                 state.unitSapDropOffFactorSet = true;
 
-                log("Resolved unitSapDropOffFactor to " + std::to_string(state.unitSapDropOffFactor));
+                LOG_INFO("Resolved unitSapDropOffFactor to " + std::to_string(state.unitSapDropOffFactor));
 
                 auto& details = Metrics::getInstance().details;
                 if (details.unitSapDropOffFactorIdentifiedStep < 0) {
@@ -438,17 +300,17 @@ bool ShuttleEnergyTracker::attemptResolution(ShuttleData& shuttle) {
                     details.unitSapDropOffFactorIdentifiedStep = state.currentStep;
                 }
             } else {
-                log("Current rangedIndirectSapEnergyDropoffFactor values -> " + vectorToString(rangedIndirectSapEnergyDropoffFactor, "rangedIndirectSapEnergyDropoffFactor"));
+                LOG_DEBUG("Current rangedIndirectSapEnergyDropoffFactor values -> " + rangedIndirectSapEnergyDropoffFactor.toString("rangedIndirectSapEnergyDropoffFactor"));
             }
         }
     }
 
-    if (!resolved && distribution.accurateResults) {
-        log("Problem: Unable to account for all the energy changes for shuttle" + std::to_string(shuttle.id));
+    if (!resolved && accurateResults) {
+        LOG_WARN("Problem: Unable to account for all the energy changes for shuttle" + std::to_string(shuttle.id));
         std::cerr<<"Problem: Unable to account for all the energy changes"<<std::endl;
     }
 
-    log("Number of solutions found -> " + std::to_string(numberOfSolutions));
+    LOG_DEBUG("Number of solutions found -> " + std::to_string(explanation.solutions));
     return resolved;
 }
 
@@ -505,12 +367,12 @@ void ShuttleEnergyTracker::step() {
         if (shuttle->energy == UNIT_SPAWN_ENERGY && shuttle->visible && shuttle->previouslyVisible && shuttle->getX() == gameEnvConfig.originX && shuttle->getY() == gameEnvConfig.originY
             && (shuttle->getPreviousX() !=  gameEnvConfig.originX || shuttle->getPreviousY() !=  gameEnvConfig.originY)) {
             // This can be a false positive but extremely rare.
-            log("Identified collision that happened at spawn for shuttle " + std::to_string(s));
+            LOG_DEBUG("Identified collision that happened at spawn for shuttle " + std::to_string(s));
 
             if (respawnRegistry.playerUnitRespawned != s) {                
                 int actualUnitExpectedToSpawn = respawnRegistry.playerUnitRespawned;
                 if (actualUnitExpectedToSpawn != -1) {
-                    log("Bumping unit to next slot as we had a collition at spawn for shuttle " + std::to_string(s) + " and expected to spawn " + std::to_string(actualUnitExpectedToSpawn));
+                    LOG_DEBUG("Bumping unit to next slot as we had a collition at spawn for shuttle " + std::to_string(s) + " and expected to spawn " + std::to_string(actualUnitExpectedToSpawn));
                     respawnRegistry.pushPlayerUnit(actualUnitExpectedToSpawn, state.currentMatchStep);
                 }
 
@@ -521,6 +383,9 @@ void ShuttleEnergyTracker::step() {
 
     collectInformationFromPreviousSap();
 
+    influenceGeneration++;
+    sapInfluenceMap.compute(opponentTracker.getOpponentPreviousPositionProbabilities(), gameEnvConfig.maxUnits, gameEnvConfig.unitSapRange + 1);
+
     for (int s = 0; s < gameEnvConfig.maxUnits; ++s) {
         auto& shuttle = gameMap.shuttles[s];        
 
@@ -530,29 +395,26 @@ void ShuttleEnergyTracker::step() {
         }
         
         if (respawnRegistry.playerUnitRespawned == s) {
-            log("Shuttle " + std::to_string(s) + " just spawned");
+            LOG_DEBUG("Shuttle " + std::to_string(s) + " just spawned");
 
             if (shuttle->energy != UNIT_SPAWN_ENERGY) {
-                log("Problem:  Unit " + std::to_string(s) +" just spawned but energy mismatch - " + std::to_string(shuttle->energy));
+                LOG_WARN("Problem:  Unit " + std::to_string(s) +" just spawned but energy mismatch - " + std::to_string(shuttle->energy));
                 std::cerr<<"Problem:  Unit just spawned but energy mismatch"<<std::endl;
             }
 
             if (shuttle->getPreviousX() != -1 || shuttle->getPreviousY() != -1) {
-                log("shuttle " + std::to_string(s) + " just spawned, but previous position is not (-1,-1) instead (" + std::to_string(shuttle->getPreviousX()) + "," + std::to_string(shuttle->getPreviousY()) + ")");
+                LOG_DEBUG("shuttle " + std::to_string(s) + " just spawned, but previous position is not (-1,-1) instead (" + std::to_string(shuttle->getPreviousX()) + "," + std::to_string(shuttle->getPreviousY()) + ")");
                 // std::cerr<<"Problem, shuttle just spawned, but previous position is not (-1,-1)"<<std::endl;
             }
 
             if (shuttle->getX() != gameEnvConfig.originX || shuttle->getY() != gameEnvConfig.originY) {
-                log("shuttle " + std::to_string(s) + " just spawned, but current position is not (" + std::to_string(gameEnvConfig.originX) + "," + std::to_string(gameEnvConfig.originY) + ") instead (" + std::to_string(shuttle->getX()) + "," + std::to_string(shuttle->getY()) + ")");
+                LOG_DEBUG("shuttle " + std::to_string(s) + " just spawned, but current position is not (" + std::to_string(gameEnvConfig.originX) + "," + std::to_string(gameEnvConfig.originY) + ") instead (" + std::to_string(shuttle->getX()) + "," + std::to_string(shuttle->getY()) + ")");
                 std::cerr<<"Problem, shuttle just spawned, but current position is not (org, org)"<<std::endl;
             }
 
             Metrics::getInstance().add("energy_gain", shuttle->energy);
         } else {
 
-            GameTile& currentTile = gameMap.getTile(shuttle->getX(), shuttle->getY());
-            ShuttleEnergyChangeDistribution distribution;
-
             attemptResolution(*shuttle);
 
         }
@@ -582,10 +444,11 @@ void ShuttleEnergyTracker::updateShuttleActions(std::vector<std::vector<int>>& a
 }
 
 ShuttleEnergyTracker::ShuttleEnergyTracker(GameMap& gameMap, OpponentTracker& opponentTracker, RespawnRegistry& respawnRegistry)
-            : gameMap(gameMap), opponentTracker(opponentTracker), respawnRegistry(respawnRegistry) {
-
-    nebulaTileEnergyReduction = std::vector<int>(std::begin(POSSIBLE_NEBULA_ENERGY_REDUCTION_VALUES), std::end(POSSIBLE_NEBULA_ENERGY_REDUCTION_VALUES));
-    meleeSapEnergyVoidFactor = std::vector<float>(std::begin(POSSIBLE_UNIT_ENERGY_VOID_FACTOR_VALUES), std::end(POSSIBLE_UNIT_ENERGY_VOID_FACTOR_VALUES));
-    rangedIndirectSapEnergyDropoffFactor = std::vector<float>(std::begin(POSSIBLE_UNIT_SAP_DROP_OFF_FACTOR_VALUES), std::end(POSSIBLE_UNIT_SAP_DROP_OFF_FACTOR_VALUES));
+            : gameMap(gameMap), opponentTracker(opponentTracker), respawnRegistry(respawnRegistry),
+              meleeInfluence(gameMap.width * gameMap.height), sapInfluenceMap(gameMap.width, gameMap.height) {
 
+    if (GameEnvConfig::getInstance().maxUnits > SapInfluenceMap::MAX_OPPONENTS) {
+        LOG_WARN("Problem: More opponents than the sap influence map tracks");
+        std::cerr<<"Problem: More opponents than the sap influence map tracks"<<std::endl;
+    }
 }
\ No newline at end of file
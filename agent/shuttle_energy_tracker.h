@@ -4,6 +4,8 @@
 #include "game_env_config.h"
 #include "game_map.h"
 #include "opponent_tracker.h"
+#include "energy_inference.h"
+#include "sap_influence_map.h"
 #include "datastructures/respawn_registry.h"
 #include <unordered_set>
 #include <cmath>
@@ -103,8 +105,6 @@ class ShuttleEnergyTracker {
 
     private:
         static void log(const std::string& message);
-        template<typename T>
-        std::string vectorToString(const std::vector<T>& vec, const std::string& name);
 
         GameMap& gameMap;
         OpponentTracker& opponentTracker;
@@ -112,9 +112,9 @@ class ShuttleEnergyTracker {
     
         std::unordered_map<int, GameTile*> shuttlesThatSappedLastTurn;
 
-        std::vector<int> nebulaTileEnergyReduction;
-        std::vector<float> meleeSapEnergyVoidFactor;
-        std::vector<float> rangedIndirectSapEnergyDropoffFactor;
+        EnergyInference energyInference;
+        EnergyObservation observation;
+        EnergyExplanation explanation;
 
         std::unordered_map<int, std::vector<int>> confirmedCollisions;
         std::unordered_map<int, std::vector<int>> possibleCollisions;
@@ -124,10 +124,21 @@ class ShuttleEnergyTracker {
         void prepareOpponentCollisionMap();
         void preparePlayerCollisions();
 
+        /**
+         * Net energy the opponents on a tile could melee sap with, worked out once per step and shared by the
+         * shuttles around the tile
+         */
+        struct MeleeInfluence {
+            int netEnergy = 0;
+            bool accurate = true;
+            int generation = -1;
+        };
+        std::vector<MeleeInfluence> meleeInfluence;
+        int influenceGeneration = 0;
+        SapInfluenceMap sapInfluenceMap;
+
+        const MeleeInfluence& getMeleeInfluence(GameTile& tile);
         bool getPossibleMeleeSappingEnergyNearby(ShuttleData& shuttle, std::vector<int>& meleeSapEnergies);
-        void getPossibleDirectRangedSappingUnitsNearby(ShuttleData& shuttle,
-            std::unordered_set<int>& opponentShuttlesDirect,
-            std::unordered_set<int>& opponentShuttlesIndirect);
 
         bool attemptResolution(ShuttleData& shuttle);
 
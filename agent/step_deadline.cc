@@ -0,0 +1,69 @@
+#include "agent/step_deadline.h"
+
+#include <algorithm>
+
+#include "config.h"
+#include "game_env_config.h"
+#include "logger.h"
+#include "metrics.h"
+
+void StepDeadline::log(const std::string& message) {
+    Logger::getInstance().log("StepDeadline -> " + message);
+}
+
+const char* StepDeadline::getStageName(StepStage stage) {
+    switch (stage) {
+        case STAGE_PATHING: return "pathing";
+        case STAGE_OPPONENT_TRACKING: return "opponent_tracking";
+        case STAGE_CONSTRAINT_SOLVING: return "constraint_solving";
+        case STAGE_JOB_ASSIGNMENT: return "job_assignment";
+        default: return "unknown";
+    }
+}
+
+void StepDeadline::beginStep(int currentStep, int remainingOverageTime) {
+    GameEnvConfig& gameEnvConfig = GameEnvConfig::getInstance();
+    stepStart = Clock::now();
+
+    int totalSteps = gameEnvConfig.matchCountPerEpisode * (gameEnvConfig.maxStepsInMatch + 1);
+    int stepsLeft = std::max(totalSteps - currentStep, 1);
+    double overageShareMs = std::max(remainingOverageTime, 0) * 1000.0 * Config::overageShare / stepsLeft;
+    budgetMs = Config::stepBudgetMs + overageShareMs;
+
+    std::fill(std::begin(stageMicros), std::end(stageMicros), 0);
+    std::fill(std::begin(degradedCount), std::end(degradedCount), 0);
+    LOG_DEBUG("Budget for step " + std::to_string(currentStep) + " is " + std::to_string(budgetMs) + " ms");
+}
+
+void StepDeadline::endStep() {
+    Metrics& metrics = Metrics::getInstance();
+    for (int stage = 0; stage < STAGE_COUNT; ++stage) {
+        std::string name = getStageName(static_cast<StepStage>(stage));
+        metrics.add("stage_" + name + "_duration", stageMicros[stage] / 1000.0f);
+        metrics.add("budget_exhausted_" + name, degradedCount[stage]);
+    }
+    metrics.add("step_budget", static_cast<float>(budgetMs));
+}
+
+double StepDeadline::getElapsedMs() const {
+    return std::chrono::duration<double, std::milli>(Clock::now() - stepStart).count();
+}
+
+bool StepDeadline::shouldDegrade(StepStage stage) {
+    if (!isExhausted()) {
+        return false;
+    }
+    if (degradedCount[stage] == 0) {
+        LOG_INFO("Budget exhausted, " + std::string(getStageName(stage)) + " falls back after " + std::to_string(getElapsedMs()) + " ms");
+    }
+    degradedCount[stage]++;
+    return true;
+}
+
+void StepDeadline::startStage(StepStage stage) {
+    stageStart[stage] = Clock::now();
+}
+
+void StepDeadline::endStage(StepStage stage) {
+    stageMicros[stage] += std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - stageStart[stage]).count();
+}
@@ -0,0 +1,65 @@
+#ifndef STEP_DEADLINE_H
+#define STEP_DEADLINE_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+enum StepStage : std::uint8_t {
+    STAGE_PATHING,
+    STAGE_OPPONENT_TRACKING,
+    STAGE_CONSTRAINT_SOLVING,
+    STAGE_JOB_ASSIGNMENT,
+    STAGE_COUNT
+};
+
+/**
+ * Time budget of a single step. The budget is the configured per step time plus a fair share of the remaining
+ * overage time over the steps left in the game.
+ *
+ * The expensive stages run in anytime mode: they ask shouldDegrade() before each unit of work and fall back to a
+ * cheaper answer once the budget is spent.
+ */
+class StepDeadline {
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        Clock::time_point stepStart;
+        double budgetMs = 0;
+
+        Clock::time_point stageStart[STAGE_COUNT];
+        long long stageMicros[STAGE_COUNT] = {};
+        int degradedCount[STAGE_COUNT] = {};
+
+        static void log(const std::string& message);
+
+    public:
+        static const char* getStageName(StepStage stage);
+
+        /**
+         * Starts the clock for the step, remainingOverageTime is in seconds as sent by the env
+         */
+        void beginStep(int currentStep, int remainingOverageTime);
+
+        /**
+         * Reports the per stage time and the budget exhausted counters of this step
+         */
+        void endStep();
+
+        double getBudgetMs() const { return budgetMs; }
+        double getElapsedMs() const;
+        double getRemainingMs() const { return budgetMs - getElapsedMs(); }
+        bool isExhausted() const { return getRemainingMs() <= 0; }
+
+        /**
+         * True if the stage has to fall back to its cheaper variant, every fallback is counted
+         */
+        bool shouldDegrade(StepStage stage);
+        int getDegradedCount(StepStage stage) const { return degradedCount[stage]; }
+
+        void startStage(StepStage stage);
+        void endStage(StepStage stage);
+        void addStageTime(StepStage stage, long long micros) { stageMicros[stage] += micros; }
+};
+
+#endif // STEP_DEADLINE_H
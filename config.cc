@@ -4,6 +4,7 @@
 #include <sstream>
 
 bool Config::enableLogging = false;
+std::string Config::logLevel = "debug";
 bool Config::enableMetrics = false;
 bool Config::enableMetricDetails = false;
 bool Config::livePlayPlayer0 = false;
@@ -14,8 +15,19 @@ int Config::portPlayer0 = 0;
 int Config::portPlayer1 = 0;
 int Config::seed = 0;
 bool Config::phaseOutConstraints = true;
+bool Config::versionedConstraints = false;
 int Config::prioritizationStrategy = 0;
 int Config::prioritizationTolerance = 3;
+int Config::planningThreads = 1;
+bool Config::planCache = false;
+int Config::planCacheMaxAge = 10;
+int Config::stepBudgetMs = 1000;
+float Config::overageShare = 0.5;
+int Config::degradedPathLength = 8;
+int Config::timeExpandedHorizon = 0;
+float Config::denseBeliefShare = 0.5;
+bool Config::exactHaloInference = false;
+int Config::exactInferenceBudgetUs = 2000;
 
 void Config::parseConfig(const std::string& filename) {
     std::ifstream configFile(filename);
@@ -40,6 +52,7 @@ void Config::parseConfig(const std::string& filename) {
     }
 
     enableLogging = (configMap["enable_logging"] == "true");
+    logLevel = configMap["log_level"].empty() ? "debug" : configMap["log_level"];
     enableMetrics = (configMap["enable_metrics"] == "true");
     enableMetricDetails = (configMap["enable_metric_details"] == "true");
     livePlayPlayer0 = (configMap["live_play_player0"] == "true");
@@ -49,7 +62,18 @@ void Config::parseConfig(const std::string& filename) {
     portPlayer0 = livePlayPlayer0 ? std::stoi(configMap["port_player0"]) : 0;
     portPlayer1 = livePlayPlayer1 ? std::stoi(configMap["port_player1"]) : 0;
     phaseOutConstraints = (configMap["phase_out_constraints"] == "true");
+    versionedConstraints = (configMap["versioned_constraints"] == "true");
     prioritizationStrategy = std::stoi(configMap["prioritization_strategy"]);
     prioritizationTolerance = std::stoi(configMap["prioritization_tolerance"]);
     seed = std::stoi(configMap["seed"]);
+    planningThreads = configMap["planning_threads"].empty() ? 1 : std::stoi(configMap["planning_threads"]);
+    planCache = (configMap["plan_cache"] == "true");
+    planCacheMaxAge = configMap["plan_cache_max_age"].empty() ? 10 : std::stoi(configMap["plan_cache_max_age"]);
+    stepBudgetMs = configMap["step_budget_ms"].empty() ? 1000 : std::stoi(configMap["step_budget_ms"]);
+    overageShare = configMap["overage_share"].empty() ? 0.5f : std::stof(configMap["overage_share"]);
+    degradedPathLength = configMap["degraded_path_length"].empty() ? 8 : std::stoi(configMap["degraded_path_length"]);
+    timeExpandedHorizon = configMap["time_expanded_horizon"].empty() ? 0 : std::stoi(configMap["time_expanded_horizon"]);
+    denseBeliefShare = configMap["dense_belief_share"].empty() ? 0.5f : std::stof(configMap["dense_belief_share"]);
+    exactHaloInference = (configMap["exact_halo_inference"] == "true");
+    exactInferenceBudgetUs = configMap["exact_inference_budget_us"].empty() ? 2000 : std::stoi(configMap["exact_inference_budget_us"]);
 }
@@ -7,6 +7,7 @@
 class Config {
 public:
     static bool enableLogging;
+    static std::string logLevel;
     static bool enableMetrics;
     static bool enableMetricDetails;
     static bool livePlayPlayer0;
@@ -17,8 +18,19 @@ public:
     static int portPlayer1;
     static int seed;
     static bool phaseOutConstraints;
+    static bool versionedConstraints;
     static int prioritizationStrategy;
     static int prioritizationTolerance;
+    static int planningThreads;
+    static bool planCache;
+    static int planCacheMaxAge;
+    static int stepBudgetMs;
+    static float overageShare;
+    static int degradedPathLength;
+    static int timeExpandedHorizon;
+    static float denseBeliefShare;
+    static bool exactHaloInference;
+    static int exactInferenceBudgetUs;
 
     static void parseConfig(const std::string& filename);
 };
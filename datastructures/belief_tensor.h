@@ -0,0 +1,98 @@
+#ifndef BELIEF_TENSOR_H
+#define BELIEF_TENSOR_H
+
+#include <algorithm>
+#include <vector>
+
+#include "datastructures/flat_array.h"
+
+/**
+ * Inclusive bounding box of one unit's probabilities, every non zero probability lies inside it. A dense support is
+ * the whole map and stops being tracked.
+ */
+struct BeliefSupport {
+    int xMin = 0;
+    int xMax = -1;
+    int yMin = 0;
+    int yMax = -1;
+    bool dense = false;
+
+    bool isEmpty() const { return xMax < xMin || yMax < yMin; }
+    int getArea() const { return isEmpty() ? 0 : (xMax - xMin + 1) * (yMax - yMin + 1); }
+
+    void reset() { *this = BeliefSupport(); }
+
+    void add(int x, int y) {
+        if (isEmpty()) {
+            xMin = xMax = x;
+            yMin = yMax = y;
+            return;
+        }
+        xMin = std::min(xMin, x);
+        xMax = std::max(xMax, x);
+        yMin = std::min(yMin, y);
+        yMax = std::max(yMax, y);
+    }
+
+    void setDense(int width, int height) {
+        xMin = 0;
+        xMax = width - 1;
+        yMin = 0;
+        yMax = height - 1;
+        dense = true;
+    }
+};
+
+/**
+ * Per unit position probabilities and max possible energies, [unit][x][y] with y contiguous. Two generations are
+ * kept and advance() flips between them, so the step being computed and the one it is computed from never allocate.
+ */
+class BeliefTensor {
+public:
+    void resize(int units, int width, int height) {
+        for (int i = 0; i < 2; i++) {
+            probabilityBuffers[i].resize(units, width, height, 0.0);
+            energyBuffers[i].resize(units, width, height, 0);
+            supportBuffers[i].assign(units, BeliefSupport());
+        }
+        current = 0;
+    }
+
+    /** The current generation becomes the previous one, the new current one starts zeroed with empty supports. */
+    void advance() {
+        current ^= 1;
+        probabilityBuffers[current].fill(0.0);
+        energyBuffers[current].fill(0);
+        for (BeliefSupport& support : supportBuffers[current]) {
+            support.reset();
+        }
+    }
+
+    void clear() {
+        for (int i = 0; i < 2; i++) {
+            probabilityBuffers[i].fill(0.0);
+            energyBuffers[i].fill(0);
+            for (BeliefSupport& support : supportBuffers[i]) {
+                support.reset();
+            }
+        }
+    }
+
+    FlatArray3D<double>& probabilities() { return probabilityBuffers[current]; }
+    FlatArray3D<int>& energies() { return energyBuffers[current]; }
+    FlatArray3D<double>& previousProbabilities() { return probabilityBuffers[current ^ 1]; }
+    FlatArray3D<int>& previousEnergies() { return energyBuffers[current ^ 1]; }
+    std::vector<BeliefSupport>& supports() { return supportBuffers[current]; }
+    std::vector<BeliefSupport>& previousSupports() { return supportBuffers[current ^ 1]; }
+
+    const FlatArray3D<double>& probabilities() const { return probabilityBuffers[current]; }
+    const FlatArray3D<int>& energies() const { return energyBuffers[current]; }
+
+private:
+    FlatArray3D<double> probabilityBuffers[2];
+    FlatArray3D<int> energyBuffers[2];
+    std::vector<BeliefSupport> supportBuffers[2];
+    int current = 0;
+};
+
+#endif //BELIEF_TENSOR_H
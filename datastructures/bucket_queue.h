@@ -0,0 +1,72 @@
+#ifndef BUCKET_QUEUE_H
+#define BUCKET_QUEUE_H
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+/**
+ * Monotone priority queue for small non negative integer edge costs (Dial's algorithm). Items live in a circular
+ * array of maxCost + 1 buckets keyed by distance, pops come out in (distance, id) order. Pushed distances must be
+ * within [last popped distance, last popped distance + maxCost].
+ *
+ * Stale entries are not removed, callers skip them by comparing the popped distance with their own record.
+ */
+class BucketQueue {
+public:
+    void reset(int maxCost) {
+        int bucketCount = std::max(maxCost, 0) + 1;
+        if (static_cast<int>(buckets.size()) < bucketCount) {
+            buckets.resize(bucketCount);
+        }
+        for (auto& bucket : buckets) {
+            bucket.clear();
+        }
+        this->bucketCount = bucketCount;
+        cursor = 0;
+        cursorSorted = false;
+        pending = 0;
+    }
+
+    void push(int id, int distance) {
+        std::vector<int>& bucket = buckets[distance % bucketCount];
+        if (distance == cursor && cursorSorted) {
+            // Zero cost edge into the bucket being drained, keep it ordered
+            bucket.insert(std::upper_bound(bucket.begin(), bucket.end(), id, std::greater<int>()), id);
+        } else {
+            bucket.push_back(id);
+        }
+        pending++;
+    }
+
+    bool pop(int& id, int& distance) {
+        while (pending > 0) {
+            std::vector<int>& bucket = buckets[cursor % bucketCount];
+            if (!cursorSorted) {
+                std::sort(bucket.begin(), bucket.end(), std::greater<int>());
+                cursorSorted = true;
+            }
+            if (!bucket.empty()) {
+                id = bucket.back();
+                distance = cursor;
+                bucket.pop_back();
+                pending--;
+                return true;
+            }
+            cursor++;
+            cursorSorted = false;
+        }
+        return false;
+    }
+
+    bool empty() const { return pending == 0; }
+
+private:
+    std::vector<std::vector<int>> buckets;
+    int bucketCount = 1;
+    int cursor = 0;
+    bool cursorSorted = false;
+    int pending = 0;
+};
+
+#endif //BUCKET_QUEUE_H
@@ -4,6 +4,7 @@
 #include <sstream>
 
 #include "logger.h"
+#include "datastructures/halo_inference.h"
 #include "game_env_config.h"
 #include "symmetry_util.h"
 #include "config.h"
@@ -21,29 +22,21 @@ std::string setToString(const std::set<int>& s) {
     return oss.str();
 }
 
-// Is set1 a superset of set2?
-bool isSuperset(const std::set<int>& set1, const std::set<int>& set2) {
-    return std::includes(set1.begin(), set1.end(), set2.begin(), set2.end());
-}
-
-// Is set1 a subset of set2?
-bool isSubset(const std::set<int>& set1, const std::set<int>& set2) {
-    return std::includes(set2.begin(), set2.end(), set1.begin(), set1.end());
-}
-
-std::set<int> subtractSets(const std::set<int>& set1, const std::set<int>& set2) {
-    std::set<int> result;
-    std::set_difference(set1.begin(), set1.end(), set2.begin(), set2.end(),
-                        std::inserter(result, result.end()));
-    return result;
+std::string setToString(const HaloBitset& s) {
+    return setToString(s.toSet());
 }
 
 bool contains(const std::set<int>& haloPointSet, int value) {
     return haloPointSet.find(value) != haloPointSet.end();
 }
 
-void removeValue(std::set<int>& haloPointSet, int value) {
-    haloPointSet.erase(value);
+/**
+ * Moves the mirrored tiles that lost their pair in the normal set back to the normal set
+ */
+void transferUnpairedMirrors(HaloBitset& haloPointSet, HaloBitset& extraMirroredHaloPointSet) {
+    HaloBitset elementsToTransfer = extraMirroredHaloPointSet - haloPointSet;
+    extraMirroredHaloPointSet.subtract(elementsToTransfer);
+    haloPointSet |= elementsToTransfer;
 }
 
 // ----------------------------------------------------------------------------
@@ -51,7 +44,7 @@ void removeValue(std::set<int>& haloPointSet, int value) {
 std::string ConstraintObservation::toString() const {
     std::ostringstream oss;
     oss << pointsValue << " @ " << setToString(haloPointSet);
-    if (extraMirroredHaloPointSet.size() > 0) {
+    if (!extraMirroredHaloPointSet.empty()) {
         oss<< " | " << setToString(extraMirroredHaloPointSet);
     }
 
@@ -60,57 +53,53 @@ std::string ConstraintObservation::toString() const {
 
 bool ConstraintObservation::isValid() const {
     if (haloPointSet.empty()) {
-        log("Empty halo point set");
+        LOG_DEBUG("Empty halo point set");
         return false;
     }
 
     if (pointsValue < 0) {
-        log("Problem:Points value is negative "+ toString());
+        LOG_WARN("Problem:Points value is negative "+ toString());
         std::cerr<<"Problem:Points value is negative "<<std::endl;
         return false;
     }
 
-    if (pointsValue > haloPointSet.size() + extraMirroredHaloPointSet.size()) {
-        log("Problem:Points value is more than the number of halo nodes " + toString());
+    if (pointsValue > getTileCount()) {
+        LOG_WARN("Problem:Points value is more than the number of halo nodes " + toString());
         std::cerr<<"Problem:Points value is higher than nodes "<<std::endl;
         return false;
     }
 
-    for (int tileId :extraMirroredHaloPointSet) {
-        if (!contains(haloPointSet, tileId)) {
-            log("Problem:Mirror point not found in haloPoint " + toString());
-            std::cerr<<"Problem:Mirror point not found in haloPoint "<<std::endl;
-            return false;
-        }
+    if (!extraMirroredHaloPointSet.isSubsetOf(haloPointSet)) {
+        LOG_WARN("Problem:Mirror point not found in haloPoint " + toString());
+        std::cerr<<"Problem:Mirror point not found in haloPoint "<<std::endl;
+        return false;
     }
 
     return true;
 }
 
-void ConstraintObservation::collectRegularAndVantagePoints(std::set<int> &identifiedRegularTiles, std::set<int> &identifiedVantagePoints) const{
+void ConstraintObservation::collectRegularAndVantagePoints(HaloBitset &identifiedRegularTiles, HaloBitset &identifiedVantagePoints) const{
 
     if (pointsValue == 0) {
-        log("Regular tiles found: " + setToString(haloPointSet));
-        identifiedRegularTiles.insert(haloPointSet.begin(), 
-                                      haloPointSet.end());
+        LOG_DEBUG("Regular tiles found: " + setToString(haloPointSet));
+        identifiedRegularTiles |= haloPointSet;
         insertAllMirrors(identifiedRegularTiles);
-    } else if (pointsValue == haloPointSet.size() + extraMirroredHaloPointSet.size()) {
-        log("Vantage points found: " + setToString(haloPointSet));
-        identifiedVantagePoints.insert(haloPointSet.begin(), 
-                                       haloPointSet.end());
-        insertAllMirrors(identifiedVantagePoints);        
+    } else if (pointsValue == getTileCount()) {
+        LOG_DEBUG("Vantage points found: " + setToString(haloPointSet));
+        identifiedVantagePoints |= haloPointSet;
+        insertAllMirrors(identifiedVantagePoints);
     }
 }
 
 /**
  * Is 'this' a subset of other?
  */
-bool ConstraintObservation::isSubsetObservation(ConstraintObservation &other) const {
-    return isSubset(haloPointSet, other.haloPointSet) && isSubset(extraMirroredHaloPointSet, other.extraMirroredHaloPointSet);
+bool ConstraintObservation::isSubsetObservation(const ConstraintObservation &other) const {
+    return haloPointSet.isSubsetOf(other.haloPointSet) && extraMirroredHaloPointSet.isSubsetOf(other.extraMirroredHaloPointSet);
 }
 
-bool ConstraintObservation::isSupersetObservation(ConstraintObservation &other) const {
-    return isSuperset(haloPointSet, other.haloPointSet) && isSuperset(extraMirroredHaloPointSet, other.extraMirroredHaloPointSet);
+bool ConstraintObservation::isSupersetObservation(const ConstraintObservation &other) const {
+    return other.haloPointSet.isSubsetOf(haloPointSet) && other.extraMirroredHaloPointSet.isSubsetOf(extraMirroredHaloPointSet);
 }
 
 void ConstraintObservation::log(const std::string message) {
@@ -122,19 +111,23 @@ void ConstraintObservation::log(const std::string message) {
  * first half of the tiles, the second half is called the mirrors.  Mirrors are used to augment faster detection of vantage points
  */
 ConstraintObservation::ConstraintObservation(int pv, const std::set<int>& hps) {
-    GameEnvConfig& gameEnvConfig = GameEnvConfig::getInstance();
     pointsValue = pv;
     for (auto& haloPoint : hps) {
         int firstHalfHaloPoint = symmetry_utils::toFirstHalfID(haloPoint);
+        if (!HaloBitset::fits(firstHalfHaloPoint)) {
+            LOG_WARN("Problem: halo point " + std::to_string(haloPoint) + " is outside the supported map size");
+            std::cerr<<"Problem: halo point outside the supported map size"<<std::endl;
+            continue;
+        }
 
-        if (!contains(haloPointSet, firstHalfHaloPoint)) {
-            haloPointSet.insert(firstHalfHaloPoint);
+        if (!haloPointSet.test(firstHalfHaloPoint)) {
+            haloPointSet.set(firstHalfHaloPoint);
         } else {
-            extraMirroredHaloPointSet.insert(firstHalfHaloPoint);
+            extraMirroredHaloPointSet.set(firstHalfHaloPoint);
         }
     }
 
-    log("Created a new observation from "  + setToString(hps) + " = " + toString());
+    LOG_TRACE("Created a new observation from "  + setToString(hps) + " = " + toString());
 }
 
 /**
@@ -144,14 +137,15 @@ ConstraintObservation::ConstraintObservation(int pv, const std::set<int>& hps) {
  * Simply will split this into " 2 @ {a} | {a'}" and "0 @ {b}" which will further resolve in the set.
  */
 bool ConstraintObservation::simplify(std::vector<ConstraintObservation> &nextRecursionCycle) const{
-    if (extraMirroredHaloPointSet.size() == 0) {
+    int mirrorCount = extraMirroredHaloPointSet.count();
+    if (mirrorCount == 0) {
         return false;
     }
 
     int iMatch = -1;
     int jMatch = -1;
-    for (int i = 0; i <= haloPointSet.size() - extraMirroredHaloPointSet.size(); ++i) {
-        for (int j = 0; j <= extraMirroredHaloPointSet.size(); ++j) {
+    for (int i = 0; i <= haloPointSet.count() - mirrorCount; ++i) {
+        for (int j = 0; j <= mirrorCount; ++j) {
             if (i + 2*j == pointsValue) {
                 if (iMatch == -1 && jMatch == -1) {
                     iMatch = i;
@@ -165,33 +159,22 @@ bool ConstraintObservation::simplify(std::vector<ConstraintObservation> &nextRec
     }
 
     // The non mirrored observation
-    auto splitSet = subtractSets(haloPointSet, extraMirroredHaloPointSet);
-    if (splitSet.size() == 0) {
+    auto splitSet = haloPointSet - extraMirroredHaloPointSet;
+    if (splitSet.empty()) {
         return false;
     }
 
-    auto normalObservation = ConstraintObservation(iMatch, splitSet);
-    auto mirrorObservation = ConstraintObservation(jMatch, extraMirroredHaloPointSet, extraMirroredHaloPointSet);
-    nextRecursionCycle.push_back(std::move(normalObservation));
-    nextRecursionCycle.push_back(std::move(mirrorObservation));
+    nextRecursionCycle.emplace_back(iMatch, splitSet);
+    nextRecursionCycle.emplace_back(jMatch, extraMirroredHaloPointSet, extraMirroredHaloPointSet);
 
-    log("Simplified " + toString() + " into " + normalObservation.toString() + " and " + mirrorObservation.toString());
+    LOG_TRACE("Simplified " + toString() + " into " + nextRecursionCycle[nextRecursionCycle.size() - 2].toString() + " and " + nextRecursionCycle.back().toString());
     return true;
 }
 
-void ConstraintObservation::insertAllMirrors(std::set<int> &target) const{
-    GameEnvConfig& gameEnvConfig = GameEnvConfig::getInstance();
-    for (auto& haloPoint : haloPointSet) {
-        int x = haloPoint % gameEnvConfig.mapWidth;
-        int y = haloPoint / gameEnvConfig.mapWidth;
-
-        int xMir = gameEnvConfig.mapHeight - y - 1;
-        int yMir = gameEnvConfig.mapWidth - x - 1;
-
-        int haloPointMir = yMir * gameEnvConfig.mapWidth + xMir;
-
-        target.insert(haloPointMir);
-    }
+void ConstraintObservation::insertAllMirrors(HaloBitset &target) const{
+    haloPointSet.forEach([&](int haloPoint) {
+        target.set(symmetry_utils::toMirroredID(haloPoint));
+    });
 }
 
 
@@ -200,114 +183,264 @@ void ConstraintSet::log(const std::string message) const {
 }
 
 void ConstraintSet::logMasterSet() const {
-    log(" ---- Master Set ----");
-    for (const auto& observation : masterSet) {
-        log(observation.toString());
+    LOG_DEBUG(" ---- Master Set ----");
+    for (const auto& observation : getMasterSet()) {
+        LOG_DEBUG(observation.toString());
+    }
+    LOG_DEBUG(" --------------------");
+    LOG_DEBUG("Vantage points: " + setToString(identifiedVantagePoints));
+    LOG_DEBUG("Regular tiles : " + setToString(identifiedRegularTiles));
+    LOG_DEBUG(" --------------------");
+}
+
+std::vector<ConstraintObservation> ConstraintSet::getMasterSet() const {
+    std::vector<ConstraintObservation> liveConstraints;
+    for (int slot = 0; slot < std::ssize(masterSet); ++slot) {
+        if (!masterSetRemoved[slot]) {
+            liveConstraints.push_back(masterSet[slot]);
+        }
     }
-    log(" --------------------");
-    log("Vantage points: " + setToString(identifiedVantagePoints));
-    log("Regular tiles : " + setToString(identifiedRegularTiles));
-    log(" --------------------");
+    return liveConstraints;
 }
 
 void ConstraintSet::clear() {
-    identifiedVantagePoints.clear();
-    identifiedRegularTiles.clear();
+    regularTileBits.clear();
+    vantagePointBits.clear();
+    vantageProbabilities.clear();
+    retiredConstraints.clear();
+    publishIdentifiedTiles();
+}
+
+/**
+ * Brings the public sets up to date, only the tiles that changed since the last time are touched
+ */
+void ConstraintSet::publishIdentifiedTiles() {
+    auto publish = [](const HaloBitset& bits, HaloBitset& publishedBits, std::set<int>& tiles) {
+        if (bits == publishedBits) {
+            return;
+        }
+        (publishedBits - bits).forEach([&](int tileId) { tiles.erase(tileId); });
+        (bits - publishedBits).forEach([&](int tileId) { tiles.insert(tileId); });
+        publishedBits = bits;
+    };
+    publish(regularTileBits, publishedRegularTileBits, identifiedRegularTiles);
+    publish(vantagePointBits, publishedVantagePointBits, identifiedVantagePoints);
+}
+
+void ConstraintSet::addToMasterSet(const ConstraintObservation& observation) {
+    int slot = masterSet.size();
+    masterSet.push_back(observation);
+    masterSetRemoved.push_back(false);
+    if (constraintsByTile.empty()) {
+        constraintsByTile.resize(HaloBitset::CAPACITY);
+    }
+    observation.haloPointSet.forEach([&](int tileId) {
+        constraintsByTile[tileId].push_back(slot);
+    });
+}
+
+/**
+ * Leaves a tombstone so the remaining constraints keep their order, the index entries are dropped lazily
+ */
+void ConstraintSet::removeFromMasterSet(int slot) {
+    masterSetRemoved[slot] = true;
+    removedCount++;
+}
+
+/**
+ * Drops the tombstones and rebuilds the tile index once they are the majority
+ */
+void ConstraintSet::compactMasterSet() {
+    if (removedCount * 2 <= std::ssize(masterSet)) {
+        return;
+    }
+
+    std::vector<ConstraintObservation> liveConstraints = getMasterSet();
+    masterSet.clear();
+    masterSetRemoved.clear();
+    removedCount = 0;
+    for (auto& tileConstraints : constraintsByTile) {
+        tileConstraints.clear();
+    }
+    for (const auto& observation : liveConstraints) {
+        addToMasterSet(observation);
+    }
+}
+
+/**
+ * Slots of the live constraints that share a tile with the given tiles, in master set order. Constraints only ever
+ * lose tiles, so the index can list a few that no longer share one, never the other way round.
+ */
+void ConstraintSet::collectCandidates(const HaloBitset& tiles, std::vector<int>& candidates) {
+    candidates.clear();
+    if (constraintsByTile.empty()) {
+        return;
+    }
+    tiles.forEach([&](int tileId) {
+        for (int slot : constraintsByTile[tileId]) {
+            if (!masterSetRemoved[slot]) {
+                candidates.push_back(slot);
+            }
+        }
+    });
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
 }
 
 /**
  * When a new relic is found and if the halo nodes overlap with existing nodes, it is better we 'forget' the older constraints. 
  * This is because, the older constraints need not be true anymore unfortunately. 
  * 
- * I am calling it phaseOut and not forget, because i might come back to this and add versioning logic.  It is too complex to think,
- * but its sad to forget the hard found constraints. :(
+ * With Config::versionedConstraints they are retired instead of forgotten, see reviveRetiredConstraints().
  */
 void ConstraintSet::phaseOutOlderConstraints(int tileId) {
     tileId = symmetry_utils::toFirstHalfID(tileId);
-    log("Phasing out older constraints for tile " + std::to_string(tileId));    
-    auto it = masterSet.begin();
+    LOG_DEBUG("Phasing out older constraints for tile " + std::to_string(tileId) + " in epoch " + std::to_string(epoch));
     int count = 0;
-    while (it != masterSet.end()) {
-        if (contains(it->haloPointSet, tileId)) {
-            log("Removing constraint with points value " + std::to_string(it->pointsValue) + " and halo point set" + setToString(it->haloPointSet));
-            it = masterSet.erase(it);
+    if (!constraintsByTile.empty() && HaloBitset::fits(tileId)) {
+        for (int slot : constraintsByTile[tileId]) {
+            if (!masterSetRemoved[slot] && masterSet[slot].haloPointSet.test(tileId)) {
+                LOG_DEBUG("Removing constraint " + masterSet[slot].toString());
+                retireConstraint(masterSet[slot], tileId);
+                removeFromMasterSet(slot);
+                count++;
+            }
+        }
+        compactMasterSet();
+    }
+
+    // The retired constraints do not know what the tile was back then either
+    for (auto& retiredConstraint : retiredConstraints) {
+        if (retiredConstraint.observation.haloPointSet.test(tileId)) {
+            retiredConstraint.changedTiles.set(tileId);
+        }
+    }
+
+    // Observations still waiting to be solved are just as old
+    int mirroredTileId = symmetry_utils::toMirroredID(tileId);
+    auto deferredIt = deferredConstraints.begin();
+    while (deferredIt != deferredConstraints.end()) {
+        if (contains(deferredIt->second, tileId) || contains(deferredIt->second, mirroredTileId)) {
+            retireConstraint(toObservation(deferredIt->first, deferredIt->second), tileId);
+            deferredIt = deferredConstraints.erase(deferredIt);
             count++;
         } else {
-            ++it;
+            ++deferredIt;
         }
     }
     Metrics::getInstance().add("phased_out_constraints", count);
 }
 
+void ConstraintSet::retireConstraint(const ConstraintObservation& observation, int changedTileId) {
+    if (!Config::versionedConstraints || !HaloBitset::fits(changedTileId)) {
+        return;
+    }
+    RetiredConstraint retiredConstraint{epoch - 1, observation, HaloBitset()};
+    retiredConstraint.changedTiles.set(changedTileId);
+    retiredConstraints.push_back(std::move(retiredConstraint));
+}
+
+/**
+ * A new relic only ever turns tiles into vantage points. So a tile that is regular now was regular in every older
+ * epoch too, and drops out of the retired constraints without changing their points. Once none of the tiles that
+ * changed meaning is left, the constraint holds in the current epoch again and is solved like a new observation. A
+ * changed tile that is a vantage point now tells nothing about the past, those constraints are dropped.
+ */
+void ConstraintSet::reviveRetiredConstraints() {
+    if (retiredConstraints.empty()) {
+        return;
+    }
+
+    HaloBitset identifiedTiles = regularTileBits | vantagePointBits;
+    HaloBitset vantageOnlyTiles = vantagePointBits - regularTileBits;
+    std::vector<ConstraintObservation> revivedConstraints;
+    int droppedCount = 0;
+    auto retiredIt = retiredConstraints.begin();
+    while (retiredIt != retiredConstraints.end()) {
+        ConstraintObservation& observation = retiredIt->observation;
+        observation.haloPointSet.subtract(regularTileBits);
+        observation.extraMirroredHaloPointSet.subtract(regularTileBits);
+        retiredIt->changedTiles.subtract(regularTileBits);
+
+        if (retiredIt->changedTiles.intersects(vantagePointBits)) {
+            LOG_DEBUG("Dropping retired constraint " + observation.toString() + " of epoch " + std::to_string(retiredIt->epoch));
+            retiredIt = retiredConstraints.erase(retiredIt);
+            droppedCount++;
+        } else if (retiredIt->changedTiles.empty()) {
+            LOG_DEBUG("Reviving constraint " + observation.toString() + " of epoch " + std::to_string(retiredIt->epoch));
+            observation.pointsValue -= (observation.haloPointSet & vantageOnlyTiles).count();
+            observation.pointsValue -= (observation.extraMirroredHaloPointSet & vantageOnlyTiles).count();
+            observation.haloPointSet.subtract(identifiedTiles);
+            observation.extraMirroredHaloPointSet.subtract(identifiedTiles);
+            revivedConstraints.push_back(std::move(observation));
+            retiredIt = retiredConstraints.erase(retiredIt);
+        } else {
+            ++retiredIt;
+        }
+    }
+
+    for (const auto& observation : revivedConstraints) {
+        solve(observation);
+    }
+
+    Metrics& metrics = Metrics::getInstance();
+    metrics.add("revived_constraints", revivedConstraints.size());
+    metrics.add("dropped_retired_constraints", droppedCount);
+    metrics.add("retired_constraints", retiredConstraints.size());
+}
+
 /**
  * If the master set has any regular tile or vantage points, then we can reduce them to have a slimmer constraint set.
+ * Constraints that become terminal are taken out and queued to be solved again.
  */
-void ConstraintSet::pruneConstraints() {
-    log("Pruning constraints");
-    auto it = masterSet.begin();
+void ConstraintSet::pruneConstraints(std::vector<Task>& worklist) {
+    LOG_DEBUG("Pruning constraints");
+    HaloBitset identifiedTiles = regularTileBits | vantagePointBits;
+    HaloBitset vantageOnlyTiles = vantagePointBits - regularTileBits; // A tile in both counts as regular
     std::vector<ConstraintObservation> nextRecursionCycle;
-    while (it != masterSet.end()) {
-        auto itPoints = it->haloPointSet.begin();
-        while (itPoints != it->haloPointSet.end()) {
-            int value = *itPoints;
-            if (identifiedRegularTiles.find(value) != identifiedRegularTiles.end()) {
-                log("Prune regular tiles " + std::to_string(value) + " - " + symmetry_utils::toXYString(value));
-                itPoints = it->haloPointSet.erase(itPoints);                
-            } else if (identifiedVantagePoints.find(value) != identifiedVantagePoints.end()) {
-                log("Prune vantage point " + std::to_string(value) + " - " + symmetry_utils::toXYString(value));
-                itPoints = it->haloPointSet.erase(itPoints);
-                it->pointsValue--;
-            } else {
-                ++itPoints;
-            }
+    for (int slot = 0; slot < std::ssize(masterSet); ++slot) {
+        if (masterSetRemoved[slot]) {
+            continue;
         }
 
-        auto itPointsExtra = it->extraMirroredHaloPointSet.begin();
-        while (itPointsExtra != it->extraMirroredHaloPointSet.end()) {
-            int value = *itPointsExtra;
-            if (identifiedRegularTiles.find(value) != identifiedRegularTiles.end()) {
-                log("Prune regular tiles mirror " + std::to_string(value) + " - " + symmetry_utils::toXYString(value));
-                itPointsExtra = it->extraMirroredHaloPointSet.erase(itPointsExtra);                
-            } else if (identifiedVantagePoints.find(value) != identifiedVantagePoints.end()) {
-                log("Prune vantage point mirror" + std::to_string(value) + " - " + symmetry_utils::toXYString(value));
-                itPointsExtra = it->extraMirroredHaloPointSet.erase(itPointsExtra);
-                it->pointsValue--;
-            } else {
-                ++itPointsExtra;
-            }
+        ConstraintObservation& constraint = masterSet[slot];
+        if (constraint.haloPointSet.intersects(identifiedTiles) || constraint.extraMirroredHaloPointSet.intersects(identifiedTiles)) {
+            LOG_TRACE("Prune identified tiles from " + constraint.toString());
+            constraint.pointsValue -= (constraint.haloPointSet & vantageOnlyTiles).count();
+            constraint.pointsValue -= (constraint.extraMirroredHaloPointSet & vantageOnlyTiles).count();
+            constraint.haloPointSet.subtract(identifiedTiles);
+            constraint.extraMirroredHaloPointSet.subtract(identifiedTiles);
         }
 
-        if (it->haloPointSet.empty()) {
-            log("Empty halo point set, removing the constraint");
-            it = masterSet.erase(it);
-        } else if(it->haloPointSet.size() + it->extraMirroredHaloPointSet.size() == it->pointsValue || it->pointsValue == 0) {
-            log("Constraint is terminal, removing the constraint");
-            nextRecursionCycle.push_back(ConstraintObservation(it->pointsValue, std::move(it->haloPointSet), std::move(it->extraMirroredHaloPointSet)));
-            it = masterSet.erase(it);            
-        }else {
-            ++it;
+        if (constraint.haloPointSet.empty()) {
+            LOG_DEBUG("Empty halo point set, removing the constraint");
+            removeFromMasterSet(slot);
+        } else if(constraint.getTileCount() == constraint.pointsValue || constraint.pointsValue == 0) {
+            LOG_DEBUG("Constraint is terminal, removing the constraint");
+            nextRecursionCycle.push_back(constraint);
+            removeFromMasterSet(slot);
         }
     }
+    compactMasterSet();
 
-    for (auto& record : nextRecursionCycle) {
-        addConstraint(record);
+    // Solved in order, so the first one goes on top of the worklist
+    for (auto it = nextRecursionCycle.rbegin(); it != nextRecursionCycle.rend(); ++it) {
+        worklist.push_back({false, std::move(*it)});
     }
 }
 
-void ConstraintSet::addConstraint(int pointsValue, std::set<int>& haloPointSet) {
-    auto start = std::chrono::high_resolution_clock::now();
-    log("Entering constraint with points value " + std::to_string(pointsValue) + " and halo point set" + setToString(haloPointSet));
-    log("Regular tiles: " + setToString(identifiedRegularTiles));
-    log("Vantage points: " + setToString(identifiedVantagePoints));
-
+/**
+ * Drops the tiles that are already identified from the observed tiles, the vantage points with their points
+ */
+ConstraintObservation ConstraintSet::toObservation(int pointsValue, std::set<int>& haloPointSet) const {
     auto it = haloPointSet.begin();
     while (it != haloPointSet.end()) {
         int value = *it;
-        if (identifiedRegularTiles.find(value) != identifiedRegularTiles.end()) {
-            log("Found as regular tile " + std::to_string(value));
+        if (HaloBitset::fits(value) && regularTileBits.test(value)) {
+            LOG_TRACE("Found as regular tile " + std::to_string(value));
             it = haloPointSet.erase(it); 
-        } else if (identifiedVantagePoints.find(value) != identifiedVantagePoints.end()) {
-            log("Found as vantage point " + std::to_string(value));
+        } else if (HaloBitset::fits(value) && vantagePointBits.test(value)) {
+            LOG_TRACE("Found as vantage point " + std::to_string(value));
             it = haloPointSet.erase(it); 
             pointsValue--;
         } else {
@@ -315,132 +448,206 @@ void ConstraintSet::addConstraint(int pointsValue, std::set<int>& haloPointSet)
         }
     }
 
-    ConstraintObservation observation(pointsValue, haloPointSet);
-    addConstraint(std::move(observation));    
+    return ConstraintObservation(pointsValue, haloPointSet);
+}
+
+void ConstraintSet::addConstraint(int pointsValue, std::set<int>& haloPointSet) {
+    auto start = std::chrono::high_resolution_clock::now();
+    LOG_DEBUG("Entering constraint with points value " + std::to_string(pointsValue) + " and halo point set" + setToString(haloPointSet));
+    LOG_DEBUG("Regular tiles: " + setToString(identifiedRegularTiles));
+    LOG_DEBUG("Vantage points: " + setToString(identifiedVantagePoints));
+
+    ConstraintObservation observation = toObservation(pointsValue, haloPointSet);
+    solve(observation);
+    inferExactly();
+    reviveRetiredConstraints();
+    publishIdentifiedTiles();
 
-    Metrics::getInstance().add("constraint_set_size", masterSet.size());
+    Metrics::getInstance().add("constraint_set_size", masterSet.size() - removedCount);
 
     auto end = std::chrono::high_resolution_clock::now();
     auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);  
     Metrics::getInstance().add("add_constraint_duration", duration.count());
 }
 
-void ConstraintSet::reconsiderNormalizedTile(int tileId) {    
+/**
+ * Enumerates the live constraints within the inference budget. Tiles that are a vantage point in every solution or in
+ * none are solved as observations of their own, so they are pruned from the constraints like any other finding.
+ */
+void ConstraintSet::inferExactly() {
+    vantageProbabilities.clear();
+    if (!Config::exactHaloInference || inferenceBudgetMicros <= 0 || std::ssize(masterSet) == removedCount) {
+        return;
+    }
+
+    auto start = HaloInference::Clock::now();
+    HaloInference inference(getMasterSet());
+    bool complete = inference.solve(start + std::chrono::microseconds(inferenceBudgetMicros));
+    long long duration = std::chrono::duration_cast<std::chrono::microseconds>(HaloInference::Clock::now() - start).count();
+    inferenceBudgetMicros -= duration;
+
+    std::vector<ConstraintObservation> decidedTiles;
+    for (auto [tileId, probability] : inference.getMarginals()) {
+        vantageProbabilities[tileId] = probability;
+        vantageProbabilities[symmetry_utils::toMirroredID(tileId)] = probability;
+        if (probability == 0.0 || probability == 1.0) {
+            HaloBitset tile;
+            tile.set(tileId);
+            decidedTiles.emplace_back(probability == 1.0 ? 1 : 0, tile);
+        }
+    }
+    LOG_DEBUG("Exact inference decided " + std::to_string(decidedTiles.size()) + " tiles in " + std::to_string(duration) + " us"
+              + (complete ? "" : ", out of time"));
+
+    for (const auto& decidedTile : decidedTiles) {
+        if (!(decidedTile.haloPointSet - regularTileBits - vantagePointBits).empty()) {
+            solve(decidedTile);
+        }
+    }
+
+    Metrics& metrics = Metrics::getInstance();
+    metrics.add("exact_inference_duration", duration / 1000.0f);
+    metrics.add("exact_inference_components", inference.getComponentCount());
+    metrics.add("exact_inference_decided_tiles", decidedTiles.size());
+    metrics.add("exact_inference_timeouts", complete ? 0 : 1);
+}
+
+double ConstraintSet::getVantageProbability(int tileId) const {
+    if (HaloBitset::fits(tileId) && vantagePointBits.test(tileId)) {
+        return 1.0;
+    }
+    if (HaloBitset::fits(tileId) && regularTileBits.test(tileId)) {
+        return 0.0;
+    }
+    auto it = vantageProbabilities.find(tileId);
+    return it == vantageProbabilities.end() ? -1.0 : it->second;
+}
+
+void ConstraintSet::deferConstraint(int pointsValue, const std::set<int>& haloPointSet) {
+    LOG_DEBUG("Deferring constraint with points value " + std::to_string(pointsValue) + " and halo point set" + setToString(haloPointSet));
+    deferredConstraints.emplace_back(pointsValue, haloPointSet);
+}
+
+void ConstraintSet::resolveNextDeferredConstraint() {
+    auto [pointsValue, haloPointSet] = std::move(deferredConstraints.front());
+    deferredConstraints.pop_front();
+    addConstraint(pointsValue, haloPointSet);
+}
+
+void ConstraintSet::reconsiderTile(int tileId) {
     int mirroredTileId = symmetry_utils::toMirroredID(tileId);
-    if (contains(identifiedRegularTiles, tileId) || contains(identifiedRegularTiles, mirroredTileId)) {
-        identifiedRegularTiles.erase(tileId);
-        identifiedRegularTiles.erase(mirroredTileId);
-        log("Removing regular tile " + std::to_string(tileId) + " and " + std::to_string(mirroredTileId));        
-    } else if (Config::phaseOutConstraints && identifiedVantagePoints.find(tileId) == identifiedVantagePoints.end() && identifiedVantagePoints.find(mirroredTileId) == identifiedVantagePoints.end()) { 
+    vantageProbabilities.erase(tileId);
+    vantageProbabilities.erase(mirroredTileId);
+    if (regularTileBits.test(tileId) || regularTileBits.test(mirroredTileId)) {
+        regularTileBits.reset(tileId);
+        regularTileBits.reset(mirroredTileId);
+        publishIdentifiedTiles();
+        LOG_DEBUG("Removing regular tile " + std::to_string(tileId) + " and " + std::to_string(mirroredTileId));        
+    } else if (Config::phaseOutConstraints && !vantagePointBits.test(tileId) && !vantagePointBits.test(mirroredTileId)) { 
         // This if condition is there just for performance. As vantage points will always be
         // included in the set, better check if it is not a vantage point before phasing out.
         phaseOutOlderConstraints(tileId);
     }
 }
 
+void ConstraintSet::reconsiderNormalizedTile(int tileId) {
+    epoch++;
+    reconsiderTile(tileId);
+}
+
+/**
+ * The tiles change meaning together, they all start the same epoch
+ */
 void ConstraintSet::reconsiderNormalizedTile(std::vector<int> tileIds) {
+    if (tileIds.empty()) {
+        return;
+    }
+    epoch++;
     for (int tileId : tileIds) {
-        reconsiderNormalizedTile(tileId);
+        reconsiderTile(tileId);
     }
 }
 
-void ConstraintSet::addConstraint(const ConstraintObservation& observation) {    
+/**
+ * Solves the observation and everything derived from it depth first, in the order the recursive solver used to.
+ */
+void ConstraintSet::solve(const ConstraintObservation& observation) {
+    std::vector<Task> worklist;
+    worklist.push_back({false, observation});
+    while (!worklist.empty()) {
+        Task task = std::move(worklist.back());
+        worklist.pop_back();
+        if (task.prune) {
+            pruneConstraints(worklist);
+        } else {
+            solveOne(task.observation, worklist);
+        }
+    }
+}
+
+void ConstraintSet::solveOne(const ConstraintObservation& observation, std::vector<Task>& worklist) {
     if (!observation.isValid()) {
         return;
     }
 
-    log("Adding observation - " + observation.toString());
+    LOG_DEBUG("Adding observation - " + observation.toString());
 
-    observation.collectRegularAndVantagePoints(identifiedRegularTiles, identifiedVantagePoints);
+    observation.collectRegularAndVantagePoints(regularTileBits, vantagePointBits);
 
     std::vector<ConstraintObservation> nextRecursionCycle;
-    bool isSubsetFound = false;
-    bool isSupersetFound = false;
+    std::vector<int> candidates;
+    collectCandidates(observation.haloPointSet, candidates);
 
-    auto it = masterSet.begin();
-    while (it != masterSet.end()) {
-        log("Comparing observation with " + it->toString());
+    for (int slot : candidates) {
+        ConstraintObservation& constraint = masterSet[slot];
+        LOG_TRACE("Comparing observation with " + constraint.toString());
 
-        bool iterated = false;
-
-        if (it->haloPointSet == observation.haloPointSet && it->extraMirroredHaloPointSet == observation.extraMirroredHaloPointSet) {
+        if (constraint.haloPointSet == observation.haloPointSet && constraint.extraMirroredHaloPointSet == observation.extraMirroredHaloPointSet) {
             // The same constraint already exists
 
-            if (it->pointsValue != observation.pointsValue) {
-                log("Problem:The constraint already exists with a different points value"
-                 + std::to_string(observation.pointsValue) + " vs " + std::to_string(it->pointsValue));
+            if (constraint.pointsValue != observation.pointsValue) {
+                LOG_WARN("Problem:The constraint already exists with a different points value"
+                 + std::to_string(observation.pointsValue) + " vs " + std::to_string(constraint.pointsValue));
 
                 std::cerr<<"Problem:The constraint already exists with a different points value"<<std::endl;
             }
 
-            log("Constraint already existing, no action");
+            LOG_DEBUG("Constraint already existing, no action");
             return;
-        } else if (observation.isSubsetObservation(*it)) {
-            log("Subset found: " + setToString(observation.haloPointSet) + " is subset of " + setToString(it->haloPointSet));
-            isSubsetFound = true;            
-
-            int newPointsValue = it->pointsValue - observation.pointsValue;
-            auto newSubset = subtractSets(it->haloPointSet, observation.haloPointSet);
-            auto newMirrorSubset = subtractSets(it->extraMirroredHaloPointSet, observation.extraMirroredHaloPointSet);
-            std::set<int> elementsToTransfer;
-            for (int tileId: newMirrorSubset) {
-                if (!contains(newSubset, tileId)){
-                    elementsToTransfer.insert(tileId);
-                }
-            }
-
-            for (const int& elem : elementsToTransfer) {
-                newMirrorSubset.erase(elem);
-                newSubset.insert(elem);
-            }
-
-            nextRecursionCycle.push_back(ConstraintObservation(newPointsValue, std::move(newSubset), std::move(newMirrorSubset)));
+        } else if (observation.isSubsetObservation(constraint)) {
+            LOG_DEBUG("Subset found: " + setToString(observation.haloPointSet) + " is subset of " + setToString(constraint.haloPointSet));
 
-            log("Erasing the superset " + setToString(it->haloPointSet));
-            it = masterSet.erase(it);
-            iterated = true;
-        } else if (observation.isSupersetObservation(*it)) {
-            log("Superset found: " + setToString(observation.haloPointSet) + " is superset of " + setToString(it->haloPointSet));
-            isSupersetFound = true;
+            int newPointsValue = constraint.pointsValue - observation.pointsValue;
+            auto newSubset = constraint.haloPointSet - observation.haloPointSet;
+            auto newMirrorSubset = constraint.extraMirroredHaloPointSet - observation.extraMirroredHaloPointSet;
+            transferUnpairedMirrors(newSubset, newMirrorSubset);
 
-            int newPointsValue = observation.pointsValue - it->pointsValue;
-            auto newSuperset = subtractSets(observation.haloPointSet, it->haloPointSet);
-            auto newMirrorSuperset = subtractSets(observation.extraMirroredHaloPointSet, it->extraMirroredHaloPointSet);
+            nextRecursionCycle.emplace_back(newPointsValue, newSubset, newMirrorSubset);
 
-            std::set<int> elementsToTransfer;
-            for (int tileId: newMirrorSuperset) {
-                if (!contains(newSuperset, tileId)){
-                    elementsToTransfer.insert(tileId);
-                }
-            }
-
-            for (const int& elem : elementsToTransfer) {
-                newMirrorSuperset.erase(elem);
-                newSuperset.insert(elem);
-            }
+            LOG_DEBUG("Erasing the superset " + setToString(constraint.haloPointSet));
+            removeFromMasterSet(slot);
+        } else if (observation.isSupersetObservation(constraint)) {
+            LOG_DEBUG("Superset found: " + setToString(observation.haloPointSet) + " is superset of " + setToString(constraint.haloPointSet));
 
-            nextRecursionCycle.push_back(ConstraintObservation(newPointsValue, std::move(newSuperset), std::move(newMirrorSuperset)));
-        }
+            int newPointsValue = observation.pointsValue - constraint.pointsValue;
+            auto newSuperset = observation.haloPointSet - constraint.haloPointSet;
+            auto newMirrorSuperset = observation.extraMirroredHaloPointSet - constraint.extraMirroredHaloPointSet;
+            transferUnpairedMirrors(newSuperset, newMirrorSuperset);
 
-        // Move to the next element only if it is not already done during delete
-        if (!iterated) {
-            ++it; 
+            nextRecursionCycle.emplace_back(newPointsValue, newSuperset, newMirrorSuperset);
         }
     }
-    
-    if (observation.haloPointSet.size() != observation.pointsValue && observation.pointsValue != 0) {
-        log("This observation is not a terminal, adding it to master set " + setToString(observation.haloPointSet));
-        masterSet.emplace_back(observation);
-    }
 
-    if (observation.simplify(nextRecursionCycle) || isSubsetFound || isSupersetFound) {        
-        for (auto& record : nextRecursionCycle) {
-            log("Recursing..");
-            addConstraint(record);
-        }
+    if (observation.haloPointSet.count() != observation.pointsValue && observation.pointsValue != 0) {
+        LOG_DEBUG("This observation is not a terminal, adding it to master set " + setToString(observation.haloPointSet));
+        addToMasterSet(observation);
     }
 
-    pruneConstraints();
+    observation.simplify(nextRecursionCycle);
 
-    log("All done");
+    // Everything derived is solved before this observation's prune pass, first derived one first
+    worklist.push_back({true, observation});
+    for (auto it = nextRecursionCycle.rbegin(); it != nextRecursionCycle.rend(); ++it) {
+        worklist.push_back({false, std::move(*it)});
+    }
 }
@@ -1,11 +1,13 @@
 #ifndef CONSTRAINT_SET_H
 #define CONSTRAINT_SET_H
 
+#include <deque>
 #include <set>
+#include <unordered_map>
 #include <vector>
 #include <string>
 
-
+#include "datastructures/halo_bitset.h"
 
 class ConstraintObservation {
 
@@ -14,65 +16,128 @@ class ConstraintObservation {
 
     public:
         int pointsValue;
-        std::set<int> haloPointSet;
-        std::set<int> extraMirroredHaloPointSet;
-        
+        HaloBitset haloPointSet;
+        HaloBitset extraMirroredHaloPointSet;
+
 
         // Constructor accepting const reference
         ConstraintObservation(int pv, const std::set<int>& hps);
 
         bool simplify(std::vector<ConstraintObservation> &nextRecursionCycle) const;
 
-        // Move constructor
-        ConstraintObservation(int pv, std::set<int>&& hps)
-            : pointsValue(pv), haloPointSet(std::move(hps)) {}
+        ConstraintObservation(int pv, const HaloBitset& hps)
+            : pointsValue(pv), haloPointSet(hps) {}
 
-        // Constructor accepting const reference
-        ConstraintObservation(int pv, const std::set<int>& hps, const std::set<int>& mhps)
+        ConstraintObservation(int pv, const HaloBitset& hps, const HaloBitset& mhps)
             : pointsValue(pv), haloPointSet(hps), extraMirroredHaloPointSet(mhps) {}
 
-        // Move constructor
-        ConstraintObservation(int pv, std::set<int>&& hps, std::set<int>&& mhps)
-            : pointsValue(pv), haloPointSet(std::move(hps)), extraMirroredHaloPointSet(std::move(mhps)) {}
-
-        void insertAllMirrors(std::set<int>& target) const;
+        void insertAllMirrors(HaloBitset& target) const;
 
         std::string toString() const;
 
         bool isValid() const;
-        void collectRegularAndVantagePoints(std::set<int> & identifiedNormalTiles, std::set<int> & identifiedVantagePoints) const;
+        int getTileCount() const { return haloPointSet.count() + extraMirroredHaloPointSet.count(); }
+        void collectRegularAndVantagePoints(HaloBitset& identifiedNormalTiles, HaloBitset& identifiedVantagePoints) const;
 
-        bool isSubsetObservation(ConstraintObservation& other) const;
-        bool isSupersetObservation(ConstraintObservation& other) const;
+        bool isSubsetObservation(const ConstraintObservation& other) const;
+        bool isSupersetObservation(const ConstraintObservation& other) const;
 };
 
+/**
+ * Solves the halo tiles from the team points gained by the tiles we occupy. Observations are bitsets over the first
+ * half tile ids, a tile id -> constraint index narrows down the constraints a new observation has to be compared
+ * with, and derived observations are solved from a worklist instead of recursing.
+ */
 class ConstraintSet {
     private:
+        struct Task {
+            bool prune; // Prune pass after the observations derived from an observation are solved
+            ConstraintObservation observation;
+        };
 
         void log(const std::string message) const;
-        void pruneConstraints();
-
-        std::vector<ConstraintObservation> masterSet;
-        
-        // std::tuple<bool, ConstraintObservation&> isSubset(const std::set<int> &querySet);
-
-        // std::tuple<bool, ConstraintObservation&> isSuperset(const std::set<int> &querySet);
-        void addConstraint(const ConstraintObservation &observation);
+        void pruneConstraints(std::vector<Task>& worklist);
+        void solve(const ConstraintObservation& observation);
+        void solveOne(const ConstraintObservation& observation, std::vector<Task>& worklist);
+
+        std::vector<ConstraintObservation> masterSet; // Insertion order, removed constraints stay as tombstones
+        std::vector<bool> masterSetRemoved;
+        int removedCount = 0;
+        std::vector<std::vector<int>> constraintsByTile; // First half tile id -> masterSet slots that had the tile
+        std::deque<std::pair<int, std::set<int>>> deferredConstraints; // Observed but not solved yet, oldest first
+
+        HaloBitset regularTileBits;
+        HaloBitset vantagePointBits;
+        HaloBitset publishedRegularTileBits; // What identifiedRegularTiles and identifiedVantagePoints hold now
+        HaloBitset publishedVantagePointBits;
+
+        void addToMasterSet(const ConstraintObservation& observation);
+        void removeFromMasterSet(int slot);
+        void compactMasterSet();
+        void collectCandidates(const HaloBitset& tiles, std::vector<int>& candidates);
+        void publishIdentifiedTiles();
+
+        long long inferenceBudgetMicros = 0;
+        std::unordered_map<int, double> vantageProbabilities; // From the last exact inference, tiles and mirrors
+        void inferExactly();
+
+        /**
+         * A constraint taken out of the master set because some of its tiles changed meaning after it was observed
+         */
+        struct RetiredConstraint {
+            int epoch; // Relic set epoch the constraint holds in
+            ConstraintObservation observation;
+            HaloBitset changedTiles; // Changed meaning since, unknown what they were in the constraint's epoch
+        };
+
+        int epoch = 0;
+        std::vector<RetiredConstraint> retiredConstraints; // Oldest first
+
+        ConstraintObservation toObservation(int pointsValue, std::set<int>& haloPointSet) const;
         void phaseOutOlderConstraints(int tileId);
+        void retireConstraint(const ConstraintObservation& observation, int changedTileId);
+        void reviveRetiredConstraints();
+        void reconsiderTile(int tileId);
     public:
         std::set<int> identifiedVantagePoints;
         std::set<int> identifiedRegularTiles;
 
         void clear();
         void addConstraint(int, std::set<int>&);
+
+        /**
+         * Queues the observation to be solved in a later step, used when the step is out of time
+         */
+        void deferConstraint(int pointsValue, const std::set<int>& haloPointSet);
+        bool hasDeferredConstraints() const { return !deferredConstraints.empty(); }
+
+        /**
+         * Solves the oldest deferred observation
+         */
+        void resolveNextDeferredConstraint();
+        /**
+         * Time the exact inference may spend from now on, it runs after every solved observation while
+         * Config::exactHaloInference is on. Once spent only the subset / superset rules are applied.
+         */
+        void setInferenceBudget(long long micros) { inferenceBudgetMicros = micros; }
+
+        /**
+         * Probability of the tile being a vantage point, negative if no constraint says anything about it
+         */
+        double getVantageProbability(int tileId) const;
+
         void reconsiderNormalizedTile(int tileId);
         void reconsiderNormalizedTile(std::vector<int> tileIds);
 
-        std::vector<ConstraintObservation> getMasterSet() {
-            return masterSet;
-        }
-       
+        std::vector<ConstraintObservation> getMasterSet() const;
+        int getRetiredConstraintCount() const { return retiredConstraints.size(); }
+
+        /**
+         * Incremented every time tiles are reconsidered, i.e. whenever the relic set changes
+         */
+        int getEpoch() const { return epoch; }
+
         void logMasterSet() const;
 };
 
-#endif // CONSTRAINT_SET_H
\ No newline at end of file
+#endif // CONSTRAINT_SET_H
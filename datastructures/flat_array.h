@@ -0,0 +1,106 @@
+#ifndef FLAT_ARRAY_H
+#define FLAT_ARRAY_H
+
+#include <algorithm>
+#include <vector>
+
+/**
+ * Contiguous row-major 2D array. `array[i][j]` resolves to a single offset into one allocation, so full-map passes
+ * walk memory linearly instead of chasing one pointer per row.
+ */
+template <typename T>
+class FlatArray2D {
+public:
+    FlatArray2D() = default;
+    FlatArray2D(int rows, int cols, const T& value = T()) { resize(rows, cols, value); }
+
+    void resize(int rows, int cols, const T& value = T()) {
+        this->rows = rows;
+        this->cols = cols;
+        data.assign(static_cast<size_t>(rows) * cols, value);
+    }
+
+    void fill(const T& value) { std::fill(data.begin(), data.end(), value); }
+
+    T* operator[](int i) { return data.data() + static_cast<size_t>(i) * cols; }
+    const T* operator[](int i) const { return data.data() + static_cast<size_t>(i) * cols; }
+
+    T& at(int i, int j) { return data[static_cast<size_t>(i) * cols + j]; }
+    const T& at(int i, int j) const { return data[static_cast<size_t>(i) * cols + j]; }
+
+    int getRows() const { return rows; }
+    int getCols() const { return cols; }
+    size_t size() const { return data.size(); }
+    bool empty() const { return data.empty(); }
+
+    T* raw() { return data.data(); }
+    const T* raw() const { return data.data(); }
+
+    bool operator==(const FlatArray2D& other) const {
+        return rows == other.rows && cols == other.cols && data == other.data;
+    }
+
+private:
+    int rows = 0;
+    int cols = 0;
+    std::vector<T> data;
+};
+
+/**
+ * Contiguous row-major 3D array, `array[i][j][k]` works through a lightweight 2D view of the i-th slice.
+ */
+template <typename T>
+class FlatArray3D {
+public:
+    template <typename U>
+    class SliceView {
+    public:
+        SliceView(U* base, int cols) : base(base), cols(cols) {}
+        U* operator[](int j) const { return base + static_cast<size_t>(j) * cols; }
+    private:
+        U* base;
+        int cols;
+    };
+
+    FlatArray3D() = default;
+    FlatArray3D(int depth, int rows, int cols, const T& value = T()) { resize(depth, rows, cols, value); }
+
+    void resize(int depth, int rows, int cols, const T& value = T()) {
+        this->depth = depth;
+        this->rows = rows;
+        this->cols = cols;
+        data.assign(static_cast<size_t>(depth) * rows * cols, value);
+    }
+
+    void fill(const T& value) { std::fill(data.begin(), data.end(), value); }
+
+    SliceView<T> operator[](int i) { return SliceView<T>(slice(i), cols); }
+    SliceView<const T> operator[](int i) const { return SliceView<const T>(slice(i), cols); }
+
+    T& at(int i, int j, int k) { return data[(static_cast<size_t>(i) * rows + j) * cols + k]; }
+    const T& at(int i, int j, int k) const { return data[(static_cast<size_t>(i) * rows + j) * cols + k]; }
+
+    T* slice(int i) { return data.data() + static_cast<size_t>(i) * rows * cols; }
+    const T* slice(int i) const { return data.data() + static_cast<size_t>(i) * rows * cols; }
+
+    int getDepth() const { return depth; }
+    int getRows() const { return rows; }
+    int getCols() const { return cols; }
+    size_t size() const { return data.size(); }
+    bool empty() const { return data.empty(); }
+
+    T* raw() { return data.data(); }
+    const T* raw() const { return data.data(); }
+
+    bool operator==(const FlatArray3D& other) const {
+        return depth == other.depth && rows == other.rows && cols == other.cols && data == other.data;
+    }
+
+private:
+    int depth = 0;
+    int rows = 0;
+    int cols = 0;
+    std::vector<T> data;
+};
+
+#endif //FLAT_ARRAY_H
@@ -0,0 +1,119 @@
+#ifndef HALO_BITSET_H
+#define HALO_BITSET_H
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <set>
+
+/**
+ * Fixed width set of tile ids, one bit per tile of the largest (24x24) map. Unlike TileBitboard it never allocates,
+ * so constraint observations can be copied, split and compared with a few word operations.
+ */
+class HaloBitset {
+public:
+    static constexpr int CAPACITY = 24 * 24;
+    static constexpr int WORDS = (CAPACITY + 63) / 64;
+
+    HaloBitset() = default;
+    explicit HaloBitset(const std::set<int>& tileIds) {
+        for (int tileId : tileIds) {
+            set(tileId);
+        }
+    }
+
+    static bool fits(int tileId) { return tileId >= 0 && tileId < CAPACITY; }
+
+    bool test(int tileId) const { return (words[tileId >> 6] >> (tileId & 63)) & 1ULL; }
+    void set(int tileId) { words[tileId >> 6] |= 1ULL << (tileId & 63); }
+    void reset(int tileId) { words[tileId >> 6] &= ~(1ULL << (tileId & 63)); }
+    void clear() { words.fill(0); }
+
+    int count() const {
+        int total = 0;
+        for (uint64_t word : words) {
+            total += std::popcount(word);
+        }
+        return total;
+    }
+
+    bool empty() const {
+        for (uint64_t word : words) {
+            if (word != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /** Every tile of this set is in other. */
+    bool isSubsetOf(const HaloBitset& other) const {
+        for (int i = 0; i < WORDS; ++i) {
+            if ((words[i] & ~other.words[i]) != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool intersects(const HaloBitset& other) const {
+        for (int i = 0; i < WORDS; ++i) {
+            if ((words[i] & other.words[i]) != 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    HaloBitset& operator|=(const HaloBitset& other) {
+        for (int i = 0; i < WORDS; ++i) {
+            words[i] |= other.words[i];
+        }
+        return *this;
+    }
+
+    HaloBitset& operator&=(const HaloBitset& other) {
+        for (int i = 0; i < WORDS; ++i) {
+            words[i] &= other.words[i];
+        }
+        return *this;
+    }
+
+    /** this &= ~other */
+    HaloBitset& subtract(const HaloBitset& other) {
+        for (int i = 0; i < WORDS; ++i) {
+            words[i] &= ~other.words[i];
+        }
+        return *this;
+    }
+
+    HaloBitset operator|(const HaloBitset& other) const { HaloBitset result(*this); return result |= other; }
+    HaloBitset operator&(const HaloBitset& other) const { HaloBitset result(*this); return result &= other; }
+    HaloBitset operator-(const HaloBitset& other) const { HaloBitset result(*this); return result.subtract(other); }
+
+    bool operator==(const HaloBitset& other) const { return words == other.words; }
+    bool operator!=(const HaloBitset& other) const { return words != other.words; }
+
+    /** Calls fn(tileId) for every tile in increasing id order. */
+    template <typename Fn>
+    void forEach(Fn&& fn) const {
+        for (int i = 0; i < WORDS; ++i) {
+            uint64_t word = words[i];
+            while (word != 0) {
+                fn(i * 64 + std::countr_zero(word));
+                word &= word - 1;
+            }
+        }
+    }
+
+    std::set<int> toSet() const {
+        std::set<int> tileIds;
+        forEach([&](int tileId) { tileIds.insert(tileIds.end(), tileId); });
+        return tileIds;
+    }
+
+private:
+    std::array<uint64_t, WORDS> words{};
+};
+
+#endif //HALO_BITSET_H
@@ -0,0 +1,217 @@
+#include "datastructures/halo_inference.h"
+
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+
+#include "logger.h"
+
+void HaloInference::log(const std::string message) {
+    Logger::getInstance().log("HaloInference -> " + message);
+}
+
+HaloInference::HaloInference(const std::vector<ConstraintObservation>& constraints) {
+    std::vector<int> variableByTile(HaloBitset::CAPACITY, -1);
+    for (const auto& constraint : constraints) {
+        int constraintIndex = pointsValues.size();
+        pointsValues.push_back(constraint.pointsValue);
+        variables.emplace_back();
+        constraint.haloPointSet.forEach([&](int tileId) {
+            if (variableByTile[tileId] == -1) {
+                variableByTile[tileId] = tileIds.size();
+                tileIds.push_back(tileId);
+                terms.emplace_back();
+            }
+            int variable = variableByTile[tileId];
+            int weight = constraint.extraMirroredHaloPointSet.test(tileId) ? 2 : 1;
+            variables[constraintIndex].push_back({variable, weight});
+            terms[variable].push_back({constraintIndex, weight});
+        });
+    }
+    buildComponents();
+}
+
+/**
+ * Variables sharing a constraint end up in the same component, smallest component first
+ */
+void HaloInference::buildComponents() {
+    std::vector<int> parent(tileIds.size());
+    std::iota(parent.begin(), parent.end(), 0);
+    auto find = [&](int variable) {
+        while (parent[variable] != variable) {
+            parent[variable] = parent[parent[variable]];
+            variable = parent[variable];
+        }
+        return variable;
+    };
+
+    for (const auto& constraintVariables : variables) {
+        for (const Term& term : constraintVariables) {
+            parent[find(term.index)] = find(constraintVariables.front().index);
+        }
+    }
+
+    std::vector<int> componentByRoot(tileIds.size(), -1);
+    for (int variable = 0; variable < std::ssize(tileIds); ++variable) {
+        int root = find(variable);
+        if (componentByRoot[root] == -1) {
+            componentByRoot[root] = components.size();
+            components.emplace_back();
+        }
+        components[componentByRoot[root]].push_back(variable);
+    }
+    std::stable_sort(components.begin(), components.end(), [](const auto& a, const auto& b) { return a.size() < b.size(); });
+
+    // Branching on the tiles in the most constraints first propagates the furthest
+    for (auto& component : components) {
+        std::stable_sort(component.begin(), component.end(), [&](int a, int b) { return terms[a].size() > terms[b].size(); });
+    }
+}
+
+bool HaloInference::solve(Clock::time_point solveDeadline) {
+    deadline = solveDeadline;
+    timedOut = false;
+    marginals.clear();
+    solvedComponents = 0;
+
+    assignment.assign(tileIds.size(), -1);
+    vantageSolutions.assign(tileIds.size(), 0.0);
+    need = pointsValues;
+    freeWeight.assign(variables.size(), 0);
+    freeSingles.assign(variables.size(), 0);
+    for (int constraint = 0; constraint < std::ssize(variables); ++constraint) {
+        for (const Term& term : variables[constraint]) {
+            freeWeight[constraint] += term.weight;
+            freeSingles[constraint] += term.weight == 1;
+        }
+    }
+
+    for (const auto& component : components) {
+        solutions = 0;
+        pending.clear();
+        for (int variable : component) {
+            for (const Term& term : terms[variable]) {
+                pending.push_back(term.index);
+            }
+        }
+
+        if (propagate()) {
+            search(component);
+        }
+        undo(0);
+        if (timedOut) {
+            LOG_DEBUG("Deadline hit after " + std::to_string(solvedComponents) + " of " + std::to_string(components.size()) + " components");
+            return false;
+        }
+
+        solvedComponents++;
+        if (solutions == 0) {
+            LOG_WARN("Problem: No assignment satisfies the halo constraints of a component with " + std::to_string(component.size()) + " tiles");
+            std::cerr<<"Problem: Inconsistent halo constraints"<<std::endl;
+            continue;
+        }
+        for (int variable : component) {
+            marginals.emplace_back(tileIds[variable], vantageSolutions[variable] / solutions);
+        }
+    }
+    return true;
+}
+
+/**
+ * The unassigned tiles can not make up the points anymore. Weight 2 tiles alone can only make up even points.
+ */
+bool HaloInference::isConflicting(int constraint) const {
+    return need[constraint] < 0 || need[constraint] > freeWeight[constraint] || (need[constraint] % 2 != 0 && freeSingles[constraint] == 0);
+}
+
+bool HaloInference::assign(int variable, int value) {
+    assignment[variable] = value;
+    trail.push_back(variable);
+    bool consistent = true;
+    for (const Term& term : terms[variable]) {
+        freeWeight[term.index] -= term.weight;
+        need[term.index] -= term.weight * value;
+        freeSingles[term.index] -= term.weight == 1;
+        pending.push_back(term.index);
+        consistent = consistent && !isConflicting(term.index);
+    }
+    return consistent;
+}
+
+void HaloInference::undo(int trailSize) {
+    while (std::ssize(trail) > trailSize) {
+        int variable = trail.back();
+        trail.pop_back();
+        for (const Term& term : terms[variable]) {
+            freeWeight[term.index] += term.weight;
+            need[term.index] += term.weight * assignment[variable];
+            freeSingles[term.index] += term.weight == 1;
+        }
+        assignment[variable] = -1;
+    }
+}
+
+/**
+ * Unit propagation: no points left makes every unassigned tile regular, as many points as weight left makes them all
+ * vantage points, and odd points with a single weight 1 tile left make that one a vantage point.
+ */
+bool HaloInference::propagate() {
+    while (!pending.empty()) {
+        int constraint = pending.back();
+        pending.pop_back();
+        if (isConflicting(constraint)) {
+            pending.clear();
+            return false;
+        }
+
+        bool allRegular = need[constraint] == 0;
+        bool allVantage = !allRegular && need[constraint] == freeWeight[constraint];
+        bool oddSingle = need[constraint] % 2 != 0 && freeSingles[constraint] == 1;
+        if (!allRegular && !allVantage && !oddSingle) {
+            continue;
+        }
+
+        for (const Term& term : variables[constraint]) {
+            if (assignment[term.index] != -1 || (!allRegular && !allVantage && term.weight != 1)) {
+                continue;
+            }
+            if (!assign(term.index, allRegular ? 0 : 1)) {
+                pending.clear();
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void HaloInference::search(const std::vector<int>& component) {
+    nodes++;
+    if ((nodes & 255) == 0 && Clock::now() > deadline) {
+        timedOut = true;
+    }
+    if (timedOut) {
+        return;
+    }
+
+    auto unassigned = std::find_if(component.begin(), component.end(), [&](int variable) { return assignment[variable] == -1; });
+    if (unassigned == component.end()) {
+        solutions += 1;
+        for (int variable : component) {
+            vantageSolutions[variable] += assignment[variable];
+        }
+        return;
+    }
+
+    for (int value = 0; value <= 1; ++value) {
+        int trailSize = trail.size();
+        if (assign(*unassigned, value) && propagate()) {
+            search(component);
+        } else {
+            pending.clear();
+        }
+        undo(trailSize);
+        if (timedOut) {
+            return;
+        }
+    }
+}
@@ -0,0 +1,77 @@
+#ifndef HALO_INFERENCE_H
+#define HALO_INFERENCE_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "datastructures/constraint_set.h"
+
+/**
+ * Exact inference over the halo constraints. Every constraint is a linear 0/1 equation over first half tiles, a tile
+ * whose mirror was occupied too counts twice. The tiles are split into connected components and every component is
+ * enumerated with unit propagation and backtracking, each solution taken as equally likely.
+ *
+ * Components are solved smallest first until the deadline, the ones that did not finish report nothing.
+ */
+class HaloInference {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        explicit HaloInference(const std::vector<ConstraintObservation>& constraints);
+
+        /**
+         * False if the deadline cut the enumeration short
+         */
+        bool solve(Clock::time_point deadline);
+
+        /**
+         * First half tile id -> share of the solutions in which it is a vantage point, for the finished components
+         */
+        const std::vector<std::pair<int, double>>& getMarginals() const { return marginals; }
+        int getComponentCount() const { return components.size(); }
+        int getSolvedComponentCount() const { return solvedComponents; }
+        long long getNodeCount() const { return nodes; }
+
+    private:
+        struct Term {
+            int index; // The constraint of a variable, or the variable of a constraint
+            int weight;
+        };
+
+        static void log(const std::string message);
+
+        std::vector<int> tileIds;                   // Variable -> first half tile id
+        std::vector<std::vector<Term>> terms;       // Variable -> constraints it appears in
+        std::vector<std::vector<Term>> variables;   // Constraint -> variables in it
+        std::vector<int> pointsValues;
+        std::vector<std::vector<int>> components;   // Variables of each component
+
+        // Search state
+        std::vector<int8_t> assignment;             // -1 unassigned, 0 regular, 1 vantage point
+        std::vector<int> need;                      // Points the unassigned variables still have to make up
+        std::vector<int> freeWeight;                // Weight of the unassigned variables
+        std::vector<int> freeSingles;               // Unassigned variables with weight 1
+        std::vector<int> trail;
+        std::vector<int> pending;                   // Constraints to propagate
+
+        double solutions = 0;
+        std::vector<double> vantageSolutions;
+        Clock::time_point deadline;
+        bool timedOut = false;
+        long long nodes = 0;
+
+        int solvedComponents = 0;
+        std::vector<std::pair<int, double>> marginals;
+
+        void buildComponents();
+        bool isConflicting(int constraint) const;
+        bool assign(int variable, int value);
+        bool propagate();
+        void undo(int trailSize);
+        void search(const std::vector<int>& component);
+};
+
+#endif //HALO_INFERENCE_H
@@ -17,24 +17,24 @@ void RespawnRegistry::log(const std::string& message) {
 }
 
 void RespawnRegistry::logCurrentState() {
-    log("=== RESPAWN REGISTRY STATE ===");
-    log("Player respawn record: " + mapToString(playerRespawnRecord));
-    log("Player respawn step index: " + mapToString(playerRespawnStepIndex));
-    log("Player death record: " + mapToString(playerDeathRecord));
-    log("Player queue size: " + std::to_string(playerRespawnQueueSize));
+    LOG_DEBUG("=== RESPAWN REGISTRY STATE ===");
+    LOG_DEBUG("Player respawn record: " + mapToString(playerRespawnRecord));
+    LOG_DEBUG("Player respawn step index: " + mapToString(playerRespawnStepIndex));
+    LOG_DEBUG("Player death record: " + mapToString(playerDeathRecord));
+    LOG_DEBUG("Player queue size: " + std::to_string(playerRespawnQueueSize));
     
-    log("Opponent respawn record: " + mapToString(opponentRespawnRecord));
-    log("Opponent respawn step index: " + mapToString(opponentRespawnStepIndex));
-    log("Opponent death record: " + mapToString(opponentDeathRecord));
-    log("Opponent queue size: " + std::to_string(opponentRespawnQueueSize));
+    LOG_DEBUG("Opponent respawn record: " + mapToString(opponentRespawnRecord));
+    LOG_DEBUG("Opponent respawn step index: " + mapToString(opponentRespawnStepIndex));
+    LOG_DEBUG("Opponent death record: " + mapToString(opponentDeathRecord));
+    LOG_DEBUG("Opponent queue size: " + std::to_string(opponentRespawnQueueSize));
     
     if (playerUnitRespawned != -1) {
-        log("Last player unit respawned: " + std::to_string(playerUnitRespawned));
+        LOG_DEBUG("Last player unit respawned: " + std::to_string(playerUnitRespawned));
     }
     if (opponentUnitRespawned != -1) {
-        log("Last opponent unit respawned: " + std::to_string(opponentUnitRespawned));
+        LOG_DEBUG("Last opponent unit respawned: " + std::to_string(opponentUnitRespawned));
     }
-    log("=============================");
+    LOG_DEBUG("=============================");
 }
 
 int RespawnRegistry::getNextSpawnStep(int currentStep, int queueSize) {
@@ -55,7 +55,7 @@ int RespawnRegistry::slotTheCurrentUnit(int currentStep, int& queueSize, std::un
 
             currentPosition = i;
         } else {
-            log("Problem: spawn step " + std::to_string(currentSpawnStep) + " is not found in the respawn queue for index " + std::to_string(i));
+            LOG_WARN("Problem: spawn step " + std::to_string(currentSpawnStep) + " is not found in the respawn queue for index " + std::to_string(i));
             std::cerr<<"Problem: spawn step is not found in the respawn queue"<<std::endl;
         }
     }
@@ -79,26 +79,26 @@ int RespawnRegistry::slotTheCurrentUnit(int currentStep, int& queueSize, std::un
 int RespawnRegistry::pushPlayerUnit(int unitId, int step){
 
     if (playerRespawnRecord.find(unitId) != playerRespawnRecord.end()) {
-        log("Player unit " + std::to_string(unitId) + " is already in the respawn queue");
+        LOG_DEBUG("Player unit " + std::to_string(unitId) + " is already in the respawn queue");
         return playerRespawnRecord[unitId];
     }
 
     int spawnStep = slotTheCurrentUnit(step, playerRespawnQueueSize, playerRespawnRecord, playerRespawnStepIndex, playerDeathRecord, unitId);
 
-    log("Player unit " + std::to_string(unitId) + " will respawn at " + std::to_string(spawnStep) + " as the queue size is " + std::to_string(playerRespawnQueueSize));
+    LOG_DEBUG("Player unit " + std::to_string(unitId) + " will respawn at " + std::to_string(spawnStep) + " as the queue size is " + std::to_string(playerRespawnQueueSize));
     return spawnStep;
 }
 
 int RespawnRegistry::pushOpponentUnit(int unitId, int step){
 
     if (opponentRespawnRecord.find(unitId) != opponentRespawnRecord.end()) {
-        log("Opponent unit " + std::to_string(unitId) + " is already in the respawn queue");
+        LOG_DEBUG("Opponent unit " + std::to_string(unitId) + " is already in the respawn queue");
         return opponentRespawnRecord[unitId];
     }
     
     int spawnStep = slotTheCurrentUnit(step, opponentRespawnQueueSize, opponentRespawnRecord, opponentRespawnStepIndex, opponentDeathRecord, unitId);
 
-    log("Opponent unit " + std::to_string(unitId) + " will respawn at " + std::to_string(spawnStep) + " as the queue size is " + std::to_string(opponentRespawnQueueSize));
+    LOG_DEBUG("Opponent unit " + std::to_string(unitId) + " will respawn at " + std::to_string(spawnStep) + " as the queue size is " + std::to_string(opponentRespawnQueueSize));
     return spawnStep;
 }
 
@@ -144,7 +144,7 @@ void RespawnRegistry::step(int currentStep) {
         playerRespawnRecord.erase(unitId);
         playerDeathRecord.erase(unitId);
         playerRespawnStepIndex.erase(currentStep);
-        log("Player unit " + std::to_string(unitId) + " has respawned");
+        LOG_DEBUG("Player unit " + std::to_string(unitId) + " has respawned");
         playerUnitRespawned = unitId;
     }
 
@@ -155,14 +155,14 @@ void RespawnRegistry::step(int currentStep) {
         opponentRespawnRecord.erase(unitId);
         opponentDeathRecord.erase(unitId);
         opponentRespawnStepIndex.erase(currentStep);
-        log("Opponent unit " + std::to_string(unitId) + " has respawned");
+        LOG_DEBUG("Opponent unit " + std::to_string(unitId) + " has respawned");
         opponentUnitRespawned = unitId;
     }
 }
 
 void RespawnRegistry::printUpcomingRespawns(int currentStep) {
-    log("player spawns -> " + mapToString(playerRespawnRecord));
-    log("opponent spawns -> " + mapToString(opponentRespawnRecord));
+    LOG_DEBUG("player spawns -> " + mapToString(playerRespawnRecord));
+    LOG_DEBUG("opponent spawns -> " + mapToString(opponentRespawnRecord));
 }
 
 bool RespawnRegistry::isOpponentShuttleAlive(int shuttleId, int stepId) {
@@ -0,0 +1,61 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+/**
+ * Bounded lock-free queue for exactly one producer thread and one consumer thread. Capacity is rounded up to a power
+ * of two, head and tail only ever grow and are masked into the slot array.
+ */
+template <typename T>
+class SpscRing {
+public:
+    explicit SpscRing(size_t capacity) {
+        size_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        slots.resize(size);
+        mask = size - 1;
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    /** Producer side, the value is left untouched when the ring is full. */
+    bool tryPush(T&& value) {
+        size_t currentHead = head.load(std::memory_order_relaxed);
+        if (currentHead - tail.load(std::memory_order_acquire) == slots.size()) {
+            return false;
+        }
+        slots[currentHead & mask] = std::move(value);
+        head.store(currentHead + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** Consumer side. */
+    bool tryPop(T& value) {
+        size_t currentTail = tail.load(std::memory_order_relaxed);
+        if (currentTail == head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = std::move(slots[currentTail & mask]);
+        tail.store(currentTail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const { return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire); }
+    size_t capacity() const { return slots.size(); }
+
+private:
+    std::vector<T> slots;
+    size_t mask = 0;
+
+    // Separate cache lines, the producer spins on head and the consumer on tail
+    alignas(64) std::atomic<size_t> head{0};
+    alignas(64) std::atomic<size_t> tail{0};
+};
+
+#endif //SPSC_RING_H
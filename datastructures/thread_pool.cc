@@ -0,0 +1,83 @@
+#include "thread_pool.h"
+
+ThreadPool::ThreadPool(int threads) {
+    for (int i = 1; i < threads; ++i) {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::parallelFor(int count, const std::function<void(int)>& fn) {
+    if (workers.empty() || count <= 1) {
+        for (int i = 0; i < count; ++i) {
+            fn(i);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        task = &fn;
+        taskCount = count;
+        nextIndex.store(0);
+        activeWorkers = static_cast<int>(workers.size());
+        generation++;
+    }
+    workAvailable.notify_all();
+
+    drain();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    workDone.wait(lock, [this] { return activeWorkers == 0; });
+    task = nullptr;
+    if (failure) {
+        std::exception_ptr rethrown = failure;
+        failure = nullptr;
+        std::rethrow_exception(rethrown);
+    }
+}
+
+void ThreadPool::drain() {
+    for (int i = nextIndex.fetch_add(1); i < taskCount; i = nextIndex.fetch_add(1)) {
+        try {
+            (*task)(i);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!failure) {
+                failure = std::current_exception();
+            }
+        }
+    }
+}
+
+void ThreadPool::workerLoop() {
+    long long seenGeneration = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            workAvailable.wait(lock, [&] { return stopping || generation != seenGeneration; });
+            if (stopping) {
+                return;
+            }
+            seenGeneration = generation;
+        }
+
+        drain();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            activeWorkers--;
+        }
+        workDone.notify_one();
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Fixed set of worker threads created once and reused every step. The only operation is a blocking parallel for,
+ * the calling thread works on the batch too, so a pool of n threads starts n - 1 workers.
+ */
+class ThreadPool {
+public:
+    explicit ThreadPool(int threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int getThreadCount() const { return static_cast<int>(workers.size()) + 1; }
+
+    /**
+     * Runs fn(i) for every i in [0, count) and returns once all of them are done. Indices are handed out
+     * dynamically, fn must not depend on which thread runs it. The first exception thrown by fn is rethrown here.
+     */
+    void parallelFor(int count, const std::function<void(int)>& fn);
+
+private:
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable workAvailable;
+    std::condition_variable workDone;
+
+    const std::function<void(int)>* task = nullptr;
+    int taskCount = 0;
+    std::atomic<int> nextIndex{0};
+    int activeWorkers = 0;
+    long long generation = 0;
+    bool stopping = false;
+    std::exception_ptr failure;
+
+    void workerLoop();
+    void drain();
+};
+
+#endif //THREAD_POOL_H
@@ -0,0 +1,211 @@
+#ifndef TILE_BITBOARD_H
+#define TILE_BITBOARD_H
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+/**
+ * One bit per tile, indexed by tile id (y * width + x). A 24x24 map fits in nine 64 bit words, so map-wide queries
+ * such as counting explored tiles or finding the neighbours of a region become a handful of word operations.
+ *
+ * Bits beyond width * height are always kept clear.
+ */
+class TileBitboard {
+public:
+    TileBitboard() = default;
+    TileBitboard(int width, int height) { resize(width, height); }
+
+    void resize(int width, int height) {
+        this->width = width;
+        this->height = height;
+        words.assign((width * height + 63) / 64, 0);
+    }
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+
+    bool test(int id) const { return (words[id >> 6] >> (id & 63)) & 1ULL; }
+    bool operator[](int id) const { return test(id); }
+
+    void set(int id, bool value = true) {
+        uint64_t mask = 1ULL << (id & 63);
+        if (value) {
+            words[id >> 6] |= mask;
+        } else {
+            words[id >> 6] &= ~mask;
+        }
+    }
+
+    void reset(int id) { words[id >> 6] &= ~(1ULL << (id & 63)); }
+    void clear() { std::fill(words.begin(), words.end(), 0); }
+
+    int count() const {
+        int total = 0;
+        for (uint64_t word : words) {
+            total += std::popcount(word);
+        }
+        return total;
+    }
+
+    bool any() const {
+        for (uint64_t word : words) {
+            if (word != 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool none() const { return !any(); }
+    bool all() const { return count() == width * height; }
+
+    TileBitboard& operator&=(const TileBitboard& other) {
+        for (size_t i = 0; i < words.size(); ++i) {
+            words[i] &= other.words[i];
+        }
+        return *this;
+    }
+
+    TileBitboard& operator|=(const TileBitboard& other) {
+        for (size_t i = 0; i < words.size(); ++i) {
+            words[i] |= other.words[i];
+        }
+        return *this;
+    }
+
+    TileBitboard& operator^=(const TileBitboard& other) {
+        for (size_t i = 0; i < words.size(); ++i) {
+            words[i] ^= other.words[i];
+        }
+        return *this;
+    }
+
+    /** this &= ~other */
+    TileBitboard& subtract(const TileBitboard& other) {
+        for (size_t i = 0; i < words.size(); ++i) {
+            words[i] &= ~other.words[i];
+        }
+        return *this;
+    }
+
+    TileBitboard operator&(const TileBitboard& other) const { TileBitboard result(*this); return result &= other; }
+    TileBitboard operator|(const TileBitboard& other) const { TileBitboard result(*this); return result |= other; }
+    TileBitboard operator^(const TileBitboard& other) const { TileBitboard result(*this); return result ^= other; }
+
+    TileBitboard operator~() const {
+        TileBitboard result(*this);
+        for (auto& word : result.words) {
+            word = ~word;
+        }
+        result.clearPadding();
+        return result;
+    }
+
+    bool operator==(const TileBitboard& other) const { return words == other.words; }
+
+    /**
+     * Moves every set bit by (dx, dy) with |dx| <= 1. Bits pushed off the board are dropped, they never wrap into
+     * the neighbouring row.
+     */
+    TileBitboard shifted(int dx, int dy) const {
+        TileBitboard result(width, height);
+        int offset = dy * width + dx;
+        if (offset >= 0) {
+            shiftLeftInto(result, offset);
+        } else {
+            shiftRightInto(result, -offset);
+        }
+
+        if (dx == 1) {
+            result.subtract(columnMask(0));
+        } else if (dx == -1) {
+            result.subtract(columnMask(width - 1));
+        }
+        result.clearPadding();
+        return result;
+    }
+
+    /** Tiles that are 4-neighbours of at least one set tile. */
+    TileBitboard neighbours() const {
+        TileBitboard result = shifted(0, -1);
+        result |= shifted(0, 1);
+        result |= shifted(-1, 0);
+        result |= shifted(1, 0);
+        return result;
+    }
+
+    /** Applies the map symmetry (x, y) -> (height - y - 1, width - x - 1) to every set bit. */
+    TileBitboard mirrored() const {
+        TileBitboard result(width, height);
+        forEach([&](int id) {
+            int x = id % width;
+            int y = id / width;
+            result.set((width - x - 1) * width + (height - y - 1));
+        });
+        return result;
+    }
+
+    /** Calls fn(tileId) for every set bit in increasing id order. */
+    template <typename Fn>
+    void forEach(Fn&& fn) const {
+        for (size_t i = 0; i < words.size(); ++i) {
+            uint64_t word = words[i];
+            while (word != 0) {
+                int bit = std::countr_zero(word);
+                fn(static_cast<int>(i * 64 + bit));
+                word &= word - 1;
+            }
+        }
+    }
+
+    const std::vector<uint64_t>& getWords() const { return words; }
+
+private:
+    int width = 0;
+    int height = 0;
+    std::vector<uint64_t> words;
+
+    void clearPadding() {
+        int used = (width * height) & 63;
+        if (used != 0 && !words.empty()) {
+            words.back() &= (1ULL << used) - 1;
+        }
+    }
+
+    TileBitboard columnMask(int column) const {
+        TileBitboard mask(width, height);
+        for (int y = 0; y < height; ++y) {
+            mask.set(y * width + column);
+        }
+        return mask;
+    }
+
+    void shiftLeftInto(TileBitboard& result, int bits) const {
+        int wordShift = bits >> 6;
+        int bitShift = bits & 63;
+        for (int i = static_cast<int>(words.size()) - 1; i >= wordShift; --i) {
+            uint64_t value = words[i - wordShift] << bitShift;
+            if (bitShift != 0 && i - wordShift - 1 >= 0) {
+                value |= words[i - wordShift - 1] >> (64 - bitShift);
+            }
+            result.words[i] = value;
+        }
+    }
+
+    void shiftRightInto(TileBitboard& result, int bits) const {
+        int wordShift = bits >> 6;
+        int bitShift = bits & 63;
+        int size = static_cast<int>(words.size());
+        for (int i = 0; i + wordShift < size; ++i) {
+            uint64_t value = words[i + wordShift] >> bitShift;
+            if (bitShift != 0 && i + wordShift + 1 < size) {
+                value |= words[i + wordShift + 1] << (64 - bitShift);
+            }
+            result.words[i] = value;
+        }
+    }
+};
+
+#endif //TILE_BITBOARD_H
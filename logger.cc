@@ -1,44 +1,150 @@
 #include "logger.h"
 
+std::atomic<int> Logger::threshold{Logger::DISABLED};
+
 Logger& Logger::getInstance() {
     static Logger instance;
     return instance;
 }
 
+LogLevel Logger::parseLevel(const std::string& name) {
+    if (name == "trace") {
+        return LogLevel::TRACE;
+    } else if (name == "info") {
+        return LogLevel::INFO;
+    } else if (name == "warn") {
+        return LogLevel::WARN;
+    }
+    return LogLevel::DEBUG;
+}
+
+void Logger::setLevel(LogLevel level) {
+    this->level = level;
+    if (log_file.is_open()) {
+        threshold = static_cast<int>(level);
+    }
+}
+
 void Logger::setPlayerName(const std::string& name) {
-    player_name = name;
+    context = std::make_shared<LogContext>(LogContext{context->stepId, name});
 }
 
 void Logger::setStepId(const std::string& id) {
-    step_id = id;
+    context = std::make_shared<LogContext>(LogContext{id, context->playerName});
 }
 
 void Logger::enableLogging(const std::string& filename) {
     if (!log_file.is_open()) {
         log_file.open(filename, std::ios::out | std::ios::app);
+        running = true;
+        writer = std::thread(&Logger::writeLoop, this);
+        threshold = static_cast<int>(level);
     }
 }
 
+void Logger::disableLogging() {
+    if (!log_file.is_open()) {
+        return;
+    }
+    threshold = DISABLED;
+    running = false;
+    writer.join();
+    log_file.close();
+}
+
 bool Logger::isDebugEnabled() {
-    return log_file.is_open();
+    return isEnabled();
 }
 
 void Logger::log(const std::string& message) {
-    if (log_file.is_open()) {
-        auto now = std::chrono::system_clock::now();
-        auto in_time_t = std::chrono::system_clock::to_time_t(now);
-        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()) % 1000;
+    if (isEnabled()) {
+        push(LogRecord{std::chrono::system_clock::now(), context, message});
+    }
+}
 
-        std::tm tm = *std::localtime(&in_time_t);
-        log_file << std::put_time(&tm, "%M:%S")
-                 << '.' << std::setfill('0') << std::setw(3) << ms.count()
-                 << " : " << step_id
-                 << " : " << player_name << " - " << message << std::endl;
+void Logger::log(std::string&& message) {
+    if (isEnabled()) {
+        push(LogRecord{std::chrono::system_clock::now(), context, std::move(message)});
     }
 }
 
-Logger::~Logger() {
-    if (log_file.is_open()) {
-        log_file.close();
+void Logger::flush() {
+    unsigned long long target = pushedCount.load();
+    while (isEnabled() && flushedCount.load() < target) {
+        std::this_thread::yield();
+    }
+}
+
+SpscRing<Logger::LogRecord>& Logger::getThreadRing() {
+    thread_local SpscRing<LogRecord>* ring = nullptr;
+    if (ring == nullptr) {
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        rings.push_back(std::make_unique<SpscRing<LogRecord>>(RING_CAPACITY));
+        ring = rings.back().get();
+    }
+    return *ring;
+}
+
+void Logger::push(LogRecord&& record) {
+    SpscRing<LogRecord>& ring = getThreadRing();
+    while (!ring.tryPush(std::move(record))) {
+        // Writer is behind, wait for it rather than dropping lines
+        std::this_thread::yield();
+    }
+    pushedCount++;
+}
+
+void Logger::writeLoop() {
+    while (running) {
+        if (!drain()) {
+            log_file.flush();
+            flushedCount = writtenCount;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    while (drain()) {
     }
+    log_file.flush();
+    flushedCount = writtenCount;
+}
+
+/**
+ * Writes whatever the rings hold right now, false if they were all empty
+ */
+bool Logger::drain() {
+    {
+        // Only the ring list is guarded, a thread registering its ring never waits for the file
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        drainedRings.clear();
+        for (auto& ring : rings) {
+            drainedRings.push_back(ring.get());
+        }
+    }
+
+    bool wrote = false;
+    LogRecord record;
+    for (SpscRing<LogRecord>* ring : drainedRings) {
+        while (ring->tryPop(record)) {
+            write(record);
+            wrote = true;
+        }
+    }
+    return wrote;
+}
+
+void Logger::write(const LogRecord& record) {
+    auto in_time_t = std::chrono::system_clock::to_time_t(record.time);
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(record.time.time_since_epoch()) % 1000;
+
+    std::tm tm;
+    localtime_r(&in_time_t, &tm);
+    log_file << std::put_time(&tm, "%M:%S")
+             << '.' << std::setfill('0') << std::setw(3) << ms.count()
+             << " : " << record.context->stepId
+             << " : " << record.context->playerName << " - " << record.message << '\n';
+    writtenCount++;
+}
+
+Logger::~Logger() {
+    disableLogging();
 }
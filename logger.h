@@ -7,25 +7,121 @@
 #include <ctime>
 #include <iomanip>
 #include <chrono>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
 
+#include "datastructures/spsc_ring.h"
+
+#define LOG_LEVEL_TRACE 0
+#define LOG_LEVEL_DEBUG 1
+#define LOG_LEVEL_INFO 2
+#define LOG_LEVEL_WARN 3
+
+// Calls below this level are compiled out, set by CMake per build type
+#ifndef MOSFET_MIN_LOG_LEVEL
+#define MOSFET_MIN_LOG_LEVEL LOG_LEVEL_TRACE
+#endif
+
+enum class LogLevel : int {
+    TRACE = LOG_LEVEL_TRACE, // Per tile / per candidate detail inside loops
+    DEBUG = LOG_LEVEL_DEBUG, // Progress of a step
+    INFO = LOG_LEVEL_INFO, // Once per step or game, observations and discoveries
+    WARN = LOG_LEVEL_WARN // Problems
+};
+
+/**
+ * Calls the log helper in scope if the level is compiled in and enabled at runtime. The message is not built otherwise.
+ */
+#define LOG_AT(level, message) do { \
+        if constexpr (static_cast<int>(level) >= MOSFET_MIN_LOG_LEVEL) { \
+            if (Logger::isEnabled(level)) { log(message); } \
+        } \
+    } while (0)
+
+#define LOG_TRACE(message) LOG_AT(LogLevel::TRACE, message)
+#define LOG_DEBUG(message) LOG_AT(LogLevel::DEBUG, message)
+#define LOG_INFO(message) LOG_AT(LogLevel::INFO, message)
+#define LOG_WARN(message) LOG_AT(LogLevel::WARN, message)
+
+/**
+ * Asynchronous file logger. log() only timestamps the message and pushes it into a ring owned by the calling thread,
+ * a background writer drains the rings, formats the lines and writes them to the file.
+ */
 class Logger {
 public:
     static Logger& getInstance();
 
+    static bool isEnabled() { return isEnabled(LogLevel::WARN); }
+    static bool isEnabled(LogLevel level) { return static_cast<int>(level) >= threshold.load(std::memory_order_relaxed); }
+
+    /**
+     * trace, debug, info or warn, anything else is debug
+     */
+    static LogLevel parseLevel(const std::string& name);
+
+    void setLevel(LogLevel level);
+
     void setPlayerName(const std::string& name);
     void setStepId(const std::string& id);
     void enableLogging(const std::string& filename);
+
+    /**
+     * Writes out everything logged so far, stops the writer and closes the file
+     */
+    void disableLogging();
     bool isDebugEnabled();
     void log(const std::string& message);
+    void log(std::string&& message);
+
+    /**
+     * Blocks until everything logged so far is in the file
+     */
+    void flush();
 
 private:
-    std::string step_id = "init";
-    std::string player_name = "Unknown";
+    struct LogContext {
+        std::string stepId;
+        std::string playerName;
+    };
+
+    struct LogRecord {
+        std::chrono::system_clock::time_point time;
+        std::shared_ptr<const LogContext> context;
+        std::string message;
+    };
+
+    static constexpr size_t RING_CAPACITY = 4096;
+    static constexpr int DISABLED = LOG_LEVEL_WARN + 1;
+    static std::atomic<int> threshold; // Lowest level written, DISABLED while the file is closed
+
+    LogLevel level = LogLevel::DEBUG;
+
+    // Replaced, never modified, by the game thread between steps. Records keep the one they were logged under
+    std::shared_ptr<const LogContext> context = std::make_shared<LogContext>(LogContext{"init", "Unknown"});
     std::ofstream log_file;
 
+    std::mutex ringsMutex;
+    std::vector<std::unique_ptr<SpscRing<LogRecord>>> rings; // One per producing thread, kept for the logger lifetime
+    std::vector<SpscRing<LogRecord>*> drainedRings; // Writer thread only, the rings copied out of the lock
+
+    std::thread writer;
+    std::atomic<bool> running{false};
+    std::atomic<unsigned long long> pushedCount{0};
+    std::atomic<unsigned long long> flushedCount{0};
+    unsigned long long writtenCount = 0;
+
     Logger() = default;
     ~Logger();
 
+    SpscRing<LogRecord>& getThreadRing();
+    void push(LogRecord&& record);
+    void writeLoop();
+    bool drain();
+    void write(const LogRecord& record);
+
     // Delete copy constructor and assignment operator
     Logger(const Logger&) = delete;
     Logger& operator=(const Logger&) = delete;
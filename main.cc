@@ -17,6 +17,10 @@ using json = nlohmann::json;
 
 ControlCenter* cc = new ControlCenter();
 
+// Reused across steps so the streaming parser can write into buffers sized on the first step
+ObservationParser observationParser;
+GameState gameState;
+
 void emit_memory_usage_metric() {
     struct rusage usage;
     getrusage(RUSAGE_SELF, &usage);
@@ -30,17 +34,16 @@ void process(std::string& input, int counter) {
 
     auto start = std::chrono::high_resolution_clock::now();
 
-    log("Input --> " + input);
+    LOG_INFO("Input --> " + input);
 
-    json jsonObject = json::parse(input);
-    GameState gameState = jsonObject.get<GameState>();
+    observationParser.parse(input, gameState);
 
     cc->update(gameState);
     cc->plan();
     std::vector<std::vector<int>> results = cc->act();
     
     json json_results = {{"action", results}};
-    log("Output --> " + json_results.dump());
+    LOG_INFO("Output --> " + json_results.dump());
     std::cout << json_results.dump() << std::endl;
     std::cerr.flush();
     std::cout.flush();
@@ -50,7 +53,7 @@ void process(std::string& input, int counter) {
     }
 
     if (cc->gameMap->derivedGameState.currentStep == 504) {
-        log("All done, have a nice day");        
+        LOG_INFO("All done, have a nice day");        
         if (Config::enableMetricDetails) {
             Metrics::getInstance().details.wins = cc->gameMap->derivedGameState.teamWins;
             Metrics::getInstance().details.losses = cc->gameMap->derivedGameState.opponentWins;
@@ -96,7 +99,7 @@ int main(int argc, char* argv[]) {
         Metrics::getInstance().enableMetrics("metrics.csv");
     }
     
-    log("Mosfet daemon started with config " + configFile);    
+    LOG_INFO("Mosfet daemon started with config " + configFile);    
 
     std::string input;
     
@@ -107,10 +110,10 @@ int main(int argc, char* argv[]) {
         try{            
             process(input, counter++);                        
         } catch (const std::exception& e) {
-            log("Exception caught: " + std::string(e.what()));
+            LOG_WARN("Exception caught: " + std::string(e.what()));
 
             delete cc;
-            log("Deleted CC, good bye");
+            LOG_INFO("Deleted CC, good bye");
             std::cerr << "Fatal:" << e.what() << std::endl;
             return -1;
         }
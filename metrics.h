@@ -6,6 +6,7 @@
 #include <fstream>
 #include <string>
 #include <ctime>
+#include <mutex>
 
 
 struct MetricDetails {
@@ -69,6 +70,7 @@ class Metrics {
 
         void add(const std::string& name, const float value){
             if (log_file.is_open()) {
+                std::lock_guard<std::mutex> lock(mutex);
                 log_file << step_id << "," << player_name << "," << name << "," << value << std::endl;
             }
         }
@@ -128,6 +130,7 @@ class Metrics {
         std::string step_id = "-1";
         std::string player_name = "Unknown";
         std::ofstream log_file;
+        std::mutex mutex;
 
         Metrics() = default;
         ~Metrics() {
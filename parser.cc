@@ -1,5 +1,11 @@
 #include "parser.h"
 
+#include <charconv>
+#include <cstdlib>
+#include <stdexcept>
+
+#include "logger.h"
+
 // Define from_json for Info
 void from_json(const json& j, Info& i) {
     if (j.contains("env_cfg")) {
@@ -25,7 +31,34 @@ void from_json(const json &j, MapFeatures &m) {
     }
 }
 
-void from_json(const json &j, Obs &m) {
+void from_json(const json& j, FlatArray2D<int>& a) {
+    int rows = static_cast<int>(j.size());
+    int cols = rows > 0 ? static_cast<int>(j[0].size()) : 0;
+    a.resize(rows, cols);
+    for (int i = 0; i < rows; i++) {
+        int* row = a[i];
+        for (int k = 0; k < cols; k++) {
+            row[k] = j[i][k].get<int>();
+        }
+    }
+}
+
+void from_json(const json& j, FlatArray3D<int>& a) {
+    int depth = static_cast<int>(j.size());
+    int rows = depth > 0 ? static_cast<int>(j[0].size()) : 0;
+    int cols = rows > 0 ? static_cast<int>(j[0][0].size()) : 0;
+    a.resize(depth, rows, cols);
+    for (int i = 0; i < depth; i++) {
+        for (int k = 0; k < rows; k++) {
+            int* row = a[i][k];
+            for (int l = 0; l < cols; l++) {
+                row[l] = j[i][k][l].get<int>();
+            }
+        }
+    }
+}
+
+void from_json(const json &j, ObservationFrame &m) {
     if (j.contains("units")) {
         j.at("units").get_to(m.units);
     }
@@ -83,81 +116,56 @@ std::ostream& operator<<(std::ostream& os, const Info& info) {
     return os;
 }
 
+template <typename T>
+static void printRows(std::ostream& os, const FlatArray2D<T>& array) {
+    for (int i = 0; i < array.getRows(); i++) {
+        os << "\t\t[";
+        for (int k = 0; k < array.getCols(); k++) {
+            os << array[i][k] << ", ";
+        }
+        os << "], ";
+    }
+}
+
 std::ostream &operator<<(std::ostream &os, const Units &units) {
     os << "\n\tposition: \n";
-    for (const auto& position : units.position) {
+    for (int t = 0; t < units.position.getDepth(); t++) {
         os << "\t\t[";
-        for (const auto& pos : position) {
+        for (int u = 0; u < units.position.getRows(); u++) {
             os << "[";
-            for (const auto& p : pos) {
-                os << p << ", ";
+            for (int c = 0; c < units.position.getCols(); c++) {
+                os << units.position[t][u][c] << ", ";
             }
             os << "], ";
         }
         os << "], ";
     }
     os << "\n\tenergy: \n";
-    for (const auto& e1 : units.energy) {
-        os << "\t\t[";
-        for (const auto& e2 : e1) {
-            os << e2 << ", ";
-        }
-        os << "], ";
-    }
+    printRows(os, units.energy);
     return os;
 }
 
 std::ostream &operator<<(std::ostream &os, const MapFeatures &mapFeatures) {
     os << "\n\tenergy: \n";
-    for (const auto& energy : mapFeatures.energy) {
-        os << "\t\t[";
-        for (const auto& e : energy) {
-            os << e << ", ";
-        }
-        os << "], ";
-    }
+    printRows(os, mapFeatures.energy);
     os << "\n\ttileType: \n";
-    for (const auto& tileType : mapFeatures.tileType) {
-        os << "\t\t[";
-        for (const auto& t : tileType) {
-            os << t << ", ";
-        }
-        os << "], ";
-    }
+    printRows(os, mapFeatures.tileType);
     return os;
 }
 
-std::ostream &operator<<(std::ostream &os, const Obs &obs) {
+std::ostream &operator<<(std::ostream &os, const ObservationFrame &obs) {
     os << "\n\tunits: " << obs.units;
     os << "\n\tunitsMask: \n";
-    for (const auto& unitsMask : obs.unitsMask) {
-        os << "\t\t[";
-        for (const auto& u : unitsMask) {
-            os << u << ", ";
-        }
-        os << "], ";
-    }
+    printRows(os, obs.unitsMask);
     os << "\n\tsensorMask: \n";
-    for (const auto& sensorMask : obs.sensorMask) {
-        os << "\t\t[";
-        for (const auto& s : sensorMask) {
-            os << s << ", ";
-        }
-        os << "], ";
-    }
+    printRows(os, obs.sensorMask);
     os << "\n\tmapFeatures: " << obs.mapFeatures;
     os << "\n\trelicNodesMask: \n";
     for (const auto& relicNodesMask : obs.relicNodesMask) {
         os << "\t\t" << relicNodesMask << ", ";
     }
     os << "\n\trelicNodes: \n";
-    for (const auto& relicNodes : obs.relicNodes) {
-        os << "\t\t[";
-        for (const auto& r : relicNodes) {
-            os << r << ", ";
-        }
-        os << "], ";
-    }
+    printRows(os, obs.relicNodes);
     os << "\n\tteamPoints: \n";
     for (const auto& teamPoints : obs.teamPoints) {
         os << "\t\t" << teamPoints << ", ";
@@ -192,3 +200,344 @@ GameState parse(const std::string& input) {
     json jsonObject = json::parse(input);
     return jsonObject.get<GameState>();
 }
+
+void ObservationParser::parse(const std::string& input, GameState& gameState) {
+    if (!prepared) {
+        gameState = ::parse(input);
+        prepare(gameState);
+        return;
+    }
+
+    cursor = input.data();
+    end = input.data() + input.size();
+    shapeMismatch = false;
+
+    if (!stream(gameState)) {
+        Logger::getInstance().log("ObservationParser -> Problem: observation shape differs from env_cfg, falling back to json parse");
+        std::cerr << "Problem: observation shape differs from env_cfg, falling back to json parse" << std::endl;
+        gameState = ::parse(input);
+        prepare(gameState);
+    }
+}
+
+void ObservationParser::prepare(GameState& gameState) {
+    auto& envCfg = gameState.info.envCfg;
+    auto matches = [&envCfg](const std::string& key, int actual) {
+        auto it = envCfg.find(key);
+        return it == envCfg.end() || it->second == actual;
+    };
+
+    // The frame was sized by the json path, later steps are streamed into the same buffers. Relic count is not part
+    // of env_cfg so the first observation defines it.
+    ObservationFrame& obs = gameState.obs;
+    if (!matches("num_teams", obs.unitsMask.getRows()) || !matches("max_units", obs.unitsMask.getCols())
+        || !matches("map_width", obs.sensorMask.getRows()) || !matches("map_height", obs.sensorMask.getCols())) {
+        Logger::getInstance().log("ObservationParser -> Problem: observation shape differs from env_cfg");
+        std::cerr << "Problem: observation shape differs from env_cfg" << std::endl;
+    }
+
+    prepared = true;
+}
+
+bool ObservationParser::stream(GameState& gameState) {
+    expect('{');
+    if (consume('}')) {
+        return !shapeMismatch;
+    }
+    do {
+        std::string_view key = readKey();
+        if (key == "obs") {
+            readObs(gameState.obs);
+        } else if (key == "remainingOverageTime") {
+            gameState.remainingOverageTime = readInt();
+        } else if (key == "player") {
+            readString(gameState.player);
+        } else {
+            // env_cfg is fixed for the episode and was captured while preparing
+            skipValue();
+        }
+    } while (consume(','));
+    expect('}');
+    return !shapeMismatch;
+}
+
+void ObservationParser::readObs(ObservationFrame& obs) {
+    expect('{');
+    if (consume('}')) {
+        return;
+    }
+    do {
+        std::string_view key = readKey();
+        if (key == "units") {
+            readUnits(obs.units);
+        } else if (key == "units_mask") {
+            readArray(obs.unitsMask);
+        } else if (key == "sensor_mask") {
+            readArray(obs.sensorMask);
+        } else if (key == "map_features") {
+            readMapFeatures(obs.mapFeatures);
+        } else if (key == "relic_nodes_mask") {
+            readArray(obs.relicNodesMask);
+        } else if (key == "relic_nodes") {
+            readArray(obs.relicNodes);
+        } else if (key == "team_points") {
+            readArray(obs.teamPoints);
+        } else if (key == "team_wins") {
+            readArray(obs.teamWins);
+        } else if (key == "steps") {
+            obs.steps = readInt();
+        } else if (key == "match_steps") {
+            obs.matchSteps = readInt();
+        } else {
+            skipValue();
+        }
+    } while (consume(','));
+    expect('}');
+}
+
+void ObservationParser::readUnits(Units& units) {
+    expect('{');
+    if (consume('}')) {
+        return;
+    }
+    do {
+        std::string_view key = readKey();
+        if (key == "position") {
+            readArray(units.position);
+        } else if (key == "energy") {
+            readArray(units.energy);
+        } else {
+            skipValue();
+        }
+    } while (consume(','));
+    expect('}');
+}
+
+void ObservationParser::readMapFeatures(MapFeatures& mapFeatures) {
+    expect('{');
+    if (consume('}')) {
+        return;
+    }
+    do {
+        std::string_view key = readKey();
+        if (key == "energy") {
+            readArray(mapFeatures.energy);
+        } else if (key == "tile_type") {
+            readArray(mapFeatures.tileType);
+        } else {
+            skipValue();
+        }
+    } while (consume(','));
+    expect('}');
+}
+
+void ObservationParser::readArray(std::vector<int>& target) {
+    expect('[');
+    size_t index = 0;
+    if (!consume(']')) {
+        do {
+            int value = readInt();
+            if (index < target.size()) {
+                target[index] = value;
+            }
+            index++;
+        } while (consume(','));
+        expect(']');
+    }
+    if (index != target.size()) {
+        shapeMismatch = true;
+    }
+}
+
+void ObservationParser::readArray(int* target, int length) {
+    expect('[');
+    int index = 0;
+    if (!consume(']')) {
+        do {
+            int value = readInt();
+            if (index < length) {
+                target[index] = value;
+            }
+            index++;
+        } while (consume(','));
+        expect(']');
+    }
+    if (index != length) {
+        shapeMismatch = true;
+    }
+}
+
+void ObservationParser::readArray(FlatArray2D<int>& target) {
+    expect('[');
+    int index = 0;
+    if (!consume(']')) {
+        do {
+            if (index < target.getRows()) {
+                readArray(target[index], target.getCols());
+            } else {
+                skipValue();
+            }
+            index++;
+        } while (consume(','));
+        expect(']');
+    }
+    if (index != target.getRows()) {
+        shapeMismatch = true;
+    }
+}
+
+void ObservationParser::readArray(FlatArray3D<int>& target) {
+    expect('[');
+    int index = 0;
+    if (!consume(']')) {
+        do {
+            if (index < target.getDepth()) {
+                expect('[');
+                int row = 0;
+                if (!consume(']')) {
+                    do {
+                        if (row < target.getRows()) {
+                            readArray(target[index][row], target.getCols());
+                        } else {
+                            skipValue();
+                        }
+                        row++;
+                    } while (consume(','));
+                    expect(']');
+                }
+                if (row != target.getRows()) {
+                    shapeMismatch = true;
+                }
+            } else {
+                skipValue();
+            }
+            index++;
+        } while (consume(','));
+        expect(']');
+    }
+    if (index != target.getDepth()) {
+        shapeMismatch = true;
+    }
+}
+
+void ObservationParser::skipWhitespace() {
+    while (cursor < end && (*cursor == ' ' || *cursor == '\n' || *cursor == '\r' || *cursor == '\t')) {
+        cursor++;
+    }
+}
+
+void ObservationParser::expect(char c) {
+    if (!consume(c)) {
+        fail(std::string("expected '") + c + "'");
+    }
+}
+
+bool ObservationParser::consume(char c) {
+    skipWhitespace();
+    if (cursor < end && *cursor == c) {
+        cursor++;
+        return true;
+    }
+    return false;
+}
+
+std::string_view ObservationParser::readKey() {
+    expect('"');
+    const char* start = cursor;
+    while (cursor < end && *cursor != '"') {
+        cursor += (*cursor == '\\') ? 2 : 1;
+    }
+    if (cursor >= end) {
+        fail("unterminated string");
+    }
+    std::string_view key(start, cursor - start);
+    cursor++;
+    expect(':');
+    return key;
+}
+
+int ObservationParser::readInt() {
+    skipWhitespace();
+    if (cursor >= end) {
+        fail("unexpected end of input");
+    }
+
+    // Masks arrive as json booleans, the DOM path converts them to 0/1 as well
+    if (*cursor == 't' || *cursor == 'f' || *cursor == 'n') {
+        int value = *cursor == 't' ? 1 : 0;
+        skipValue();
+        return value;
+    }
+
+    const char* numberStart = cursor;
+    int value = 0;
+    auto [next, error] = std::from_chars(cursor, end, value);
+    if (error != std::errc()) {
+        fail("expected a number");
+    }
+    cursor = next;
+
+    if (cursor < end && (*cursor == '.' || *cursor == 'e' || *cursor == 'E')) {
+        // Fractional numbers are truncated just like json::get<int>
+        char* doubleEnd = nullptr;
+        value = static_cast<int>(std::strtod(numberStart, &doubleEnd));
+        cursor = doubleEnd;
+    }
+    return value;
+}
+
+void ObservationParser::readString(std::string& target) {
+    skipWhitespace();
+    expect('"');
+    const char* start = cursor;
+    while (cursor < end && *cursor != '"') {
+        cursor += (*cursor == '\\') ? 2 : 1;
+    }
+    if (cursor >= end) {
+        fail("unterminated string");
+    }
+    target.assign(start, cursor - start);
+    cursor++;
+}
+
+void ObservationParser::skipValue() {
+    skipWhitespace();
+    if (cursor >= end) {
+        fail("unexpected end of input");
+    }
+
+    char c = *cursor;
+    if (c == '{' || c == '[') {
+        char close = (c == '{') ? '}' : ']';
+        cursor++;
+        if (consume(close)) {
+            return;
+        }
+        do {
+            if (c == '{') {
+                readKey();
+            }
+            skipValue();
+        } while (consume(','));
+        expect(close);
+    } else if (c == '"') {
+        cursor++;
+        while (cursor < end && *cursor != '"') {
+            cursor += (*cursor == '\\') ? 2 : 1;
+        }
+        if (cursor >= end) {
+            fail("unterminated string");
+        }
+        cursor++;
+    } else {
+        // Numbers and literals
+        while (cursor < end && *cursor != ',' && *cursor != '}' && *cursor != ']' &&
+               *cursor != ' ' && *cursor != '\n' && *cursor != '\r' && *cursor != '\t') {
+            cursor++;
+        }
+    }
+}
+
+void ObservationParser::fail(const std::string& reason) {
+    throw std::invalid_argument("Malformed observation, " + reason);
+}
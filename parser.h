@@ -6,8 +6,11 @@
 #include <vector>
 #include <map>
 #include <sstream>
+#include <string_view>
 #include <nlohmann/json.hpp>
 
+#include "datastructures/flat_array.h"
+
 using json = nlohmann::json;
 
 struct Info {
@@ -15,22 +18,25 @@ struct Info {
 };
 
 struct Units {
-    std::vector<std::vector<std::vector<int>>> position;
-    std::vector<std::vector<int>> energy;
+    FlatArray3D<int> position;  // [team][unit][x/y]
+    FlatArray2D<int> energy;    // [team][unit]
 };
 
 struct MapFeatures {
-    std::vector<std::vector<int>> energy;
-    std::vector<std::vector<int>> tileType;
+    FlatArray2D<int> energy;    // [x][y]
+    FlatArray2D<int> tileType;  // [x][y]
 };
 
-struct Obs {
+/**
+ * One observation with every 2D/3D field stored contiguously in row-major order, one allocation per field.
+ */
+struct ObservationFrame {
     Units units;
-    std::vector<std::vector<int>> unitsMask;
-    std::vector<std::vector<int>> sensorMask;
+    FlatArray2D<int> unitsMask;   // [team][unit]
+    FlatArray2D<int> sensorMask;  // [x][y]
     MapFeatures mapFeatures;
     std::vector<int> relicNodesMask;
-    std::vector<std::vector<int>> relicNodes;
+    FlatArray2D<int> relicNodes;  // [relic][x/y]
     std::vector<int> teamPoints;
     std::vector<int> teamWins;
     int steps;
@@ -38,7 +44,7 @@ struct Obs {
 };
 
 struct GameState {
-    Obs obs;
+    ObservationFrame obs;
     int remainingOverageTime;
     std::string player;
     Info info;
@@ -48,16 +54,57 @@ struct GameState {
 void from_json(const json& j, Info& i);
 void from_json(const json& j, Units& u);
 void from_json(const json& j, MapFeatures& m);
-void from_json(const json& j, Obs& m);
+void from_json(const json& j, ObservationFrame& m);
+void from_json(const json& j, FlatArray2D<int>& a);
+void from_json(const json& j, FlatArray3D<int>& a);
 void from_json(const json& j, GameState& g);
 
 std::ostream& operator<<(std::ostream& os, const Info& info);
 std::ostream& operator<<(std::ostream& os, const Units& units);
 std::ostream& operator<<(std::ostream& os, const MapFeatures& mapFeatures);
-std::ostream& operator<<(std::ostream& os, const Obs& obs);
+std::ostream& operator<<(std::ostream& os, const ObservationFrame& obs);
 std::ostream& operator<<(std::ostream& os, const GameState& gameState);
 
 std::string to_string(const GameState& gameState);
 GameState parse(const std::string& input);
 
+/**
+ * Streaming observation parser. The first step goes through the json DOM path, which sizes the observation frame
+ * and is checked against env_cfg; later steps scan the raw line once and write values in place, so steady state
+ * parsing does not touch the heap.
+ */
+class ObservationParser {
+public:
+    void parse(const std::string& input, GameState& gameState);
+    bool isPrepared() const { return prepared; }
+
+private:
+    bool prepared = false;
+    bool shapeMismatch = false;
+    const char* cursor = nullptr;
+    const char* end = nullptr;
+
+    void prepare(GameState& gameState);
+    bool stream(GameState& gameState);
+
+    void skipWhitespace();
+    void expect(char c);
+    bool consume(char c);
+    std::string_view readKey();
+    int readInt();
+    void readString(std::string& target);
+    void skipValue();
+
+    void readArray(std::vector<int>& target);
+    void readArray(int* target, int length);
+    void readArray(FlatArray2D<int>& target);
+    void readArray(FlatArray3D<int>& target);
+
+    void readObs(ObservationFrame& obs);
+    void readUnits(Units& units);
+    void readMapFeatures(MapFeatures& mapFeatures);
+
+    [[noreturn]] void fail(const std::string& reason);
+};
+
 #endif // PARSER_H
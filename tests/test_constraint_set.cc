@@ -1,7 +1,11 @@
 #include "datastructures/constraint_set.h"
 #include <gtest/gtest.h>
+#include <chrono>
+#include <random>
 #include "game_env_config.h"
 #include "symmetry_util.h"    
+#include "config.h"
+#include "legacy_constraint_set.h"
 
 class ConstraintSetTest : public ::testing::Test {
     
@@ -130,10 +134,10 @@ TEST_F(ConstraintSetTest, TestSupersetThatCanResolve) {
     if (masterSet.size() == 1) {
         auto observation = masterSet[0];
         EXPECT_EQ(observation.pointsValue, 1);
-        EXPECT_EQ(observation.haloPointSet.size(), 3);
-        EXPECT_NE(observation.haloPointSet.find(p1), observation.haloPointSet.end());
-        EXPECT_NE(observation.haloPointSet.find(p2), observation.haloPointSet.end());
-        EXPECT_NE(observation.haloPointSet.find(p3), observation.haloPointSet.end());
+        EXPECT_EQ(observation.haloPointSet.count(), 3);
+        EXPECT_TRUE(observation.haloPointSet.test(p1));
+        EXPECT_TRUE(observation.haloPointSet.test(p2));
+        EXPECT_TRUE(observation.haloPointSet.test(p3));
     }
 
     // Lets continue the exploration
@@ -268,6 +272,343 @@ TEST_F(ConstraintSetTest, TestSupersetWithMirrorPromotion) {
     EXPECT_NE(constraintSet.identifiedRegularTiles.find(p3Mirr), constraintSet.identifiedRegularTiles.end());
 }
 
+TEST_F(ConstraintSetTest, TestDeferredConstraintsResolveInOrder) {
+    Logger::getInstance().setPlayerName("TestDeferredConstraintsResolveInOrder");
+
+    std::set<int> haloPointSet1 = {p1, p2, p3};
+    std::set<int> haloPointSet2 = {p2, p1Mirr};
+    constraintSet.deferConstraint(2, haloPointSet1);
+    constraintSet.deferConstraint(2, haloPointSet2);
+
+    EXPECT_TRUE(constraintSet.identifiedVantagePoints.empty());
+
+    while (constraintSet.hasDeferredConstraints()) {
+        constraintSet.resolveNextDeferredConstraint();
+    }
+
+    EXPECT_NE(constraintSet.identifiedVantagePoints.find(p1), constraintSet.identifiedVantagePoints.end());
+    EXPECT_NE(constraintSet.identifiedVantagePoints.find(p2), constraintSet.identifiedVantagePoints.end());
+    EXPECT_NE(constraintSet.identifiedRegularTiles.find(p3), constraintSet.identifiedRegularTiles.end());
+}
+
+TEST_F(ConstraintSetTest, TestDeferredConstraintsArePhasedOut) {
+    Logger::getInstance().setPlayerName("TestDeferredConstraintsArePhasedOut");
+
+    std::set<int> haloPointSet1 = {p1Mirr, p2};
+    constraintSet.deferConstraint(1, haloPointSet1);
+    constraintSet.reconsiderNormalizedTile(p1);
+
+    EXPECT_FALSE(constraintSet.hasDeferredConstraints());
+}
+
+/**
+ * Points gained by random groups of occupied halo tiles around a few relics, with the occasional tile reconsidered
+ */
+struct ConstraintStream {
+    std::vector<std::pair<int, std::set<int>>> observations;
+    std::vector<int> reconsideredTiles; // -1 where nothing is reconsidered after the observation
+    std::set<int> vantagePoints;
+};
+
+static ConstraintStream makeConstraintStream(int seed, int steps, int relics = 6) {
+    std::mt19937 random(seed);
+    std::set<int> haloTiles;
+    std::set<int> vantagePoints;
+    for (int relic = 0; relic < relics; relic++) {
+        int relicX = 2 + random() % 14;
+        int relicY = 2 + random() % (20 - relicX);
+        for (int x = relicX - 2; x <= relicX + 2; x++) {
+            for (int y = relicY - 2; y <= relicY + 2; y++) {
+                int tileId = symmetry_utils::toID(x, y);
+                int mirroredTileId = symmetry_utils::toMirroredID(tileId);
+                haloTiles.insert(tileId);
+                haloTiles.insert(mirroredTileId);
+                if (random() % 5 == 0) {
+                    vantagePoints.insert(tileId);
+                    vantagePoints.insert(mirroredTileId);
+                }
+            }
+        }
+    }
+
+    std::vector<int> halo(haloTiles.begin(), haloTiles.end());
+    ConstraintStream stream;
+    stream.vantagePoints = vantagePoints;
+    for (int step = 0; step < steps; step++) {
+        std::set<int> occupied;
+        int shuttles = 4 + random() % 9;
+        for (int i = 0; i < shuttles; i++) {
+            occupied.insert(halo[random() % halo.size()]);
+        }
+        int points = 0;
+        for (int tileId : occupied) {
+            points += vantagePoints.count(tileId);
+        }
+        stream.observations.emplace_back(points, occupied);
+        stream.reconsideredTiles.push_back(step % 10 == 9 ? halo[random() % halo.size()] : -1);
+    }
+    return stream;
+}
+
+TEST_F(ConstraintSetTest, MatchesLegacySolverOnLongStreams) {
+    Logger::getInstance().setPlayerName("MatchesLegacySolverOnLongStreams");
+    const int steps = 500;
+
+    long long legacyMicros = 0;
+    long long bitsetMicros = 0;
+    for (int seed = 1; seed <= 5; seed++) {
+        ConstraintStream stream = makeConstraintStream(seed, steps);
+        legacy::ConstraintSet legacySet;
+        ConstraintSet bitsetSet;
+
+        for (int step = 0; step < steps; step++) {
+            auto [points, tiles] = stream.observations[step];
+            std::set<int> legacyTiles = tiles;
+            std::set<int> bitsetTiles = tiles;
+
+            auto start = std::chrono::high_resolution_clock::now();
+            legacySet.addConstraint(points, legacyTiles);
+            if (stream.reconsideredTiles[step] != -1) {
+                legacySet.reconsiderNormalizedTile(stream.reconsideredTiles[step]);
+            }
+            auto middle = std::chrono::high_resolution_clock::now();
+            bitsetSet.addConstraint(points, bitsetTiles);
+            if (stream.reconsideredTiles[step] != -1) {
+                bitsetSet.reconsiderNormalizedTile(stream.reconsideredTiles[step]);
+            }
+            auto end = std::chrono::high_resolution_clock::now();
+            legacyMicros += std::chrono::duration_cast<std::chrono::microseconds>(middle - start).count();
+            bitsetMicros += std::chrono::duration_cast<std::chrono::microseconds>(end - middle).count();
+
+            ASSERT_EQ(bitsetTiles, legacyTiles) << "seed " << seed << " step " << step;
+            ASSERT_EQ(bitsetSet.identifiedVantagePoints, legacySet.identifiedVantagePoints) << "seed " << seed << " step " << step;
+            ASSERT_EQ(bitsetSet.identifiedRegularTiles, legacySet.identifiedRegularTiles) << "seed " << seed << " step " << step;
+            ASSERT_EQ(bitsetSet.getMasterSet().size(), legacySet.getMasterSet().size()) << "seed " << seed << " step " << step;
+        }
+        EXPECT_FALSE(bitsetSet.identifiedVantagePoints.empty());
+    }
+
+    std::cout << "ConstraintSet over 5 x " << steps << " observations : std::set " << legacyMicros / 1000.0
+              << " ms, bitset " << bitsetMicros / 1000.0 << " ms" << std::endl;
+}
+
+TEST_F(ConstraintSetTest, ExactInferenceResolvesWhatTheRulesCannot) {
+    Logger::getInstance().setPlayerName("ExactInferenceResolvesWhatTheRulesCannot");
+    // No constraint is a subset of another, but only p2 = p4 = 1 and p1 = p3 = 0 satisfies all three
+    std::vector<std::pair<int, std::set<int>>> observations = {{1, {p1, p2}}, {1, {p2, p3}}, {1, {p1, p3, p4}}};
+
+    ConstraintSet rulesOnly;
+    for (auto [points, tiles] : observations) {
+        rulesOnly.addConstraint(points, tiles);
+    }
+    EXPECT_TRUE(rulesOnly.identifiedVantagePoints.empty());
+    EXPECT_TRUE(rulesOnly.identifiedRegularTiles.empty());
+
+    Config::exactHaloInference = true;
+    for (auto [points, tiles] : observations) {
+        constraintSet.setInferenceBudget(100000);
+        constraintSet.addConstraint(points, tiles);
+    }
+    Config::exactHaloInference = false;
+
+    EXPECT_EQ(constraintSet.identifiedVantagePoints, std::set<int>({p2, p2Mirr, p4, p4Mirr}));
+    EXPECT_EQ(constraintSet.identifiedRegularTiles, std::set<int>({p1, p1Mirr, p3, p3Mirr}));
+    EXPECT_TRUE(constraintSet.getMasterSet().empty());
+}
+
+TEST_F(ConstraintSetTest, ExactInferenceReportsMarginals) {
+    Logger::getInstance().setPlayerName("ExactInferenceReportsMarginals");
+    // Three solutions: p1 alone, or p2 with either p3 or p4
+    std::set<int> haloPointSet1 = {p1, p2};
+    std::set<int> haloPointSet2 = {p1, p3, p4};
+
+    Config::exactHaloInference = true;
+    constraintSet.setInferenceBudget(100000);
+    constraintSet.addConstraint(1, haloPointSet1);
+    constraintSet.addConstraint(1, haloPointSet2);
+    Config::exactHaloInference = false;
+
+    EXPECT_DOUBLE_EQ(constraintSet.getVantageProbability(p1), 1.0 / 3);
+    EXPECT_DOUBLE_EQ(constraintSet.getVantageProbability(p1Mirr), 1.0 / 3);
+    EXPECT_DOUBLE_EQ(constraintSet.getVantageProbability(p2), 2.0 / 3);
+    EXPECT_DOUBLE_EQ(constraintSet.getVantageProbability(p3), 1.0 / 3);
+    EXPECT_DOUBLE_EQ(constraintSet.getVantageProbability(p4), 1.0 / 3);
+    EXPECT_LT(constraintSet.getVantageProbability(p5), 0);
+}
+
+TEST_F(ConstraintSetTest, ExactInferenceFallsBackToTheRulesWithoutBudget) {
+    Logger::getInstance().setPlayerName("ExactInferenceFallsBackToTheRulesWithoutBudget");
+    std::set<int> haloPointSet1 = {p1, p2};
+    std::set<int> haloPointSet2 = {p2, p3};
+    std::set<int> haloPointSet3 = {p1, p3, p4};
+
+    Config::exactHaloInference = true;
+    constraintSet.setInferenceBudget(0);
+    constraintSet.addConstraint(1, haloPointSet1);
+    constraintSet.addConstraint(1, haloPointSet2);
+    constraintSet.addConstraint(1, haloPointSet3);
+    Config::exactHaloInference = false;
+
+    EXPECT_TRUE(constraintSet.identifiedVantagePoints.empty());
+    EXPECT_EQ(constraintSet.getMasterSet().size(), 3);
+    EXPECT_LT(constraintSet.getVantageProbability(p2), 0);
+}
+
+TEST_F(ConstraintSetTest, ExactInferenceAgreesWithTheHiddenVantagePoints) {
+    Logger::getInstance().setPlayerName("ExactInferenceAgreesWithTheHiddenVantagePoints");
+    const int steps = 40;
+
+    int rulesIdentified = 0;
+    int exactIdentified = 0;
+    long long exactMicros = 0;
+    for (int seed = 1; seed <= 5; seed++) {
+        ConstraintStream stream = makeConstraintStream(seed, steps);
+        ConstraintSet rulesOnly;
+        ConstraintSet exact;
+
+        for (int step = 0; step < steps; step++) {
+            auto [points, tiles] = stream.observations[step];
+            std::set<int> rulesTiles = tiles;
+            rulesOnly.addConstraint(points, rulesTiles);
+
+            auto start = std::chrono::high_resolution_clock::now();
+            Config::exactHaloInference = true;
+            exact.setInferenceBudget(2000);
+            exact.addConstraint(points, tiles);
+            Config::exactHaloInference = false;
+            exactMicros += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count();
+        }
+
+        for (int tileId : exact.identifiedVantagePoints) {
+            EXPECT_TRUE(stream.vantagePoints.count(tileId)) << "seed " << seed << " tile " << tileId;
+        }
+        for (int tileId : exact.identifiedRegularTiles) {
+            EXPECT_FALSE(stream.vantagePoints.count(tileId)) << "seed " << seed << " tile " << tileId;
+        }
+        rulesIdentified += rulesOnly.identifiedVantagePoints.size() + rulesOnly.identifiedRegularTiles.size();
+        exactIdentified += exact.identifiedVantagePoints.size() + exact.identifiedRegularTiles.size();
+    }
+
+    EXPECT_GE(exactIdentified, rulesIdentified);
+    std::cout << "Identified tiles over 5 x " << steps << " observations : rules " << rulesIdentified
+              << ", exact " << exactIdentified << " in " << exactMicros / 1000.0 << " ms" << std::endl;
+}
+
+TEST_F(ConstraintSetTest, RetiredConstraintIsRevivedOnceTheChangedTileIsRegular) {
+    Logger::getInstance().setPlayerName("RetiredConstraintIsRevivedOnceTheChangedTileIsRegular");
+    std::set<int> haloPointSet1 = {p1, p2};
+    std::set<int> haloPointSet2 = {p1};
+
+    Config::versionedConstraints = true;
+    constraintSet.addConstraint(1, haloPointSet1);
+    constraintSet.reconsiderNormalizedTile(p1);
+    EXPECT_TRUE(constraintSet.getMasterSet().empty());
+    EXPECT_EQ(constraintSet.getRetiredConstraintCount(), 1);
+    EXPECT_EQ(constraintSet.getEpoch(), 1);
+
+    // p1 is regular after the relic change, so it was regular before it as well
+    constraintSet.addConstraint(0, haloPointSet2);
+    Config::versionedConstraints = false;
+
+    EXPECT_EQ(constraintSet.getRetiredConstraintCount(), 0);
+    EXPECT_EQ(constraintSet.identifiedVantagePoints, std::set<int>({p2, p2Mirr}));
+    EXPECT_EQ(constraintSet.identifiedRegularTiles, std::set<int>({p1, p1Mirr}));
+}
+
+TEST_F(ConstraintSetTest, RetiredConstraintIsDroppedOnceTheChangedTileIsAVantagePoint) {
+    Logger::getInstance().setPlayerName("RetiredConstraintIsDroppedOnceTheChangedTileIsAVantagePoint");
+    std::set<int> haloPointSet1 = {p1, p2};
+    std::set<int> haloPointSet2 = {p1};
+    std::set<int> haloPointSet3 = {p3, p4};
+
+    Config::versionedConstraints = true;
+    constraintSet.addConstraint(1, haloPointSet1);
+    constraintSet.deferConstraint(1, haloPointSet3);
+    constraintSet.reconsiderNormalizedTile(std::vector<int>{p1, p3});
+    EXPECT_EQ(constraintSet.getRetiredConstraintCount(), 2);
+    EXPECT_FALSE(constraintSet.hasDeferredConstraints());
+    EXPECT_EQ(constraintSet.getEpoch(), 1);
+
+    // p1 may have been a vantage point all along or only since the new relic, p2 stays unknown
+    constraintSet.addConstraint(1, haloPointSet2);
+    Config::versionedConstraints = false;
+
+    EXPECT_EQ(constraintSet.getRetiredConstraintCount(), 1);
+    EXPECT_EQ(constraintSet.identifiedVantagePoints, std::set<int>({p1, p1Mirr}));
+    EXPECT_TRUE(constraintSet.identifiedRegularTiles.empty());
+}
+
+TEST_F(ConstraintSetTest, VersionedConstraintsKeepTheirFactsOverRelicSpawns) {
+    Logger::getInstance().setPlayerName("VersionedConstraintsKeepTheirFactsOverRelicSpawns");
+    const int steps = 100;
+
+    int phasedOutIdentified = 0;
+    int versionedIdentified = 0;
+    for (int seed = 1; seed <= 5; seed++) {
+        // The first stream's relics are there from the start, the second stream's one spawns half way through
+        ConstraintStream early = makeConstraintStream(seed, steps);
+        ConstraintStream late = makeConstraintStream(seed + 100, steps, 1);
+        std::set<int> vantagePoints = early.vantagePoints;
+        std::vector<int> haloTiles;
+        for (int step = 0; step < steps; step++) {
+            for (int tileId : early.observations[step].second) {
+                haloTiles.push_back(tileId);
+            }
+        }
+
+        ConstraintSet phasedOut;
+        ConstraintSet versioned;
+        std::mt19937 random(seed);
+        for (int step = 0; step < steps; step++) {
+            if (step == steps / 2) {
+                std::set<int> spawnedTiles;
+                for (const auto& [points, tiles] : late.observations) {
+                    spawnedTiles.insert(tiles.begin(), tiles.end());
+                }
+                for (int tileId : spawnedTiles) {
+                    if (late.vantagePoints.count(tileId)) {
+                        vantagePoints.insert(tileId);
+                        vantagePoints.insert(symmetry_utils::toMirroredID(tileId));
+                    }
+                }
+                haloTiles.insert(haloTiles.end(), spawnedTiles.begin(), spawnedTiles.end());
+                phasedOut.reconsiderNormalizedTile(std::vector<int>(spawnedTiles.begin(), spawnedTiles.end()));
+                Config::versionedConstraints = true;
+                versioned.reconsiderNormalizedTile(std::vector<int>(spawnedTiles.begin(), spawnedTiles.end()));
+                Config::versionedConstraints = false;
+            }
+
+            std::set<int> tiles;
+            int shuttles = 4 + random() % 9;
+            for (int i = 0; i < shuttles; i++) {
+                tiles.insert(haloTiles[random() % haloTiles.size()]);
+            }
+            int points = 0;
+            for (int tileId : tiles) {
+                points += vantagePoints.count(tileId);
+            }
+            std::set<int> phasedOutTiles = tiles;
+            phasedOut.addConstraint(points, phasedOutTiles);
+            Config::versionedConstraints = true;
+            versioned.addConstraint(points, tiles);
+            Config::versionedConstraints = false;
+        }
+
+        for (int tileId : versioned.identifiedVantagePoints) {
+            EXPECT_TRUE(vantagePoints.count(tileId)) << "seed " << seed << " tile " << tileId;
+        }
+        for (int tileId : versioned.identifiedRegularTiles) {
+            EXPECT_FALSE(vantagePoints.count(tileId)) << "seed " << seed << " tile " << tileId;
+        }
+        phasedOutIdentified += phasedOut.identifiedVantagePoints.size() + phasedOut.identifiedRegularTiles.size();
+        versionedIdentified += versioned.identifiedVantagePoints.size() + versioned.identifiedRegularTiles.size();
+    }
+
+    EXPECT_GE(versionedIdentified, phasedOutIdentified);
+    std::cout << "Identified tiles after a relic spawn over 5 x " << steps << " observations : phased out "
+              << phasedOutIdentified << ", versioned " << versionedIdentified << std::endl;
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
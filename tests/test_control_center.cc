@@ -0,0 +1,443 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+
+#include "agent/control_center.h"
+#include "config.h"
+#include "logger.h"
+#include "parser.h"
+
+// Counts every heap allocation of the test binary, for the allocation benchmarks
+static std::atomic<long long> allocationCount{0};
+
+void* operator new(std::size_t size) {
+    allocationCount++;
+    if (void* pointer = std::malloc(size == 0 ? 1 : size)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+/**
+ * Generates a plausible game for 24x24 / 16 units without the engine: a static symmetric map, our units random
+ * walking out of the origin, opponents random walking out of the far corner and a single relic pair. Visibility,
+ * tile types and energy are masked with our sensor range just like the env does.
+ */
+class SyntheticGame {
+    public:
+        static constexpr int SIZE = 24;
+        static constexpr int UNITS = 16;
+        static constexpr int SENSOR_RANGE = 2;
+
+        SyntheticGame(int seed) : rng(seed) {
+            std::uniform_int_distribution<int> tileRoll(0, 99);
+            tileTypes.resize(SIZE, SIZE);
+            for (int x = 0; x < SIZE; x++) {
+                for (int y = 0; y < SIZE - x; y++) {
+                    int roll = tileRoll(rng);
+                    int type = roll < 8 ? 2 : (roll < 20 ? 1 : 0);
+                    if (x + y <= 3) {
+                        type = 0; // Keep the spawn corners open
+                    }
+                    tileTypes[x][y] = type;
+                    tileTypes[SIZE - y - 1][SIZE - x - 1] = type;
+                }
+            }
+
+            // Same field shape EnergyEstimator fits, so the estimator converges like it does in a real game
+            energies.resize(SIZE, SIZE);
+            std::vector<double> field(SIZE * SIZE);
+            double mean = 0;
+            for (int x = 0; x < SIZE; x++) {
+                for (int y = 0; y < SIZE; y++) {
+                    double d1 = std::hypot(x - 3, y - 15);
+                    double d2 = std::hypot(x - (SIZE - 15 - 1), y - (SIZE - 3 - 1));
+                    field[x * SIZE + y] = std::sin(d1 * 1.2 + 1) * 4 + std::sin(d2 * 1.2 + 1) * 4;
+                    mean += field[x * SIZE + y];
+                }
+            }
+            mean /= SIZE * SIZE * 6;
+            for (int x = 0; x < SIZE; x++) {
+                for (int y = 0; y < SIZE; y++) {
+                    double value = field[x * SIZE + y] + (mean < 0.25 ? 6 * (0.25 - mean) : 0);
+                    energies[x][y] = std::clamp(static_cast<int>(std::round(value)), -20, 20);
+                }
+            }
+
+            positions.resize(2, UNITS, 2, -1);
+            unitEnergies.resize(2, UNITS, -1);
+        }
+
+        /**
+         * Advances the game to the step. When our actions of the previous step are given our units follow them
+         * instead of random walking.
+         */
+        GameState next(int step, const std::vector<std::vector<int>>* actions = nullptr) {
+            GameState gameState;
+            gameState.player = "player_0";
+            gameState.remainingOverageTime = 600;
+            gameState.info.envCfg = {{"max_units", UNITS}, {"match_count_per_episode", 5}, {"max_steps_in_match", 100},
+                                     {"map_height", SIZE}, {"map_width", SIZE}, {"num_teams", 2}, {"unit_move_cost", 2},
+                                     {"unit_sap_cost", 30}, {"unit_sap_range", 4}, {"unit_sensor_range", SENSOR_RANGE}};
+
+            int matchStep = step % 101;
+            ObservationFrame& obs = gameState.obs;
+            obs.steps = step;
+            obs.matchSteps = matchStep;
+            obs.teamPoints = {0, 0};
+            obs.teamWins = {step / 101, 0};
+
+            for (int team = 0; team < 2; team++) {
+                for (int unit = 0; unit < UNITS; unit++) {
+                    int* position = positions[team][unit];
+                    int& energy = unitEnergies[team][unit];
+                    if (matchStep == 0 || matchStep <= unit * 3) {
+                        position[0] = -1;
+                        position[1] = -1;
+                        energy = -1;
+                    } else if (position[0] < 0) {
+                        position[0] = team == 0 ? 0 : SIZE - 1;
+                        position[1] = team == 0 ? 0 : SIZE - 1;
+                        energy = 100;
+                    } else {
+                        bool moved = false;
+                        if (team == 0 && actions != nullptr) {
+                            const std::vector<int>& action = (*actions)[unit];
+                            moved = move(position, action[0]);
+                            if (action[0] == 5) {
+                                energy -= 30;
+                            }
+                        } else {
+                            moved = walk(position, team);
+                        }
+                        if (moved) {
+                            energy -= 2;
+                        }
+                        energy = std::clamp(energy + energies[position[0]][position[1]], 0, 400);
+                    }
+                }
+            }
+
+            obs.sensorMask.resize(SIZE, SIZE, 0);
+            for (int unit = 0; unit < UNITS; unit++) {
+                int* position = positions[0][unit];
+                if (position[0] < 0) {
+                    continue;
+                }
+                for (int x = position[0] - SENSOR_RANGE; x <= position[0] + SENSOR_RANGE; x++) {
+                    for (int y = position[1] - SENSOR_RANGE; y <= position[1] + SENSOR_RANGE; y++) {
+                        if (x >= 0 && x < SIZE && y >= 0 && y < SIZE) {
+                            obs.sensorMask[x][y] = 1;
+                        }
+                    }
+                }
+            }
+
+            obs.mapFeatures.tileType.resize(SIZE, SIZE, -1);
+            obs.mapFeatures.energy.resize(SIZE, SIZE, -1);
+            for (int x = 0; x < SIZE; x++) {
+                for (int y = 0; y < SIZE; y++) {
+                    if (obs.sensorMask[x][y]) {
+                        obs.mapFeatures.tileType[x][y] = tileTypes[x][y];
+                        obs.mapFeatures.energy[x][y] = energies[x][y];
+                    }
+                }
+            }
+
+            obs.units.position.resize(2, UNITS, 2, -1);
+            obs.units.energy.resize(2, UNITS, -1);
+            obs.unitsMask.resize(2, UNITS, 0);
+            for (int team = 0; team < 2; team++) {
+                for (int unit = 0; unit < UNITS; unit++) {
+                    int* position = positions[team][unit];
+                    bool visible = position[0] >= 0 && (team == 0 || obs.sensorMask[position[0]][position[1]]);
+                    if (visible) {
+                        obs.unitsMask[team][unit] = 1;
+                        obs.units.position[team][unit][0] = position[0];
+                        obs.units.position[team][unit][1] = position[1];
+                        obs.units.energy[team][unit] = unitEnergies[team][unit];
+                    }
+                }
+            }
+
+            const int relics[2][2] = {{5, 7}, {SIZE - 7 - 1, SIZE - 5 - 1}};
+            obs.relicNodes.resize(6, 2, -1);
+            obs.relicNodesMask.assign(6, 0);
+            for (int r = 0; r < 2; r++) {
+                if (obs.sensorMask[relics[r][0]][relics[r][1]]) {
+                    obs.relicNodesMask[r] = 1;
+                    obs.relicNodes[r][0] = relics[r][0];
+                    obs.relicNodes[r][1] = relics[r][1];
+                }
+            }
+            return gameState;
+        }
+
+    private:
+        std::mt19937 rng;
+        FlatArray2D<int> tileTypes;
+        FlatArray2D<int> energies;
+        FlatArray3D<int> positions;
+        FlatArray2D<int> unitEnergies;
+
+        bool walk(int* position, int team) {
+            std::uniform_int_distribution<int> moveRoll(0, 6);
+            int roll = moveRoll(rng);
+            // Bias the walk away from the spawn corner
+            return move(position, roll >= 5 ? (team == 0 ? 2 + (roll - 5) : 4 - 3 * (roll - 5)) : roll);
+        }
+
+        bool move(int* position, int direction) {
+            static const int moves[5][2] = {{0, 0}, {0, -1}, {1, 0}, {0, 1}, {-1, 0}};
+            if (direction <= 0 || direction > 4) {
+                return false;
+            }
+            int x = position[0] + moves[direction][0];
+            int y = position[1] + moves[direction][1];
+            if (x < 0 || x >= SIZE || y < 0 || y >= SIZE || tileTypes[x][y] == 2) {
+                return false;
+            }
+            position[0] = x;
+            position[1] = y;
+            return true;
+        }
+};
+
+TEST(ControlCenterTest, UpdateBenchmark) {
+    const int steps = 200;
+    SyntheticGame game(7);
+    std::vector<GameState> stream;
+    for (int step = 0; step < steps; step++) {
+        stream.push_back(game.next(step));
+    }
+
+    // Best of a few fresh games to keep scheduler noise out of the numbers
+    double best = 0;
+    for (int round = 0; round < 3; round++) {
+        ControlCenter* cc = new ControlCenter();
+        long long total = 0;
+        for (auto& gameState : stream) {
+            auto start = std::chrono::high_resolution_clock::now();
+            cc->update(gameState);
+            total += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count();
+        }
+
+        EXPECT_EQ(cc->gameMap->derivedGameState.currentStep, steps - 1);
+        EXPECT_GT(cc->gameMap->derivedGameState.tilesExplored, 0);
+
+        delete cc;
+
+        double perStep = total / static_cast<double>(steps);
+        best = round == 0 ? perStep : std::min(best, perStep);
+    }
+    std::cout << "update() : " << best << " us/step over " << steps << " steps" << std::endl;
+}
+
+/**
+ * Plays the synthetic game with our units following the returned actions, records every step's actions.
+ */
+static std::vector<std::vector<std::vector<int>>> playGame(int steps, int planningThreads, long long& planMicros, bool exhaustBudget = false) {
+    int previousThreads = Config::planningThreads;
+    int previousBudget = Config::stepBudgetMs;
+    Config::planningThreads = planningThreads;
+    if (exhaustBudget) {
+        Config::stepBudgetMs = 0;
+    }
+
+    SyntheticGame game(7);
+    ControlCenter* cc = new ControlCenter();
+    std::vector<std::vector<std::vector<int>>> history;
+
+    planMicros = 0;
+    for (int step = 0; step < steps; step++) {
+        GameState gameState = game.next(step, step > 0 ? &history.back() : nullptr);
+        if (exhaustBudget) {
+            gameState.remainingOverageTime = 0;
+        }
+        cc->update(gameState);
+        auto start = std::chrono::high_resolution_clock::now();
+        cc->plan();
+        history.push_back(cc->act());
+        planMicros += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count();
+    }
+    delete cc;
+
+    Config::planningThreads = previousThreads;
+    Config::stepBudgetMs = previousBudget;
+    return history;
+}
+
+TEST(ControlCenterTest, ParallelPlanningMatchesSequential) {
+    long long sequentialMicros = 0;
+    long long parallelMicros = 0;
+    auto sequential = playGame(120, 1, sequentialMicros);
+    auto parallel = playGame(120, 4, parallelMicros);
+
+    ASSERT_EQ(sequential.size(), parallel.size());
+    for (size_t step = 0; step < sequential.size(); step++) {
+        EXPECT_EQ(sequential[step], parallel[step]) << "step " << step;
+    }
+}
+
+TEST(ControlCenterTest, ParallelPlanningMatchesSequentialWithExhaustedDeadline) {
+    long long sequentialMicros = 0;
+    long long parallelMicros = 0;
+    auto sequential = playGame(60, 1, sequentialMicros, true);
+    auto parallel = playGame(60, 4, parallelMicros, true);
+
+    ASSERT_EQ(sequential.size(), parallel.size());
+    for (size_t step = 0; step < sequential.size(); step++) {
+        EXPECT_EQ(sequential[step], parallel[step]) << "step " << step;
+    }
+}
+
+TEST(ControlCenterTest, OptimalAssignmentPlaysTheGame) {
+    int previousStrategy = Config::prioritizationStrategy;
+    Config::prioritizationStrategy = 2;
+    long long planMicros = 0;
+    auto history = playGame(120, 1, planMicros);
+    Config::prioritizationStrategy = previousStrategy;
+
+    ASSERT_EQ(history.size(), 120);
+    for (auto& actions : history) {
+        ASSERT_EQ(actions.size(), static_cast<size_t>(SyntheticGame::UNITS));
+    }
+    std::cout << "plan() + act() with the optimal assignment : " << planMicros / 120.0 << " us/step" << std::endl;
+}
+
+TEST(ControlCenterTest, PlanCacheBenchmark) {
+    bool previousPlanCache = Config::planCache;
+    for (bool planCache : {false, true}) {
+        Config::planCache = planCache;
+        long long planMicros = 0;
+        auto history = playGame(200, 1, planMicros);
+
+        ASSERT_EQ(history.size(), 200);
+        for (auto& actions : history) {
+            ASSERT_EQ(actions.size(), static_cast<size_t>(SyntheticGame::UNITS));
+        }
+        std::cout << "plan() + act() " << (planCache ? "with" : "without") << " the plan cache : " << planMicros / 200.0 << " us/step" << std::endl;
+    }
+    Config::planCache = previousPlanCache;
+}
+
+TEST(ControlCenterTest, ExhaustedBudgetStillActs) {
+    int previousBudget = Config::stepBudgetMs;
+    Config::stepBudgetMs = 0;
+
+    SyntheticGame game(7);
+    ControlCenter* cc = new ControlCenter();
+    std::vector<std::vector<int>> actions;
+    int movingShuttles = 0;
+    for (int step = 0; step < 60; step++) {
+        GameState gameState = game.next(step, step > 0 ? &actions : nullptr);
+        gameState.remainingOverageTime = 0; // Every stage falls back from the first unit of work
+        cc->update(gameState);
+        cc->plan();
+        actions = cc->act();
+
+        ASSERT_EQ(actions.size(), static_cast<size_t>(SyntheticGame::UNITS));
+        for (auto& action : actions) {
+            if (action[0] != 0) {
+                movingShuttles++;
+            }
+        }
+    }
+    delete cc;
+
+    Config::stepBudgetMs = previousBudget;
+    EXPECT_GT(movingShuttles, 0);
+}
+
+TEST(ControlCenterTest, PlanBenchmark) {
+    const int steps = 200;
+    for (int threads : {1, 4}) {
+        long long total = 0;
+        playGame(steps, threads, total);
+        std::cout << "plan() + act() with " << threads << " thread(s) : " << total / static_cast<double>(steps) << " us/step over " << steps << " steps" << std::endl;
+    }
+}
+
+TEST(ControlCenterTest, PlanAllocations) {
+    const int steps = 200;
+    SyntheticGame game(7);
+    ControlCenter* cc = new ControlCenter();
+    std::vector<std::vector<int>> actions;
+    long long planAllocations = 0;
+    for (int step = 0; step < steps; step++) {
+        GameState gameState = game.next(step, step > 0 ? &actions : nullptr);
+        cc->update(gameState);
+        long long before = allocationCount;
+        cc->plan();
+        planAllocations += allocationCount - before;
+        actions = cc->act();
+    }
+    delete cc;
+    std::cout << "plan() : " << planAllocations / static_cast<double>(steps) << " allocations/step over " << steps << " steps" << std::endl;
+
+    // ~370 with the job arena, ~1470 when every job was its own heap allocation
+    EXPECT_LT(planAllocations / static_cast<double>(steps), 500);
+}
+
+TEST(ControlCenterTest, JobArenaAllocatesNothingAfterTheFirstStep) {
+    const int capacity = 2 * SyntheticGame::SIZE * SyntheticGame::SIZE + SyntheticGame::UNITS;
+    JobArena jobArena;
+    long long allocations = 0;
+    for (int step = 0; step < 3; step++) {
+        long long before = allocationCount;
+        jobArena.reset(capacity);
+        for (int i = 0; i < capacity; i++) {
+            ASSERT_NE(jobArena.create<RelicMiningNavigatorJob>(i, i % SyntheticGame::SIZE, i / SyntheticGame::SIZE % SyntheticGame::SIZE), nullptr);
+            DefenderJob* defenderJob = jobArena.create<DefenderJob>(i, 0, 0);
+            ASSERT_NE(defenderJob, nullptr);
+            defenderJob->addOpponentPosition(1, 1);
+        }
+        if (step > 0) {
+            allocations += allocationCount - before;
+        }
+    }
+    EXPECT_EQ(allocations, 0);
+}
+
+TEST(ControlCenterTest, LoggingBenchmark) {
+    const int steps = 200;
+    const std::string filename = "control_center_benchmark.log";
+    const std::vector<std::string> levels = {"off", "warn", "info", "debug", "trace"};
+    for (const std::string& level : levels) {
+        bool logging = level != "off";
+        if (logging) {
+            Logger::getInstance().setLevel(Logger::parseLevel(level));
+            Logger::getInstance().enableLogging(filename);
+        }
+        long long total = 0;
+        auto start = std::chrono::high_resolution_clock::now();
+        playGame(steps, 1, total);
+        total = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count();
+        if (logging) {
+            Logger::getInstance().disableLogging();
+            std::remove(filename.c_str());
+        }
+        std::cout << "Full game with logging " << level << " : " << total / static_cast<double>(steps) << " us/step over " << steps << " steps" << std::endl;
+    }
+    Logger::getInstance().setLevel(LogLevel::DEBUG);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
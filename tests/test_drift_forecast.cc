@@ -0,0 +1,245 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <random>
+#include "agent/game_map.h"
+#include "logger.h"
+
+class DriftForecastTest : public ::testing::Test {
+    protected:
+        static constexpr int SIZE = 24;
+        static constexpr int STEPS = 5 * 101;
+
+        void SetUp() override {
+            Logger::getInstance().enableLogging("../../test.log");
+        }
+};
+
+/**
+ * Steps the nebulae drift at for a speed (x1000), the way DriftDetector works them out
+ */
+static std::vector<bool> driftSteps(int speed, int steps) {
+    std::vector<bool> drifts(steps + 1, false);
+    for (int i = 0; i < steps; i++) {
+        if (std::fmod((i - 1) * std::fabs(speed / 1000.0f), 1.0f) > std::fmod(i * std::fabs(speed / 1000.0f), 1.0f)) {
+            drifts[i + 1] = true;
+        }
+    }
+    return drifts;
+}
+
+/**
+ * The forecast as DriftDetector kept it before: a new grid per drift, a grid pointer per step, and explored tiles
+ * walked along the chain of grids
+ */
+struct LegacyDriftChain {
+    using Grid = std::vector<std::vector<TileType>>;
+    std::vector<std::unique_ptr<Grid>> grids;
+    std::vector<Grid*> steps;
+    int speed;
+    size_t allocations = 0;
+    size_t bytes = 0;
+
+    LegacyDriftChain(const Grid& base, int speed, const std::vector<bool>& drifts, int firstStep, int stepCount): speed(speed) {
+        Grid* current = add(std::make_unique<Grid>(base));
+        steps.assign(firstStep, current);
+        for (int i = firstStep; i < stepCount; ++i) {
+            if (drifts[i]) {
+                auto next = std::make_unique<Grid>(base.size(), std::vector<TileType>(base[0].size()));
+                int height = base.size();
+                int width = base[0].size();
+                for (int y = 0; y < height; ++y) {
+                    for (int x = 0; x < width; ++x) {
+                        int sourceX = (x + (speed < 0 ? 1 : -1) + width) % width;
+                        int sourceY = (y + (speed < 0 ? -1 : 1) + height) % height;
+                        (*next)[y][x] = (*current)[sourceY][sourceX];
+                    }
+                }
+                current = add(std::move(next));
+            }
+            steps.push_back(current);
+        }
+        bytes += steps.capacity() * sizeof(Grid*);
+    }
+
+    Grid* add(std::unique_ptr<Grid> grid) {
+        allocations += 1 + grid->size();
+        bytes += sizeof(Grid) + grid->size() * (sizeof(std::vector<TileType>) + grid->at(0).capacity());
+        grids.push_back(std::move(grid));
+        return grids.back().get();
+    }
+
+    void explore(int x, int y, int step, TileType tileType) {
+        int width = steps[step]->at(0).size();
+        int height = steps[step]->size();
+        int index = 0;
+        while (grids[index].get() != steps[step]) {
+            index++;
+        }
+        for (; index < std::ssize(grids) && (*grids[index])[y][x] != tileType; ++index) {
+            (*grids[index])[y][x] = tileType;
+            x = (x + (speed > 0 ? 1 : -1) + width) % width;
+            y = (y + (speed > 0 ? -1 : 1) + height) % height;
+        }
+    }
+
+    TileType getType(int x, int y, int step) const { return (*steps[step])[y][x]; }
+};
+
+static LegacyDriftChain::Grid randomGrid(std::mt19937& gen, int size) {
+    LegacyDriftChain::Grid grid(size, std::vector<TileType>(size));
+    for (auto& row : grid) {
+        for (TileType& tileType : row) {
+            int roll = gen() % 10;
+            tileType = roll == 0 ? TileType::ASTEROID : roll < 3 ? TileType::NEBULA : roll < 4 ? TileType::UNKNOWN_TILE : TileType::EMPTY;
+        }
+    }
+    return grid;
+}
+
+static void fillForecast(DriftForecast& driftForecast, const LegacyDriftChain::Grid& base, int speed, const std::vector<bool>& drifts, int firstStep, int stepCount) {
+    int size = base.size();
+    driftForecast.reset(size, size, speed > 0 ? 1 : -1, stepCount);
+    int offset = 0;
+    for (int i = firstStep; i < stepCount; ++i) {
+        if (drifts[i]) {
+            offset = (offset + 1) % size;
+        }
+        driftForecast.setOffset(i, offset);
+    }
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            driftForecast.setType(x, y, 0, base[y][x]);
+        }
+    }
+}
+
+TEST_F(DriftForecastTest, MatchesTheGridChain) {
+    std::mt19937 gen(17);
+    for (int speed : {-150, -100, -50, -25, 25, 50, 100, 150}) {
+        std::vector<bool> drifts = driftSteps(speed, STEPS);
+        int firstStep = 20 + gen() % 40;
+        LegacyDriftChain::Grid base = randomGrid(gen, SIZE);
+        LegacyDriftChain chain(base, speed, drifts, firstStep, STEPS);
+        DriftForecast driftForecast;
+        fillForecast(driftForecast, base, speed, drifts, firstStep, STEPS);
+
+        for (int step = 0; step < STEPS; ++step) {
+            for (int y = 0; y < SIZE; ++y) {
+                for (int x = 0; x < SIZE; ++x) {
+                    ASSERT_EQ(driftForecast.getType(x, y, step), chain.getType(x, y, step)) << "speed " << speed << " step " << step << " at (" << x << ", " << y << ")";
+                }
+            }
+        }
+    }
+}
+
+TEST_F(DriftForecastTest, ExploredTilesDriftOn) {
+    std::mt19937 gen(23);
+    int speed = 50;
+    std::vector<bool> drifts = driftSteps(speed, STEPS);
+    LegacyDriftChain::Grid base(SIZE, std::vector<TileType>(SIZE, TileType::UNKNOWN_TILE));
+    LegacyDriftChain chain(base, speed, drifts, 30, STEPS);
+    DriftForecast driftForecast;
+    fillForecast(driftForecast, base, speed, drifts, 30, STEPS);
+
+    // The map reveals itself over the episode, the same tiles every time they come round
+    LegacyDriftChain::Grid truth = randomGrid(gen, SIZE);
+    for (int step = 30; step < STEPS; ++step) {
+        int shift = driftForecast.getOffset(step);
+        for (int i = 0; i < 10; ++i) {
+            int x = gen() % SIZE;
+            int y = gen() % SIZE;
+            TileType tileType = truth[(y + shift) % SIZE][(x - shift + SIZE) % SIZE];
+            if (tileType == TileType::UNKNOWN_TILE) {
+                continue;
+            }
+            chain.explore(x, y, step, tileType);
+            driftForecast.setType(x, y, step, tileType);
+        }
+
+        // From the explored step on both agree, earlier grids of the chain were left as they were
+        for (int later = step; later < std::min(step + 30, STEPS); ++later) {
+            for (int y = 0; y < SIZE; ++y) {
+                for (int x = 0; x < SIZE; ++x) {
+                    ASSERT_EQ(driftForecast.getType(x, y, later), chain.getType(x, y, later)) << "explored at " << step << ", step " << later;
+                }
+            }
+        }
+    }
+}
+
+TEST_F(DriftForecastTest, RowsMatchTheTileTypes) {
+    std::mt19937 gen(29);
+    int speed = -100;
+    std::vector<bool> drifts = driftSteps(speed, STEPS);
+    LegacyDriftChain::Grid base = randomGrid(gen, SIZE);
+    DriftForecast driftForecast;
+    fillForecast(driftForecast, base, speed, drifts, 40, STEPS);
+
+    for (int step = 0; step < STEPS; ++step) {
+        for (int y = 0; y < SIZE; ++y) {
+            const TileType* row = driftForecast.getRow(y, step);
+            for (int x = 0; x < SIZE; ++x) {
+                ASSERT_EQ(row[x], driftForecast.getType(x, y, step)) << "step " << step << " at (" << x << ", " << y << ")";
+            }
+        }
+    }
+}
+
+TEST_F(DriftForecastTest, EpisodeBenchmark) {
+    const int episodes = 20;
+    const int speed = 150;
+    std::vector<bool> drifts = driftSteps(speed, STEPS);
+    std::mt19937 gen(29);
+    LegacyDriftChain::Grid base = randomGrid(gen, SIZE);
+
+    size_t chainBytes = 0;
+    size_t chainAllocations = 0;
+    long long chainChecksum = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int episode = 0; episode < episodes; ++episode) {
+        LegacyDriftChain chain(base, speed, drifts, 30, STEPS);
+        for (int step = 0; step < STEPS; ++step) {
+            for (int y = 0; y < SIZE; ++y) {
+                for (int x = 0; x < SIZE; ++x) {
+                    chainChecksum += chain.getType(x, y, step);
+                }
+            }
+        }
+        chainBytes = chain.bytes;
+        chainAllocations = chain.allocations;
+    }
+    auto chainMicros = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count();
+
+    size_t forecastBytes = 0;
+    long long forecastChecksum = 0;
+    start = std::chrono::high_resolution_clock::now();
+    for (int episode = 0; episode < episodes; ++episode) {
+        DriftForecast driftForecast;
+        fillForecast(driftForecast, base, speed, drifts, 30, STEPS);
+        for (int step = 0; step < STEPS; ++step) {
+            for (int y = 0; y < SIZE; ++y) {
+                for (int x = 0; x < SIZE; ++x) {
+                    forecastChecksum += driftForecast.getType(x, y, step);
+                }
+            }
+        }
+        forecastBytes = driftForecast.getMemoryUsage();
+    }
+    auto forecastMicros = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count();
+
+    EXPECT_EQ(forecastChecksum, chainChecksum);
+    EXPECT_LT(forecastBytes, chainBytes);
+    std::cout << "Grid chain : " << chainBytes << " bytes in " << chainAllocations << " allocations, "
+              << chainMicros / static_cast<double>(episodes) << " us per episode" << std::endl;
+    std::cout << "Forecast   : " << forecastBytes << " bytes in 3 allocations, "
+              << forecastMicros / static_cast<double>(episodes) << " us per episode" << std::endl;
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
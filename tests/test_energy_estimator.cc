@@ -3,6 +3,10 @@
 #include "agent/control_center.h"
 #include "symmetry_util.h"
 #include <gtest/gtest.h>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
 
 std::string seed_1 = R"(
     {"obs": {"units": {"position": [[[0, 1], [-1, -1], [-1, -1], [-1, -1], [-1, -1], [-1, -1], [-1, -1], [-1, -1], [-1, -1], [-1, -1], [-1, -1], [-1, -1], [-1, -1], [-1, -1], [-1, -1], [-1, -1]], [[-1, -1], [-1, -1], [-1, -1], [-1, -1], [-1, -1], [-1, -1], [-1, -1], [-1, -1], [-1, -1], [-1, -1], [-1, -1], [-1, -1], [-1, -1], [-1, -1], [-1, -1], [-1, -1]]], "energy": [[103, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1], [-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1]]}, "units_mask": [[true, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false], [false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false]], "sensor_mask": [[true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true], [true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true], [true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true], [true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true], [true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true], [true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true], [true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true], [true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true], [true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true], [true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true], [true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true], [true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true], [true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true], [true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true], [true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true], [true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true], [true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true], [true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true], [true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true], [true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true], [true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true], [true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true], [true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true], [true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true]], "map_features": {"energy": [[8, 6, 4, 2, 0, -2, -4, -5, -5, -3, 0, 3, 4, 2, -2, -4, -4, -1, 1, 1, -3, -5, -3, 3], [2, 0, 0, 1, 3, 4, 4, 3, 1, 0, 1, 4, 8, 8, 6, 1, -1, 1, 3, 4, 0, -5, -6, -3], [-5, -5, -3, 0, 4, 7, 9, 9, 7, 3, 1, 2, 6, 9, 9, 5, 2, 2, 5, 8, 6, 0, -5, -5], [-5, -3, -1, 1, 3, 4, 6, 7, 6, 3, -1, -3, -1, 3, 5, 4, 1, 0, 3, 8, 9, 6, 0, -3], [3, 4, 4, 2, 0, -2, -1, 1, 2, 1, -2, -6, -6, -3, 1, 2, -1, -4, -3, 3, 8, 8, 4, 1], [9, 9, 7, 3, -1, -5, -6, -4, 0, 2, 1, -2, -5, -3, 0, 2, 0, -5, -6, -3, 3, 5, 3, 1], [7, 5, 3, 2, 0, -2, -4, -3, 1, 5, 7, 4, 1, 0, 3, 6, 5, -1, -5, -4, 0, 2, 1, -1], [-1, -3, -2, 1, 4, 4, 2, 1, 2, 6, 9, 8, 4, 1, 4, 8, 9, 5, 0, -1, 1, 2, -1, -4], [-6, -6, -4, 1, 6, 9, 7, 2, 0, 3, 6, 6, 2, -2, 0, 5, 8, 6, 2, 2, 4, 5, 1, -4], [-3, -2, -1, 2, 6, 8, 6, 0, -4, -3, 1, 2, -2, -5, -5, 0, 4, 3, 0, 1, 5, 9, 6, -2], [4, 5, 3, 1, 2, 4, 3, -2, -6, -5, 0, 2, -1, -5, -5, -2, 1, 0, -3, -3, 3, 9, 8, 2], [7, 9, 4, -2, -2, 0, 1, -2, -4, -2, 4, 7, 4, -1, -2, 2, 4, 1, -5, -6, -1, 6, 8, 4], [9, 6, -1, -5, -4, 1, 4, 2, 0, 2, 7, 9, 7, 2, 2, 6, 8, 4, -2, -6, -3, 2, 4, 3], [4, -1, -5, -6, -1, 5, 7, 4, 1, 3, 6, 7, 4, 0, 1, 6, 9, 7, 1, -2, -1, 1, 1, 0], [-2, -5, -6, -1, 5, 9, 7, 2, -1, 0, 3, 2, -2, -5, -3, 3, 6, 5, 2, 1, 3, 3, 0, -3], [-2, -4, -1, 5, 9, 8, 2, -3, -4, -1, 1, 0, -4, -6, -4, 0, 2, 1, 0, 2, 6, 7, 1, -5], [0, 1, 5, 9, 8, 2, -4, -6, -3, 2, 4, 2, -2, -2, 0, 2, 1, -3, -4, 1, 7, 9, 3, -5], [1, 4, 7, 7, 2, -4, -6, -4, 2, 7, 7, 4, 1, 3, 6, 7, 2, -4, -6, -1, 6, 9, 4, -4], [-2, 2, 4, 2, -3, -6, -4, 2, 8, 9, 5, 1, 0, 4, 8, 9, 4, -2, -5, -2, 4, 7, 4, -2], [-4, 0, 1, -1, -4, -3, 2, 8, 9, 5, -1, -4, -2, 2, 6, 6, 4, 0, -1, 0, 3, 4, 3, 0], [-2, 2, 3, 0, -1, 2, 7, 9, 5, -1, -6, -5, -2, 1, 2, 1, 1, 2, 3, 2, 1, 0, 1, 2], [4, 7, 6, 3, 1, 4, 7, 5, -1, -6, -5, -1, 4, 3, -1, -4, -2, 3, 7, 4, -1, -3, 0, 4], [7, 9, 7, 2, 0, 2, 4, 1, -4, -5, -1, 6, 9, 5, -2, -6, -3, 5, 9, 4, -3, -5, 0, 6], [4, 7, 4, -2, -4, -2, 1, 0, -2, -2, 4, 9, 7, 4, -3, -6, -1, 7, 9, 3, -5, -5, 2, 8]], "tile_type": [[0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 0, 0, 0, 2, 2, 0, 0, 0, 0, 0], [0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0], [2, 0, 0, 0, 0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 2, 2, 0, 0, 0, 0, 0, 0, 0, 0], [0, 0, 0, 0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 2, 2, 2, 0, 2, 0, 0, 0, 0, 0, 0], [0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 2, 0, 0, 0, 0, 0], [0, 0, 0, 0, 0, 0, 0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 0, 0, 0, 2], [2, 0, 0, 0, 0, 0, 0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 2, 0, 0, 2], [0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 2, 0, 0, 0, 0, 0, 0, 0, 0], [0, 0, 0, 0, 2, 2, 0, 0, 0, 0, 0, 0, 0, 0, 2, 2, 2, 0, 0, 0, 2, 2, 0, 0], [0, 0, 0, 0, 2, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 2, 0, 0, 0, 2, 2, 0, 0], [2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 0, 0, 2], [0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0], [0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0], [1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0], [0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0], [0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 2, 0, 0, 0, 0, 0], [0, 0, 0, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0], [0, 0, 0, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 0, 0], [0, 0, 0, 1, 1, 0, 1, 1, 0, 0, 0, 0, 0, 0, 2, 2, 0, 0, 0, 0, 2, 0, 0, 0], [0, 0, 0, 2, 0, 1, 1, 1, 1, 0, 0, 0, 0, 0, 2, 2, 0, 0, 0, 0, 0, 0, 0, 0], [0, 0, 0, 0, 2, 1, 1, 1, 1, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0], [0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0], [0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0], [0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 2, 0, 0, 0, 2, 0, 0, 0, 2, 0, 0]]}, "relic_nodes": [[-1, -1], [-1, -1], [-1, -1], [-1, -1], [-1, -1], [-1, -1]], "relic_nodes_mask": [false, false, false, false, false, false], "team_points": [0, 0], "team_wins": [0, 0], "steps": 2, "match_steps": 2}, "step": 2, "remainingOverageTime": 600, "player": "player_0", "info": {"env_cfg": {"max_units": 16, "match_count_per_episode": 5, "max_steps_in_match": 100, "map_height": 24, "map_width": 24, "num_teams": 2, "unit_move_cost": 3, "unit_sap_cost": 30, "unit_sap_range": 6, "unit_sensor_range": 1}}}
@@ -18,7 +22,7 @@ std::string seed_4 = R"(
 
 class EnergyEstimatorTest : public ::testing::Test {
     protected:
-        GameMap* gameMap;
+        GameMap* gameMap = nullptr;
         void SetUp() override {
             Logger::getInstance().enableLogging("../../test.log");
 
@@ -73,6 +77,146 @@ TEST_F(EnergyEstimatorTest, Seed4) {
     EXPECT_EQ(ee->getEnergyNode(), energyNodeTileId);
 }
 
+/**
+ * The energy field of a node pair, the way the estimator built it before the distance tables: a fresh cube of the six
+ * node functions for every candidate
+ */
+static bool legacyEstimate(GameMap& gameMap, int energyNodeTileId, std::vector<int>& field) {
+    const double fn[4] = {0, 1.2, 1, 4};
+    const int fns = 6;
+    int height = gameMap.height;
+    int width = gameMap.width;
+    std::vector<std::vector<std::vector<double>>> estimatedEnergy(height, std::vector<std::vector<double>>(width, std::vector<double>(fns, 0.0)));
+
+    int x, y, mirrorX, mirrorY;
+    symmetry_utils::toXY(energyNodeTileId, x, y);
+    symmetry_utils::toMirroredXY(x, y, mirrorX, mirrorY);
+    double meanValue = 0;
+    for (int i = 0; i < height; ++i) {
+        for (int j = 0; j < width; ++j) {
+            for (int k = 0; k < fns; ++k) {
+                if (k == 0) {
+                    double distance = std::sqrt((i - x) * (i - x) + (j - y) * (j - y));
+                    estimatedEnergy[i][j][k] = sin(distance * fn[1] + fn[2]) * fn[3];
+                } else if (k == 3) {
+                    double distance = std::sqrt((i - mirrorX) * (i - mirrorX) + (j - mirrorY) * (j - mirrorY));
+                    estimatedEnergy[i][j][k] += sin(distance * fn[1] + fn[2]) * fn[3];
+                }
+                meanValue += estimatedEnergy[i][j][k];
+            }
+        }
+    }
+    meanValue /= height * width * fns;
+
+    field.assign(width * height, 0);
+    bool allGood = true;
+    for (int i = 0; i < height; ++i) {
+        for (int j = 0; j < width; ++j) {
+            double estimatedEnergyValue = 0;
+            for (int k = 0; k < fns; ++k) {
+                if (meanValue < 0.25) {
+                    estimatedEnergy[i][j][k] += 0.25 - meanValue;
+                }
+                estimatedEnergyValue += estimatedEnergy[i][j][k];
+            }
+            int rounded = std::clamp(static_cast<int>(std::round(estimatedEnergyValue)), -20, 20);
+            GameTile& tile = gameMap.getTile(i, j);
+            field[tile.getId()] = rounded;
+            if (tile.isVisible() && rounded != tile.getEnergy()) {
+                allGood = false;
+            }
+        }
+    }
+    return allGood;
+}
+
+/**
+ * The node a cold start settles on, -1 unless exactly one first half node fits
+ */
+static int legacyIdentify(GameMap& gameMap, std::vector<int>& field) {
+    std::vector<int> candidateField;
+    int found = -1;
+    int matches = 0;
+    for (int id = 0; id < gameMap.width * gameMap.height; ++id) {
+        if (symmetry_utils::isFirstHalfID(id) && legacyEstimate(gameMap, id, candidateField)) {
+            found = id;
+            field = candidateField;
+            matches++;
+        }
+    }
+    return matches == 1 ? found : -1;
+}
+
+TEST_F(EnergyEstimatorTest, MatchesTheLegacyFieldUnderPartialVisibility) {
+    Logger::getInstance().setPlayerName("Partial");
+    std::mt19937 gen(7);
+
+    for (std::string* seed : {&seed_1, &seed_2, &seed_4}) {
+        GameState gameState = parse(*seed);
+        ControlCenter* cc = new ControlCenter();
+        cc->update(gameState);
+        GameMap& map = *cc->gameMap;
+
+        int identified = 0;
+        for (int trial = 0; trial < 40; ++trial) {
+            // From a handful of tiles in sight up to the whole map
+            int visiblePercent = 1 + trial * 99 / 39;
+            for (int id = 0; id < map.width * map.height; ++id) {
+                map.getTile(id).setVisible(static_cast<int>(gen() % 100) < visiblePercent);
+            }
+
+            std::vector<int> expectedField;
+            int expectedNode = legacyIdentify(map, expectedField);
+
+            EnergyEstimator energyEstimator(map);
+            energyEstimator.updateEnergyNodes();
+            ASSERT_EQ(energyEstimator.getEnergyNode(), expectedNode) << "trial " << trial;
+            if (expectedNode < 0) {
+                continue;
+            }
+            identified++;
+            for (int id = 0; id < map.width * map.height; ++id) {
+                ASSERT_EQ(map.getTile(id).getLastKnownEnergy(), expectedField[id]) << "trial " << trial << " tile " << id;
+            }
+        }
+        EXPECT_GT(identified, 0);
+    }
+}
+
+TEST_F(EnergyEstimatorTest, ColdStartBenchmark) {
+    Logger::getInstance().setPlayerName("ColdStart");
+    const int repetitions = 20;
+
+    for (std::string* seed : {&seed_1, &seed_2, &seed_4}) {
+        GameState gameState = parse(*seed);
+        ControlCenter* cc = new ControlCenter();
+        cc->update(gameState);
+        GameMap& map = *cc->gameMap;
+
+        std::vector<int> field;
+        int legacyNode = -1;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < repetitions; ++i) {
+            legacyNode = legacyIdentify(map, field);
+        }
+        auto legacyMicros = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count();
+
+        int node = -1;
+        start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < repetitions; ++i) {
+            // A fresh estimator every time, the distance table and field sums included
+            EnergyEstimator energyEstimator(map);
+            energyEstimator.updateEnergyNodes();
+            node = energyEstimator.getEnergyNode();
+        }
+        auto micros = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count();
+
+        EXPECT_EQ(node, legacyNode);
+        std::cout << "Node " << symmetry_utils::toXYString(node) << " legacy : " << legacyMicros / static_cast<double>(repetitions)
+                  << " us, tabled : " << micros / static_cast<double>(repetitions) << " us per cold start" << std::endl;
+    }
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
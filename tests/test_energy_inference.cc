@@ -0,0 +1,244 @@
+#include "agent/energy_inference.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include "agent/shuttle_energy_tracker.h"
+#include "game_env_config.h"
+#include "logger.h"
+
+class EnergyInferenceTest : public ::testing::Test {
+    protected:
+        void SetUp() override {
+            Logger::getInstance().enableLogging("../../test.log");
+            GameEnvConfig::getInstance().unitSapCost = 31;
+        }
+};
+
+/**
+ * Solutions of the full cross product, as the tracker enumerated them before the hypothesis sets
+ */
+struct CrossProductResult {
+    int solutions = 0;
+    ShuttleEnergyChangeDistribution first;
+    uint32_t possibleNebulaEnergyReduction = 0;
+    uint32_t possibleMeleeVoidFactor = 0;
+    uint32_t possibleSapDropOffFactor = 0;
+};
+
+static CrossProductResult crossProduct(const EnergyObservation& observation, uint32_t nebulaMask, uint32_t voidMask, uint32_t dropOffMask) {
+    CrossProductResult result;
+    ShuttleEnergyChangeDistribution distribution;
+    distribution.moveCost = observation.moveCost;
+    distribution.tileEnergy = observation.tileEnergy;
+    distribution.unitStackCount = observation.unitStackCount;
+    distribution.meleeSapEnergies = observation.meleeSapEnergies;
+
+    std::vector<std::pair<int, int>> nebulaSet;
+    if (observation.inNebula) {
+        for (int index = 0; index < std::ssize(POSSIBLE_NEBULA_ENERGY_REDUCTION_VALUES); ++index) {
+            if (nebulaMask & (1u << index)) {
+                nebulaSet.push_back({index, POSSIBLE_NEBULA_ENERGY_REDUCTION_VALUES[index]});
+            }
+        }
+    } else {
+        nebulaSet.push_back({-1, 0});
+    }
+    std::vector<std::pair<int, float>> voidSet;
+    if (observation.meleeSapEnergies.empty()) {
+        voidSet.push_back({-1, 1.0});
+    } else {
+        for (int index = 0; index < std::ssize(POSSIBLE_UNIT_ENERGY_VOID_FACTOR_VALUES); ++index) {
+            if (voidMask & (1u << index)) {
+                voidSet.push_back({index, POSSIBLE_UNIT_ENERGY_VOID_FACTOR_VALUES[index]});
+            }
+        }
+    }
+    std::vector<std::pair<int, float>> dropOffSet;
+    for (int index = 0; index < std::ssize(POSSIBLE_UNIT_SAP_DROP_OFF_FACTOR_VALUES); ++index) {
+        if (dropOffMask & (1u << index)) {
+            dropOffSet.push_back({index, POSSIBLE_UNIT_SAP_DROP_OFF_FACTOR_VALUES[index]});
+        }
+    }
+
+    for (auto [nebulaIndex, nebulaEnergyReduction] : nebulaSet) {
+        distribution.nebulaEnergyReduction = nebulaEnergyReduction;
+        for (int direct = 0; direct <= observation.directSapCandidates; ++direct) {
+            distribution.rangedDirectSapCount = direct;
+            for (int indirect = 0; indirect <= observation.indirectSapCandidates; ++indirect) {
+                for (int dropOffId = 0; dropOffId < std::ssize(dropOffSet); ++dropOffId) {
+                    auto [dropOffIndex, dropOffFactor] = dropOffSet[dropOffId];
+                    if (indirect == 0) {
+                        dropOffFactor = 1.0;
+                        dropOffId = std::ssize(dropOffSet);
+                    }
+                    distribution.rangedIndirectSapDropOffFactor = dropOffFactor;
+                    distribution.rangedIndirectSapCount = indirect;
+
+                    for (auto [voidIndex, voidFactor] : voidSet) {
+                        distribution.meleeEnergyVoidFactor = voidFactor;
+                        if (distribution.computeEnergy(observation.previousEnergy) != observation.energy) {
+                            continue;
+                        }
+                        if (result.solutions++ == 0) {
+                            result.first = distribution;
+                        }
+                        if (observation.inNebula) {
+                            result.possibleNebulaEnergyReduction |= 1u << nebulaIndex;
+                        }
+                        if (distribution.computedMeleeSapEnergy > 0) {
+                            result.possibleMeleeVoidFactor |= 1u << voidIndex;
+                        }
+                        if (indirect > 0 && dropOffFactor < 1.0) {
+                            result.possibleSapDropOffFactor |= 1u << dropOffIndex;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return result;
+}
+
+/**
+ * A shuttle in a fight: opponents in sap range, some next to it, and an energy that one hidden combination explains
+ */
+static EnergyObservation makeObservation(std::mt19937& gen, int sapCandidates) {
+    EnergyObservation observation;
+    observation.previousEnergy = gen() % 300;
+    observation.moveCost = gen() % 2 ? 4 : 0;
+    observation.tileEnergy = static_cast<int>(gen() % 17) - 6;
+    observation.unitStackCount = 1 + gen() % 2;
+    observation.inNebula = gen() % 2;
+    observation.directSapCandidates = sapCandidates;
+    observation.indirectSapCandidates = sapCandidates;
+    int neighbours = gen() % 5;
+    for (int i = 0; i < neighbours; ++i) {
+        observation.meleeSapEnergies.push_back(1 + gen() % 250);
+    }
+
+    ShuttleEnergyChangeDistribution truth;
+    truth.moveCost = observation.moveCost;
+    truth.tileEnergy = observation.tileEnergy;
+    truth.unitStackCount = observation.unitStackCount;
+    truth.meleeSapEnergies = observation.meleeSapEnergies;
+    truth.nebulaEnergyReduction = observation.inNebula ? POSSIBLE_NEBULA_ENERGY_REDUCTION_VALUES[gen() % 6] : 0;
+    truth.rangedDirectSapCount = gen() % 3;
+    truth.rangedIndirectSapCount = gen() % 3;
+    truth.rangedIndirectSapDropOffFactor = POSSIBLE_UNIT_SAP_DROP_OFF_FACTOR_VALUES[gen() % 3];
+    truth.meleeEnergyVoidFactor = POSSIBLE_UNIT_ENERGY_VOID_FACTOR_VALUES[gen() % 4];
+    observation.energy = truth.computeEnergy(observation.previousEnergy);
+    if (gen() % 10 == 0) {
+        // Something the model does not know about
+        observation.energy += 7;
+    }
+    return observation;
+}
+
+TEST_F(EnergyInferenceTest, PredictEnergyMatchesTheDistribution) {
+    for (int energyBeforeGain = -50; energyBeforeGain <= 450; energyBeforeGain += 7) {
+        for (int energyGain = -30; energyGain <= 30; energyGain += 5) {
+            for (bool attack : {false, true}) {
+                ShuttleEnergyChangeDistribution distribution;
+                distribution.tileEnergy = energyGain;
+                distribution.rangedDirectSapCount = attack;
+                GameEnvConfig::getInstance().unitSapCost = 0;
+                int expected = distribution.computeEnergy(energyBeforeGain);
+                GameEnvConfig::getInstance().unitSapCost = 31;
+                EXPECT_EQ(EnergyInference::predictEnergy(energyBeforeGain, energyGain, attack), expected);
+            }
+        }
+    }
+}
+
+TEST_F(EnergyInferenceTest, MatchesTheCrossProduct) {
+    std::mt19937 gen(5);
+    for (int trial = 0; trial < 5000; ++trial) {
+        EnergyObservation observation = makeObservation(gen, gen() % 8);
+        observation.exhaustive = trial % 3 != 0;
+
+        EnergyInference energyInference;
+        energyInference.nebulaEnergyReduction.retain(gen() | 1u << (gen() % 6));
+        energyInference.meleeVoidFactor.retain(gen() | 1u << (gen() % 4));
+        energyInference.sapDropOffFactor.retain(gen() | 1u << (gen() % 3));
+
+        EnergyExplanation explanation;
+        energyInference.explain(observation, explanation);
+        CrossProductResult expected = crossProduct(observation, energyInference.nebulaEnergyReduction.getMask(),
+            energyInference.meleeVoidFactor.getMask(), energyInference.sapDropOffFactor.getMask());
+
+        ASSERT_EQ(explanation.solutions > 0, expected.solutions > 0) << "trial " << trial;
+        if (expected.solutions == 0) {
+            continue;
+        }
+        EXPECT_EQ(explanation.nebulaEnergyReduction, expected.first.nebulaEnergyReduction) << "trial " << trial;
+        EXPECT_EQ(explanation.rangedDirectSapCount, expected.first.rangedDirectSapCount) << "trial " << trial;
+        EXPECT_EQ(explanation.rangedIndirectSapCount, expected.first.rangedIndirectSapCount) << "trial " << trial;
+        EXPECT_EQ(explanation.meleeSapEnergy, expected.first.computedMeleeSapEnergy) << "trial " << trial;
+        if (!observation.exhaustive) {
+            continue;
+        }
+
+        // What the tracker prunes with
+        EXPECT_EQ(explanation.solutions == 1, expected.solutions == 1) << "trial " << trial;
+        EXPECT_EQ(explanation.possibleNebulaEnergyReduction, expected.possibleNebulaEnergyReduction) << "trial " << trial;
+        EXPECT_EQ(explanation.possibleMeleeVoidFactor, expected.possibleMeleeVoidFactor) << "trial " << trial;
+        if (expected.solutions == 1) {
+            EXPECT_EQ(explanation.possibleSapDropOffFactor, expected.possibleSapDropOffFactor) << "trial " << trial;
+        }
+    }
+}
+
+TEST_F(EnergyInferenceTest, PinsTheNebulaReduction) {
+    EnergyInference energyInference;
+    EnergyObservation observation;
+    observation.previousEnergy = 100;
+    observation.tileEnergy = 2;
+    observation.inNebula = true;
+    observation.energy = 100 + 2 - 25;
+
+    EnergyExplanation explanation;
+    energyInference.explain(observation, explanation);
+    ASSERT_EQ(explanation.solutions, 1);
+    energyInference.nebulaEnergyReduction.retain(explanation.possibleNebulaEnergyReduction);
+    ASSERT_TRUE(energyInference.nebulaEnergyReduction.isPinned());
+    EXPECT_EQ(energyInference.nebulaEnergyReduction.getPinnedValue(), 25);
+    EXPECT_EQ(energyInference.nebulaEnergyReduction.toString("nebula"), "nebula values: [25]");
+}
+
+TEST_F(EnergyInferenceTest, HeavyCombatBenchmark) {
+    // 16 shuttles a step, each with every opponent in sap range and every hypothesis still open
+    const int steps = 200;
+    const int shuttles = 16;
+    std::mt19937 gen(9);
+    std::vector<EnergyObservation> observations;
+    for (int i = 0; i < steps * shuttles; ++i) {
+        observations.push_back(makeObservation(gen, 16));
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    long long crossProductSolutions = 0;
+    for (const EnergyObservation& observation : observations) {
+        crossProductSolutions += crossProduct(observation, ~0u, ~0u, ~0u).solutions > 0;
+    }
+    auto crossProductMicros = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count();
+
+    EnergyInference energyInference;
+    EnergyExplanation explanation;
+    start = std::chrono::high_resolution_clock::now();
+    long long inferenceSolutions = 0;
+    for (const EnergyObservation& observation : observations) {
+        energyInference.explain(observation, explanation);
+        inferenceSolutions += explanation.solutions > 0;
+    }
+    auto inferenceMicros = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count();
+
+    EXPECT_EQ(inferenceSolutions, crossProductSolutions);
+    std::cout << "Cross product : " << crossProductMicros / static_cast<double>(steps) << " us per step" << std::endl;
+    std::cout << "Inference     : " << inferenceMicros / static_cast<double>(steps) << " us per step" << std::endl;
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,258 @@
+#include "agent/planning/job_assignment.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <random>
+#include <set>
+#include "game_env_config.h"
+#include "config.h"
+
+class JobAssignmentTest : public ::testing::Test {
+    protected:
+        void SetUp() override {
+            Logger::getInstance().enableLogging("../../test.log");
+            GameEnvConfig::getInstance().mapWidth = 24;
+            GameEnvConfig::getInstance().mapHeight = 24;
+        }
+};
+
+/**
+ * Jobs and applications of one step, made the way the roles make them: miners and explorers apply for the tile they
+ * stand on, navigators for every target in reach with the path length as a penalty.
+ */
+struct RandomBoard {
+    static constexpr int SIZE = 24;
+
+    GameMap gameMap{SIZE, SIZE};
+    JobArena jobArena;
+    std::vector<std::unique_ptr<ShuttleData>> shuttles;
+    JobBoard jobBoard{gameMap};
+};
+
+static std::unique_ptr<RandomBoard> makeBoard(int seed, int shuttleCount, int jobCount, int span) {
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<> coordinate(0, span - 1);
+    auto board = std::make_unique<RandomBoard>();
+    board->jobArena.reset(jobCount + shuttleCount);
+
+    // Every tile posts at most one job of a type
+    std::vector<Job*> jobs;
+    std::set<std::pair<int, int>> taken;
+    int jobId = 0;
+    for (int attempt = 0; attempt < 10 * jobCount && std::ssize(jobs) < jobCount; ++attempt) {
+        int x = coordinate(gen);
+        int y = coordinate(gen);
+        int kind = gen() % 3;
+        if (!taken.insert({kind, y * RandomBoard::SIZE + x}).second) {
+            continue;
+        }
+        if (kind == 0) {
+            jobs.push_back(board->jobArena.create<RelicMinerJob>(jobId++, x, y));
+            jobs.push_back(board->jobArena.create<RelicMiningNavigatorJob>(jobId++, x, y));
+        } else if (kind == 1) {
+            jobs.push_back(board->jobArena.create<HaloNodeExplorerJob>(jobId++, x, y));
+            jobs.push_back(board->jobArena.create<HaloNodeNavigatorJob>(jobId++, x, y));
+        } else {
+            jobs.push_back(board->jobArena.create<TrailblazerNavigatorJob>(jobId++, x, y));
+        }
+    }
+    for (int shuttleId = 0; shuttleId < shuttleCount; ++shuttleId) {
+        RechargeJob* rechargeJob = board->jobArena.create<RechargeJob>(jobId++);
+        rechargeJob->preferredShuttle = shuttleId;
+        jobs.push_back(rechargeJob);
+    }
+    for (Job* job : jobs) {
+        board->jobBoard.addJob(job);
+    }
+
+    for (int shuttleId = 0; shuttleId < shuttleCount; ++shuttleId) {
+        auto shuttle = std::make_unique<ShuttleData>(shuttleId, ShuttleType::PLAYER);
+        if (shuttleId % 2 == 0) {
+            // Half of the shuttles stand on a target
+            Job* job = jobs[gen() % (jobs.size() - shuttleCount)];
+            shuttle->position = {job->targetX, job->targetY};
+        } else {
+            shuttle->position = {coordinate(gen), coordinate(gen)};
+        }
+        board->shuttles.push_back(std::move(shuttle));
+    }
+
+    for (auto& shuttle : board->shuttles) {
+        for (Job* job : jobs) {
+            int distance = std::abs(job->targetX - shuttle->getX()) + std::abs(job->targetY - shuttle->getY());
+            int applicationPriority;
+            if (job->jobType == JobType::RECHARGE) {
+                if (job->as<RechargeJob>()->preferredShuttle != shuttle->id || gen() % 4 != 0) {
+                    continue;
+                }
+                applicationPriority = -1 - static_cast<int>(gen() % 10);
+            } else if (job->jobType == JobType::RELIC_MINER || job->jobType == JobType::HALO_NODE_EXPLORER) {
+                if (distance != 0) {
+                    continue;
+                }
+                applicationPriority = 1;
+            } else {
+                if (distance < 1 || distance > 10) {
+                    continue;
+                }
+                applicationPriority = -distance;
+            }
+            board->jobBoard.applyForJob(job, shuttle.get(), {0, 0, 0}).setPriority(applicationPriority);
+        }
+    }
+    board->jobBoard.sortJobApplications(board->gameMap);
+    return board;
+}
+
+/**
+ * Target a job competes for in the optimal assignment, relic miners and relic mining navigators share theirs
+ */
+static std::pair<int, int> getTarget(const Job* job) {
+    if (job->jobType == JobType::RECHARGE) {
+        return {JobType::RECHARGE, job->id};
+    }
+    JobType targetType = job->jobType == JobType::RELIC_MINING_NAVIGATOR ? JobType::RELIC_MINER : job->jobType;
+    return {targetType, job->targetY * RandomBoard::SIZE + job->targetX};
+}
+
+static void expectValid(RandomBoard& board, const JobAssignment& jobAssignment) {
+    std::set<int> shuttleIds;
+    std::set<std::pair<int, int>> targets;
+    long long total = 0;
+    for (int jobApplicationId : jobAssignment.getAcceptedIds()) {
+        JobApplication& jobApplication = board.jobBoard.getJobApplications()[jobApplicationId];
+        EXPECT_EQ(jobApplication.getStatus(), JobApplicationStatus::ACCEPTED);
+        EXPECT_TRUE(shuttleIds.insert(jobApplication.shuttleData->id).second) << "shuttle assigned twice";
+        EXPECT_TRUE(targets.insert({jobApplication.job->jobType, getTarget(jobApplication.job).second}).second) << "target assigned twice";
+        total += jobApplication.priority;
+    }
+    EXPECT_EQ(total, jobAssignment.getAssignedPriority());
+
+    for (JobApplication& jobApplication : board.jobBoard.getJobApplications()) {
+        EXPECT_NE(jobApplication.getStatus(), JobApplicationStatus::APPLIED);
+    }
+}
+
+/**
+ * Highest total priority over every way to give each shuttle one of its applications or none
+ */
+static long long bruteForce(RandomBoard& board) {
+    std::vector<std::vector<JobApplication*>> applicationsByShuttle(board.shuttles.size());
+    for (JobApplication& jobApplication : board.jobBoard.getJobApplications()) {
+        applicationsByShuttle[jobApplication.shuttleData->id].push_back(&jobApplication);
+    }
+
+    std::set<std::pair<int, int>> targets;
+    std::function<long long(int)> search = [&](int shuttleId) -> long long {
+        if (shuttleId == std::ssize(applicationsByShuttle)) {
+            return 0;
+        }
+        long long best = search(shuttleId + 1);
+        for (JobApplication* jobApplication : applicationsByShuttle[shuttleId]) {
+            if (jobApplication->priority <= 0 || !targets.insert(getTarget(jobApplication->job)).second) {
+                continue;
+            }
+            best = std::max(best, jobApplication->priority + search(shuttleId + 1));
+            targets.erase(getTarget(jobApplication->job));
+        }
+        return best;
+    };
+    return search(0);
+}
+
+TEST_F(JobAssignmentTest, GreedyTakesEveryTargetOnce) {
+    auto board = makeBoard(1, 16, 300, RandomBoard::SIZE);
+    JobAssignment jobAssignment(board->gameMap);
+    jobAssignment.reset(board->shuttles.size());
+    jobAssignment.assignGreedily(board->jobBoard, board->jobBoard.getSortedJobApplicationIds());
+
+    EXPECT_GT(jobAssignment.getAcceptedIds().size(), 0);
+    expectValid(*board, jobAssignment);
+}
+
+TEST_F(JobAssignmentTest, RelicMiningNavigatorStaysAwayFromAMinedTile) {
+    RandomBoard board;
+    board.jobArena.reset(2);
+    RelicMinerJob* relicMinerJob = board.jobArena.create<RelicMinerJob>(0, 3, 3);
+    RelicMiningNavigatorJob* navigatorJob = board.jobArena.create<RelicMiningNavigatorJob>(1, 3, 3);
+    board.jobBoard.addJob(relicMinerJob);
+    board.jobBoard.addJob(navigatorJob);
+
+    for (int shuttleId = 0; shuttleId < 2; ++shuttleId) {
+        board.shuttles.push_back(std::make_unique<ShuttleData>(shuttleId, ShuttleType::PLAYER));
+    }
+    board.shuttles[0]->position = {3, 3};
+    board.shuttles[1]->position = {3, 5};
+    board.jobBoard.applyForJob(relicMinerJob, board.shuttles[0].get(), {0, 0, 0}).setPriority(1);
+    board.jobBoard.applyForJob(navigatorJob, board.shuttles[1].get(), {3, 0, 0}).setPriority(-2);
+    board.jobBoard.sortJobApplications(board.gameMap);
+
+    for (bool optimal : {false, true}) {
+        JobAssignment jobAssignment(board.gameMap);
+        jobAssignment.reset(2);
+        if (optimal) {
+            jobAssignment.assignOptimally(board.jobBoard);
+        } else {
+            jobAssignment.assignGreedily(board.jobBoard, board.jobBoard.getSortedJobApplicationIds());
+        }
+        ASSERT_EQ(jobAssignment.getAcceptedIds(), std::vector<int>{0});
+        EXPECT_EQ(board.jobBoard.getJobApplications()[1].getStatus(), JobApplicationStatus::TARGET_BUSY);
+    }
+}
+
+TEST_F(JobAssignmentTest, OptimalMatchesBruteForce) {
+    for (int seed = 0; seed < 200; ++seed) {
+        // A small corner of the map, so the shuttles compete for the few targets
+        auto board = makeBoard(seed, 5, 8, 5);
+        JobAssignment jobAssignment(board->gameMap);
+        jobAssignment.reset(board->shuttles.size());
+        jobAssignment.assignOptimally(board->jobBoard);
+
+        expectValid(*board, jobAssignment);
+        ASSERT_EQ(jobAssignment.getAssignedPriority(), bruteForce(*board)) << "seed " << seed;
+    }
+}
+
+TEST_F(JobAssignmentTest, OptimalBenchmark) {
+    const int boards = 200;
+    long long greedyTotal = 0;
+    long long optimalTotal = 0;
+    long long greedyMicros = 0;
+    long long optimalMicros = 0;
+    int improvedBoards = 0;
+
+    for (int seed = 0; seed < boards; ++seed) {
+        long long priorities[2];
+        for (bool optimal : {false, true}) {
+            auto board = makeBoard(seed, 16, 300, RandomBoard::SIZE);
+            JobAssignment jobAssignment(board->gameMap);
+            jobAssignment.reset(board->shuttles.size());
+
+            auto start = std::chrono::high_resolution_clock::now();
+            if (optimal) {
+                jobAssignment.assignOptimally(board->jobBoard);
+            } else {
+                jobAssignment.assignGreedily(board->jobBoard, board->jobBoard.getSortedJobApplicationIds());
+            }
+            long long micros = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count();
+
+            expectValid(*board, jobAssignment);
+            priorities[optimal] = jobAssignment.getAssignedPriority();
+            (optimal ? optimalMicros : greedyMicros) += micros;
+        }
+        EXPECT_GE(priorities[1], priorities[0]) << "seed " << seed;
+        greedyTotal += priorities[0];
+        optimalTotal += priorities[1];
+        improvedBoards += priorities[1] > priorities[0];
+    }
+
+    std::cout << "Greedy  : " << greedyTotal / static_cast<double>(boards) << " priority, " << greedyMicros / static_cast<double>(boards) << " us per board" << std::endl;
+    std::cout << "Optimal : " << optimalTotal / static_cast<double>(boards) << " priority, " << optimalMicros / static_cast<double>(boards) << " us per board" << std::endl;
+    std::cout << "Optimal assigned more on " << improvedBoards << " of " << boards << " boards" << std::endl;
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,158 @@
+#include "agent/planning/jobs.h"
+#include <gtest/gtest.h>
+#include "game_env_config.h"
+
+class JobsTest : public ::testing::Test {
+    protected:
+        static constexpr int SIZE = 24;
+
+        GameMap gameMap{SIZE, SIZE};
+        JobArena jobArena;
+
+        void SetUp() override {
+            Logger::getInstance().enableLogging("../../test.log");
+            GameEnvConfig::getInstance().mapWidth = SIZE;
+            GameEnvConfig::getInstance().mapHeight = SIZE;
+            jobArena.reset(8);
+        }
+};
+
+TEST_F(JobsTest, AsReachesTheTaggedJob) {
+    Job* recharge = jobArena.create<RechargeJob>(0);
+    ASSERT_NE(recharge->as<RechargeJob>(), nullptr);
+    recharge->as<RechargeJob>()->preferredShuttle = 3;
+    EXPECT_EQ(static_cast<RechargeJob*>(recharge)->preferredShuttle, 3);
+
+    Job* defender = jobArena.create<DefenderJob>(1, 4, 5);
+    ASSERT_NE(defender->as<DefenderJob>(), nullptr);
+    EXPECT_EQ(defender->as<DefenderJob>()->targetX, 4);
+}
+
+TEST_F(JobsTest, AsRejectsAnotherJobType) {
+    Job* recharge = jobArena.create<RechargeJob>(0);
+    Job* miner = jobArena.create<RelicMinerJob>(1, 2, 3);
+    EXPECT_EQ(recharge->as<DefenderJob>(), nullptr);
+    EXPECT_EQ(miner->as<RechargeJob>(), nullptr);
+    EXPECT_EQ(miner->as<NavigatorJob>(), nullptr);
+}
+
+TEST_F(JobsTest, AsNavigatorJobCoversEveryNavigator) {
+    Job* relicMining = jobArena.create<RelicMiningNavigatorJob>(0, 1, 1);
+    Job* haloNode = jobArena.create<HaloNodeNavigatorJob>(1, 2, 2);
+    Job* trailblazer = jobArena.create<TrailblazerNavigatorJob>(2, 3, 3);
+    for (Job* job : {relicMining, haloNode, trailblazer}) {
+        ASSERT_NE(job->as<NavigatorJob>(), nullptr);
+        EXPECT_EQ(job->as<NavigatorJob>()->targetX, job->targetX);
+    }
+    EXPECT_EQ(haloNode->as<RelicMiningNavigatorJob>(), nullptr);
+}
+
+TEST_F(JobsTest, DefenderJobKeepsAtMostNineOpponentPositions) {
+    DefenderJob* defender = jobArena.create<DefenderJob>(0, 4, 4);
+    for (int i = 0; i < DefenderJob::MAX_OPPONENT_POSITIONS + 2; ++i) {
+        defender->addOpponentPosition(i, 4);
+    }
+    ASSERT_EQ(defender->getAllOpponentPositions().size(), static_cast<size_t>(DefenderJob::MAX_OPPONENT_POSITIONS));
+    EXPECT_EQ(defender->getAllOpponentPositions().back(), std::make_pair(DefenderJob::MAX_OPPONENT_POSITIONS - 1, 4));
+}
+
+class JobBoardTest : public JobsTest {
+    protected:
+        std::unique_ptr<JobBoard> jobBoard;
+
+        void SetUp() override {
+            JobsTest::SetUp();
+            jobBoard = std::make_unique<JobBoard>(gameMap);
+        }
+
+        template <typename T, typename... Args>
+        T* post(Args&&... args) {
+            T* job = jobArena.create<T>(std::forward<Args>(args)...);
+            jobBoard->addJob(job);
+            return job;
+        }
+
+        int tileId(int x, int y) { return gameMap.getTile(x, y).getId(); }
+};
+
+TEST_F(JobBoardTest, GroupsJobsOfSeveralTypesOnTheSameTile) {
+    Job* miner = post<RelicMinerJob>(0, 5, 7);
+    Job* otherTile = post<RelicMiningNavigatorJob>(1, 6, 7);
+    Job* navigator = post<RelicMiningNavigatorJob>(2, 5, 7);
+    Job* defender = post<DefenderJob>(3, 5, 7);
+    Job* secondDefender = post<DefenderJob>(4, 5, 7);
+    jobBoard->indexJobs();
+
+    auto jobsAt = jobBoard->getJobsAt(tileId(5, 7));
+    ASSERT_EQ(jobsAt.size(), 4u);
+    EXPECT_EQ(jobsAt[0], miner);
+    EXPECT_EQ(jobsAt[1], navigator);
+    EXPECT_EQ(jobsAt[2], defender);
+    EXPECT_EQ(jobsAt[3], secondDefender);
+
+    ASSERT_EQ(jobBoard->getJobsAt(tileId(6, 7)).size(), 1u);
+    EXPECT_EQ(jobBoard->getJobsAt(tileId(6, 7))[0], otherTile);
+
+    auto navigators = jobBoard->getJobs(JobType::RELIC_MINING_NAVIGATOR);
+    ASSERT_EQ(navigators.size(), 2u);
+    EXPECT_EQ(navigators[0], otherTile);
+    EXPECT_EQ(navigators[1], navigator);
+    EXPECT_EQ(jobBoard->getJobs(JobType::DEFENDER).size(), 2u);
+    EXPECT_EQ(jobBoard->getJobs().size(), 5u);
+}
+
+TEST_F(JobBoardTest, EmptyTilesHaveNoJobs) {
+    post<RelicMinerJob>(0, 0, 0);
+    post<HaloNodeExplorerJob>(1, SIZE - 1, SIZE - 1);
+    post<RechargeJob>(2);
+    jobBoard->indexJobs();
+
+    EXPECT_EQ(jobBoard->getJobsAt(tileId(0, 0)).size(), 1u);
+    EXPECT_EQ(jobBoard->getJobsAt(tileId(SIZE - 1, SIZE - 1)).size(), 1u);
+    int jobsOnTiles = 0;
+    for (int id = 0; id < SIZE * SIZE; ++id) {
+        jobsOnTiles += jobBoard->getJobsAt(id).size();
+    }
+    // The recharge job has no target tile
+    EXPECT_EQ(jobsOnTiles, 2);
+    EXPECT_EQ(jobBoard->getJobs(JobType::RECHARGE).size(), 1u);
+    EXPECT_TRUE(jobBoard->getJobs(JobType::TRAILBLAZER_NAVIGATOR).empty());
+
+    EXPECT_TRUE(jobBoard->getJobsAt(-1).empty());
+    EXPECT_TRUE(jobBoard->getJobsAt(SIZE * SIZE).empty());
+}
+
+TEST_F(JobBoardTest, NothingOnTheTilesBeforeIndexing) {
+    post<RelicMinerJob>(0, 3, 3);
+    EXPECT_TRUE(jobBoard->getJobsAt(tileId(3, 3)).empty());
+    EXPECT_EQ(jobBoard->getJobs(JobType::RELIC_MINER).size(), 1u);
+}
+
+TEST_F(JobBoardTest, ChildBoardsShareTheParentIndex) {
+    Job* miner = post<RelicMinerJob>(0, 2, 9);
+    Job* navigator = post<HaloNodeNavigatorJob>(1, 2, 9);
+    jobBoard->indexJobs();
+
+    JobBoard child(gameMap, *jobBoard);
+    EXPECT_EQ(child.getJobs().data(), jobBoard->getJobs().data());
+    EXPECT_EQ(child.getJobs(JobType::HALO_NODE_NAVIGATOR).data(), jobBoard->getJobs(JobType::HALO_NODE_NAVIGATOR).data());
+    auto jobsAt = child.getJobsAt(tileId(2, 9));
+    ASSERT_EQ(jobsAt.size(), 2u);
+    EXPECT_EQ(jobsAt.data(), jobBoard->getJobsAt(tileId(2, 9)).data());
+    EXPECT_EQ(jobsAt[0], miner);
+    EXPECT_EQ(jobsAt[1], navigator);
+
+    // Applications stay on the child until merged
+    ShuttleData shuttle(0, PLAYER);
+    child.applyForJob(navigator, &shuttle, {1, 0, 0});
+    EXPECT_EQ(child.getJobApplications().size(), 1u);
+    EXPECT_TRUE(jobBoard->getJobApplications().empty());
+    jobBoard->mergeApplications(child);
+    ASSERT_EQ(jobBoard->getJobApplications().size(), 1u);
+    EXPECT_EQ(jobBoard->getJobApplications()[0].job, navigator);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
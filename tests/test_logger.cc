@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "datastructures/spsc_ring.h"
+#include "logger.h"
+
+TEST(SpscRingTest, KeepsOrderAcrossThreads) {
+    const int count = 200000;
+    SpscRing<int> ring(64);
+
+    std::thread producer([&]() {
+        for (int i = 0; i < count; i++) {
+            int value = i;
+            while (!ring.tryPush(std::move(value))) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    int expected = 0;
+    int value;
+    while (expected < count) {
+        if (ring.tryPop(value)) {
+            ASSERT_EQ(value, expected);
+            expected++;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    EXPECT_TRUE(ring.empty());
+}
+
+TEST(SpscRingTest, RejectsPushWhenFull) {
+    SpscRing<std::string> ring(3);
+    EXPECT_EQ(ring.capacity(), 4u);
+
+    for (int i = 0; i < 4; i++) {
+        EXPECT_TRUE(ring.tryPush(std::to_string(i)));
+    }
+    std::string rejected = "rejected";
+    EXPECT_FALSE(ring.tryPush(std::move(rejected)));
+    EXPECT_EQ(rejected, "rejected");
+
+    std::string value;
+    EXPECT_TRUE(ring.tryPop(value));
+    EXPECT_EQ(value, "0");
+}
+
+TEST(LoggerTest, WritesEveryLineFromEveryThread) {
+    const std::string filename = "logger_test.log";
+    std::remove(filename.c_str());
+
+    const int threads = 4;
+    const int linesPerThread = 5000; // More than a ring holds, producers have to wait for the writer
+    Logger::getInstance().enableLogging(filename);
+    Logger::getInstance().setStepId("1/1");
+
+    std::vector<std::thread> producers;
+    for (int t = 0; t < threads; t++) {
+        producers.emplace_back([t]() {
+            for (int i = 0; i < linesPerThread; i++) {
+                Logger::getInstance().log("thread " + std::to_string(t) + " line " + std::to_string(i));
+            }
+        });
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    Logger::getInstance().disableLogging();
+    EXPECT_FALSE(Logger::isEnabled());
+
+    std::ifstream logFile(filename);
+    std::string line;
+    int lines = 0;
+    std::vector<int> nextLine(threads, 0);
+    while (std::getline(logFile, line)) {
+        ASSERT_NE(line.find(" : 1/1 : "), std::string::npos) << line;
+        int t = std::stoi(line.substr(line.find("thread ") + 7));
+        int i = std::stoi(line.substr(line.find("line ") + 5));
+        EXPECT_EQ(i, nextLine[t]++) << "lines of a thread stay in order";
+        lines++;
+    }
+    EXPECT_EQ(lines, threads * linesPerThread);
+    std::remove(filename.c_str());
+}
+
+TEST(LoggerTest, SkipsMessageConstructionWhenDisabled) {
+    int evaluated = 0;
+    auto message = [&evaluated]() {
+        evaluated++;
+        return std::string("built");
+    };
+    auto log = [](const std::string& message) { Logger::getInstance().log(message); };
+
+    Logger::getInstance().disableLogging();
+    LOG_WARN(message());
+    EXPECT_EQ(evaluated, 0);
+}
+
+TEST(LoggerTest, FiltersLevelsAtRuntime) {
+    const std::string filename = "logger_level_test.log";
+    std::remove(filename.c_str());
+
+    int evaluated = 0;
+    auto message = [&evaluated](const std::string& text) {
+        evaluated++;
+        return text;
+    };
+    auto log = [](const std::string& message) { Logger::getInstance().log(message); };
+
+    Logger::getInstance().setLevel(LogLevel::INFO);
+    Logger::getInstance().enableLogging(filename);
+    EXPECT_FALSE(Logger::isEnabled(LogLevel::DEBUG));
+    EXPECT_TRUE(Logger::isEnabled(LogLevel::INFO));
+
+    LOG_TRACE(message("trace"));
+    LOG_DEBUG(message("debug"));
+    LOG_WARN(message("warn"));
+    Logger::getInstance().disableLogging();
+    Logger::getInstance().setLevel(LogLevel::DEBUG);
+
+    EXPECT_EQ(evaluated, 1);
+
+    std::ifstream logFile(filename);
+    std::string line;
+    int lines = 0;
+    while (std::getline(logFile, line)) {
+        EXPECT_NE(line.find("warn"), std::string::npos);
+        lines++;
+    }
+    EXPECT_EQ(lines, evaluated);
+    std::remove(filename.c_str());
+}
+
+TEST(LoggerTest, ParsesLevelNames) {
+    EXPECT_EQ(Logger::parseLevel("trace"), LogLevel::TRACE);
+    EXPECT_EQ(Logger::parseLevel("info"), LogLevel::INFO);
+    EXPECT_EQ(Logger::parseLevel("warn"), LogLevel::WARN);
+    EXPECT_EQ(Logger::parseLevel("debug"), LogLevel::DEBUG);
+    EXPECT_EQ(Logger::parseLevel(""), LogLevel::DEBUG);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
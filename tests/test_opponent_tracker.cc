@@ -0,0 +1,321 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <iostream>
+#include <random>
+
+#include "agent/opponent_tracker.h"
+#include "config.h"
+#include "constants.h"
+#include "game_env_config.h"
+
+using Positions = std::vector<std::vector<std::vector<double>>>;
+using Energies = std::vector<std::vector<std::vector<int>>>;
+
+class OpponentTrackerTest : public ::testing::Test {
+    protected:
+        const int size = 24;
+        const int units = 16;
+
+        GameMap* gameMap;
+        RespawnRegistry respawnRegistry;
+
+        void SetUp() override {
+            Logger::getInstance().enableLogging("../../test.log");
+
+            GameEnvConfig& gameEnvConfig = GameEnvConfig::getInstance();
+            gameEnvConfig.maxUnits = units;
+            gameEnvConfig.mapWidth = size;
+            gameEnvConfig.mapHeight = size;
+            gameEnvConfig.unitMoveCost = 4;
+            gameEnvConfig.originX = 0;
+            gameEnvConfig.originY = 0;
+            gameEnvConfig.opponentOriginX = size - 1;
+            gameEnvConfig.opponentOriginY = size - 1;
+
+            gameMap = new GameMap(size, size);
+            gameMap->derivedGameState.nebulaTileEnergyReduction = 5;
+            gameMap->derivedGameState.nebulaTileEnergyReductionSet = true;
+
+            std::mt19937 random(11);
+            for (int x = 0; x < size; ++x) {
+                for (int y = 0; y < size; ++y) {
+                    GameTile& tile = gameMap->getTile(x, y);
+                    int roll = random() % 10;
+                    tile.setType(roll == 0 ? TileType::ASTEROID : roll < 3 ? TileType::NEBULA : TileType::EMPTY, 0, false);
+                    tile.setEstimatedEnergy(static_cast<int>(random() % 17) - 6);
+                }
+            }
+
+            // Every opponent is seen once around their origin and then goes dark
+            for (int s = 0; s < units; ++s) {
+                ShuttleData* shuttle = new ShuttleData(s, ShuttleType::OPPONENT);
+                shuttle->visible = true;
+                shuttle->ghost = false;
+                shuttle->position = {size - 1 - s % 4, size - 1 - s / 4};
+                shuttle->energy = 20 + 10 * s;
+                gameMap->opponentShuttles.push_back(shuttle);
+            }
+        }
+
+        void TearDown() override {
+            for (ShuttleData* shuttle : gameMap->opponentShuttles) {
+                delete shuttle;
+            }
+            delete gameMap;
+        }
+
+        /**
+         * A 7x7 sensor window that sweeps over the map, so the visible tiles change every step
+         */
+        void moveSensors(int step) {
+            int cx = (step * 3) % size;
+            int cy = (step * 5) % size;
+            for (int x = 0; x < size; ++x) {
+                for (int y = 0; y < size; ++y) {
+                    gameMap->getTile(x, y).setVisible(std::abs(x - cx) <= 3 && std::abs(y - cy) <= 3);
+                }
+            }
+            gameMap->derivedGameState.currentStep = step;
+        }
+
+        void hideOpponents() {
+            for (ShuttleData* shuttle : gameMap->opponentShuttles) {
+                shuttle->visible = false;
+                shuttle->ghost = true;
+            }
+        }
+
+        /**
+         * The scatter propagation the tracker used before the belief tensor, one shuttle at a time over nested vectors
+         */
+        void referenceStep(Positions& positions, Energies& energies, int s) {
+            GameEnvConfig& gameEnvConfig = GameEnvConfig::getInstance();
+            DerivedGameState& state = gameMap->derivedGameState;
+            std::vector<std::vector<double>> previousPositions = positions[s];
+            std::vector<std::vector<int>> previousEnergies = energies[s];
+            positions[s].assign(size, std::vector<double>(size, 0.0));
+            energies[s].assign(size, std::vector<int>(size, 0));
+
+            double lostProbability = 0.0;
+            std::vector<std::vector<bool>> visited(size, std::vector<bool>(size, false));
+            int count = 0;
+            for (int x = 0; x < size; ++x) {
+                for (int y = 0; y < size; ++y) {
+                    if (previousPositions[x][y] < LOWEST_DOUBLE) {
+                        continue;
+                    }
+                    if (previousEnergies[x][y] < 0) {
+                        lostProbability += previousPositions[x][y];
+                        continue;
+                    }
+                    for (int pmi = 0; pmi < POSSIBLE_MOVE_SIZE; pmi++) {
+                        int xNext = POSSIBLE_MOVES[pmi][0] + x;
+                        int yNext = POSSIBLE_MOVES[pmi][1] + y;
+                        if (!gameMap->isValidTile(xNext, yNext)) {
+                            lostProbability += previousPositions[x][y] / 5.0;
+                            continue;
+                        }
+                        GameTile& nextTile = gameMap->getTile(xNext, yNext);
+                        TileType type = gameMap->getEstimatedType(nextTile, state.currentStep);
+                        if ((type == TileType::ASTEROID && pmi != 0) || nextTile.isVisible()) {
+                            lostProbability += previousPositions[x][y] / 5.0;
+                            continue;
+                        }
+                        int newEnergy = previousEnergies[x][y] + nextTile.getLastKnownEnergy();
+                        if (pmi != 0) {
+                            newEnergy -= gameEnvConfig.unitMoveCost;
+                            if (newEnergy < 0) {
+                                lostProbability += previousPositions[x][y] / 5.0;
+                                continue;
+                            }
+                        }
+                        if (type == TileType::NEBULA && state.nebulaTileEnergyReductionSet) {
+                            newEnergy -= state.nebulaTileEnergyReduction;
+                        }
+                        newEnergy = std::clamp(newEnergy, 0, static_cast<int>(MAX_ENERGY));
+
+                        energies[s][xNext][yNext] = std::max(energies[s][xNext][yNext], newEnergy);
+                        positions[s][xNext][yNext] += previousPositions[x][y] / 5.0;
+                        if (positions[s][xNext][yNext] > LOWEST_DOUBLE && !visited[xNext][yNext]) {
+                            visited[xNext][yNext] = true;
+                            count++;
+                        }
+                    }
+                }
+            }
+
+            for (int x = 0; x < size; ++x) {
+                for (int y = 0; y < size; ++y) {
+                    if (positions[s][x][y] > LOWEST_DOUBLE) {
+                        positions[s][x][y] += lostProbability / count;
+                    }
+                }
+            }
+        }
+};
+
+TEST_F(OpponentTrackerTest, PropagationMatchesScalarReference) {
+    OpponentTracker tracker(*gameMap, respawnRegistry);
+
+    moveSensors(0);
+    tracker.step();
+    hideOpponents();
+
+    Positions positions(units, std::vector<std::vector<double>>(size, std::vector<double>(size, 0.0)));
+    Energies energies(units, std::vector<std::vector<int>>(size, std::vector<int>(size, 0)));
+    for (int s = 0; s < units; ++s) {
+        ShuttleData* shuttle = gameMap->opponentShuttles[s];
+        positions[s][shuttle->getX()][shuttle->getY()] = 1.0;
+        energies[s][shuttle->getX()][shuttle->getY()] = shuttle->energy;
+    }
+
+    for (int step = 1; step <= 30; ++step) {
+        moveSensors(step);
+        tracker.step();
+
+        auto& trackedPositions = tracker.getOpponentPositionProbabilities();
+        auto& trackedEnergies = tracker.getOpponentMaxPossibleEnergies();
+        for (int s = 0; s < units; ++s) {
+            referenceStep(positions, energies, s);
+            double total = 0.0;
+            for (int x = 0; x < size; ++x) {
+                for (int y = 0; y < size; ++y) {
+                    ASSERT_NEAR(trackedPositions[s][x][y], positions[s][x][y], 1e-12) << "step " << step << " shuttle " << s << " at " << x << ", " << y;
+                    ASSERT_EQ(trackedEnergies[s][x][y], energies[s][x][y]) << "step " << step << " shuttle " << s << " at " << x << ", " << y;
+                    total += trackedPositions[s][x][y];
+                }
+            }
+            EXPECT_NEAR(total, 1.0, 1e-9);
+        }
+
+        // The previous step stays readable until the next one
+        EXPECT_NE(&tracker.getOpponentPreviousPositionProbabilities(), &trackedPositions);
+    }
+}
+
+TEST_F(OpponentTrackerTest, StepBenchmark) {
+    const int steps = 200;
+    OpponentTracker tracker(*gameMap, respawnRegistry);
+
+    moveSensors(0);
+    tracker.step();
+    hideOpponents();
+
+    long long total = 0;
+    for (int step = 1; step <= steps; ++step) {
+        moveSensors(step);
+        auto start = std::chrono::high_resolution_clock::now();
+        tracker.step();
+        total += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count();
+    }
+
+    Positions positions(units, std::vector<std::vector<double>>(size, std::vector<double>(size, 0.0)));
+    Energies energies(units, std::vector<std::vector<int>>(size, std::vector<int>(size, 0)));
+    for (int s = 0; s < units; ++s) {
+        positions[s][size - 1][size - 1] = 1.0;
+        energies[s][size - 1][size - 1] = 100;
+    }
+    long long referenceTotal = 0;
+    for (int step = 1; step <= steps; ++step) {
+        moveSensors(step);
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int s = 0; s < units; ++s) {
+            referenceStep(positions, energies, s);
+        }
+        referenceTotal += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count();
+    }
+
+    std::cout << "OpponentTracker::step() with " << units << " units on " << size << "x" << size << " : "
+              << total / static_cast<double>(steps) << " us/step, scalar reference "
+              << referenceTotal / static_cast<double>(steps) << " us/step" << std::endl;
+}
+
+TEST_F(OpponentTrackerTest, SparseSupportMatchesDensePropagation) {
+    float previousShare = Config::denseBeliefShare;
+    Config::denseBeliefShare = 0.0f;
+    OpponentTracker denseTracker(*gameMap, respawnRegistry);
+    Config::denseBeliefShare = 1.0f;
+    OpponentTracker sparseTracker(*gameMap, respawnRegistry);
+
+    moveSensors(0);
+    Config::denseBeliefShare = 0.0f;
+    denseTracker.step();
+    Config::denseBeliefShare = 1.0f;
+    sparseTracker.step();
+    hideOpponents();
+
+    for (int step = 1; step <= 40; ++step) {
+        moveSensors(step);
+        Config::denseBeliefShare = 0.0f;
+        denseTracker.step();
+        Config::denseBeliefShare = 1.0f;
+        sparseTracker.step();
+
+        auto& denseProbabilities = denseTracker.getOpponentPositionProbabilities();
+        auto& sparseProbabilities = sparseTracker.getOpponentPositionProbabilities();
+        auto& denseEnergies = denseTracker.getOpponentMaxPossibleEnergies();
+        auto& sparseEnergies = sparseTracker.getOpponentMaxPossibleEnergies();
+        for (int s = 0; s < units; ++s) {
+            const BeliefSupport& support = sparseTracker.getSupport(s);
+            EXPECT_FALSE(support.dense);
+            EXPECT_TRUE(denseTracker.getSupport(s).dense);
+            for (int x = 0; x < size; ++x) {
+                for (int y = 0; y < size; ++y) {
+                    ASSERT_DOUBLE_EQ(sparseProbabilities[s][x][y], denseProbabilities[s][x][y]) << "step " << step << " shuttle " << s;
+                    ASSERT_EQ(sparseEnergies[s][x][y], denseEnergies[s][x][y]) << "step " << step << " shuttle " << s;
+
+                    bool inside = x >= support.xMin && x <= support.xMax && y >= support.yMin && y <= support.yMax;
+                    if (!inside) {
+                        ASSERT_EQ(sparseProbabilities[s][x][y], 0.0) << "step " << step << " shuttle " << s << " outside its support";
+                    }
+                }
+            }
+        }
+
+        auto& denseAtleastOne = denseTracker.getAtleastOneShuttleProbabilities();
+        auto& sparseAtleastOne = sparseTracker.getAtleastOneShuttleProbabilities();
+        for (int x = 0; x < size; ++x) {
+            for (int y = 0; y < size; ++y) {
+                ASSERT_DOUBLE_EQ(sparseAtleastOne[x][y], denseAtleastOne[x][y]);
+            }
+        }
+    }
+    Config::denseBeliefShare = previousShare;
+}
+
+TEST_F(OpponentTrackerTest, EarlyMatchBenchmark) {
+    // The first steps after the opponents go dark, when their beliefs only cover a few tiles
+    const int steps = 20;
+    const int rounds = 20;
+    float previousShare = Config::denseBeliefShare;
+    for (float share : {0.0f, previousShare}) {
+        Config::denseBeliefShare = share;
+        long long total = 0;
+        for (int round = 0; round < rounds; ++round) {
+            for (ShuttleData* shuttle : gameMap->opponentShuttles) {
+                shuttle->visible = true;
+                shuttle->ghost = false;
+            }
+            OpponentTracker tracker(*gameMap, respawnRegistry);
+            moveSensors(0);
+            tracker.step();
+            hideOpponents();
+
+            for (int step = 1; step <= steps; ++step) {
+                moveSensors(step);
+                auto start = std::chrono::high_resolution_clock::now();
+                tracker.step();
+                total += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count();
+            }
+        }
+        std::cout << "OpponentTracker::step() over the first " << steps << " dark steps, " << (share == 0.0f ? "dense" : "sparse") << " : "
+                  << total / static_cast<double>(steps * rounds) << " us/step" << std::endl;
+    }
+    Config::denseBeliefShare = previousShare;
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -1,13 +1,19 @@
 #include <gtest/gtest.h>
 #include "parser.h"
 
-TEST(ParserTest, SimpleJSONParseTest) {
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <random>
 
-    std::string input = R"(
+const std::string SAMPLE_OBSERVATION = R"(
     {"obs": {"units": {"position": [[[-1, -1], [-1, -1], [-1, -1], [-1, -1], [-1, -1], [-1, -1], [-1, -1], [-1, -1], [-1, -1], [-1, -1], [-1, -1], [-1, -1], [-1, -1], [-1, -1], [-1, -1], [-1, -1]], [[-1, -1], [-1, -1], [-1, -1], [-1, -1], [-1, -1], [-1, -1], [-1, -1], [-1, -1], [-1, -1], [-1, -1], [-1, -1], [-1, -1], [-1, -1], [-1, -1], [-1, -1], [-1, -1]]], "energy": [[-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1], [-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1]]}, "units_mask": [[false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false], [false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false]], "sensor_mask": [[false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false], [false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false], [false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false], [false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false], [false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false], [false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false], [false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false], [false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false], [false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false], [false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false], [false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false], [false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false], [false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false], [false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false], [false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false], [false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false], [false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false], [false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false], [false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false], [false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false], [false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false], [false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false], [false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false], [false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false]], "map_features": {"energy": [[-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1], [-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1], [-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1], [-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1], [-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1], [-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1], [-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1], [-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1], [-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1], [-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1], [-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1], [-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1], [-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1], [-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1], [-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1], [-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1], [-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1], [-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1], [-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1], [-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1], [-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1], [-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1], [-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1], [-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1]], "tile_type": [[-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1], [-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1], [-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1], [-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1], [-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1], [-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1], [-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1], [-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1], [-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1], [-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1], [-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1], [-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1], [-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1], [-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1], [-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1], [-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1], [-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1], [-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1], [-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1], [-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1], [-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1], [-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1], [-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1], [-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1]]}, "relic_nodes": [[-1, -1], [-1, -1], [-1, -1], [-1, -1], [-1, -1], [-1, -1]], "relic_nodes_mask": [false, false, false, false, false, false], "team_points": [0, 0], "team_wins": [0, 0], "steps": 0, "match_steps": 5}, "step": 0, "remainingOverageTime": 600, "player": "player_1", "reward": 0.0, "info": {"env_cfg": {"max_units": 16, "match_count_per_episode": 5, "max_steps_in_match": 100, "map_height": 24, "map_width": 24, "num_teams": 2, "unit_move_cost": 1, "unit_sap_cost": 38, "unit_sap_range": 5, "unit_sensor_range": 2}}}
     )";
 
-    GameState gameState = parse(input);
+
+TEST(ParserTest, SimpleJSONParseTest) {
+
+    GameState gameState = parse(SAMPLE_OBSERVATION);
     
     std::cout << "Working to print?" << to_string(gameState) << std::endl;
 
@@ -16,6 +22,157 @@ TEST(ParserTest, SimpleJSONParseTest) {
     EXPECT_EQ(gameState.info.envCfg["max_units"], 16);
 }
 
+/**
+ * Observation stream used by the streaming parser tests. Set MOSFET_OBSERVATION_STREAM to an application log (or a
+ * file with one observation per line) to replay a recorded game, otherwise a synthetic stream is derived from the sample.
+ */
+std::vector<std::string> observationStream() {
+    std::vector<std::string> stream;
+
+    const char* recording = std::getenv("MOSFET_OBSERVATION_STREAM");
+    if (recording != nullptr) {
+        std::ifstream file(recording);
+        std::string line;
+        const std::string marker = "Input --> ";
+        while (std::getline(file, line)) {
+            auto position = line.find(marker);
+            if (position != std::string::npos) {
+                stream.push_back(line.substr(position + marker.size()));
+            } else if (!line.empty() && line[0] == '{') {
+                stream.push_back(line);
+            }
+        }
+        if (!stream.empty()) {
+            return stream;
+        }
+    }
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> coordinate(-1, 23);
+    std::uniform_int_distribution<int> energy(-20, 400);
+    std::uniform_int_distribution<int> tileType(-1, 2);
+    std::bernoulli_distribution flag(0.5);
+
+    json sample = json::parse(SAMPLE_OBSERVATION);
+    for (int step = 0; step < 100; step++) {
+        json& obs = sample["obs"];
+        for (auto& team : obs["units"]["position"]) {
+            for (auto& position : team) {
+                position = {coordinate(rng), coordinate(rng)};
+            }
+        }
+        for (auto& team : obs["units"]["energy"]) {
+            for (auto& value : team) {
+                value = energy(rng);
+            }
+        }
+        for (auto& team : obs["units_mask"]) {
+            for (auto& value : team) {
+                value = flag(rng);
+            }
+        }
+        for (auto& row : obs["sensor_mask"]) {
+            for (auto& value : row) {
+                value = flag(rng);
+            }
+        }
+        for (auto& row : obs["map_features"]["energy"]) {
+            for (auto& value : row) {
+                value = energy(rng) % 21;
+            }
+        }
+        for (auto& row : obs["map_features"]["tile_type"]) {
+            for (auto& value : row) {
+                value = tileType(rng);
+            }
+        }
+        for (auto& relic : obs["relic_nodes"]) {
+            relic = {coordinate(rng), coordinate(rng)};
+        }
+        for (auto& value : obs["relic_nodes_mask"]) {
+            value = flag(rng);
+        }
+        obs["team_points"] = {step * 3, step * 2};
+        obs["steps"] = step;
+        obs["match_steps"] = step % 101;
+        sample["remainingOverageTime"] = 600 - step;
+        if (step > 0) {
+            // The env only sends env_cfg on the first step
+            sample["info"] = json::object();
+        }
+        stream.push_back(sample.dump());
+    }
+    return stream;
+}
+
+void expectSameObservation(const GameState& expected, const GameState& actual) {
+    EXPECT_EQ(expected.obs.units.position, actual.obs.units.position);
+    EXPECT_EQ(expected.obs.units.energy, actual.obs.units.energy);
+    EXPECT_EQ(expected.obs.unitsMask, actual.obs.unitsMask);
+    EXPECT_EQ(expected.obs.sensorMask, actual.obs.sensorMask);
+    EXPECT_EQ(expected.obs.mapFeatures.energy, actual.obs.mapFeatures.energy);
+    EXPECT_EQ(expected.obs.mapFeatures.tileType, actual.obs.mapFeatures.tileType);
+    EXPECT_EQ(expected.obs.relicNodesMask, actual.obs.relicNodesMask);
+    EXPECT_EQ(expected.obs.relicNodes, actual.obs.relicNodes);
+    EXPECT_EQ(expected.obs.teamPoints, actual.obs.teamPoints);
+    EXPECT_EQ(expected.obs.teamWins, actual.obs.teamWins);
+    EXPECT_EQ(expected.obs.steps, actual.obs.steps);
+    EXPECT_EQ(expected.obs.matchSteps, actual.obs.matchSteps);
+    EXPECT_EQ(expected.remainingOverageTime, actual.remainingOverageTime);
+    EXPECT_EQ(expected.player, actual.player);
+}
+
+TEST(ParserTest, StreamingParserMatchesJsonParse) {
+    std::vector<std::string> stream = observationStream();
+
+    ObservationParser observationParser;
+    GameState gameState;
+    for (const auto& input : stream) {
+        observationParser.parse(input, gameState);
+        expectSameObservation(parse(input), gameState);
+    }
+
+    EXPECT_TRUE(observationParser.isPrepared());
+    EXPECT_EQ(gameState.info.envCfg["max_units"], 16);
+}
+
+TEST(ParserTest, StreamingParserRejectsMalformedInput) {
+    ObservationParser observationParser;
+    GameState gameState;
+    observationParser.parse(SAMPLE_OBSERVATION, gameState);
+
+    EXPECT_THROW(observationParser.parse("{\"obs\": {\"steps\": ", gameState), std::invalid_argument);
+}
+
+TEST(ParserTest, StreamingParserBenchmark) {
+    std::vector<std::string> stream = observationStream();
+    const int rounds = 10;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int round = 0; round < rounds; round++) {
+        for (const auto& input : stream) {
+            GameState gameState = parse(input);
+            ASSERT_GE(gameState.obs.steps, 0);
+        }
+    }
+    auto jsonDuration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start);
+
+    ObservationParser observationParser;
+    GameState gameState;
+    start = std::chrono::high_resolution_clock::now();
+    for (int round = 0; round < rounds; round++) {
+        for (const auto& input : stream) {
+            observationParser.parse(input, gameState);
+            ASSERT_GE(gameState.obs.steps, 0);
+        }
+    }
+    auto streamDuration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start);
+
+    double observations = static_cast<double>(rounds * stream.size());
+    std::cout << "json parse      : " << jsonDuration.count() / observations << " us/observation" << std::endl;
+    std::cout << "streaming parse : " << streamDuration.count() / observations << " us/observation" << std::endl;
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -1,6 +1,8 @@
 #include <gtest/gtest.h>
 #include "agent/game_map.h"
 #include "agent/pathing.h"
+#include "agent/pathing_service.h"
+#include "agent/roles/agent_role.h"
 #include "parser.h"
 #include "agent/control_center.h"
 
@@ -44,22 +46,35 @@ TEST_F(PathingTest, FindAllPaths) {
     Pathing* pathing = new Pathing(*gameMap, config);
     GameTile* startTile = &gameMap->getTile(0, 0);
     pathing->findAllPaths(*startTile);
-    auto distances = pathing->distances;
 
     // Check the distances from the start tile to all other tiles
-    EXPECT_EQ(distances[&gameMap->getTile(0, 0)].first, 0);
-    EXPECT_EQ(distances[&gameMap->getTile(1, 0)].first, 1);
-    EXPECT_EQ(distances[&gameMap->getTile(2, 0)].first, 2);
-    EXPECT_EQ(distances[&gameMap->getTile(0, 1)].first, 1);
-    EXPECT_EQ(distances[&gameMap->getTile(1, 1)].first, 2);
-    EXPECT_EQ(distances[&gameMap->getTile(2, 1)].first, 3);
-    EXPECT_EQ(distances[&gameMap->getTile(0, 2)].first, 2);
-    EXPECT_EQ(distances[&gameMap->getTile(1, 2)].first, 3);
-    EXPECT_EQ(distances[&gameMap->getTile(2, 2)].first, 4);
+    EXPECT_EQ(pathing->getDistance(gameMap->getTile(0, 0)), 0);
+    EXPECT_EQ(pathing->getDistance(gameMap->getTile(1, 0)), 1);
+    EXPECT_EQ(pathing->getDistance(gameMap->getTile(2, 0)), 2);
+    EXPECT_EQ(pathing->getDistance(gameMap->getTile(0, 1)), 1);
+    EXPECT_EQ(pathing->getDistance(gameMap->getTile(1, 1)), 2);
+    EXPECT_EQ(pathing->getDistance(gameMap->getTile(2, 1)), 3);
+    EXPECT_EQ(pathing->getDistance(gameMap->getTile(0, 2)), 2);
+    EXPECT_EQ(pathing->getDistance(gameMap->getTile(1, 2)), 3);
+    EXPECT_EQ(pathing->getDistance(gameMap->getTile(2, 2)), 4);
 
     // Check the paths from the start tile to a specific tile
     std::vector<GameTile*> expectedPath = {startTile, &gameMap->getTile(1, 0), &gameMap->getTile(2, 0)};
-    EXPECT_EQ(distances[&gameMap->getTile(2, 0)].second, expectedPath);
+    EXPECT_EQ(pathing->getPath(gameMap->getTile(2, 0)), expectedPath);
+    EXPECT_EQ(pathing->getPathLength(gameMap->getTile(2, 0)), 2);
+    EXPECT_EQ(pathing->getNextTile(gameMap->getTile(2, 0)), &gameMap->getTile(1, 0));
+    EXPECT_EQ(pathing->getNextTile(*startTile), nullptr);
+
+    // Destinations come out closest first
+    int previousDistance = 0;
+    int destinationCount = 0;
+    for (const auto [distance, tile] : pathing->allDestinations) {
+        EXPECT_GE(distance, previousDistance);
+        EXPECT_EQ(distance, pathing->getDistance(*tile));
+        previousDistance = distance;
+        destinationCount++;
+    }
+    EXPECT_EQ(destinationCount, 9);
     delete pathing;
 }
 
@@ -79,16 +94,15 @@ TEST_F(PathingTest, FindAllPathsWithStopAtExploredTiles) {
 
     GameTile* startTile = &gameMap->getTile(0, 0);
     pathing->findAllPaths(*startTile);
-    auto distances = pathing->distances;
 
     // Find the shortest tile that has explored == false
     GameTile* shortestUnexploredTile = nullptr;
     int shortestDistance = std::numeric_limits<int>::max();
 
-    for (const auto& [tile, distancePathPair] : distances) {
-        if (!tile->isExplored() && distancePathPair.first < shortestDistance) {
+    for (const auto [distance, tile] : pathing->allDestinations) {
+        if (!tile->isExplored() && distance < shortestDistance) {
             shortestUnexploredTile = tile;
-            shortestDistance = distancePathPair.first;
+            shortestDistance = distance;
         }
     }
 
@@ -114,31 +128,214 @@ TEST_F(PathingTest, FindLeastEnergyPath) {
 
     GameTile* startTile = &cc->gameMap->getTile(11, 3);
     pathing->findAllPaths(*startTile);
-    auto distances = pathing->distances;
 
     Logger::getInstance().log("Parsed value -> " + std::to_string(gameState.obs.mapFeatures.tileType[4][2]));
     Logger::getInstance().log("Type of (4,2) is " + std::to_string(cc->gameMap->getTile(4, 2).getType()));
     EXPECT_EQ(gameState.obs.mapFeatures.tileType[4][2], 2);
     EXPECT_EQ(cc->gameMap->getTile(4, 2).getType(), 3);
 
-    for (const auto& [tile, distancePathPair] : distances) {
-        // Logger::getInstance().log("Distance to ( " + std::to_string(tile->x) + "," + std::to_string(tile->y) + ") is " + std::to_string(distancePathPair.first));
-        if (tile->x == 5 && tile->y == 8) {
-            Logger::getInstance().log("distance to (5, 8) is " + std::to_string(distancePathPair.first));
-
-            EXPECT_EQ(distancePathPair.first, 65);
-
-            const std::vector<std::tuple<int, int>> idealPath = { {11, 3}, {11, 4}, {10, 4}, {9, 4}, {8, 4}, {8, 5}, {7, 5}, {6, 5}, {6, 6}, {5, 6}, {5, 7}, {5, 8}};
-            int idx = 0;
-            for (GameTile* pathTile : distancePathPair.second) {                
-                Logger::getInstance().log("Step ( " + std::to_string(pathTile->x) + "," + std::to_string(pathTile->y) + "), tileType - " + std::to_string(pathTile->getType()) 
-                + ", energy -> " + std::to_string(pathTile->getEnergy()));
-                EXPECT_EQ(pathTile->x, std::get<0>(idealPath[idx]));
-                EXPECT_EQ(pathTile->y, std::get<1>(idealPath[idx]));
-                idx++;
+    GameTile& destinationTile = cc->gameMap->getTile(5, 8);
+    Logger::getInstance().log("distance to (5, 8) is " + std::to_string(pathing->getDistance(destinationTile)));
+
+    EXPECT_EQ(pathing->getDistance(destinationTile), 65);
+
+    const std::vector<std::tuple<int, int>> idealPath = { {11, 3}, {11, 4}, {10, 4}, {9, 4}, {8, 4}, {8, 5}, {7, 5}, {6, 5}, {6, 6}, {5, 6}, {5, 7}, {5, 8}};
+    std::vector<GameTile*> path = pathing->getPath(destinationTile);
+    ASSERT_EQ(path.size(), idealPath.size());
+    int idx = 0;
+    for (GameTile* pathTile : path) {
+        Logger::getInstance().log("Step ( " + std::to_string(pathTile->x) + "," + std::to_string(pathTile->y) + "), tileType - " + std::to_string(pathTile->getType()) 
+        + ", energy -> " + std::to_string(pathTile->getEnergy()));
+        EXPECT_EQ(pathTile->x, std::get<0>(idealPath[idx]));
+        EXPECT_EQ(pathTile->y, std::get<1>(idealPath[idx]));
+        idx++;
+    }
+    delete pathing;
+    delete cc;
+}
+
+TEST_F(PathingTest, DistanceFieldMatchesForwardSearch) {
+
+    GameState gameState = parse (seed_2087279490);
+    ControlCenter* cc = new ControlCenter();
+    cc->update(gameState);
+    GameMap& map = *cc->gameMap;
+
+    PathingConfig config = PathingService::createLeastEnergyConfig();
+    Pathing* pathing = new Pathing(map, config);
+
+    TileBitboard targets(map.width, map.height);
+    targets.set(map.getTile(5, 8).getId());
+    targets.set(map.getTile(20, 2).getId());
+    targets.set(map.getTile(12, 19).getId());
+
+    pathing->prepareCosts();
+    DistanceField field(map, config);
+    field.compute(targets, pathing->getEntryCosts());
+
+    for (int y = 0; y < map.height; y += 3) {
+        for (int x = 0; x < map.width; x += 2) {
+            GameTile& startTile = map.getTile(x, y);
+            pathing->findAllPaths(startTile);
+
+            int nearest = Pathing::UNREACHABLE;
+            targets.forEach([&](int id) {
+                nearest = std::min(nearest, pathing->getDistance(map.getTile(id)));
+            });
+            EXPECT_EQ(field.distanceToNearest(startTile), nearest) << "from (" << x << ", " << y << ")";
+
+            // Following the field never overshoots the forward distance
+            GameTile* next = field.getNextTile(startTile);
+            if (next != nullptr) {
+                EXPECT_EQ(field.distanceToNearest(*next) + pathing->getEntryCosts()[next->getId()], nearest);
+            }
+        }
+    }
+    delete pathing;
+    delete cc;
+}
+
+TEST_F(PathingTest, PathingServiceSharesFieldsPerStartTile) {
+
+    GameState gameState = parse (seed_2087279490);
+    ControlCenter* cc = new ControlCenter();
+    cc->update(gameState);
+    GameMap& map = *cc->gameMap;
+
+    PathingService service(map);
+    service.beginStep();
+    Pathing* first = service.getLeastEnergyPathing(map.getTile(11, 3));
+    Pathing* second = service.getLeastEnergyPathing(map.getTile(11, 3));
+    Pathing* other = service.getLeastEnergyPathing(map.getTile(3, 11));
+    EXPECT_EQ(first, second);
+    EXPECT_NE(first, other);
+    EXPECT_EQ(service.getDistance(map.getTile(11, 3), map.getTile(5, 8)), 65);
+    delete cc;
+}
+
+TEST_F(PathingTest, RechargeFallsBackToTheRechargeField) {
+
+    GameState gameState = parse (seed_2087279490);
+    ControlCenter* cc = new ControlCenter();
+    cc->update(gameState);
+    GameMap& map = *cc->gameMap;
+
+    PathingService service(map);
+    service.beginStep();
+    const DistanceField& rechargeField = service.getRechargeField();
+
+    // Off any recharge tile, with one in reach
+    GameTile* startTile = nullptr;
+    for (int id = 0; id < map.width * map.height && startTile == nullptr; ++id) {
+        GameTile& tile = map.getTile(id);
+        if (tile.getLastKnownEnergy() <= 0 && rechargeField.getPathLength(tile) > 1) {
+            startTile = &tile;
+        }
+    }
+    ASSERT_NE(startTile, nullptr);
+
+    ShuttleData shuttle(3, PLAYER);
+    shuttle.position = {startTile->x, startTile->y};
+    RechargeAgentRole role(shuttle, map);
+    role.setPathingService(&service);
+
+    // A shuttle following a cached plan still surveys it
+    EXPECT_FALSE(role.plansPaths());
+
+    JobArena jobArena;
+    jobArena.reset(1);
+    JobBoard jobBoard(map);
+    RechargeJob* rechargeJob = jobArena.create<RechargeJob>(0);
+    rechargeJob->preferredShuttle = shuttle.id;
+    jobBoard.addJob(rechargeJob);
+    jobBoard.indexJobs();
+
+    role.surveyJobBoard(jobBoard);
+    ASSERT_EQ(jobBoard.getJobApplications().size(), 1);
+    const JobApplication& jobApplication = jobBoard.getJobApplications()[0];
+    EXPECT_EQ(jobApplication.priority, rechargeJob->priority * JOB_PRIORITY_MULTIPLIER - rechargeField.getPathLength(*startTile));
+    EXPECT_EQ(jobApplication.bestPlan[0], directionToInt(role.getDirectionTo(*rechargeField.getNextTile(*startTile))));
+    delete cc;
+}
+
+TEST_F(PathingTest, TimeExpandedPathGoesAroundADriftingAsteroid) {
+
+    GameMap map(5, 3);
+    map.derivedGameState.currentStep = 0;
+    for (int y = 0; y < 3; ++y) {
+        for (int x = 0; x < 5; ++x) {
+            map.getTile(x, y).setType(TileType::EMPTY, 0, false);
+        }
+    }
+
+    // An asteroid at (1, 2) drifts onto (2, 1) with the drift at step 1
+    DriftForecast& driftForecast = map.getDriftForecast();
+    driftForecast.reset(5, 3, 1, 9);
+    for (int y = 0; y < 3; ++y) {
+        for (int x = 0; x < 5; ++x) {
+            driftForecast.setType(x, y, 0, x == 1 && y == 2 ? TileType::ASTEROID : TileType::EMPTY);
+        }
+    }
+    for (int step = 1; step < 9; ++step) {
+        driftForecast.setOffset(step, 1);
+    }
+    map.getTile(1, 2).setType(TileType::ASTEROID, 0, false);
+    ASSERT_EQ(map.getEstimatedType(map.getTile(2, 1), 1), TileType::ASTEROID);
+
+    PathingConfig config = {};
+    config.pathingHeuristics = SHORTEST_DISTANCE;
+    Pathing pathing(map, config);
+    ForecastCosts forecast;
+    pathing.prepareForecastCosts(8, forecast);
+    EXPECT_EQ(forecast.layers, 2);
+
+    GameTile& startTile = map.getTile(0, 1);
+    GameTile& targetTile = map.getTile(4, 1);
+    pathing.findAllPaths(startTile);
+    EXPECT_EQ(pathing.getDistance(targetTile), 4);
+
+    pathing.findAllPaths(startTile, forecast);
+    EXPECT_EQ(pathing.getDistance(targetTile), 6);
+    std::vector<GameTile*> path = pathing.getPath(targetTile);
+    ASSERT_EQ(path.size(), 7);
+    EXPECT_EQ(path.front(), &startTile);
+    EXPECT_EQ(path.back(), &targetTile);
+    for (int move = 1; move < std::ssize(path); ++move) {
+        EXPECT_NE(path[move], &map.getTile(2, 1)) << "entered the asteroid with move " << move;
+    }
+    EXPECT_EQ(pathing.getNextTile(targetTile), path[1]);
+
+    // Reaching (1, 1) with the first move is still fine
+    EXPECT_EQ(pathing.getDistance(map.getTile(1, 1)), 1);
+}
+
+TEST_F(PathingTest, TimeExpandedMatchesStaticWithoutDrift) {
+
+    GameState gameState = parse (seed_2087279490);
+    ControlCenter* cc = new ControlCenter();
+    cc->update(gameState);
+    GameMap& map = *cc->gameMap;
+
+    PathingConfig config = PathingService::createLeastEnergyConfig();
+    Pathing forward(map, config);
+    Pathing timeExpanded(map, config);
+    ForecastCosts forecast;
+    timeExpanded.prepareForecastCosts(12, forecast);
+    ASSERT_EQ(forecast.layers, 1);
+
+    for (int y = 0; y < map.height; y += 3) {
+        for (int x = 0; x < map.width; x += 2) {
+            GameTile& startTile = map.getTile(x, y);
+            forward.findAllPaths(startTile);
+            timeExpanded.findAllPaths(startTile, forecast);
+            for (int id = 0; id < map.width * map.height; ++id) {
+                GameTile& tile = map.getTile(id);
+                ASSERT_EQ(timeExpanded.getDistance(tile), forward.getDistance(tile)) << "from (" << x << ", " << y << ")";
+                ASSERT_EQ(timeExpanded.getNextTile(tile), forward.getNextTile(tile));
             }
-        }  
+        }
     }
+    delete cc;
 }
 
 int main(int argc, char **argv) {
@@ -0,0 +1,116 @@
+#include "agent/planning/plan_cache.h"
+#include <gtest/gtest.h>
+#include "game_env_config.h"
+#include "config.h"
+
+class PlanCacheTest : public ::testing::Test {
+    protected:
+        static constexpr int SIZE = 24;
+
+        GameMap gameMap{SIZE, SIZE};
+        JobArena jobArena;
+        std::unique_ptr<JobBoard> jobBoard;
+        std::vector<int> entryCost;
+        std::vector<GameTile*> path;
+        PlanCache planCache;
+
+        void SetUp() override {
+            Logger::getInstance().enableLogging("../../test.log");
+            GameEnvConfig::getInstance().mapWidth = SIZE;
+            GameEnvConfig::getInstance().mapHeight = SIZE;
+            entryCost.assign(SIZE * SIZE, 12);
+
+            // (2, 5) -> (6, 5)
+            for (int x = 2; x <= 6; ++x) {
+                path.push_back(&gameMap.getTile(x, 5));
+            }
+            postBoard(true);
+            planCache.commit(JobType::RELIC_MINING_NAVIGATOR, gameMap.getTile(6, 5).getId(), path, entryCost, 10);
+        }
+
+        /**
+         * The board of the next step, with or without the navigator job the shuttle committed to
+         */
+        void postBoard(bool withJob) {
+            jobArena.reset(4);
+            jobBoard = std::make_unique<JobBoard>(gameMap);
+            jobBoard->addJob(jobArena.create<HaloNodeNavigatorJob>(0, 6, 5));
+            if (withJob) {
+                jobBoard->addJob(jobArena.create<RelicMiningNavigatorJob>(1, 6, 5));
+            }
+            jobBoard->indexJobs();
+        }
+
+        bool revalidate(int x, int step) {
+            return planCache.revalidate(*jobBoard, gameMap.getTile(x, 5).getId(), entryCost, step);
+        }
+};
+
+TEST_F(PlanCacheTest, FollowsThePathToTheTarget) {
+    ASSERT_TRUE(revalidate(3, 11));
+    EXPECT_TRUE(planCache.isHit());
+    EXPECT_EQ(planCache.getNextTileId(), gameMap.getTile(4, 5).getId());
+    EXPECT_EQ(planCache.getRemainingPathLength(), 3);
+    ASSERT_NE(planCache.getJob(*jobBoard), nullptr);
+    EXPECT_EQ(planCache.getJob(*jobBoard)->jobType, JobType::RELIC_MINING_NAVIGATOR);
+
+    ASSERT_TRUE(revalidate(4, 12));
+    ASSERT_TRUE(revalidate(5, 13));
+    EXPECT_EQ(planCache.getRemainingPathLength(), 1);
+
+    // On the target the roles take over
+    EXPECT_FALSE(revalidate(6, 14));
+    EXPECT_FALSE(planCache.holds(JobType::RELIC_MINING_NAVIGATOR, gameMap.getTile(6, 5).getId()));
+}
+
+TEST_F(PlanCacheTest, ReplansWhenATileOnThePathChanges) {
+    ASSERT_TRUE(revalidate(3, 11));
+
+    // An asteroid drifted onto the path
+    entryCost[gameMap.getTile(5, 5).getId()] = -1;
+    EXPECT_FALSE(revalidate(4, 12));
+    EXPECT_FALSE(planCache.isHit());
+}
+
+TEST_F(PlanCacheTest, IgnoresChangesBehindTheShuttle) {
+    entryCost[gameMap.getTile(2, 5).getId()] = 20;
+    entryCost[gameMap.getTile(3, 5).getId()] = 20;
+    EXPECT_TRUE(revalidate(3, 11));
+}
+
+TEST_F(PlanCacheTest, ReplansWhenTheJobIsGone) {
+    postBoard(false);
+    EXPECT_FALSE(revalidate(3, 11));
+}
+
+TEST_F(PlanCacheTest, ReplansWhenTheShuttleLeftThePath) {
+    // The move failed
+    EXPECT_FALSE(revalidate(2, 11));
+}
+
+TEST_F(PlanCacheTest, ReplansAfterAMissedStep) {
+    EXPECT_FALSE(revalidate(3, 12));
+}
+
+TEST_F(PlanCacheTest, ReplansOnceThePlanIsTooOld) {
+    std::vector<GameTile*> longPath;
+    for (int x = 0; x <= 20; ++x) {
+        longPath.push_back(&gameMap.getTile(x, 5));
+    }
+    jobArena.reset(4);
+    jobBoard = std::make_unique<JobBoard>(gameMap);
+    jobBoard->addJob(jobArena.create<TrailblazerNavigatorJob>(0, 20, 5));
+    jobBoard->indexJobs();
+    planCache.commit(JobType::TRAILBLAZER_NAVIGATOR, gameMap.getTile(20, 5).getId(), longPath, entryCost, 0);
+
+    int step = 1;
+    for (; step <= Config::planCacheMaxAge; ++step) {
+        ASSERT_TRUE(revalidate(step, step));
+    }
+    EXPECT_FALSE(revalidate(step, step));
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
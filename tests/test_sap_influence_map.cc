@@ -0,0 +1,126 @@
+#include "agent/sap_influence_map.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <unordered_set>
+#include "constants.h"
+#include "logger.h"
+
+class SapInfluenceMapTest : public ::testing::Test {
+    protected:
+        void SetUp() override {
+            Logger::getInstance().enableLogging("../../test.log");
+        }
+};
+
+/**
+ * Previous position probabilities with every opponent spread over a few tiles, some of them too unlikely to count
+ */
+static FlatArray3D<double> makeProbabilities(std::mt19937& gen, int opponents, int width, int height) {
+    FlatArray3D<double> probabilities(opponents, width, height, 0.0);
+    for (int s = 0; s < opponents; ++s) {
+        int tiles = gen() % 6;
+        for (int i = 0; i < tiles; ++i) {
+            probabilities[s][gen() % width][gen() % height] = gen() % 4 == 0 ? LOWEST_DOUBLE / 2 : 0.2;
+        }
+    }
+    return probabilities;
+}
+
+/**
+ * The per shuttle scan the tracker did before the map: every tile of the square around it, every opponent
+ */
+static int scanOpponents(FlatArray3D<double>& probabilities, int opponents, int width, int height, int tileX, int tileY, int radius) {
+    std::unordered_set<int> found;
+    for (int x = tileX - radius; x <= tileX + radius; ++x) {
+        for (int y = tileY - radius; y <= tileY + radius; ++y) {
+            if (x < 0 || y < 0 || x >= width || y >= height) {
+                continue;
+            }
+            for (int s = 0; s < opponents; ++s) {
+                if (probabilities[s][x][y] > LOWEST_DOUBLE) {
+                    found.insert(s);
+                }
+            }
+        }
+    }
+    return found.size();
+}
+
+TEST_F(SapInfluenceMapTest, MatchesTheSquareScan) {
+    std::mt19937 gen(3);
+    for (auto [width, height] : {std::pair{24, 24}, std::pair{7, 13}, std::pair{1, 5}}) {
+        for (int radius = 0; radius <= 9; ++radius) {
+            FlatArray3D<double> probabilities = makeProbabilities(gen, 16, width, height);
+            SapInfluenceMap sapInfluenceMap(width, height);
+            sapInfluenceMap.compute(probabilities, 16, radius);
+
+            for (int x = 0; x < width; ++x) {
+                for (int y = 0; y < height; ++y) {
+                    ASSERT_EQ(sapInfluenceMap.countOpponents(y * width + x), scanOpponents(probabilities, 16, width, height, x, y, radius))
+                        << width << "x" << height << " radius " << radius << " at (" << x << ", " << y << ")";
+                }
+            }
+        }
+    }
+}
+
+TEST_F(SapInfluenceMapTest, KeepsOpponentsApart) {
+    FlatArray3D<double> probabilities(3, 10, 10, 0.0);
+    probabilities[0][2][2] = 1.0;
+    probabilities[2][8][8] = 1.0;
+    SapInfluenceMap sapInfluenceMap(10, 10);
+    sapInfluenceMap.compute(probabilities, 3, 2);
+
+    EXPECT_EQ(sapInfluenceMap.getOpponents(4 * 10 + 4), 0b001);
+    EXPECT_EQ(sapInfluenceMap.getOpponents(6 * 10 + 6), 0b100);
+    EXPECT_EQ(sapInfluenceMap.getOpponents(5 * 10 + 5), 0);
+    EXPECT_EQ(sapInfluenceMap.getOpponents(5 * 10 + 0), 0);
+}
+
+TEST_F(SapInfluenceMapTest, SapRangeBenchmark) {
+    // 16 shuttles resolved a step on a 24x24 map against 16 opponents
+    const int steps = 500;
+    std::mt19937 gen(7);
+    std::vector<FlatArray3D<double>> frames;
+    for (int step = 0; step < 20; ++step) {
+        frames.push_back(makeProbabilities(gen, 16, 24, 24));
+    }
+    std::vector<std::pair<int, int>> shuttles;
+    for (int i = 0; i < 16; ++i) {
+        shuttles.push_back({static_cast<int>(gen() % 24), static_cast<int>(gen() % 24)});
+    }
+
+    SapInfluenceMap sapInfluenceMap(24, 24);
+    for (int sapRange : {3, 5, 7}) {
+        long long scanTotal = 0;
+        long long mapTotal = 0;
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int step = 0; step < steps; ++step) {
+            for (auto [x, y] : shuttles) {
+                scanTotal += scanOpponents(frames[step % frames.size()], 16, 24, 24, x, y, sapRange + 1);
+            }
+        }
+        auto scanMicros = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count();
+
+        start = std::chrono::high_resolution_clock::now();
+        for (int step = 0; step < steps; ++step) {
+            sapInfluenceMap.compute(frames[step % frames.size()], 16, sapRange + 1);
+            for (auto [x, y] : shuttles) {
+                mapTotal += sapInfluenceMap.countOpponents(y * 24 + x);
+            }
+        }
+        auto mapMicros = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count();
+
+        EXPECT_EQ(mapTotal, scanTotal);
+        std::cout << "Sap range " << sapRange << " : scan " << scanMicros / static_cast<double>(steps) << " us, map "
+                  << mapMicros / static_cast<double>(steps) << " us per step" << std::endl;
+    }
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,76 @@
+#include "datastructures/tile_bitboard.h"
+
+#include <gtest/gtest.h>
+#include <random>
+
+class TileBitboardTest : public ::testing::Test {
+    protected:
+        static const int SIZE = 24;
+        TileBitboard board;
+        std::vector<bool> reference;
+
+        void SetUp() override {
+            std::mt19937 rng(11);
+            std::bernoulli_distribution flag(0.3);
+            board.resize(SIZE, SIZE);
+            reference.assign(SIZE * SIZE, false);
+            for (int id = 0; id < SIZE * SIZE; ++id) {
+                if (flag(rng)) {
+                    board.set(id);
+                    reference[id] = true;
+                }
+            }
+        }
+
+        bool referenceAt(int x, int y) {
+            return x >= 0 && x < SIZE && y >= 0 && y < SIZE && reference[y * SIZE + x];
+        }
+};
+
+TEST_F(TileBitboardTest, CountAndComplement) {
+    int expected = 0;
+    for (bool bit : reference) {
+        expected += bit;
+    }
+
+    EXPECT_EQ(board.count(), expected);
+    EXPECT_EQ((~board).count(), SIZE * SIZE - expected);
+    EXPECT_TRUE((board | ~board).all());
+    EXPECT_TRUE((board & ~board).none());
+}
+
+TEST_F(TileBitboardTest, ShiftsDoNotWrapRows) {
+    const int moves[4][2] = {{0, -1}, {1, 0}, {0, 1}, {-1, 0}};
+    for (auto& move : moves) {
+        TileBitboard shifted = board.shifted(move[0], move[1]);
+        for (int y = 0; y < SIZE; ++y) {
+            for (int x = 0; x < SIZE; ++x) {
+                EXPECT_EQ(shifted.test(y * SIZE + x), referenceAt(x - move[0], y - move[1]));
+            }
+        }
+    }
+
+    TileBitboard neighbours = board.neighbours();
+    for (int y = 0; y < SIZE; ++y) {
+        for (int x = 0; x < SIZE; ++x) {
+            bool expected = referenceAt(x, y - 1) || referenceAt(x, y + 1) || referenceAt(x - 1, y) || referenceAt(x + 1, y);
+            EXPECT_EQ(neighbours.test(y * SIZE + x), expected);
+        }
+    }
+}
+
+TEST_F(TileBitboardTest, MirrorFollowsMapSymmetry) {
+    TileBitboard mirrored = board.mirrored();
+    for (int y = 0; y < SIZE; ++y) {
+        for (int x = 0; x < SIZE; ++x) {
+            int mirroredId = (SIZE - x - 1) * SIZE + (SIZE - y - 1);
+            EXPECT_EQ(mirrored.test(mirroredId), referenceAt(x, y));
+        }
+    }
+    EXPECT_EQ(mirrored.mirrored(), board);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
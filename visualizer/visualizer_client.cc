@@ -20,7 +20,8 @@ struct FileCloser {
     }
 };
 
-void saveToFile(const std::vector<std::vector<std::vector<int>>>& data, const std::string& filename, size_t index) {    
+template <typename T>
+void saveToFile(const FlatArray3D<T>& data, const std::string& filename, size_t index) {
     std::ofstream file(filename, std::ios::binary | std::ios::app); // Open in append mode
     if (!file) {
         std::cerr << "Error opening file for writing.\n";
@@ -30,49 +31,23 @@ void saveToFile(const std::vector<std::vector<std::vector<int>>>& data, const st
     // Write the current index for the 4D array (first dimension)
     file.write(reinterpret_cast<const char*>(&index), sizeof(index));
 
-    // Write dimensions of the current 3D array
-    size_t dim1 = data.size();
+    // Write dimensions of the current 3D array, same layout as the nested vectors it used to be
+    size_t dim1 = data.getDepth();
     file.write(reinterpret_cast<const char*>(&dim1), sizeof(dim1));
-    for (const auto& matrix : data) {
-        size_t dim2 = matrix.size();
+    for (int i = 0; i < data.getDepth(); i++) {
+        size_t dim2 = data.getRows();
         file.write(reinterpret_cast<const char*>(&dim2), sizeof(dim2));
-        for (const auto& row : matrix) {
-            size_t dim3 = row.size();
+        for (int j = 0; j < data.getRows(); j++) {
+            size_t dim3 = data.getCols();
             file.write(reinterpret_cast<const char*>(&dim3), sizeof(dim3));
-            file.write(reinterpret_cast<const char*>(row.data()), dim3 * sizeof(int));
+            file.write(reinterpret_cast<const char*>(data[i][j]), dim3 * sizeof(T));
         }
     }
 
     file.close();
 }
 
-void saveToFile(const std::vector<std::vector<std::vector<double>>>& data, const std::string& filename, size_t index) {    
-    std::ofstream file(filename, std::ios::binary | std::ios::app); // Open in append mode
-    if (!file) {
-        std::cerr << "Error opening file for writing.\n";
-        return;
-    }
-
-    // Write the current index for the 4D array (first dimension)
-    file.write(reinterpret_cast<const char*>(&index), sizeof(index));
-
-    // Write dimensions of the current 3D array
-    size_t dim1 = data.size();
-    file.write(reinterpret_cast<const char*>(&dim1), sizeof(dim1));
-    for (const auto& matrix : data) {
-        size_t dim2 = matrix.size();
-        file.write(reinterpret_cast<const char*>(&dim2), sizeof(dim2));
-        for (const auto& row : matrix) {
-            size_t dim3 = row.size();
-            file.write(reinterpret_cast<const char*>(&dim3), sizeof(dim3));
-            file.write(reinterpret_cast<const char*>(row.data()), dim3 * sizeof(double));
-        }
-    }
-
-    file.close();
-}
-
-void saveToFile(const std::vector<std::vector<double>>& data, const std::string& filename, size_t index) {    
+void saveToFile(const FlatArray2D<double>& data, const std::string& filename, size_t index) {
     std::ofstream file(filename, std::ios::binary | std::ios::app); // Open in append mode
     if (!file) {
         std::cerr << "Error opening file for writing.\n";
@@ -83,12 +58,12 @@ void saveToFile(const std::vector<std::vector<double>>& data, const std::string&
     file.write(reinterpret_cast<const char*>(&index), sizeof(index));
 
     // Write dimensions of the current 2D array
-    size_t dim1 = data.size();
+    size_t dim1 = data.getRows();
     file.write(reinterpret_cast<const char*>(&dim1), sizeof(dim1));
-    for (const auto& row : data) {
-        size_t dim2 = row.size();
+    for (int i = 0; i < data.getRows(); i++) {
+        size_t dim2 = data.getCols();
         file.write(reinterpret_cast<const char*>(&dim2), sizeof(dim2));
-        file.write(reinterpret_cast<const char*>(row.data()), dim2 * sizeof(double));
+        file.write(reinterpret_cast<const char*>(data[i]), dim2 * sizeof(double));
     }
 
     file.close();
@@ -118,7 +93,7 @@ std::string VisualizerClient::exec(const char* cmd) {
 std::string VisualizerClient::getData(const std::vector<std::vector<int>>& actions) {
     // Implement the function to return the required data as a JSON string
     // return "{\"grid_size\": [24, 24], \"asteroids\": [[0,0], [0,5],[20,5]], \"blue_shuttles\": [[3,0], [7,5]], \"red_shuttles\": [[4,3], [9,5]]}";
-    log("Collecting data");
+    LOG_DEBUG("Collecting data");
     GameEnvConfig& gameEnvConfig = GameEnvConfig::getInstance();
     
     // Create a JSON object
@@ -138,18 +113,21 @@ std::string VisualizerClient::getData(const std::vector<std::vector<int>>& actio
     jsonObject["unit_sap_range"] = gameEnvConfig.unitSapRange;
     jsonObject["unit_sensor_range"] = gameEnvConfig.unitSensorRange;
 
-    log("Looking for relics - " + std::to_string(relics.size()));
+    LOG_DEBUG("Looking for relics - " + std::to_string(relics.size()));
     // Add relics
     for (const auto& pair : relics) {
         jsonObject["relics"].push_back(pair.second->position);
     }
 
-    log("Looking for asteroids");
+    LOG_DEBUG("Looking for asteroids");
+    std::vector<TileType> estimatedTypes;
+    gameMap.getEstimatedTypes(gameMap.derivedGameState.currentStep, estimatedTypes);
+
     // Add asteroids
     for (int i = 0; i < gameEnvConfig.mapHeight; ++i) {
         for (int j = 0; j < gameEnvConfig.mapWidth; ++j) {
             GameTile& tile = gameMap.getTile(i, j);          
-            TileType tileType = gameMap.getEstimatedType(tile, gameMap.derivedGameState.currentStep);
+            TileType tileType = estimatedTypes[tile.getId()];
             // TileType tileType = tile.getType();
             if (tileType == TileType::ASTEROID) {
                 jsonObject["asteroids"].push_back({i, j});
@@ -171,7 +149,7 @@ std::string VisualizerClient::getData(const std::vector<std::vector<int>>& actio
         }
     }
 
-    log("Looking for player shuttles");
+    LOG_DEBUG("Looking for player shuttles");
     // Blue is always the current player
     for (int i = 0; i < gameEnvConfig.maxUnits; ++i) {
         if (shuttles[i]->getShuttleData().getX() == -1) {
@@ -182,10 +160,10 @@ std::string VisualizerClient::getData(const std::vector<std::vector<int>>& actio
         jsonObject["blue_shuttles_actions"].push_back(actions[i]);
     }
 
-    log("Looking for opponent shuttles");
+    LOG_DEBUG("Looking for opponent shuttles");
     // Red is always the enemy player
     for (int i = 0; i < gameEnvConfig.maxUnits; ++i) {
-        log("Checking opponent shuttle " + std::to_string(i));
+        LOG_TRACE("Checking opponent shuttle " + std::to_string(i));
         // if (opponentShuttles[i]->getShuttleData().getX() == -1 || opponentShuttles[i]->getShuttleData().getY() == -1) {
         //     continue;
         // }
@@ -193,7 +171,7 @@ std::string VisualizerClient::getData(const std::vector<std::vector<int>>& actio
         jsonObject["red_shuttles_energy"].push_back(opponentShuttles[i]->getShuttleData().lastKnownEnergy);        
     }
 
-    log("Done collecing data");
+    LOG_DEBUG("Done collecing data");
     return jsonObject.dump();
 }
 
@@ -245,7 +223,7 @@ int VisualizerClient::sendGameData(const std::vector<std::vector<int>>& actions)
         return 0;
     }
 
-    log("sending game data");
+    LOG_DEBUG("sending game data");
     auto start = std::chrono::high_resolution_clock::now();         
 
     std::string data = getData(actions);
@@ -266,12 +244,12 @@ int VisualizerClient::sendGameData(const std::vector<std::vector<int>>& actions)
     auto end = std::chrono::high_resolution_clock::now();
     auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);      
     Metrics::getInstance().add("visualizer_overhead", duration.count());
-    log("game data sent");
+    LOG_DEBUG("game data sent");
     return 0;
 }
 
 VisualizerClient::~VisualizerClient() {
-    log("Destroying visualizer");
+    LOG_DEBUG("Destroying visualizer");
     if (log_file.is_open()) {
         log_file<<"{}]}"<<std::endl;
         log_file.close();